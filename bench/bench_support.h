@@ -0,0 +1,58 @@
+#pragma once
+
+#include "mxspp/backend/codegen.h"
+#include "mxspp/frontend/action.h"
+#include <format>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <string_view>
+
+namespace mxs::bench {
+    namespace pegtl = tao::pegtl;
+
+    // Synthetic script with `bindings` pairs of top-level bindings. The static
+    // ones fold at compile time; the dynamic ones chain on each other, so they
+    // lower to real code in the module initializer. Every line mixes literals,
+    // prefix and binary operators and name references.
+    inline auto generate_source(std::size_t bindings) -> std::string {
+        std::string source;
+        source.reserve(bindings * 96);
+        auto out = std::back_inserter(source);
+        std::format_to(out, "dynamic let d0 = 1;\n");
+        for (std::size_t i = 1; i <= bindings; ++i) {
+            std::format_to(out, "static let c{0} = ({0} + 3) * 7 - -{0} % 5;\n", i);
+            std::format_to(out, "dynamic let d{0} = (d{1} + c{0}) * 2.5 - {0} / 3;\n", i,
+                           i - 1);
+        }
+        return source;
+    }
+
+    // 与 shell 相同的语法和 action；失败时返回 false
+    inline auto parse(std::string_view source, frontend::actions::AstBuilderState &state)
+            -> bool {
+        pegtl::memory_input input(source.data(), source.size(), "<bench>");
+        return pegtl::parse<frontend::grammar::grammar, frontend::actions::action,
+                            frontend::actions::control>(input, state);
+    }
+
+    // 把解析出的顶层绑定降级进 `module` 的一个初始化函数，返回生成的指令数
+    inline auto lower(const frontend::actions::AstBuilderState &state,
+                      llvm::Module &module) -> std::size_t {
+        auto &context = module.getContext();
+        llvm::IRBuilder<> builder(context);
+        backend::codegen::CodegenContext ctx{ context, &module, &builder };
+        auto *object_ptr = llvm::PointerType::getUnqual(context);
+        auto *init = llvm::Function::Create(llvm::FunctionType::get(object_ptr, false),
+                                            llvm::Function::ExternalLinkage,
+                                            "__mxs_module_init", &module);
+        builder.SetInsertPoint(llvm::BasicBlock::Create(context, "entry", init));
+        for (const auto &node : state.node_stack) {
+            using frontend::ast::BindingStatement;
+            if (auto *binding = dynamic_cast<BindingStatement *>(node.get()))
+                binding->codegen(ctx);
+        }
+        builder.CreateRet(llvm::ConstantPointerNull::get(object_ptr));
+        return init->getInstructionCount();
+    }
+}
@@ -0,0 +1,98 @@
+#include "mxspp/core/MXCollection.h"
+#include "mxspp/core/MXNumeric.h"
+#include "mxspp/core/MXObject.h"
+#include "mxspp/core/MXString.h"
+#include <benchmark/benchmark.h>
+#include <format>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+    using mxs::MXObjectOwned;
+    using mxs::builtin::MXDict;
+    using mxs::builtin::MXInteger;
+    using mxs::builtin::MXList;
+    using mxs::core::MXString;
+
+    // 单个对象的分配/释放：构造和析构都要经过 MXPopulationManager 的锁和集合
+    auto allocate_free(benchmark::State &state) -> void {
+        std::int64_t i = 0;
+        for (auto _ : state) {
+            auto object = std::make_unique<MXInteger>(i++);
+            benchmark::DoNotOptimize(object.get());
+        }
+        state.SetItemsProcessed(state.iterations());
+    }
+    BENCHMARK(allocate_free);
+
+    // 存活对象数量增长时的分配速率（population 集合变大、rehash）
+    auto allocate_batch(benchmark::State &state) -> void {
+        const auto count = static_cast<std::size_t>(state.range(0));
+        std::vector<std::unique_ptr<MXInteger>> live;
+        live.reserve(count);
+        for (auto _ : state) {
+            for (std::size_t i = 0; i < count; ++i)
+                live.push_back(std::make_unique<MXInteger>(static_cast<std::int64_t>(i)));
+            live.clear();
+        }
+        state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * count));
+    }
+    BENCHMARK(allocate_batch)->RangeMultiplier(16)->Range(64, 1 << 16);
+
+    // 动态属性的读取
+    auto property_access(benchmark::State &state) -> void {
+        const auto count = static_cast<std::size_t>(state.range(0));
+        MXInteger object(0);
+        std::vector<std::string> names;
+        for (std::size_t i = 0; i < count; ++i) {
+            names.push_back(std::format("field{}", i));
+            MXObjectOwned value = std::make_unique<MXInteger>(i);
+            object.register_properties(names.back(), std::move(value));
+        }
+        std::size_t i = 0;
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(object.refer_property(names[i++ % count]).get());
+        }
+        state.SetItemsProcessed(state.iterations());
+    }
+    BENCHMARK(property_access)->Arg(4)->Arg(64);
+
+    auto string_build(benchmark::State &state) -> void {
+        const std::string word(static_cast<std::size_t>(state.range(0)), 'x');
+        for (auto _ : state) {
+            MXString text(word);
+            benchmark::DoNotOptimize(text.get_hash_code());
+        }
+        state.SetBytesProcessed(
+                static_cast<std::int64_t>(state.iterations() * word.size()));
+    }
+    BENCHMARK(string_build)->Arg(8)->Arg(256)->Arg(4096);
+
+    auto list_append(benchmark::State &state) -> void {
+        const auto count = state.range(0);
+        for (auto _ : state) {
+            MXList list;
+            for (std::int64_t i = 0; i < count; ++i)
+                list.append(std::make_unique<MXInteger>(i));
+            benchmark::DoNotOptimize(list.at(0));
+        }
+        state.SetItemsProcessed(state.iterations() * count);
+    }
+    BENCHMARK(list_append)->Arg(16)->Arg(1024);
+
+    auto dict_set_get(benchmark::State &state) -> void {
+        const auto count = static_cast<std::size_t>(state.range(0));
+        std::vector<std::string> keys;
+        for (std::size_t i = 0; i < count; ++i) keys.push_back(std::format("key{}", i));
+        for (auto _ : state) {
+            MXDict dict;
+            for (std::size_t i = 0; i < count; ++i)
+                dict.set(keys[i], std::make_unique<MXInteger>(i));
+            for (const auto &key : keys) benchmark::DoNotOptimize(dict.get(key));
+        }
+        state.SetItemsProcessed(
+                static_cast<std::int64_t>(state.iterations() * count * 2));
+    }
+    BENCHMARK(dict_set_get)->Arg(16)->Arg(1024);
+}
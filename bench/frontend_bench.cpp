@@ -0,0 +1,45 @@
+#include "bench_support.h"
+#include <benchmark/benchmark.h>
+
+namespace {
+    using mxs::frontend::actions::AstBuilderState;
+
+    // 解析吞吐：每轮从头解析同一份生成的源码
+    auto parse_throughput(benchmark::State &state) -> void {
+        const auto source = mxs::bench::generate_source(state.range(0));
+        for (auto _ : state) {
+            AstBuilderState ast;
+            if (!mxs::bench::parse(source, ast)) {
+                state.SkipWithError("generated source does not parse");
+                return;
+            }
+            benchmark::DoNotOptimize(ast.node_stack.data());
+        }
+        state.SetBytesProcessed(
+                static_cast<std::int64_t>(state.iterations() * source.size()));
+        state.SetComplexityN(state.range(0));
+    }
+    BENCHMARK(parse_throughput)->RangeMultiplier(4)->Range(16, 4096)->Complexity();
+
+    // 代码生成耗时与 AST 规模的关系；解析只做一次，每轮换新的 LLVMContext
+    auto codegen_time(benchmark::State &state) -> void {
+        AstBuilderState ast;
+        if (!mxs::bench::parse(mxs::bench::generate_source(state.range(0)), ast)) {
+            state.SkipWithError("generated source does not parse");
+            return;
+        }
+        std::size_t instructions = 0;
+        for (auto _ : state) {
+            llvm::LLVMContext context;
+            llvm::Module module("bench", context);
+            instructions = mxs::bench::lower(ast, module);
+            benchmark::ClobberMemory();
+        }
+        state.counters["nodes"] = static_cast<double>(ast.node_stack.size());
+        state.counters["instructions"] = static_cast<double>(instructions);
+        state.SetItemsProcessed(
+                static_cast<std::int64_t>(state.iterations() * ast.node_stack.size()));
+        state.SetComplexityN(state.range(0));
+    }
+    BENCHMARK(codegen_time)->RangeMultiplier(4)->Range(16, 4096)->Complexity();
+}
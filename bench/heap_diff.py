@@ -0,0 +1,199 @@
+#!/usr/bin/env python3
+"""Compares two heap snapshots written by `mxs --heap-snapshot`.
+
+A snapshot is JSON Lines: a header, then one line per live MXObject with its
+address, type, allocation size and outgoing references (see
+core::MXPopulationManager::write_snapshot).
+
+The report has two parts:
+  growth by type   objects and bytes per type in both snapshots, sorted by
+                   bytes gained
+  retaining paths  for the types that grew the most, the chains of references
+                   that keep their new objects alive, starting at a root
+
+Nothing in the runtime traces the native stack, so a root is any object that
+no other object refers to: it is owned by C++ code, a compiled function's
+frame or a global. Paths are the shortest ones from such a root. List indices
+are folded into "[*]" so that paths through the same container group together.
+An object counts as new when its address is missing from the older snapshot or
+holds an object of another type there.
+"""
+
+import argparse
+import collections
+import json
+import re
+import sys
+
+SNAPSHOT_FORMAT = "mxs-heap-snapshot"
+# 每个类型最多追溯这么多个新对象的保留路径，足以看出主要的路径形状
+MAX_TRACED = 2000
+
+
+# ==============================================================================
+# Helper Functions for Colored Output
+# ==============================================================================
+
+
+class Colors:
+    """ANSI color codes"""
+
+    BLUE = "\033[0;34m"
+    GREEN = "\033[0;32m"
+    RED = "\033[0;31m"
+    YELLOW = "\033[0;33m"
+    NC = "\033[0m"
+
+
+def info(msg):
+    print(f"{Colors.BLUE}[INFO]{Colors.NC} {msg}")
+
+
+def warn(msg):
+    print(f"{Colors.YELLOW}[WARNING]{Colors.NC} {msg}")
+
+
+def error(msg):
+    print(f"{Colors.RED}[ERROR]{Colors.NC} {msg}", file=sys.stderr)
+
+
+# ==============================================================================
+# Snapshot Loading
+# ==============================================================================
+
+
+class Snapshot:
+    def __init__(self, path):
+        self.path = path
+        self.objects = {}
+        with open(path, encoding="utf-8") as file:
+            header = json.loads(file.readline() or "{}")
+            if header.get("format") != SNAPSHOT_FORMAT:
+                raise ValueError(f"'{path}' is not an mxs heap snapshot")
+            for line in file:
+                record = json.loads(line)
+                self.objects[record["id"]] = record
+        if len(self.objects) != header.get("objects"):
+            warn(f"'{path}' is truncated: {len(self.objects)} of "
+                 f"{header.get('objects')} objects")
+
+    def totals_by_type(self):
+        totals = collections.defaultdict(lambda: [0, 0])
+        for record in self.objects.values():
+            entry = totals[record["type"]]
+            entry[0] += 1
+            entry[1] += record["size"]
+        return totals
+
+    def shortest_paths(self):
+        """Parent of every reachable object on a shortest path from a root."""
+        referenced = set()
+        for record in self.objects.values():
+            referenced.update(target for _, target in record["refs"])
+        roots = [oid for oid, record in self.objects.items()
+                 if oid not in referenced or record["static"]]
+        parent = {oid: None for oid in roots}
+        queue = collections.deque(roots)
+        while queue:
+            oid = queue.popleft()
+            for edge, target in self.objects[oid]["refs"]:
+                # 引用可能指向快照之后才登记的对象，这里没有它的记录
+                if target in parent or target not in self.objects:
+                    continue
+                parent[target] = (oid, edge)
+                queue.append(target)
+        return parent
+
+    def path_to(self, parent, oid):
+        if oid not in parent:
+            return f"(unreachable, only held by a cycle) {self.objects[oid]['type']}"
+        steps = []
+        while parent[oid] is not None:
+            holder, edge = parent[oid]
+            steps.append(re.sub(r"^\[\d+\]$", "[*]", edge))
+            oid = holder
+        return self.objects[oid]["type"] + "".join(reversed(steps))
+
+
+# ==============================================================================
+# Report
+# ==============================================================================
+
+
+def new_objects(old, new):
+    for oid, record in new.objects.items():
+        previous = old.objects.get(oid)
+        if previous is None or previous["type"] != record["type"]:
+            yield oid, record
+
+
+def report_growth(old, new, top):
+    before = old.totals_by_type()
+    after = new.totals_by_type()
+    rows = []
+    for type_name in before.keys() | after.keys():
+        old_count, old_bytes = before.get(type_name, (0, 0))
+        new_count, new_bytes = after.get(type_name, (0, 0))
+        rows.append((new_bytes - old_bytes, new_count - old_count, type_name,
+                     old_count, new_count))
+    rows.sort(key=lambda row: (row[0], row[1]), reverse=True)
+
+    print(f"Growth by type: '{old.path}' -> '{new.path}'")
+    print(f"  {'Objects':>21}  {'Delta':>8}  {'Bytes (KiB)':>11}  Type")
+    for bytes_delta, count_delta, type_name, old_count, new_count in rows[:top]:
+        print(f"  {old_count:>9} -> {new_count:<9}  {count_delta:>+8}  "
+              f"{bytes_delta / 1024:>+11.1f}  {type_name}")
+    old_total = sum(count for count, _ in before.values())
+    new_total = sum(count for count, _ in after.values())
+    print(f"  {old_total:>9} -> {new_total:<9}  {new_total - old_total:>+8}  "
+          f"{'':>11}  Total")
+    return [row[2] for row in rows if row[1] > 0]
+
+
+def report_paths(old, new, type_names, paths):
+    parent = new.shortest_paths()
+    added = collections.defaultdict(list)
+    for oid, record in new_objects(old, new):
+        added[record["type"]].append(oid)
+    for type_name in type_names:
+        objects = added.get(type_name, [])
+        if not objects:
+            continue
+        traced = objects[:MAX_TRACED]
+        shapes = collections.Counter(new.path_to(parent, oid) for oid in traced)
+        note = f", {len(traced)} traced" if len(traced) < len(objects) else ""
+        print(f"\nRetaining paths of {len(objects)} new {type_name}{note}")
+        for shape, count in shapes.most_common(paths):
+            print(f"  {count:>9}  {shape}")
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("old", help="earlier snapshot")
+    parser.add_argument("new", help="later snapshot")
+    parser.add_argument("--top", type=int, default=20,
+                        help="types listed by growth (default: 20)")
+    parser.add_argument("--type", action="append", default=[], dest="types",
+                        metavar="NAME",
+                        help="show retaining paths for NAME (repeatable; default: "
+                             "the 3 types that gained the most bytes)")
+    parser.add_argument("--paths", type=int, default=5,
+                        help="retaining paths shown per type (default: 5)")
+    args = parser.parse_args()
+
+    try:
+        old = Snapshot(args.old)
+        new = Snapshot(args.new)
+    except (OSError, ValueError) as exc:
+        error(str(exc))
+        return 2
+    info(f"Loaded {len(old.objects)} and {len(new.objects)} objects.")
+
+    growing = report_growth(old, new, args.top)
+    report_paths(old, new, args.types or growing[:3], args.paths)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,74 @@
+#include "bench_support.h"
+#include "mxspp/jit/jit.h"
+#include <benchmark/benchmark.h>
+#include <llvm/Passes/OptimizationLevel.h>
+#include <llvm/Passes/PassBuilder.h>
+
+namespace {
+    using mxs::frontend::actions::AstBuilderState;
+
+    auto optimization_level(std::int64_t level) -> llvm::OptimizationLevel {
+        switch (level) {
+            case 1: return llvm::OptimizationLevel::O1;
+            case 2: return llvm::OptimizationLevel::O2;
+            default: return llvm::OptimizationLevel::O3;
+        }
+    }
+
+    // 跑一遍 LLVM 的默认 O1-O3 流水线
+    auto optimize(llvm::Module &module, std::int64_t level) -> void {
+        llvm::LoopAnalysisManager loops;
+        llvm::FunctionAnalysisManager functions;
+        llvm::CGSCCAnalysisManager cgscc;
+        llvm::ModuleAnalysisManager modules;
+        llvm::PassBuilder builder;
+        builder.registerModuleAnalyses(modules);
+        builder.registerCGSCCAnalyses(cgscc);
+        builder.registerFunctionAnalyses(functions);
+        builder.registerLoopAnalyses(loops);
+        builder.crossRegisterProxies(loops, functions, cgscc, modules);
+        builder.buildPerModuleDefaultPipeline(optimization_level(level))
+                .run(module, modules);
+    }
+
+    // 从 IR 到可重定位目标文件的 JIT 编译延迟。O0 是 MXJit 自己的流水线；
+    // O1-O3 先跑对应的 LLVM 默认流水线，衡量提高默认优化级别的代价
+    auto compile_latency(benchmark::State &state) -> void {
+        const auto level = state.range(0);
+        auto jit = mxs::jit::MXJit::create();
+        if (!jit) {
+            state.SkipWithError(llvm::toString(jit.takeError()).c_str());
+            return;
+        }
+        AstBuilderState ast;
+        if (!mxs::bench::parse(mxs::bench::generate_source(state.range(1)), ast)) {
+            state.SkipWithError("generated source does not parse");
+            return;
+        }
+
+        std::size_t object_size = 0;
+        for (auto _ : state) {
+            state.PauseTiming();
+            auto context = std::make_unique<llvm::LLVMContext>();
+            auto module = std::make_unique<llvm::Module>("bench", *context);
+            module->setDataLayout((*jit)->data_layout());
+            module->setTargetTriple((*jit)->target_triple().str());
+            mxs::bench::lower(ast, *module);
+            state.ResumeTiming();
+
+            if (level > 0) optimize(*module, level);
+            auto object = (*jit)->compile_object(
+                    llvm::orc::ThreadSafeModule(std::move(module), std::move(context)));
+            if (!object) {
+                state.SkipWithError(llvm::toString(object.takeError()).c_str());
+                return;
+            }
+            object_size = (*object)->getBufferSize();
+        }
+        state.counters["object_bytes"] = static_cast<double>(object_size);
+    }
+    BENCHMARK(compile_latency)
+            ->ArgsProduct({ { 0, 1, 2, 3 }, { 64, 512 } })
+            ->ArgNames({ "O", "bindings" })
+            ->Unit(benchmark::kMillisecond);
+}
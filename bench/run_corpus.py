@@ -0,0 +1,343 @@
+#!/usr/bin/env python3
+"""Runs the .mxs benchmark corpus under the driver and compares with a baseline.
+
+Cold mode starts a fresh `mxs run` per repetition, so every run pays for LLVM
+start-up, loading runtime.bc and compiling the script. Warm mode starts one
+`mxs serve` and submits the script through `mxs-client`: the first request
+compiles it (and fills the object cache), the measured runs reuse the
+initialized process.
+
+Recorded per program and mode (median over --repeat runs):
+  wall_ms      wall time as seen by the runner
+  rss_kb       peak resident set size of the process running the script
+  compile_ms   parse + lower + JIT compile time reported by the driver
+  allocations  MXObjects allocated during the run
+
+compile_ms and allocations come from the driver's $MXS_STATS_FILE output.
+
+A program that exits non-zero (or fails to compile in warm mode) fails the whole
+run with status 1, with or without --baseline, and no baseline is saved.
+"""
+
+import argparse
+import contextlib
+import json
+import os
+import pathlib
+import statistics
+import subprocess
+import sys
+import tempfile
+import time
+
+ROOT = pathlib.Path(__file__).resolve().parent.parent
+DEFAULT_CORPUS = ROOT / "example" / "benchmarks"
+DEFAULT_BIN_DIR = ROOT / "build" / "bin"
+METRICS = ("wall_ms", "rss_kb", "compile_ms", "allocations")
+# 默认阈值（百分比）：墙钟时间和编译时间波动较大，分配次数应当是确定的
+DEFAULT_THRESHOLDS = {"wall_ms": 10.0, "rss_kb": 10.0, "compile_ms": 15.0, "allocations": 1.0}
+
+
+# ==============================================================================
+# Helper Functions for Colored Output
+# ==============================================================================
+
+
+class Colors:
+    """ANSI color codes"""
+
+    BLUE = "\033[0;34m"
+    GREEN = "\033[0;32m"
+    RED = "\033[0;31m"
+    YELLOW = "\033[0;33m"
+    NC = "\033[0m"
+
+
+def info(msg):
+    print(f"{Colors.BLUE}[INFO]{Colors.NC} {msg}")
+
+
+def success(msg):
+    print(f"{Colors.GREEN}[SUCCESS]{Colors.NC} {msg}")
+
+
+def warn(msg):
+    print(f"{Colors.YELLOW}[WARNING]{Colors.NC} {msg}")
+
+
+def error(msg):
+    print(f"{Colors.RED}[ERROR]{Colors.NC} {msg}", file=sys.stderr)
+
+
+# ==============================================================================
+# Measurement
+# ==============================================================================
+
+
+def read_stats(path):
+    try:
+        with open(path, encoding="utf-8") as file:
+            stats = json.load(file)
+    except (OSError, ValueError):
+        return {}
+    os.unlink(path)
+    return stats
+
+
+def proc_status_kb(pid, field):
+    """Reads a `<field>: N kB` line from /proc/<pid>/status (Linux only)."""
+    try:
+        with open(f"/proc/{pid}/status", encoding="ascii") as file:
+            for line in file:
+                if line.startswith(field + ":"):
+                    return int(line.split()[1])
+    except OSError:
+        pass
+    return None
+
+
+def reset_peak_rss(pid):
+    """Resets VmHWM to the current RSS; returns False if the kernel refuses."""
+    try:
+        with open(f"/proc/{pid}/clear_refs", "w", encoding="ascii") as file:
+            file.write("5")
+        return True
+    except OSError:
+        return False
+
+
+def run_cold(mxs, program, stats_file, env):
+    started = time.perf_counter()
+    process = subprocess.Popen(
+        [str(mxs), "run", str(program)], env=env, stdout=subprocess.DEVNULL
+    )
+    # wait4 给出子进程的资源使用，ru_maxrss 在 Linux 上以 KiB 为单位
+    _, status, usage = os.wait4(process.pid, 0)
+    wall_ms = (time.perf_counter() - started) * 1000.0
+    stats = read_stats(stats_file)
+    return os.waitstatus_to_exitcode(status), {
+        "wall_ms": wall_ms,
+        "rss_kb": usage.ru_maxrss,
+        "compile_ms": stats.get("compile_ms"),
+        "allocations": stats.get("allocations"),
+    }
+
+
+class WarmServer:
+    """An `mxs serve` on a private socket, shut down on exit."""
+
+    def __init__(self, mxs, client, env, workdir):
+        self.client = client
+        self.env = dict(env, MXS_SOCKET=str(pathlib.Path(workdir) / "mxs.sock"))
+        self.process = subprocess.Popen(
+            [str(mxs), "serve", "--socket", self.env["MXS_SOCKET"]], env=self.env
+        )
+        deadline = time.monotonic() + 30.0
+        while not os.path.exists(self.env["MXS_SOCKET"]):
+            if self.process.poll() is not None or time.monotonic() > deadline:
+                raise RuntimeError("mxs serve did not start")
+            time.sleep(0.05)
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, *_):
+        self.submit("shutdown")
+        try:
+            self.process.wait(timeout=10)
+        except subprocess.TimeoutExpired:
+            self.process.kill()
+
+    def submit(self, verb, program=None):
+        command = [str(self.client), verb] + ([str(program)] if program else [])
+        return subprocess.run(command, env=self.env, stdout=subprocess.DEVNULL).returncode
+
+    def run(self, program, stats_file):
+        pid = self.process.pid
+        resettable = reset_peak_rss(pid)
+        started = time.perf_counter()
+        status = self.submit("run", program)
+        wall_ms = (time.perf_counter() - started) * 1000.0
+        stats = read_stats(stats_file)
+        return status, {
+            "wall_ms": wall_ms,
+            # 没法重置峰值时 VmHWM 是服务进程启动以来的峰值
+            "rss_kb": proc_status_kb(pid, "VmHWM") if resettable else None,
+            "compile_ms": stats.get("compile_ms"),
+            "allocations": stats.get("allocations"),
+        }
+
+
+def summarize(samples):
+    summary = {}
+    for metric in METRICS:
+        values = [sample[metric] for sample in samples if sample[metric] is not None]
+        summary[metric] = statistics.median(values) if values else None
+    return summary
+
+
+def measure_program(args, server, program, stats_file, env, mode):
+    if server and server.submit("compile", program) != 0:
+        error(f"{program.stem} [{mode}]: compile failed")
+        return {"status": "error"}
+    samples = []
+    for _ in range(args.repeat):
+        if server:
+            status, sample = server.run(program, stats_file)
+        else:
+            status, sample = run_cold(args.mxs, program, stats_file, env)
+        if status != 0:
+            error(f"{program.stem} [{mode}]: exit status {status}")
+            break
+        samples.append(sample)
+    entry = {"status": "ok" if len(samples) == args.repeat else "error"}
+    if samples:
+        entry.update(summarize(samples))
+    return entry
+
+
+def measure(args, programs):
+    results = {}
+    modes = ["cold", "warm"] if args.mode == "both" else [args.mode]
+    with tempfile.TemporaryDirectory(prefix="mxs-corpus-") as workdir:
+        stats_file = pathlib.Path(workdir) / "stats.json"
+        env = dict(os.environ, MXS_STATS_FILE=str(stats_file))
+        for mode in modes:
+            try:
+                server = WarmServer(args.mxs, args.client, env, workdir) if mode == "warm" else None
+            except RuntimeError as exc:
+                error(str(exc))
+                for program in programs:
+                    results.setdefault(program.stem, {})[mode] = {"status": "error"}
+                continue
+            with server or contextlib.nullcontext():
+                for program in programs:
+                    entry = measure_program(args, server, program, stats_file, env, mode)
+                    results.setdefault(program.stem, {})[mode] = entry
+                    info(f"{program.stem} [{mode}]: " + format_entry(entry))
+    return results
+
+
+def format_entry(entry):
+    if entry["status"] != "ok":
+        return "failed"
+    parts = []
+    for metric in METRICS:
+        value = entry.get(metric)
+        parts.append(f"{metric}={'-' if value is None else f'{value:.1f}'}")
+    return " ".join(parts)
+
+
+# ==============================================================================
+# Baseline comparison
+# ==============================================================================
+
+
+def compare(results, baseline, thresholds):
+    """Returns the list of regressions beyond the per-metric thresholds."""
+    regressions = []
+    for name, modes in results.items():
+        for mode, entry in modes.items():
+            previous = baseline.get(name, {}).get(mode)
+            if previous is None:
+                warn(f"{name} [{mode}]: not in baseline")
+                continue
+            if entry["status"] != "ok" or previous.get("status") != "ok":
+                continue
+            for metric in METRICS:
+                old, new = previous.get(metric), entry.get(metric)
+                if not old or new is None:
+                    continue
+                change = (new - old) / old * 100.0
+                if change > thresholds[metric]:
+                    regressions.append(
+                        f"{name} [{mode}] {metric}: {old:.1f} -> {new:.1f} "
+                        f"(+{change:.1f}%, limit {thresholds[metric]:.1f}%)"
+                    )
+    return regressions
+
+
+def parse_threshold(text):
+    metric, _, percent = text.partition("=")
+    aliases = {"wall": "wall_ms", "rss": "rss_kb", "compile": "compile_ms", "alloc": "allocations"}
+    metric = aliases.get(metric, metric)
+    if metric not in METRICS:
+        raise argparse.ArgumentTypeError(f"unknown metric '{metric}'")
+    try:
+        return metric, float(percent)
+    except ValueError:
+        raise argparse.ArgumentTypeError(f"bad percentage in '{text}'") from None
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="Run the .mxs benchmark corpus and compare against a baseline."
+    )
+    parser.add_argument("--mxs", type=pathlib.Path, default=DEFAULT_BIN_DIR / "mxs",
+                        help="Driver executable (default: build/bin/mxs).")
+    parser.add_argument("--client", type=pathlib.Path, default=DEFAULT_BIN_DIR / "mxs-client",
+                        help="Compile-server client used in warm mode.")
+    parser.add_argument("--corpus", type=pathlib.Path, default=DEFAULT_CORPUS,
+                        help="Directory of .mxs programs (default: example/benchmarks).")
+    parser.add_argument("--filter", default="",
+                        help="Only run programs whose name contains this text.")
+    parser.add_argument("--mode", choices=("cold", "warm", "both"), default="both")
+    parser.add_argument("--repeat", type=int, default=5,
+                        help="Runs per program and mode; medians are reported.")
+    parser.add_argument("--output", type=pathlib.Path,
+                        help="Write the results as JSON to this file.")
+    parser.add_argument("--baseline", type=pathlib.Path,
+                        help="Compare against a results file from an earlier run.")
+    parser.add_argument("--save-baseline", type=pathlib.Path,
+                        help="Write the results as the new baseline.")
+    parser.add_argument("--threshold", type=parse_threshold, action="append", default=[],
+                        metavar="METRIC=PERCENT",
+                        help="Allowed regression, e.g. wall=5 or rss_kb=20. Repeatable.")
+    args = parser.parse_args()
+
+    if args.repeat < 1:
+        parser.error("--repeat must be at least 1")
+    for tool in [args.mxs] + ([args.client] if args.mode != "cold" else []):
+        if not tool.is_file():
+            error(f"'{tool}' not found. Build the project first (python3 rebuild.py).")
+            return 2
+    programs = sorted(p for p in args.corpus.glob("*.mxs") if args.filter in p.stem)
+    if not programs:
+        error(f"No programs in '{args.corpus}' match '{args.filter}'.")
+        return 2
+
+    results = measure(args, programs)
+    failed = [
+        f"{name} [{mode}]"
+        for name, modes in sorted(results.items())
+        for mode, entry in modes.items()
+        if entry["status"] != "ok"
+    ]
+    document = json.dumps(results, indent=2, sort_keys=True) + "\n"
+    if args.output:
+        args.output.write_text(document, encoding="utf-8")
+        info(f"Results written to '{args.output}'.")
+    # 任何脚本失败（非零退出、编译失败、服务起不来）都直接判为失败，
+    # 也不把残缺的结果存成基线，否则之后的比较会把失败当成常态
+    if failed:
+        error("Failed: " + ", ".join(failed))
+        return 1
+    if args.save_baseline:
+        args.save_baseline.write_text(document, encoding="utf-8")
+        info(f"Baseline written to '{args.save_baseline}'.")
+
+    if not args.baseline:
+        return 0
+    thresholds = dict(DEFAULT_THRESHOLDS, **dict(args.threshold))
+    baseline = json.loads(args.baseline.read_text(encoding="utf-8"))
+    regressions = compare(results, baseline, thresholds)
+    for regression in regressions:
+        error(regression)
+    if regressions:
+        return 1
+    success(f"No regressions against '{args.baseline}'.")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
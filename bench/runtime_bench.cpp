@@ -0,0 +1,67 @@
+#include "mxspp/core/MXNumeric.h"
+#include "mxspp/core/MXString.h"
+#include "mxspp/runtime/runtime.h"
+#include <benchmark/benchmark.h>
+#include <memory>
+
+namespace {
+    using mxs::builtin::MXFloat;
+    using mxs::builtin::MXInteger;
+    using mxs::core::MXString;
+    using mxs::core::MXObject;
+
+    // 装箱路径上的算术循环：acc = acc op step，每一步都分配新的结果对象。
+    // 这正是生成代码在操作数类型未知时走的路径
+    template<typename Box, auto Step>
+    auto arithmetic_loop(benchmark::State &state, std::int32_t op) -> void {
+        const auto steps = state.range(0);
+        Box step(Step);
+        for (auto _ : state) {
+            std::unique_ptr<MXObject> acc = std::make_unique<Box>(Step);
+            for (std::int64_t i = 0; i < steps; ++i)
+                acc.reset(mxs_runtime_binary(op, acc.get(), &step));
+            benchmark::DoNotOptimize(acc.get());
+        }
+        state.SetItemsProcessed(state.iterations() * steps);
+    }
+
+    auto integer_add_loop(benchmark::State &state) -> void {
+        arithmetic_loop<MXInteger, std::int64_t{ 3 }>(state, MXS_OP_ADD);
+    }
+    BENCHMARK(integer_add_loop)->Arg(1024);
+
+    auto integer_mul_loop(benchmark::State &state) -> void {
+        arithmetic_loop<MXInteger, std::int64_t{ 3 }>(state, MXS_OP_MUL);
+    }
+    BENCHMARK(integer_mul_loop)->Arg(1024);
+
+    auto float_add_loop(benchmark::State &state) -> void {
+        arithmetic_loop<MXFloat, 0.5>(state, MXS_OP_ADD);
+    }
+    BENCHMARK(float_add_loop)->Arg(1024);
+
+    auto string_concat(benchmark::State &state) -> void {
+        MXString lhs(std::string(static_cast<std::size_t>(state.range(0)), 'a'));
+        MXString rhs("suffix");
+        for (auto _ : state) {
+            std::unique_ptr<MXObject> joined(mxs_runtime_binary(MXS_OP_ADD, &lhs, &rhs));
+            benchmark::DoNotOptimize(joined.get());
+        }
+        const auto bytes = lhs.size() + rhs.size();
+        state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * bytes));
+    }
+    BENCHMARK(string_concat)->Arg(8)->Arg(1024);
+
+    auto string_compare(benchmark::State &state) -> void {
+        const std::string text(static_cast<std::size_t>(state.range(0)), 'a');
+        MXString lhs(text);
+        MXString rhs(text);
+        for (auto _ : state) {
+            std::unique_ptr<MXObject> equal(mxs_runtime_binary(MXS_OP_EQ, &lhs, &rhs));
+            benchmark::DoNotOptimize(equal.get());
+        }
+        state.SetBytesProcessed(
+                static_cast<std::int64_t>(state.iterations() * text.size()));
+    }
+    BENCHMARK(string_compare)->Arg(8)->Arg(1024);
+}
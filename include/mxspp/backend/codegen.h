@@ -1,13 +1,210 @@
 #pragma once
+#include <cstdint>
+#include <functional>
+#include <llvm/IR/DIBuilder.h>
 #include <llvm/IR/IRBuilder.h>
 #include <llvm/IR/Module.h>
 #include <llvm/IR/Value.h>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <variant>
+#include <vector>
 
 namespace mxs::backend::codegen {
+    struct CoroutineFrame;
+
+    // Compile-time value of a `static let` or of a folded expression; nil is
+    // std::monostate.
+    using ConstantValue =
+            std::variant<std::monostate, std::int64_t, double, bool, std::string>;
+    using ConstantTable = std::unordered_map<std::string, ConstantValue>;
+
+    // 1-based position in the .mxs source; line 0 means unknown.
+    struct SourceLocation {
+        std::uint32_t line = 0;
+        std::uint32_t column = 0;
+    };
+
+    // A construct the grammar accepts but that is invalid where it appears, such
+    // as `await` outside an async func. Thrown by codegen and reported by the
+    // driver as a CompileError; what() is "<line>:<column>: <message>".
+    struct CompileError : std::runtime_error {
+        CompileError(SourceLocation location, const std::string &message);
+        SourceLocation location;
+    };
+
+    // Line-tables-only DWARF for one module: a compile unit, a subprogram per
+    // function and a line on every statement, with no types or variables. That
+    // is what perf, gdb and sampling profilers need to attribute samples to
+    // .mxs lines, and it is cheap enough to leave on.
+    struct DebugInfo {
+        explicit DebugInfo(llvm::Module &module) : builder(module) { }
+        llvm::DIBuilder builder;
+        llvm::DICompileUnit *unit = nullptr;
+        llvm::DIFile *file = nullptr;
+    };
+
+    // A loop that may move to optimized code while it runs (on-stack
+    // replacement). `symbol` names its continuation: a function in the OSR
+    // module that takes the `live` named values, boxed and in this order, and
+    // runs the loop and the rest of the enclosing function. `live` is the
+    // scope where the loop starts, captured when the loop is emitted; the back
+    // edge passes those values, reloading the mutable ones. `used` is set
+    // once the loop has been emitted.
+    struct OsrEntry {
+        std::string symbol;
+        std::vector<std::pair<std::string, llvm::Value *>> live;
+        bool used = false;
+    };
+    // A loop in one emitted version of a function: the baseline and the
+    // speculated version of a function each get their own continuation.
+    using OsrKey = std::pair<const void *, const llvm::Function *>;
+
+    // The lambda being emitted. A name it reads from an enclosing scope is
+    // captured on first use: loaded from the next slot of its flat environment
+    // at the lambda's entry, and copied into that slot when the closure is
+    // created. A `let mut` variable is captured as its heap cell, so the frame
+    // and the closures see each other's writes.
+    struct ClosureScope {
+        // Named values where the lambda is created; names captured on behalf of
+        // an inner lambda are added here too.
+        std::unordered_map<std::string, llvm::Value *> outer;
+        // The lambda the creation site itself is in, if any.
+        ClosureScope *parent = nullptr;
+        llvm::Value *environment = nullptr;
+        // Ends in the branch to the body; the slot loads go before it.
+        llvm::BasicBlock *entry = nullptr;
+        // Per slot, the captured value at the creation site.
+        std::vector<llvm::Value *> captured;
+    };
+
+    struct CodegenContext;
+
+    // A `defer` body waiting for its block to exit, with the named values it
+    // saw; it reads them wherever it is emitted.
+    struct DeferredBlock {
+        std::function<void(CodegenContext &ctx)> emit;
+        std::unordered_map<std::string, llvm::Value *> named;
+    };
+
+    // A block emitted once that runs the first n deferred bodies of a scope and
+    // then dispatches on `exit` to the place each incoming exit resumes. Exits
+    // pass their result (or null) in `value`. dispatch is nullptr when the
+    // deferred code never falls through.
+    struct DeferCleanup {
+        llvm::BasicBlock *block = nullptr;
+        llvm::PHINode *exit = nullptr;
+        llvm::PHINode *value = nullptr;
+        llvm::SwitchInst *dispatch = nullptr;
+    };
+
+    // The deferred bodies of one enclosing block, in registration order.
+    // `cloned` counts the instructions emitted by copies of them on exit edges;
+    // past a budget, further exits share a cleanup keyed by the body count.
+    struct DeferScope {
+        std::vector<DeferredBlock> deferred;
+        std::size_t cloned = 0;
+        std::unordered_map<std::size_t, DeferCleanup> cleanups;
+    };
+
+    // An enclosing loop: where continue and break go, and how many defer
+    // scopes were open when it started (those inside it unwind on the jump).
+    struct LoopTargets {
+        llvm::BasicBlock *continue_target;
+        llvm::BasicBlock *break_target;
+        std::size_t defer_depth;
+    };
+
+    using Instantiator = std::function<llvm::Function *(
+            CodegenContext &ctx, const std::vector<llvm::Type *> &type_args)>;
+
+    // How call sites instantiate one generic function.
+    struct GenericFunction {
+        std::size_t generic_count = 0;
+        // Per parameter, the index of the generic parameter that is its type,
+        // or -1 when it has another or no declared type.
+        std::vector<int> param_generics;
+        // Returns the instance for one type per generic parameter: i64, double
+        // or i1 for an unboxed type, ptr for a boxed one.
+        Instantiator instantiate;
+    };
+
     struct CodegenContext {
         llvm::LLVMContext &llvmContext;
         llvm::Module *module;
         llvm::IRBuilder<> *builder;
         std::unordered_map<std::string, llvm::Value *> namedValues;
+        // Set while emitting the body of an `async func`, nullptr otherwise.
+        CoroutineFrame *coroutine = nullptr;
+        // Folded `static let` bindings visible to this module, including those
+        // of earlier modules (REPL inputs) that were compiled separately.
+        ConstantTable constants;
+        // Set by begin_debug_info(); without it the helpers below do nothing.
+        std::unique_ptr<DebugInfo> debug;
+        // Makes every function count the kinds of its arguments in the global
+        // "mxs.feedback.<name>" (see jit/feedback.h).
+        bool collect_feedback = false;
+        // Functions to compile speculatively: per parameter, the MXSValueKind
+        // it is assumed to have, MXS_KIND_OTHER for no assumption.
+        std::unordered_map<std::string, std::vector<std::int32_t>> speculation;
+        // Receives OSR continuations, compiled at O2 only when a loop gets
+        // hot; nullptr disables OSR. Keyed by the loop's AST node and the
+        // function it is emitted into.
+        llvm::Module *osr_module = nullptr;
+        std::map<OsrKey, OsrEntry> osr_entries;
+        // Enclosing loops, innermost last.
+        std::vector<LoopTargets> loops;
+        // Blocks being emitted, innermost last, with their pending `defer`s.
+        std::vector<DeferScope> defers;
+        // Callable functions of the program: parameter counts of plain ones,
+        // generic ones by name, and how many unboxed instances each generic
+        // function has, which is capped to bound code size.
+        std::unordered_map<std::string, std::size_t> functions;
+        std::unordered_map<std::string, GenericFunction> generics;
+        std::unordered_map<std::string, std::size_t> specializations;
+        // Compiles `assert` statements to nothing, condition included.
+        bool strip_asserts = false;
+        // Set while emitting a lambda body, nullptr otherwise.
+        ClosureScope *closure = nullptr;
+        // Named values that are the heap cell of a captured `let mut` variable
+        // (see mxs_runtime_cell_new): reads and writes go through the cell.
+        std::unordered_set<llvm::Value *> cells;
+        // Closures created from a lambda literal in the current function, with
+        // their code: calls through such a value skip the indirect call.
+        std::unordered_map<llvm::Value *, llvm::Function *> lambdas;
     };
-}
\ No newline at end of file
+
+    auto runtime_function(CodegenContext &ctx, const char *name, llvm::Type *ret,
+                          llvm::ArrayRef<llvm::Type *> params) -> llvm::FunctionCallee;
+
+    // Materializes a folded value: an i64 / double / i1 immediate, a null
+    // pointer for nil, or a String boxed from constant bytes in the module.
+    auto emit_constant(CodegenContext &ctx, const ConstantValue &value) -> llvm::Value *;
+
+    // Boxes an unboxed i64 / double / i1 into an MXObject*; pointers are
+    // returned unchanged and any other type yields nil.
+    auto emit_box(CodegenContext &ctx, llvm::Value *value) -> llvm::Value *;
+
+    // Emits `value` as the read-only global "mxs.static.<name>", so code that
+    // is not compiled together with the binding can still read it.
+    auto emit_static_data(CodegenContext &ctx, const std::string &name,
+                          const ConstantValue &value) -> void;
+
+    // Starts debug info for the module being generated, attributed to `path`.
+    auto begin_debug_info(CodegenContext &ctx, llvm::StringRef path) -> void;
+    // Gives `fn` a subprogram starting at `location` and points the builder's
+    // debug location at it; call with the insert point inside `fn`.
+    auto begin_function_scope(CodegenContext &ctx, llvm::Function *fn,
+                              SourceLocation location) -> void;
+    // Attributes the instructions emitted next to `location` in the current
+    // function. Unknown locations keep the previous one.
+    auto set_location(CodegenContext &ctx, SourceLocation location) -> void;
+    auto end_function_scope(CodegenContext &ctx) -> void;
+    // Resolves the debug metadata; call once, before verifying the module.
+    auto finish_debug_info(CodegenContext &ctx) -> void;
+}
@@ -0,0 +1,29 @@
+#pragma once
+#include "mxspp/backend/codegen.h"
+
+namespace mxs::backend::codegen {
+    // Blocks and values of an `async func` lowered with the switched-resume
+    // llvm.coro.* ABI. The promise is a { ptr result, ptr continuation } pair
+    // and must stay layout compatible with core::MXCoroutinePromise.
+    struct CoroutineFrame {
+        llvm::Value *id;
+        llvm::Value *handle;
+        llvm::Value *promise;
+        llvm::BasicBlock *final_suspend;
+        llvm::BasicBlock *cleanup;
+        llvm::BasicBlock *suspend;
+    };
+
+    // Emits coro.id / coro.alloc / coro.begin at the current insert point and
+    // leaves the builder at the start of the function body. The frame is only
+    // heap allocated when CoroElide cannot place it in the caller.
+    auto emit_coroutine_begin(CodegenContext &ctx, llvm::Function *fn) -> CoroutineFrame;
+
+    // Suspends until `task` completes, then yields its result.
+    auto emit_coroutine_await(CodegenContext &ctx, const CoroutineFrame &frame,
+                              llvm::Value *task) -> llvm::Value *;
+
+    // Stores `value` into the promise and branches to the final suspend point.
+    auto emit_coroutine_return(CodegenContext &ctx, const CoroutineFrame &frame,
+                               llvm::Value *value) -> void;
+}
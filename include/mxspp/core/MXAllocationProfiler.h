@@ -0,0 +1,90 @@
+#pragma once
+
+#include "mxspp/core/MXMacro.h"
+#include "mxspp/core/MXObject.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace mxs::core {
+    // Sampling allocation profiler behind `mxs --alloc-profile`.
+    //
+    // MXObject::operator new reports each allocation's size. Allocations are
+    // sampled by bytes: each thread draws the distance to its next sample from
+    // an exponential distribution with mean `sample_bytes`, so big objects are
+    // sampled more often and every sample can be scaled back to an unbiased
+    // estimate. A sample keeps the size and the frame-pointer stack of the
+    // allocation. Once MXObject's constructor has run, the sample also points
+    // at the object, and report() asks it for runtime_type().
+    //
+    // report() lists the top allocation sites, keyed by the innermost frame in
+    // compiled .mxs code, then the sampled live heap grouped by type. Each
+    // group shows estimated totals.
+    class MXS_API MXAllocationProfiler {
+    public:
+        static constexpr std::size_t MAX_DEPTH = 32;
+
+        // A symbolized return address; `script` marks compiled .mxs code.
+        struct Frame {
+            std::string name;
+            bool script = false;
+        };
+        using Symbolizer = std::function<Frame(std::uintptr_t)>;
+
+        static auto get_profiler() -> MXAllocationProfiler &;
+
+        auto enable(std::size_t sample_bytes = 512 * 1024) -> void;
+        [[nodiscard]] auto enabled() const -> bool {
+            return this->enabled_.load(std::memory_order_relaxed);
+        }
+
+        // Hooks called by MXObject; cheap no-ops unless enabled.
+        auto on_allocate(void *memory, std::size_t size) -> void;
+        auto on_construct(MXObject *object) -> void;
+        auto on_destroy(const MXObject *object) -> void;
+        auto on_free(void *memory) -> void;
+
+        // `symbolize` names stack frames. Without one, frames are named with
+        // dladdr() and no frame counts as script code. Safe to call while
+        // other threads allocate; objects being destroyed concurrently may be
+        // reported under a base type.
+        auto report(std::ostream &out, const Symbolizer &symbolize = {},
+                    std::size_t top = 20) const -> void;
+
+    private:
+        MXAllocationProfiler() = default;
+
+        struct Sample {
+            void *memory = nullptr;
+            std::size_t size = 0;
+            std::uint32_t depth = 0;
+            std::uintptr_t frames[MAX_DEPTH]{};
+        };
+
+        // 同一调用栈上的样本汇总；按分配时的大小估算总量
+        struct Site {
+            double allocations = 0;
+            double bytes = 0;
+        };
+
+        auto weight(std::size_t size) const -> double;
+
+        std::atomic<bool> enabled_{ false };
+        std::size_t sample_bytes_ = 512 * 1024;
+
+        mutable std::mutex lock_;
+        std::map<std::vector<std::uintptr_t>, Site> sites_;
+        std::unordered_map<const MXObject *, Sample> live_;
+        // 已经分配、对象尚未构造完成的样本；计数让构造函数不必加锁就能跳过
+        std::vector<Sample> pending_;
+        std::atomic<std::size_t> pending_count_{ 0 };
+        std::uint64_t samples_ = 0;
+    };
+}
@@ -0,0 +1,104 @@
+#pragma once
+
+#include "mxspp/core/MXEventLoop.h"
+#include "mxspp/core/MXMacro.h"
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <vector>
+
+namespace mxs::core {
+    enum class MXIOOp : std::uint8_t { READ, WRITE, ACCEPT, CONNECT };
+
+    // One outstanding operation. It lives in the awaiting coroutine's frame, so
+    // submitting it allocates nothing.
+    struct MXS_API MXIORequest {
+        MXIOOp op = MXIOOp::READ;
+        int fd = -1;
+        void *buffer = nullptr;
+        std::size_t length = 0;
+        // -1 uses the current file position (and is the only value for sockets)
+        std::int64_t offset = -1;
+        const sockaddr *address = nullptr;
+        socklen_t address_length = 0;
+        // Slot in the backend's registered buffer pool, -1 for a plain buffer
+        int buffer_index = -1;
+        // Bytes transferred or accepted fd on success, -errno on failure
+        std::int64_t result = 0;
+        std::coroutine_handle<> waiter = {};
+    };
+
+    // Fixed-size buffers carved from one allocation. io_uring pins them once
+    // at registration instead of on every READ_FIXED / WRITE_FIXED.
+    class MXS_API MXIOBufferPool {
+    public:
+        MXIOBufferPool(std::size_t slot_count, std::size_t slot_size);
+        ~MXIOBufferPool();
+        MXIOBufferPool(const MXIOBufferPool &) = delete;
+
+        auto acquire(std::size_t length) -> std::optional<int>;
+        auto release(int index) -> void;
+        [[nodiscard]] auto data(int index) const -> std::byte *;
+        [[nodiscard]] auto iovecs() -> std::span<iovec>;
+
+    private:
+        std::size_t slot_size;
+        std::byte *storage;
+        std::vector<iovec> slots;
+        std::vector<int> free_slots;
+    };
+
+    class MXS_API MXIOBackend {
+    public:
+        virtual ~MXIOBackend();
+
+        // Queues `request`; it reaches the kernel on the next flush(), so every
+        // operation issued during one loop iteration shares a single syscall.
+        virtual auto submit(MXIORequest &request) -> void = 0;
+        virtual auto flush() -> void = 0;
+        // Schedules the waiters of finished requests on `loop` without blocking.
+        virtual auto reap(MXEventLoop &loop) -> std::size_t = 0;
+        // Readable when completions may be pending; the loop blocks on it.
+        [[nodiscard]] virtual auto completion_fd() const -> int = 0;
+        [[nodiscard]] virtual auto name() const -> const char * = 0;
+
+        [[nodiscard]] auto in_flight() const -> std::size_t { return this->pending; }
+        auto buffers() -> MXIOBufferPool & { return this->pool; }
+
+    protected:
+        MXIOBackend();
+        std::size_t pending = 0;
+        MXIOBufferPool pool;
+    };
+
+    // io_uring when the kernel allows it, epoll readiness otherwise. Setting
+    // MXS_IO_BACKEND=epoll forces the fallback.
+    MXS_API auto mx_make_io_backend() -> std::unique_ptr<MXIOBackend>;
+
+    // io_uring_enter(2) as the io_uring backend issues it: submits up to
+    // `to_submit` queued entries and returns how many the kernel took, or -1
+    // with errno set.
+    using MXIOUringEnter = int (*)(int ring_fd, unsigned to_submit);
+    // The io_uring backend alone, or nullptr when the kernel does not allow it.
+    // `enter` replaces the syscall so tests can inject submission failures.
+    MXS_API auto mx_make_io_uring_backend(MXIOUringEnter enter = nullptr)
+            -> std::unique_ptr<MXIOBackend>;
+
+    struct MXS_API MXIOAwaiter {
+        MXIORequest &request;
+        auto await_ready() const noexcept -> bool { return false; }
+        auto await_suspend(std::coroutine_handle<> handle) const -> void;
+        auto await_resume() const noexcept -> std::int64_t { return request.result; }
+    };
+
+    // Native async operations. Each returns a task whose result is an MXString
+    // (read), an MXInteger (write: bytes written, accept: fd, connect: 0) or an
+    // MXError.
+    MXS_API auto mx_async_read(int fd, std::size_t length, std::int64_t offset) -> MXTask;
+    MXS_API auto mx_async_write(int fd, std::string data, std::int64_t offset) -> MXTask;
+    MXS_API auto mx_async_accept(int fd) -> MXTask;
+    MXS_API auto mx_async_connect(int fd, std::string host, std::uint16_t port) -> MXTask;
+}
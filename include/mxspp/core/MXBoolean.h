@@ -6,5 +6,16 @@
 namespace mxs::builtin {
     class MXS_API MXBoolean : public core::MXObject {
     public:
+        explicit MXBoolean(bool value, bool is_static = false);
+        ~MXBoolean() override;
+
+        const bool value;
+
+        [[nodiscard]] auto get_hash_code() const -> MXHashCode_t override;
+        [[nodiscard]] auto repr() const -> core::repr_t override;
+
+        static auto get_rtti() -> const core::MXRuntimeTypeInfo &;
+        [[nodiscard]] auto runtime_type() const
+                -> const core::MXRuntimeTypeInfo & override;
     };
-}
\ No newline at end of file
+}
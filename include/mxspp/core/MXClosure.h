@@ -0,0 +1,34 @@
+#pragma once
+
+#include "MXMacro.h"
+#include "MXObject.h"
+#include "_type_def.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace mxs::core {
+    // A lambda value: the code generated for its body and the flat environment
+    // its captures were copied into when it was created. The code takes the
+    // environment followed by `arity` boxed arguments and returns a boxed value.
+    // The environment is one 8-byte slot per capture, laid out by the code
+    // generator; slots may hold unboxed numbers, so it is not visited.
+    class MXS_API MXClosure : public MXObject {
+    public:
+        MXClosure(void *code, std::int64_t arity, std::size_t slots,
+                  bool is_static = false);
+        ~MXClosure() override;
+
+        void *const code;
+        const std::int64_t arity;
+
+        auto environment() -> void * { return this->environment_.get(); }
+
+        [[nodiscard]] auto repr() const -> repr_t override;
+        static auto get_rtti() -> const MXRuntimeTypeInfo &;
+        [[nodiscard]] auto runtime_type() const -> const MXRuntimeTypeInfo & override;
+
+    private:
+        std::unique_ptr<std::uint64_t[]> environment_;
+    };
+}
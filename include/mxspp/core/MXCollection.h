@@ -0,0 +1,106 @@
+#pragma once
+
+#include "MXMacro.h"
+#include "MXObject.h"
+#include "_type_def.h"
+#include <mutex>
+#include <span>
+#include <string_view>
+
+namespace mxs::builtin {
+    // Ordered sequence of owned objects; nil elements are stored as nullptr.
+    class MXS_API MXList : public core::MXObject {
+    public:
+        explicit MXList(bool is_static = false);
+        ~MXList() override;
+
+        auto append(MXObjectOwned value) -> void;
+        auto reserve(std::size_t capacity) -> void;
+        [[nodiscard]] auto size() const -> std::size_t {
+            std::scoped_lock guard(this->lock_);
+            return this->items_.size();
+        }
+        [[nodiscard]] auto at(std::size_t index) const -> core::MXObject * {
+            std::scoped_lock guard(this->lock_);
+            return this->items_.at(index).get();
+        }
+
+        [[nodiscard]] auto repr() const -> core::repr_t override;
+        auto visit_references(const core::MXReferenceVisitor &visit) const
+                -> void override;
+        static auto get_rtti() -> const core::MXRuntimeTypeInfo &;
+        [[nodiscard]] auto runtime_type() const
+                -> const core::MXRuntimeTypeInfo & override;
+
+    private:
+        // Guards items_; heap snapshots walk the list from another thread.
+        mutable std::mutex lock_;
+        std::vector<MXObjectOwned> items_;
+    };
+
+    // String-keyed mapping that remembers insertion order for repr().
+    class MXS_API MXDict : public core::MXObject {
+    public:
+        explicit MXDict(bool is_static = false);
+        ~MXDict() override;
+
+        // Inserts or replaces; a replaced key keeps its original position.
+        auto set(std::string key, MXObjectOwned value) -> void;
+        [[nodiscard]] auto contains(std::string_view key) const -> bool;
+        // Returns nullptr for both a missing key and a nil value.
+        [[nodiscard]] auto get(std::string_view key) const -> core::MXObject *;
+        [[nodiscard]] auto size() const -> std::size_t {
+            std::scoped_lock guard(this->lock_);
+            return this->order_.size();
+        }
+        // Keys in insertion order. The span is not guarded; callers must not
+        // insert keys while iterating it.
+        [[nodiscard]] auto keys() const -> std::span<const std::string> {
+            return this->order_;
+        }
+
+        [[nodiscard]] auto repr() const -> core::repr_t override;
+        auto visit_references(const core::MXReferenceVisitor &visit) const
+                -> void override;
+        static auto get_rtti() -> const core::MXRuntimeTypeInfo &;
+        [[nodiscard]] auto runtime_type() const
+                -> const core::MXRuntimeTypeInfo & override;
+
+    private:
+        struct KeyHash {
+            using is_transparent = void;
+            auto operator()(std::string_view key) const -> std::size_t {
+                return std::hash<std::string_view>{}(key);
+            }
+        };
+
+        // Guards items_ and order_, as in MXList.
+        mutable std::mutex lock_;
+        std::unordered_map<std::string, MXObjectOwned, KeyHash, std::equal_to<>> items_;
+        std::vector<std::string> order_;
+    };
+
+    // Homogeneous numeric array stored unboxed, e.g. a parsed CSV column.
+    class MXS_API MXArray : public core::MXObject {
+    public:
+        using storage_t = std::variant<std::vector<std::int64_t>, std::vector<double>>;
+
+        explicit MXArray(storage_t values, bool is_static = false);
+        ~MXArray() override;
+
+        [[nodiscard]] auto size() const -> std::size_t;
+        [[nodiscard]] auto is_integer() const -> bool {
+            return std::holds_alternative<std::vector<std::int64_t>>(this->values_);
+        }
+        [[nodiscard]] auto integers() const -> std::span<const std::int64_t>;
+        [[nodiscard]] auto floats() const -> std::span<const double>;
+
+        [[nodiscard]] auto repr() const -> core::repr_t override;
+        static auto get_rtti() -> const core::MXRuntimeTypeInfo &;
+        [[nodiscard]] auto runtime_type() const
+                -> const core::MXRuntimeTypeInfo & override;
+
+    private:
+        storage_t values_;
+    };
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include "mxspp/core/MXMacro.h"
+#include "mxspp/core/MXMappedFile.h"
+#include "mxspp/core/MXObject.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+namespace mxs::core {
+    // Streaming CSV reader with RFC 4180 quoting. Delimiters and record ends are
+    // located with 64-byte SIMD masks a chunk at a time; quoted sections are
+    // masked out with a prefix XOR of the quote bits instead of a per-byte state
+    // machine. Fields are StringViews into the input unless they contain ""
+    // escapes. Blank lines are skipped.
+    class MXS_API MXCsvReader : public MXObject {
+    public:
+        explicit MXCsvReader(std::shared_ptr<const MXMappedRegion> input,
+                             char delimiter = ',', bool is_static = false);
+        ~MXCsvReader() override;
+
+        // Returns the next record as a List of strings, or nullptr at the end.
+        auto next_row() -> MXObjectOwned;
+        // Reads up to `rows` records and returns them as a List of columns, or
+        // nullptr at the end. A column whose fields all parse as integers
+        // becomes an integer Array, one of numbers a float Array; any other
+        // column is a List of strings.
+        auto next_batch(std::size_t rows) -> MXObjectOwned;
+
+        [[nodiscard]] auto repr() const -> repr_t override;
+        static auto get_rtti() -> const MXRuntimeTypeInfo &;
+        [[nodiscard]] auto runtime_type() const -> const MXRuntimeTypeInfo & override;
+
+    private:
+        static constexpr std::size_t INDEX_CHUNK = 64 * 1024;
+
+        struct Field {
+            std::string_view text;
+            bool quoted;
+        };
+
+        auto index_block(std::size_t base) -> void;
+        auto index_chunk() -> bool;
+        auto next_separator() -> std::size_t;
+        auto read_record(std::vector<Field> &fields) -> bool;
+        auto add_field(std::vector<Field> &fields, std::size_t begin,
+                       std::size_t end) const -> void;
+        auto make_string(const Field &field) const -> MXObjectOwned;
+        auto make_column(const std::vector<const Field *> &cells) const -> MXObjectOwned;
+
+        std::shared_ptr<const MXMappedRegion> input_;
+        std::string_view bytes_;
+        char delimiter_;
+        std::vector<std::size_t> separators_;
+        std::size_t cursor_ = 0;
+        std::size_t indexed_ = 0;
+        std::size_t field_start_ = 0;
+        std::uint64_t in_quotes_ = 0;
+        std::vector<Field> record_;
+    };
+}
@@ -19,6 +19,7 @@ namespace mxs::core {
 
         static auto get_manager() -> MXDynamicTypeInfoManager &;
         static auto get_rtti() -> MXRuntimeTypeInfo &;
+        [[nodiscard]] auto runtime_type() const -> const MXRuntimeTypeInfo & override;
         auto repr() const -> std::string override;
     };
 };
@@ -18,9 +18,11 @@ namespace mxs::core {
         ~MXError() override;
         // --- Overrides ---
         [[nodiscard]] auto repr() const -> repr_t override;
+        auto visit_references(const MXReferenceVisitor &visit) const -> void override;
 
         // --- RTTI ---
         static auto get_rtti() -> const MXRuntimeTypeInfo &;
+        [[nodiscard]] auto runtime_type() const -> const MXRuntimeTypeInfo & override;
 
     private:
         error_type_name_t error_type_;
@@ -0,0 +1,101 @@
+#pragma once
+
+#include "mxspp/core/MXMacro.h"
+#include "mxspp/core/MXObject.h"
+#include "mxspp/core/MXType.h"
+#include <coroutine>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <unordered_set>
+#include <utility>
+
+namespace mxs::core {
+    // Promise of a compiled `async func`. The backend allocates it as
+    // { ptr, ptr } next to the llvm.coro.id token, so the layout is fixed.
+    struct MXS_API MXCoroutinePromise {
+        MXObject *result;
+        void *continuation;
+    };
+    using MXCoroutineHandle = std::coroutine_handle<MXCoroutinePromise>;
+
+    class MXIOBackend;
+
+    // C++ counterpart of a compiled `async func`. Native coroutines returning
+    // MXTask share the promise layout, so script code can `await` them and the
+    // same runtime hooks complete them.
+    class MXS_API MXTask {
+    public:
+        struct FinalAwaiter {
+            auto await_ready() const noexcept -> bool { return false; }
+            auto await_suspend(std::coroutine_handle<> handle) const noexcept -> void;
+            auto await_resume() const noexcept -> void { }
+        };
+        struct promise_type : MXCoroutinePromise {
+            promise_type() : MXCoroutinePromise{ nullptr, nullptr } { }
+            auto get_return_object() -> MXTask;
+            auto initial_suspend() const noexcept -> std::suspend_never { return {}; }
+            auto final_suspend() const noexcept -> FinalAwaiter { return {}; }
+            auto return_value(MXObject *value) -> void { this->result = value; }
+            auto unhandled_exception() -> void;
+        };
+
+        explicit MXTask(void *frame) : frame(frame) { }
+        MXTask(MXTask &&other) noexcept : frame(std::exchange(other.frame, nullptr)) { }
+        MXTask(const MXTask &) = delete;
+        ~MXTask();
+
+        // Hands the frame over to script code and registers it with this thread's
+        // loop (see MXEventLoop::adopt_task); mxs_runtime_await_resume destroys it.
+        auto release() -> void *;
+
+    private:
+        void *frame;
+    };
+
+    // Single-threaded epoll event loop that resumes suspended coroutines. One
+    // loop per thread; a coroutine is always resumed on the thread it was
+    // scheduled on.
+    class MXS_API MXEventLoop {
+    private:
+        int epoll_fd;
+        std::size_t waiting_io = 0;
+        std::deque<std::coroutine_handle<>> ready;
+        std::unique_ptr<MXIOBackend> io_backend;
+        std::unordered_set<void *> tasks;
+        MXEventLoop();
+        ~MXEventLoop();
+
+    public:
+        MXEventLoop(const MXEventLoop &) = delete;
+        auto operator=(const MXEventLoop &) -> MXEventLoop & = delete;
+
+        static auto get_loop() -> MXEventLoop &;
+        static auto get_rtti() -> MXRuntimeTypeInfo &;
+
+        // Completion-based I/O backend (io_uring, epoll fallback), created on first use.
+        auto io() -> MXIOBackend &;
+
+        auto schedule(std::coroutine_handle<> handle) -> void;
+
+        // Coroutine frames handed to script code: compiled `async func`s register
+        // in their ramp, native MXTasks on release(). Script `await` only touches
+        // operands registered here, so awaiting any other value is a TypeError
+        // instead of a reinterpretation of its memory.
+        auto adopt_task(void *frame) -> void;
+        [[nodiscard]] auto owns_task(void *frame) const -> bool;
+        // Unregisters `frame` before it is destroyed; false if it was not a task.
+        auto forget_task(void *frame) -> bool;
+        // Resumes `handle` once `fd` reports any of `events` (EPOLLIN, EPOLLOUT, ...).
+        // Only one coroutine may wait on a given fd at a time.
+        auto await_fd(std::coroutine_handle<> handle, int fd, std::uint32_t events)
+                -> bool;
+
+        // Resumes every ready coroutine, then polls for I/O for at most
+        // `timeout_ms` (-1 blocks). Returns the number of coroutines resumed.
+        auto run_once(int timeout_ms) -> std::size_t;
+        auto run_until(std::coroutine_handle<> handle) -> void;
+        auto run() -> void;
+        [[nodiscard]] auto has_pending() const -> bool;
+    };
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "mxspp/core/MXMacro.h"
+#include "mxspp/core/MXMappedFile.h"
+#include "mxspp/core/MXObject.h"
+#include "mxspp/core/MXOutputStream.h"
+#include "mxspp/core/MXType.h"
+#include <string_view>
+
+namespace mxs::core {
+    // Backing object of std.file.File. Writes go through a buffered
+    // MXOutputStream; reads go through a read-only mapping of the whole file.
+    // The descriptor is flushed and closed on destruction.
+    class MXS_API MXFile : public MXObject {
+    public:
+        // mode: "r", "rm" (read, mapped eagerly), "w" (truncate) or "a" (append).
+        // Returns an MXFile, or an MXError when the mode is unknown or open(2)
+        // or mmap(2) fails.
+        static auto open(const std::string &path, std::string_view mode) -> MXObjectOwned;
+        ~MXFile() override;
+
+        auto write(std::string_view data) -> bool;
+        auto flush() -> bool;
+        auto close() -> bool;
+
+        // Maps the file on first use; nullptr for write-only or closed files or
+        // when mmap(2) fails. The mapping outlives close() while referenced.
+        auto mapping() -> std::shared_ptr<const MXMappedRegion>;
+        // Returns an MXLineIterator over the mapping, or an MXError.
+        auto lines() -> MXObjectOwned;
+
+        [[nodiscard]] auto path() const -> const std::string & { return this->path_; }
+        [[nodiscard]] auto fd() const -> int { return this->fd_; }
+        [[nodiscard]] auto is_writable() const -> bool {
+            return this->writer_ != nullptr;
+        }
+
+        [[nodiscard]] auto repr() const -> repr_t override;
+        auto visit_references(const MXReferenceVisitor &visit) const -> void override;
+        static auto get_rtti() -> const MXRuntimeTypeInfo &;
+        [[nodiscard]] auto runtime_type() const -> const MXRuntimeTypeInfo & override;
+
+    private:
+        MXFile(std::string path, int fd, bool writable);
+
+        std::string path_;
+        int fd_;
+        std::unique_ptr<MXOutputStream> writer_;
+        std::shared_ptr<const MXMappedRegion> mapping_;
+    };
+}
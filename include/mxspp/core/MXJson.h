@@ -0,0 +1,74 @@
+#pragma once
+
+#include "mxspp/core/MXMacro.h"
+#include "mxspp/core/MXMappedFile.h"
+#include "mxspp/core/MXObject.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace mxs::core {
+    // Streaming JSON reader in the style of simdjson. A structural index (offsets
+    // of braces, brackets, colons, commas, opening quotes and scalar starts) is
+    // built from 64-byte SIMD masks one chunk ahead of the parser, so string
+    // bodies and whitespace are never walked byte by byte. The input may hold
+    // several whitespace-separated documents (NDJSON); next() returns one per
+    // call. Objects become Dicts, arrays Lists, and strings without escapes are
+    // StringViews into the input.
+    class MXS_API MXJsonReader : public MXObject {
+    public:
+        explicit MXJsonReader(std::shared_ptr<const MXMappedRegion> input,
+                              bool is_static = false);
+        ~MXJsonReader() override;
+
+        // Parses exactly one document. Returns the value (an MXNil for null) or
+        // an MXError("JSONError").
+        static auto parse(std::string text) -> MXObjectOwned;
+
+        // Returns the next document, an MXNil for a top-level null, or an
+        // MXError; nullptr only once the input is exhausted. Nulls nested in
+        // objects and arrays stay nullptr. A reader that has failed stays failed.
+        auto next() -> MXObjectOwned;
+        // True once the input is exhausted or an error has been returned.
+        [[nodiscard]] auto done() -> bool;
+
+        [[nodiscard]] auto repr() const -> repr_t override;
+        static auto get_rtti() -> const MXRuntimeTypeInfo &;
+        [[nodiscard]] auto runtime_type() const -> const MXRuntimeTypeInfo & override;
+
+    private:
+        static constexpr std::size_t INDEX_CHUNK = 64 * 1024;
+        static constexpr int MAX_DEPTH = 1024;
+
+        auto index_chunk() -> bool;
+        auto index_block(std::size_t base) -> void;
+        auto peek_structural() -> std::size_t;
+        auto next_structural() -> std::size_t;
+
+        auto parse_value(std::size_t pos, int depth) -> MXObjectOwned;
+        auto parse_object(int depth) -> MXObjectOwned;
+        auto parse_array(int depth) -> MXObjectOwned;
+        auto parse_scalar(std::size_t pos) -> MXObjectOwned;
+        auto read_string(std::size_t pos, std::string_view &text, bool &borrowed) -> bool;
+        auto check_control(std::size_t pos, const char *quote) -> bool;
+        auto fail(std::string_view what, std::size_t pos) -> MXObjectOwned;
+
+        std::shared_ptr<const MXMappedRegion> input_;
+        std::string_view bytes_;
+        std::vector<std::size_t> structurals_;
+        std::size_t cursor_ = 0;
+        std::size_t indexed_ = 0;
+        // 跨 64 字节块传递的状态：是否在字符串内、上一块末尾是否转义、是否在标量中
+        std::uint64_t in_string_ = 0;
+        std::uint64_t escaped_ = 0;
+        std::uint64_t in_scalar_ = 0;
+        // 已索引部分里第一个落在字符串内的控制字节（< 0x20）；读到包含它的字符串时报错
+        std::size_t control_ = static_cast<std::size_t>(-1);
+        std::string scratch_;
+        std::string error_;
+        bool reported_ = false;
+    };
+}
@@ -0,0 +1,94 @@
+#pragma once
+
+#include "mxspp/core/MXMacro.h"
+#include "mxspp/core/MXObject.h"
+#include "mxspp/core/MXString.h"
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <string_view>
+
+namespace mxs::core {
+    // Returns the first occurrence of `byte` in [first, last), or `last`. Scans 16
+    // bytes per step with SSE2 / NEON and falls back to memchr elsewhere.
+    MXS_API auto mx_find_byte(const char *first, const char *last, char byte)
+            -> const char *;
+
+    // A read-only private mapping of a whole file, unmapped when the last
+    // reference (the owning MXFile, a line iterator or a view) goes away. An
+    // in-memory buffer can be adopted so parsers see a single input type.
+    class MXS_API MXMappedRegion {
+    public:
+        // Maps `fd` from offset 0; returns nullptr when mmap(2) fails. Empty
+        // files yield a region with an empty view.
+        static auto map(int fd) -> std::shared_ptr<const MXMappedRegion>;
+        static auto adopt(std::string bytes) -> std::shared_ptr<const MXMappedRegion>;
+        ~MXMappedRegion();
+
+        MXMappedRegion(const MXMappedRegion &) = delete;
+        auto operator=(const MXMappedRegion &) -> MXMappedRegion & = delete;
+
+        [[nodiscard]] auto view() const -> std::string_view {
+            return { this->data_, this->size_ };
+        }
+
+    private:
+        MXMappedRegion(const char *data, std::size_t size);
+        explicit MXMappedRegion(std::string bytes);
+
+        std::string owned_;
+        const char *data_;
+        std::size_t size_;
+        bool mapped_;
+    };
+
+    // A string that borrows its bytes from a mapping instead of owning them.
+    // Keeps the mapping alive; materialize() copies into an owned MXString when
+    // the value has to outlive or detach from the file.
+    class MXS_API MXStringView : public MXObject {
+    public:
+        MXStringView(std::shared_ptr<const MXMappedRegion> region, std::string_view value,
+                     bool is_static = false);
+        ~MXStringView() override;
+
+        [[nodiscard]] auto view() const -> std::string_view { return this->value_; }
+        [[nodiscard]] auto size() const -> std::size_t { return this->value_.size(); }
+        [[nodiscard]] auto materialize() const -> std::unique_ptr<MXString>;
+
+        // --- Overrides ---
+        [[nodiscard]] auto get_hash_code() const -> MXHashCode_t override;
+        [[nodiscard]] auto repr() const -> repr_t override;
+
+        // --- RTTI ---
+        static auto get_rtti() -> const MXRuntimeTypeInfo &;
+        [[nodiscard]] auto runtime_type() const -> const MXRuntimeTypeInfo & override;
+
+    private:
+        std::shared_ptr<const MXMappedRegion> region_;
+        std::string_view value_;
+    };
+
+    // Iterator behind std.file.lines(). Yields one MXStringView per line with
+    // the trailing "\n" / "\r\n" stripped; a final line without newline is
+    // still yielded.
+    class MXS_API MXLineIterator : public MXObject {
+    public:
+        explicit MXLineIterator(std::shared_ptr<const MXMappedRegion> region,
+                                bool is_static = false);
+        ~MXLineIterator() override;
+
+        // Returns the next line, or nullptr once the mapping is exhausted.
+        auto next() -> std::unique_ptr<MXStringView>;
+        // Same as next() without allocating a view object.
+        auto next_view(std::string_view &line) -> bool;
+
+        [[nodiscard]] auto repr() const -> repr_t override;
+        static auto get_rtti() -> const MXRuntimeTypeInfo &;
+        [[nodiscard]] auto runtime_type() const -> const MXRuntimeTypeInfo & override;
+
+    private:
+        std::shared_ptr<const MXMappedRegion> region_;
+        const char *cursor_;
+        const char *end_;
+    };
+}
@@ -0,0 +1,136 @@
+#pragma once
+
+#include "mxspp/core/MXMacro.h"
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <string>
+
+namespace mxs::core {
+    // Monotonic count; add() is a relaxed atomic increment.
+    class MXS_API MXCounter {
+    public:
+        auto add(std::uint64_t amount = 1) -> void {
+            this->value_.fetch_add(amount, std::memory_order_relaxed);
+        }
+        [[nodiscard]] auto value() const -> std::uint64_t {
+            return this->value_.load(std::memory_order_relaxed);
+        }
+
+    private:
+        std::atomic<std::uint64_t> value_{ 0 };
+    };
+
+    // Value that goes up and down, e.g. work in flight.
+    class MXS_API MXGauge {
+    public:
+        auto add(std::int64_t delta) -> void {
+            this->value_.fetch_add(delta, std::memory_order_relaxed);
+        }
+        auto set(std::int64_t value) -> void {
+            this->value_.store(value, std::memory_order_relaxed);
+        }
+        [[nodiscard]] auto value() const -> std::int64_t {
+            return this->value_.load(std::memory_order_relaxed);
+        }
+
+    private:
+        std::atomic<std::int64_t> value_{ 0 };
+    };
+
+    // HDR-style histogram of non-negative integers (nanoseconds, bytes, ...).
+    // Each power of two is split into 2^SUB_BUCKET_BITS linear buckets, so a
+    // recorded value is known to within 1/32 (about 3%) over the whole 64-bit
+    // range. record() touches three relaxed atomics and never allocates or
+    // locks. Readers see a consistent total only once writers are quiet;
+    // scrapes may be off by the records that race with them.
+    class MXS_API MXHistogram {
+    public:
+        static constexpr unsigned SUB_BUCKET_BITS = 5;
+        static constexpr std::size_t SUB_BUCKETS = std::size_t{ 1 } << SUB_BUCKET_BITS;
+        static constexpr std::size_t BUCKETS = SUB_BUCKETS * (64 - SUB_BUCKET_BITS + 1);
+
+        auto record(std::uint64_t value) -> void;
+
+        [[nodiscard]] auto count() const -> std::uint64_t;
+        [[nodiscard]] auto sum() const -> std::uint64_t;
+        // Number of recorded values <= `limit`, to bucket precision.
+        [[nodiscard]] auto count_at_or_below(std::uint64_t limit) const -> std::uint64_t;
+        // Upper bound of the bucket holding the q-th quantile (0 <= q <= 1).
+        [[nodiscard]] auto value_at_quantile(double q) const -> std::uint64_t;
+
+    private:
+        static auto bucket_of(std::uint64_t value) -> std::size_t;
+        static auto bucket_limit(std::size_t bucket) -> std::uint64_t;
+
+        std::array<std::atomic<std::uint64_t>, BUCKETS> buckets_{};
+        std::atomic<std::uint64_t> count_{ 0 };
+        std::atomic<std::uint64_t> sum_{ 0 };
+    };
+
+    // Process-wide metrics, exported in the Prometheus text format.
+    //
+    // counter(), gauge() and histogram() create a metric on first use and
+    // return the same object for the same name afterwards. The references stay
+    // valid for the life of the process, so hot paths look a metric up once:
+    //
+    //     static auto &hits = MXMetricsRegistry::get_registry().counter(
+    //             "mxs_jit_object_cache_hits_total", "Objects loaded from the cache.");
+    //     hits.add();
+    //
+    // Collectors produce values that are cheaper to compute at scrape time than
+    // to maintain, such as objects alive by type. They return one value per
+    // label value.
+    class MXS_API MXMetricsRegistry {
+    public:
+        enum class Kind { COUNTER, GAUGE };
+        using Collector = std::function<std::map<std::string, double>()>;
+
+        static auto get_registry() -> MXMetricsRegistry &;
+
+        auto counter(const std::string &name, const std::string &help) -> MXCounter &;
+        auto gauge(const std::string &name, const std::string &help) -> MXGauge &;
+        // Values are recorded in integer units and exported multiplied by
+        // `scale`, e.g. nanoseconds with scale 1e-9 for a `_seconds` metric.
+        auto histogram(const std::string &name, const std::string &help, double scale)
+                -> MXHistogram &;
+        // `label` is empty for a collector that returns one unlabeled value
+        // under the key "".
+        auto collector(const std::string &name, const std::string &help, Kind kind,
+                       const std::string &label, Collector collect) -> void;
+
+        // Collectors run outside the registry lock, so they may be slow or
+        // register metrics themselves without blocking other threads.
+        auto write_prometheus(std::ostream &out) const -> void;
+
+    private:
+        MXMetricsRegistry() = default;
+
+        struct Family {
+            std::string help;
+            std::string type;
+            MXCounter *counter = nullptr;
+            MXGauge *gauge = nullptr;
+            MXHistogram *histogram = nullptr;
+            double scale = 1.0;
+            std::string label;
+            Collector collect;
+        };
+
+        auto family(const std::string &name, const std::string &help,
+                    const std::string &type) -> Family &;
+
+        mutable std::mutex lock_;
+        // 按名字排序输出；deque 保证已经交出去的引用不会失效
+        std::map<std::string, Family> families_;
+        std::deque<MXCounter> counters_;
+        std::deque<MXGauge> gauges_;
+        std::deque<MXHistogram> histograms_;
+    };
+}
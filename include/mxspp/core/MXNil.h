@@ -4,6 +4,19 @@
 #include "MXObject.h"
 #include "_type_def.h"
 namespace mxs::builtin {
-    class MXS_API MXNil : public core::MXObject { };
+    // An explicit nil for APIs where nullptr already means something else, e.g.
+    // a top-level JSON null from MXJsonReader::next(), whose nullptr marks the
+    // end of input. Falsy; stored as plain nil (nullptr) when copied into a global.
+    class MXS_API MXNil : public core::MXObject {
+    public:
+        explicit MXNil(bool is_static = false);
+        ~MXNil() override;
 
-}
\ No newline at end of file
+        [[nodiscard]] auto get_hash_code() const -> MXHashCode_t override;
+        [[nodiscard]] auto repr() const -> core::repr_t override;
+
+        static auto get_rtti() -> const core::MXRuntimeTypeInfo &;
+        [[nodiscard]] auto runtime_type() const
+                -> const core::MXRuntimeTypeInfo & override;
+    };
+}
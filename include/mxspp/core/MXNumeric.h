@@ -1,7 +1,41 @@
 #pragma once
 
 #include "MXMacro.h"
+#include "MXObject.h"
 #include "_type_def.h"
 namespace mxs::builtin {
-    class MXS_API MXNumeric : public virtual core::MXObject { };
-}
\ No newline at end of file
+    class MXS_API MXNumeric : public virtual core::MXObject {
+    public:
+        MXNumeric(bool is_static) : core::MXObject(is_static) { }
+    };
+
+    class MXS_API MXInteger : public MXNumeric {
+    public:
+        explicit MXInteger(std::int64_t value, bool is_static = false);
+        ~MXInteger() override;
+
+        const std::int64_t value;
+
+        [[nodiscard]] auto get_hash_code() const -> MXHashCode_t override;
+        [[nodiscard]] auto repr() const -> core::repr_t override;
+
+        static auto get_rtti() -> const core::MXRuntimeTypeInfo &;
+        [[nodiscard]] auto runtime_type() const
+                -> const core::MXRuntimeTypeInfo & override;
+    };
+
+    class MXS_API MXFloat : public MXNumeric {
+    public:
+        explicit MXFloat(double value, bool is_static = false);
+        ~MXFloat() override;
+
+        const double value;
+
+        [[nodiscard]] auto get_hash_code() const -> MXHashCode_t override;
+        [[nodiscard]] auto repr() const -> core::repr_t override;
+
+        static auto get_rtti() -> const core::MXRuntimeTypeInfo &;
+        [[nodiscard]] auto runtime_type() const
+                -> const core::MXRuntimeTypeInfo & override;
+    };
+}
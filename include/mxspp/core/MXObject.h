@@ -2,13 +2,21 @@
 #include "MXMacro.h"
 #include "MXType.h"
 #include "_type_def.h"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
 #include <mutex>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 
 namespace mxs::core {
     using property_name_t = std::string;
     using repr_t = std::string;
+    // One outgoing reference: how it is reached (".property", "[index]",
+    // "[\"key\"]", ...) and the object it keeps alive.
+    using MXReferenceVisitor =
+            std::function<void(std::string_view edge, const MXObject *target)>;
     class MXS_API MXObject {
     public:
         const bool is_static;
@@ -17,6 +25,23 @@ namespace mxs::core {
         virtual ~MXObject();
         MXObject(bool is_static);
         static auto get_rtti() -> const core::MXRuntimeTypeInfo &;
+        // The most derived type's get_rtti(); classes with their own type info
+        // override it.
+        [[nodiscard]] virtual auto runtime_type() const -> const MXRuntimeTypeInfo &;
+
+        // Every heap-allocated object comes through here, which lets
+        // MXAllocationProfiler see its size.
+        static auto operator new(std::size_t size) -> void *;
+        static auto operator delete(void *memory, std::size_t size) -> void;
+        // Size of the operator new allocation holding this object, or 0 when it
+        // was not created with new (statics, locals, members).
+        [[nodiscard]] auto allocation_size() const -> std::size_t {
+            return this->heap_bytes;
+        }
+        // Calls `visit` for every non-nil object this one owns or shares.
+        // Classes that hold objects override it and call the base version for
+        // the dynamic properties. Used by heap snapshots.
+        virtual auto visit_references(const MXReferenceVisitor &visit) const -> void;
 
         virtual auto equals(MXObjectConstBorrow other) -> bool;
         virtual auto get_hash_code() const -> MXHashCode_t;
@@ -29,9 +54,14 @@ namespace mxs::core {
         virtual auto repr() const -> repr_t;
 
     private:
+        friend class MXAllocationProfiler;
+
         std::unordered_map<std::string, MXObjectOwned> dynamic_owned_properties;
         std::unordered_map<std::string, MXObjectShared> dynamic_shared_properties;
-        std::mutex lock;
+        mutable std::mutex lock;
+        std::uint32_t heap_bytes = 0;
+        // 由分配分析器采样过，析构时需要通知它
+        bool allocation_sampled = false;
     };
 
     template<class T = MXObject>
@@ -0,0 +1,62 @@
+#pragma once
+
+#include "mxspp/core/MXMacro.h"
+#include "mxspp/core/MXObject.h"
+#include "mxspp/core/MXType.h"
+#include <mutex>
+#include <string_view>
+#include <vector>
+
+namespace mxs::core {
+    enum class MXFlushPolicy : std::uint8_t {
+        LINE,// flush after every write containing '\n' (interactive terminals)
+        FULL,// flush when the buffer fills, on flush() and on destruction
+        NONE,// every write goes straight to the fd
+    };
+
+    // Buffered writer over a raw fd. Small writes are batched in a user-space
+    // buffer; writes too large to be worth copying are sent together with the
+    // buffered bytes in a single writev(), straight from the caller's storage.
+    class MXS_API MXOutputStream : public MXObject {
+    public:
+        static constexpr std::size_t BUFFER_SIZE = 64 * 1024;
+        static constexpr std::size_t DIRECT_WRITE_THRESHOLD = 4 * 1024;
+
+        // LINE for terminals, FULL otherwise.
+        static auto default_policy(int fd) -> MXFlushPolicy;
+
+        MXOutputStream(int fd, MXFlushPolicy policy, bool owns_fd,
+                       bool is_static = false);
+        ~MXOutputStream() override;
+
+        auto write(std::string_view data) -> bool;
+        // `data` followed by '\n' without concatenating them first.
+        auto write_line(std::string_view data) -> bool;
+        auto flush() -> bool;
+        auto close() -> bool;
+
+        [[nodiscard]] auto fd() const -> int { return this->fd_; }
+        [[nodiscard]] auto policy() const -> MXFlushPolicy { return this->policy_; }
+        auto set_policy(MXFlushPolicy policy) -> void;
+
+        [[nodiscard]] auto repr() const -> repr_t override;
+        static auto get_rtti() -> const MXRuntimeTypeInfo &;
+        [[nodiscard]] auto runtime_type() const -> const MXRuntimeTypeInfo & override;
+
+        static auto standard_output() -> MXOutputStream &;
+        static auto standard_error() -> MXOutputStream &;
+
+    private:
+        // Writes the buffered bytes followed by `tail` with one writev() per round
+        // trip. Caller holds `lock_`.
+        auto drain(std::string_view tail, std::string_view tail_suffix) -> bool;
+        auto append(std::string_view data, std::string_view suffix) -> bool;
+
+        int fd_;
+        MXFlushPolicy policy_;
+        bool owns_fd_;
+        std::vector<char> buffer_;
+        std::size_t used_ = 0;
+        mutable std::mutex lock_;
+    };
+}
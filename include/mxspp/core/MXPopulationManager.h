@@ -3,22 +3,85 @@
 #include "mxspp/core/MXMacro.h"
 #include "mxspp/core/MXObject.h"
 #include "mxspp/core/MXType.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <map>
 #include <mutex>
+#include <ostream>
+#include <string>
 #include <unordered_set>
 namespace mxs::core {
     class MXS_API MXPopulationManager {
     private:
         mutable std::mutex lock;
         std::unordered_set<const MXObject *> populations;
+        std::uint64_t registrations = 0;
+        // Threads that have constructed or destroyed an object and are not
+        // parked; write_snapshot() waits for this to drop to zero.
+        std::mutex world_lock;
+        std::condition_variable world_changed;
+        std::size_t running = 0;
+        bool stopped = false;
+        std::atomic<bool> stop_requested{ false };
+        struct Member;
+        static thread_local Member member;
         MXPopulationManager();
         ~MXPopulationManager();
+        auto join_world() -> void;
+        auto leave_world() -> void;
 
     public:
         auto register_object(const MXObject *const obj) -> void;
         auto unregister_object(const MXObject *const obj) -> void;
+        // Objects registered since startup; never decreases. Tools diff two
+        // readings to count the allocations made in between.
+        auto total_registered() const -> std::uint64_t;
+        auto live_count() const -> std::size_t;
+        // Live objects per runtime_type() name. Objects that another thread is
+        // destroying meanwhile may be counted under a base type.
+        auto live_by_type() const -> std::map<std::string, std::size_t>;
+
+        // Streams a heap snapshot of every live object as JSON Lines. The first
+        // line is a header:
+        //   {"format":"mxs-heap-snapshot","version":1,"objects":N}
+        // followed by one line per object:
+        //   {"id":"0x...","type":"List","size":56,"static":false,
+        //    "refs":[["[0]","0x..."],[".name","0x..."]]}
+        // `size` is allocation_size(), so buffers an object owns (string bytes,
+        // vector storage) are not included. `refs` comes from
+        // visit_references(). The lock is only held while addresses, types and
+        // references are copied; formatting and I/O happen after it is
+        // released. bench/heap_diff.py compares two snapshots.
+        //
+        // The objects are copied with the world stopped: every other thread
+        // that has constructed or destroyed an object must be parked at a
+        // safepoint() or inside a Parked scope, so none of them is half way
+        // through a constructor or destructor. Returns false, writing nothing,
+        // when some thread does not park within a few seconds (a loop that
+        // makes no runtime calls, or a wait outside a Parked scope).
+        auto write_snapshot(std::ostream &out) -> bool;
+
+        // Lets a pending snapshot run. Only call it where the thread is in no
+        // MXObject constructor or destructor, e.g. on entry to a runtime call.
+        auto safepoint() -> void;
+        // Parks the thread for a blocking wait (epoll, accept, reading input).
+        // Objects must not be constructed or destroyed inside the scope.
+        class MXS_API Parked {
+        public:
+            Parked();
+            ~Parked();
+            Parked(const Parked &) = delete;
+            auto operator=(const Parked &) -> Parked & = delete;
+
+        private:
+            bool joined;
+        };
 
         static auto get_manager() -> MXPopulationManager &;
         static auto get_rtti() -> MXRuntimeTypeInfo &;
+        // Live object count and the most common types; use write_snapshot()
+        // for the objects themselves.
         auto repr() const -> std::string;
     };
 }
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#if defined(__PCLMUL__)
+#include <wmmintrin.h>
+#endif
+
+namespace mxs::core {
+    // Bitmask helpers for the runtime's structural scanners (JSON, CSV). Input is
+    // processed in 64-byte blocks; bit i of a mask describes block[i].
+    inline constexpr std::size_t MX_SCAN_BLOCK = 64;
+
+    class MXScanBlock {
+    public:
+        // `size` may be shorter than a block at the end of input; the rest is
+        // padded with spaces, which no scanner treats as significant.
+        MXScanBlock(const char *data, std::size_t size) {
+            if (size >= MX_SCAN_BLOCK) {
+                this->bytes_ = data;
+            } else {
+                std::memset(this->padded_, ' ', MX_SCAN_BLOCK);
+                std::memcpy(this->padded_, data, size);
+                this->bytes_ = this->padded_;
+            }
+        }
+
+        [[nodiscard]] auto eq(char byte) const -> std::uint64_t {
+#if defined(__SSE2__)
+            const __m128i needle = _mm_set1_epi8(byte);
+            std::uint64_t mask = 0;
+            for (int lane = 0; lane < 4; ++lane) {
+                const __m128i chunk = _mm_loadu_si128(
+                        reinterpret_cast<const __m128i *>(this->bytes_ + lane * 16));
+                const auto bits = static_cast<std::uint32_t>(
+                        _mm_movemask_epi8(_mm_cmpeq_epi8(chunk, needle)));
+                mask |= static_cast<std::uint64_t>(bits) << (lane * 16);
+            }
+            return mask;
+#else
+            std::uint64_t mask = 0;
+            for (std::size_t i = 0; i < MX_SCAN_BLOCK; ++i)
+                mask |= static_cast<std::uint64_t>(this->bytes_[i] == byte) << i;
+            return mask;
+#endif
+        }
+
+        // Bytes below 0x20 (compared unsigned, so UTF-8 lead bytes never match),
+        // which JSON forbids unescaped inside strings.
+        [[nodiscard]] auto control() const -> std::uint64_t {
+#if defined(__SSE2__)
+            const __m128i limit = _mm_set1_epi8(0x1F);
+            std::uint64_t mask = 0;
+            for (int lane = 0; lane < 4; ++lane) {
+                const __m128i chunk = _mm_loadu_si128(
+                        reinterpret_cast<const __m128i *>(this->bytes_ + lane * 16));
+                // min(x, 0x1F) == x 当且仅当 x <= 0x1F（无符号）
+                const auto bits = static_cast<std::uint32_t>(_mm_movemask_epi8(
+                        _mm_cmpeq_epi8(_mm_min_epu8(chunk, limit), chunk)));
+                mask |= static_cast<std::uint64_t>(bits) << (lane * 16);
+            }
+            return mask;
+#else
+            std::uint64_t mask = 0;
+            for (std::size_t i = 0; i < MX_SCAN_BLOCK; ++i) {
+                const auto byte = static_cast<unsigned char>(this->bytes_[i]);
+                mask |= static_cast<std::uint64_t>(byte < 0x20) << i;
+            }
+            return mask;
+#endif
+        }
+
+    private:
+        const char *bytes_;
+        char padded_[MX_SCAN_BLOCK];
+    };
+
+    // Bit i of the result is the XOR of bits 0..i: turns quote positions into an
+    // "inside quotes" mask (opening quote set, closing quote clear).
+    inline auto mx_prefix_xor(std::uint64_t bits) -> std::uint64_t {
+#if defined(__PCLMUL__)
+        const __m128i all_ones = _mm_set1_epi8(static_cast<char>(0xFF));
+        const __m128i product =
+                _mm_clmulepi64_si128(_mm_set_epi64x(0, static_cast<long long>(bits)),
+                                     all_ones, 0);
+        return static_cast<std::uint64_t>(_mm_cvtsi128_si64(product));
+#else
+        bits ^= bits << 1;
+        bits ^= bits << 2;
+        bits ^= bits << 4;
+        bits ^= bits << 8;
+        bits ^= bits << 16;
+        bits ^= bits << 32;
+        return bits;
+#endif
+    }
+
+    // Pops the lowest set bit and returns its index; `bits` must be non-zero.
+    inline auto mx_pop_bit(std::uint64_t &bits) -> unsigned {
+        const auto index = static_cast<unsigned>(__builtin_ctzll(bits));
+        bits &= bits - 1;
+        return index;
+    }
+}
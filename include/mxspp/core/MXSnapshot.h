@@ -0,0 +1,101 @@
+#pragma once
+
+#include "mxspp/core/MXMacro.h"
+#include "mxspp/core/MXMappedFile.h"
+#include "mxspp/core/MXObject.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace mxs::core {
+    // Startup image: the named values left behind by module initialization plus
+    // the program's object code, written once and mmap()ed on later launches.
+    //
+    // Layout (host byte order, every section 8-byte aligned):
+    //   header   magic "MXSI", format version, key, flags, section extents
+    //   objects  records of three u64 {tag, count, payload}, children first
+    //   refs     u64 object references (index + 1, 0 for nil) used by lists
+    //            and dicts
+    //   roots    pairs of references {name string, value}
+    //   data     unboxed array elements
+    //   strings  string bytes; equal strings are stored once and share a record
+    //   code     relocatable object file, linked by the JIT at load time
+    //
+    // Object references are indices, not addresses, so the image is position
+    // independent; restore() resolves them into freshly allocated objects.
+    // Supported values: nil, Integer, Float, Boolean, String / StringView,
+    // List, Dict and Array.
+    class MXS_API MXSnapshotWriter {
+    public:
+        // Serializes `value` under `name`. Returns nullptr on success or a
+        // SnapshotError for values that cannot live in an image (files,
+        // streams, tasks, ...); nothing is recorded in that case.
+        auto add_root(std::string name, const MXObject *value) -> MXObjectOwned;
+        auto set_code(std::string object) -> void;
+        auto set_flags(std::uint32_t flags) -> void;
+
+        // Writes the image to a temporary file and renames it over `path`, so a
+        // concurrently starting process never maps a partial image. `key` must
+        // match on load; it identifies the runtime and compiler that built it.
+        auto write(const std::string &path, std::uint64_t key) const -> MXObjectOwned;
+
+    private:
+        auto serialize(const MXObject *value) -> std::uint64_t;
+        auto intern(std::string_view text) -> std::uint64_t;
+        auto push(std::uint64_t tag, std::uint64_t count, std::uint64_t payload)
+                -> std::uint64_t;
+
+        // 每条记录三个字：tag、count、payload
+        std::vector<std::uint64_t> objects_;
+        std::vector<std::uint64_t> refs_;
+        std::vector<std::uint64_t> roots_;
+        std::string data_;
+        std::string strings_;
+        std::string code_;
+        std::uint32_t flags_ = 0;
+        // 字符串驻留：内容相同的字符串共用一条记录
+        std::unordered_map<std::string, std::uint64_t> interned_;
+    };
+
+    class MXS_API MXSnapshotImage {
+    public:
+        // Maps and validates the image at `path`. Returns nullptr when the file
+        // is missing, truncated, malformed or was built with a different key,
+        // in which case the caller initializes from source instead.
+        static auto open(const std::string &path, std::uint64_t key)
+                -> std::unique_ptr<MXSnapshotImage>;
+
+        // Rebuilds every root in the order it was added. Each call allocates a
+        // new object graph owned by the caller.
+        [[nodiscard]] auto restore() const
+                -> std::vector<std::pair<std::string, MXObjectOwned>>;
+
+        // The object code borrows the mapping and stays valid while the image
+        // is alive.
+        [[nodiscard]] auto code() const -> std::string_view { return this->code_; }
+        [[nodiscard]] auto flags() const -> std::uint32_t { return this->flags_; }
+
+    private:
+        explicit MXSnapshotImage(std::shared_ptr<const MXMappedRegion> region);
+
+        auto build(std::uint64_t ref) const -> MXObjectOwned;
+        auto text(std::uint64_t ref) const -> std::string_view;
+
+        std::shared_ptr<const MXMappedRegion> region_;
+        const std::uint64_t *objects_ = nullptr;
+        const std::uint64_t *refs_ = nullptr;
+        const std::uint64_t *roots_ = nullptr;
+        std::string_view data_;
+        std::string_view strings_;
+        std::string_view code_;
+        std::uint64_t object_count_ = 0;
+        std::uint64_t ref_count_ = 0;
+        std::uint64_t root_count_ = 0;
+        std::uint32_t flags_ = 0;
+    };
+}
@@ -1,8 +1,27 @@
 #pragma once
 
-#include "mxspp/builtin/MXMacro.h"
-#include "mxspp/builtin/MXObject.h"
+#include "mxspp/core/MXMacro.h"
+#include "mxspp/core/MXObject.h"
+#include <string_view>
+
 namespace mxs::core {
-    class MXS_API MXString : public MXObject { };
+    class MXS_API MXString : public MXObject {
+    public:
+        explicit MXString(std::string value, bool is_static = false);
+        ~MXString() override;
+
+        [[nodiscard]] auto view() const -> std::string_view;
+        [[nodiscard]] auto size() const -> std::size_t;
+
+        // --- Overrides ---
+        [[nodiscard]] auto get_hash_code() const -> MXHashCode_t override;
+        [[nodiscard]] auto repr() const -> repr_t override;
+
+        // --- RTTI ---
+        static auto get_rtti() -> const MXRuntimeTypeInfo &;
+        [[nodiscard]] auto runtime_type() const -> const MXRuntimeTypeInfo & override;
 
-}
\ No newline at end of file
+    private:
+        std::string value_;
+    };
+}
@@ -0,0 +1,122 @@
+#pragma once
+
+#include "mxspp/core/MXMacro.h"
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <vector>
+#if defined(__x86_64__)
+#include <x86intrin.h>
+#endif
+
+namespace mxs::core {
+    // Event tracer behind `mxs --trace`.
+    //
+    // Each thread appends fixed-size events to its own ring buffer. A ring has
+    // a single writer, so recording an event takes a timestamp, a few plain
+    // stores and one release store of the write index. It needs no lock, no
+    // read-modify-write and no allocation after the thread's first event.
+    // When a ring is full the oldest events are overwritten, so a trace keeps
+    // the last CAPACITY events of every thread. Timestamps are raw TSC reads
+    // on x86-64 and steady_clock nanoseconds elsewhere. They are converted to
+    // microseconds against steady_clock only when the trace is written.
+    //
+    // While tracing is off, every hook costs one relaxed load and a branch.
+    // The hooks only pass integers and pointers, so runtime.bc, which is
+    // compiled separately from the host, calls them like any other host
+    // function.
+    //
+    // Categories and names must be string literals: only the pointer is kept.
+    class MXS_API MXTracer {
+    public:
+        static constexpr std::size_t CAPACITY = std::size_t{ 1 } << 15;
+
+        // Times a block as one complete ("X") event, recorded when the scope
+        // ends. Costs nothing beyond the enabled() check when tracing is off.
+        class Scope {
+        public:
+            Scope(const char *category, const char *name)
+                : category_(category), name_(name), active_(enabled()),
+                  started_(active_ ? now() : 0) { }
+            ~Scope() {
+                if (this->active_)
+                    get_tracer().complete(this->category_, this->name_, this->started_,
+                                          this->value_);
+            }
+            Scope(const Scope &) = delete;
+            auto operator=(const Scope &) -> Scope & = delete;
+
+            // Attached to the event as args.value, e.g. bytes produced.
+            auto set_value(std::int64_t value) -> void { this->value_ = value; }
+
+        private:
+            const char *category_;
+            const char *name_;
+            bool active_;
+            std::uint64_t started_;
+            std::int64_t value_ = 0;
+        };
+
+        static auto get_tracer() -> MXTracer &;
+
+        [[nodiscard]] static auto enabled() -> bool {
+            return enabled_.load(std::memory_order_relaxed);
+        }
+        static auto now() -> std::uint64_t {
+#if defined(__x86_64__)
+            return __rdtsc();
+#else
+            return static_cast<std::uint64_t>(
+                    std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+        }
+
+        auto enable() -> void;
+
+        // Recording hooks; callers check enabled() first.
+        auto complete(const char *category, const char *name, std::uint64_t start,
+                      std::int64_t value = 0) -> void;
+        auto instant(const char *category, const char *name, std::int64_t value = 0)
+                -> void;
+        auto counter(const char *category, const char *name, std::int64_t value)
+                -> void;
+
+        // Writes the Chrome trace-event JSON format, which chrome://tracing
+        // and the Perfetto UI open directly. Safe to call while other threads
+        // record; events they overwrite during the copy are left out.
+        auto write_chrome_trace(std::ostream &out) const -> void;
+        // Events lost because a ring wrapped around.
+        [[nodiscard]] auto overwritten_count() const -> std::uint64_t;
+
+    private:
+        MXTracer() = default;
+
+        struct Event {
+            const char *category;
+            const char *name;
+            std::uint64_t start;
+            std::uint64_t duration;
+            std::int64_t value;
+            char phase;
+        };
+        struct Ring;
+
+        auto ring() -> Ring &;
+        auto record(const Event &event) -> void;
+
+        static std::atomic<bool> enabled_;
+        static thread_local Ring *current_ring_;
+
+        // 时间戳换算基准：开启时同时读取 TSC 和 steady_clock
+        std::uint64_t base_ticks_ = 0;
+        std::chrono::steady_clock::time_point base_time_{};
+
+        // 线程退出后环形缓冲区仍然保留，写出时还能读到它的事件
+        mutable std::mutex lock_;
+        std::vector<std::unique_ptr<Ring>> rings_;
+    };
+}
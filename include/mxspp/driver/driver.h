@@ -5,4 +5,84 @@
 #ifndef DRIVER_H
 #define DRIVER_H
 
+#include <array>
+#include <cstdint>
+#include <string>
+
+namespace mxs::shell {
+    class MXShell;
+}
+
+namespace mxs::driver {
+    // Compile-server protocol spoken between `mxs serve` and `mxs-client` over
+    // a Unix stream socket, one request per connection:
+    //   request:  RequestHeader (carrying the client's stdin/stdout/stderr as
+    //             SCM_RIGHTS), then `name_size` bytes of script name and
+    //             `source_size` bytes of source;
+    //   response: the script's exit status as an int32.
+    // The server runs the script with the client's descriptors installed as
+    // fds 0-2, so output goes straight to the client's terminal or pipe.
+    enum class Command : std::uint32_t { RUN = 1, COMPILE = 2, SHUTDOWN = 3 };
+
+    struct RequestHeader {
+        static constexpr std::uint32_t MAGIC = 0x4d585331;// "MXS1"
+        // Upper bounds enforced by receive_request() before anything is
+        // allocated; larger requests are rejected.
+        static constexpr std::uint64_t MAX_NAME_SIZE = 4096;
+        static constexpr std::uint64_t MAX_SOURCE_SIZE = 64ull << 20;
+        std::uint32_t magic = MAGIC;
+        Command command = Command::RUN;
+        std::uint64_t name_size = 0;
+        std::uint64_t source_size = 0;
+    };
+
+    struct Request {
+        Command command = Command::RUN;
+        std::string name;
+        std::string source;
+        std::array<int, 3> fds{ -1, -1, -1 };
+    };
+
+    // $MXS_SOCKET, else $XDG_RUNTIME_DIR/mxs.sock, else /tmp/mxs-<uid>.sock.
+    auto default_socket_path() -> std::string;
+
+    // Returns a connected socket, or -1 when no server is listening.
+    auto connect_server(const std::string &path) -> int;
+    auto send_request(int socket, const Request &request) -> bool;
+    // Rejects headers with a bad magic, an unknown command or sizes above the
+    // RequestHeader limits. On success the caller owns request.fds.
+    auto receive_request(int socket, Request &request) -> bool;
+    auto send_status(int socket, std::int32_t status) -> bool;
+    auto receive_status(int socket, std::int32_t &status) -> bool;
+
+    // Binds a Unix stream socket at `path` (replacing a stale one) that only
+    // the current user may connect to; returns the listening fd or -1.
+    auto listen_socket(const std::string &path) -> int;
+
+    // Serves requests on `path` until a SHUTDOWN request; returns the exit code.
+    auto serve(const std::string &path, shell::MXShell &shell) -> int;
+
+    // Run statistics for bench/run_corpus.py. Take allocation_count() before
+    // run_program(); write_run_stats() then overwrites $MXS_STATS_FILE (when
+    // set) with a JSON object holding the compile time, the objects allocated
+    // since that reading and the objects still alive.
+    auto allocation_count() -> std::uint64_t;
+    auto write_run_stats(const shell::MXShell &shell, std::uint64_t allocations_before)
+            -> void;
+
+    // Exports core::MXMetricsRegistry in the Prometheus text format:
+    //   MXS_METRICS_SOCKET=path  answer each connection on this Unix socket
+    //                            with the current metrics (as an HTTP response
+    //                            when the request is a GET, so
+    //                            `curl --unix-socket path http://mxs/metrics`
+    //                            works);
+    //   MXS_METRICS_FILE=path    rewrite this file every MXS_METRICS_INTERVAL
+    //                            seconds (default 10) and at exit, e.g. for
+    //                            node_exporter's textfile collector.
+    // start_metrics_export() starts background threads for whichever is set;
+    // dump_metrics() writes the file once more before the process exits.
+    auto start_metrics_export() -> void;
+    auto dump_metrics() -> void;
+}
+
 #endif//DRIVER_H
@@ -1,7 +1,10 @@
 #pragma once
 #include "ast.h"
 #include "grammer.hpp"
+#include <charconv>
+#include <string>
 #include <tao/pegtl.hpp>
+#include <vector>
 
 namespace mxs::frontend::actions {
     namespace pegtl = tao::pegtl;
@@ -10,31 +13,602 @@ namespace mxs::frontend::actions {
     using NodePtr = std::unique_ptr<mxs::frontend::ast::MXASTNode>;
     struct AstBuilderState {
         std::vector<NodePtr> node_stack;
+        // 二元运算符在 *_op 匹配时入栈，由对应的 *_tail 取走
+        std::vector<std::string> operators;
+        // 每个正在匹配的规则开始时两个栈的高度，见 control
+        struct Mark {
+            std::size_t nodes;
+            std::size_t operators;
+            backend::codegen::SourceLocation start;
+        };
+        std::vector<Mark> marks;
 
         // 你可以在这里添加其他状态，例如符号表、作用域栈等
         // ScopeManager scope_manager;
     };
 
+    // Parse with `pegtl::parse<Rule, action, control>`. A rule that fails after
+    // some of its children matched drops the nodes and operators they pushed,
+    // so backtracking into another alternative starts from a clean stack.
+    // PEGTL calls apply() before success(), so inside an action marks.back() is
+    // the stack height at the start of that action's own rule. A node gets the
+    // start position of the innermost rule that was matching when it was built.
+    template<typename Rule>
+    struct control : pegtl::normal<Rule> {
+        template<typename ParseInput>
+        static void start(const ParseInput &in, AstBuilderState &state) {
+            const auto &at = in.iterator();
+            state.marks.push_back({ state.node_stack.size(), state.operators.size(),
+                                    { static_cast<std::uint32_t>(at.line),
+                                      static_cast<std::uint32_t>(at.column) } });
+        }
+        template<typename ParseInput>
+        static void success(const ParseInput &, AstBuilderState &state) {
+            const auto mark = state.marks.back();
+            state.marks.pop_back();
+            // 内层规则先成功，已经标过位置的节点保持不变
+            for (std::size_t i = mark.nodes; i < state.node_stack.size(); ++i) {
+                auto &location = state.node_stack[i]->location;
+                if (location.line == 0) location = mark.start;
+            }
+        }
+        template<typename ParseInput>
+        static void failure(const ParseInput &, AstBuilderState &state) {
+            const auto mark = state.marks.back();
+            state.marks.pop_back();
+            state.node_stack.erase(state.node_stack.begin() + mark.nodes,
+                                   state.node_stack.end());
+            state.operators.erase(state.operators.begin() + mark.operators,
+                                  state.operators.end());
+        }
+    };
+
+    // 把节点转换为期望的 AST 类型；类型不符时返回 nullptr 且节点被丢弃
+    template<typename T>
+    auto cast_node(NodePtr node) -> std::unique_ptr<T> {
+        auto *typed = dynamic_cast<T *>(node.get());
+        if (!typed) return nullptr;
+        node.release();
+        return std::unique_ptr<T>(typed);
+    }
+
+    // 弹出栈顶节点并转换为期望的 AST 类型
+    template<typename T>
+    auto pop_node(AstBuilderState &state) -> std::unique_ptr<T> {
+        NodePtr node = std::move(state.node_stack.back());
+        state.node_stack.pop_back();
+        return cast_node<T>(std::move(node));
+    }
+
+    // 取走从 `from` 起压入的全部节点，保持压入的顺序
+    inline auto take_nodes(AstBuilderState &state, std::size_t from)
+            -> std::vector<NodePtr> {
+        const auto first = state.node_stack.begin() + static_cast<std::ptrdiff_t>(from);
+        std::vector<NodePtr> nodes(std::make_move_iterator(first),
+                                   std::make_move_iterator(state.node_stack.end()));
+        state.node_stack.erase(first, state.node_stack.end());
+        return nodes;
+    }
+
+    // 把从 `from` 起压入的节点替换成一个 OpaqueExpression
+    template<typename ActionInput>
+    auto collapse(const ActionInput &in, AstBuilderState &state, std::size_t from)
+            -> void {
+        state.node_stack.erase(state.node_stack.begin() + from, state.node_stack.end());
+        state.node_stack.push_back(
+                std::make_unique<ast::OpaqueExpression>(in.string(), false));
+    }
+
     template<typename Rule>
     struct action : pegtl::nothing<Rule> { };
+
+    // ---------------- 字面量 ----------------
     template<>
     struct action<grammar::integer_literal> {
         template<typename ActionInput>
         static void apply(const ActionInput &in, AstBuilderState &state) {
-            // --- 步骤 1: 从输入中提取数据 ---
-            // in.string() 返回匹配到的文本，例如 "123"
-            const int64_t val = std::stoll(in.string());
+            const auto text = in.string_view();
+            int64_t value = 0;
+            const auto [end, ec] =
+                    std::from_chars(text.data(), text.data() + text.size(), value);
+            if (ec != std::errc{} || end != text.data() + text.size())
+                throw pegtl::parse_error("integer literal out of range", in);
+            state.node_stack.push_back(
+                    std::make_unique<ast::IntegerLiteral>(value, false));
+        }
+    };
+
+    template<>
+    struct action<grammar::float_literal> {
+        template<typename ActionInput>
+        static void apply(const ActionInput &in, AstBuilderState &state) {
+            const auto text = in.string_view();
+            double value = 0;
+            std::from_chars(text.data(), text.data() + text.size(), value);
+            state.node_stack.push_back(std::make_unique<ast::FloatLiteral>(value, false));
+        }
+    };
+
+    template<>
+    struct action<grammar::string_literal> {
+        template<typename ActionInput>
+        static void apply(const ActionInput &in, AstBuilderState &state) {
+            // 去掉两端引号并处理转义；未知转义保留被转义的字符本身
+            const auto text = in.string_view().substr(1, in.size() - 2);
+            std::string value;
+            value.reserve(text.size());
+            for (std::size_t i = 0; i < text.size(); ++i) {
+                if (text[i] != '\\' || i + 1 == text.size()) {
+                    value += text[i];
+                    continue;
+                }
+                switch (const char c = text[++i]) {
+                    case 'n': value += '\n'; break;
+                    case 't': value += '\t'; break;
+                    case 'r': value += '\r'; break;
+                    case '0': value += '\0'; break;
+                    default: value += c; break;
+                }
+            }
+            state.node_stack.push_back(
+                    std::make_unique<ast::StringLiteral>(std::move(value), false));
+        }
+    };
+
+    template<>
+    struct action<grammar::bool_literal> {
+        template<typename ActionInput>
+        static void apply(const ActionInput &in, AstBuilderState &state) {
+            const bool value = in.string_view() == "true";
+            state.node_stack.push_back(
+                    std::make_unique<ast::BooleanLiteral>(value, false));
+        }
+    };
+
+    template<>
+    struct action<grammar::nil_literal> {
+        template<typename ActionInput>
+        static void apply(const ActionInput &, AstBuilderState &state) {
+            state.node_stack.push_back(std::make_unique<ast::NilLiteral>(false));
+        }
+    };
+
+    template<>
+    struct action<grammar::name_ref> {
+        template<typename ActionInput>
+        static void apply(const ActionInput &in, AstBuilderState &state) {
+            state.node_stack.push_back(
+                    std::make_unique<ast::Identifier>(in.string(), false));
+        }
+    };
+
+    // ---------------- 尚未建树的表达式 ----------------
+    // 这些规则匹配到的整段表达式折叠成一个 OpaqueExpression，保证每个表达式规则
+    // 恰好留下一个节点
+    struct opaque_action {
+        template<typename ActionInput>
+        static void apply(const ActionInput &in, AstBuilderState &state) {
+            collapse(in, state, state.marks.back().nodes);
+        }
+    };
+    template<>
+    struct action<grammar::block_expr> : opaque_action { };
+    template<>
+    struct action<grammar::match_expr> : opaque_action { };
+    template<>
+    struct action<grammar::raise_expr> : opaque_action { };
+    template<>
+    struct action<grammar::keyword_argument> : opaque_action { };
+
+    // tail 左边的操作数在 tail 开始之前压入，位于 marks.back().nodes - 1
+    struct opaque_tail_action {
+        template<typename ActionInput>
+        static void apply(const ActionInput &in, AstBuilderState &state) {
+            collapse(in, state, state.marks.back().nodes - 1);
+        }
+    };
+    template<>
+    struct action<grammar::postfix_tail> : opaque_tail_action { };
+    template<>
+    struct action<grammar::range_tail> : opaque_tail_action { };
+
+    // 赋值的左边只能是名字；成员和下标赋值还没有建树
+    template<>
+    struct action<grammar::assign_tail> {
+        template<typename ActionInput>
+        static void apply(const ActionInput &in, AstBuilderState &state) {
+            std::string op = std::move(state.operators.back());
+            state.operators.pop_back();
+            const auto target = state.marks.back().nodes - 1;
+            auto *name = dynamic_cast<ast::Identifier *>(state.node_stack[target].get());
+            if (!name) return collapse(in, state, target);
+            auto value = pop_node<ast::Expression>(state);
+            auto assigned = pop_node<ast::Identifier>(state);
+            state.node_stack.push_back(std::make_unique<ast::Assignment>(
+                    std::move(assigned->name), std::move(op), std::move(value), false));
+        }
+    };
+
+    // ---------------- 运算符 ----------------
+    template<>
+    struct action<grammar::prefix_expr> {
+        template<typename ActionInput>
+        static void apply(const ActionInput &in, AstBuilderState &state) {
+            auto operand = pop_node<ast::Expression>(state);
+            state.node_stack.push_back(std::make_unique<ast::UnaryOp>(
+                    std::string(1, in.peek_char()), std::move(operand), false));
+        }
+    };
+
+    struct operator_action {
+        template<typename ActionInput>
+        static void apply(const ActionInput &in, AstBuilderState &state) {
+            state.operators.push_back(in.string());
+        }
+    };
+    template<>
+    struct action<grammar::multiplicative_op> : operator_action { };
+    template<>
+    struct action<grammar::additive_op> : operator_action { };
+    template<>
+    struct action<grammar::relational_op> : operator_action { };
+    template<>
+    struct action<grammar::equality_op> : operator_action { };
+    template<>
+    struct action<grammar::logic_and_op> : operator_action { };
+    template<>
+    struct action<grammar::logic_or_op> : operator_action { };
+    template<>
+    struct action<grammar::assign_op> : operator_action { };
+
+    struct binary_action {
+        template<typename ActionInput>
+        static void apply(const ActionInput &, AstBuilderState &state) {
+            auto right = pop_node<ast::Expression>(state);
+            auto left = pop_node<ast::Expression>(state);
+            std::string op = std::move(state.operators.back());
+            state.operators.pop_back();
+            state.node_stack.push_back(std::make_unique<ast::BinaryOp>(
+                    std::move(left), std::move(op), std::move(right), false));
+        }
+    };
+    template<>
+    struct action<grammar::multiplicative_tail> : binary_action { };
+    template<>
+    struct action<grammar::additive_tail> : binary_action { };
+    template<>
+    struct action<grammar::relational_tail> : binary_action { };
+    template<>
+    struct action<grammar::equality_tail> : binary_action { };
+    template<>
+    struct action<grammar::logic_and_tail> : binary_action { };
+    template<>
+    struct action<grammar::logic_or_tail> : binary_action { };
+
+    template<>
+    struct action<grammar::await_expr> {
+        template<typename ActionInput>
+        static void apply(const ActionInput &, AstBuilderState &state) {
+            // 操作数 (postfix_expr) 已经在栈顶
+            auto operand = pop_node<ast::Expression>(state);
+            state.node_stack.push_back(
+                    std::make_unique<ast::AwaitExpression>(std::move(operand), false));
+        }
+    };
+
+    // ---------------- 调用和 lambda ----------------
+    // 声明出的名字和类型先作为 Declarator 入栈，由外层规则取走
+    template<>
+    struct action<grammar::declared_name> {
+        template<typename ActionInput>
+        static void apply(const ActionInput &in, AstBuilderState &state) {
+            state.node_stack.push_back(
+                    std::make_unique<ast::Declarator>(in.string(), false));
+        }
+    };
+
+    struct type_name_action {
+        template<typename ActionInput>
+        static void apply(const ActionInput &in, AstBuilderState &state) {
+            auto type = std::make_unique<ast::Declarator>(std::string{}, false);
+            type->typeName = in.string();
+            state.node_stack.push_back(std::move(type));
+        }
+    };
+    template<>
+    struct action<grammar::param_type> : type_name_action { };
+    template<>
+    struct action<grammar::type_arg> : type_name_action { };
+
+    // `a, b: T` 留下两个带类型的 Declarator
+    template<>
+    struct action<grammar::param> {
+        template<typename ActionInput>
+        static void apply(const ActionInput &in, AstBuilderState &state) {
+            auto nodes = take_nodes(state, state.marks.back().nodes);
+            std::vector<std::unique_ptr<ast::Declarator>> names;
+            std::string type;
+            for (auto &node : nodes) {
+                auto declarator = cast_node<ast::Declarator>(std::move(node));
+                if (!declarator)
+                    throw pegtl::parse_error("default parameter values are not supported yet",
+                                             in);
+                if (declarator->name.empty()) {
+                    type = std::move(declarator->typeName);
+                } else {
+                    names.push_back(std::move(declarator));
+                }
+            }
+            for (auto &name : names) {
+                name->typeName = type;
+                state.node_stack.push_back(std::move(name));
+            }
+        }
+    };
+
+    template<>
+    struct action<grammar::call_expr> {
+        template<typename ActionInput>
+        static void apply(const ActionInput &, AstBuilderState &state) {
+            // 依次是被调用的名字、显式类型实参和实参
+            auto nodes = take_nodes(state, state.marks.back().nodes);
+            auto callee = cast_node<ast::Identifier>(std::move(nodes.front()));
+            auto call = std::make_unique<ast::FunctionCall>(std::move(callee->name), false);
+            for (auto &node : llvm::drop_begin(nodes)) {
+                if (auto *type = dynamic_cast<ast::Declarator *>(node.get())) {
+                    call->typeArgs.push_back(type->typeName);
+                } else {
+                    call->args.push_back(cast_node<ast::Expression>(std::move(node)));
+                }
+            }
+            state.node_stack.push_back(std::move(call));
+        }
+    };
+
+    template<>
+    struct action<grammar::lambda_expr> {
+        template<typename ActionInput>
+        static void apply(const ActionInput &, AstBuilderState &state) {
+            auto nodes = take_nodes(state, state.marks.back().nodes);
+            auto lambda = std::make_unique<ast::LambdaExpression>(false);
+            auto body = std::move(nodes.back());
+            nodes.pop_back();
+            for (auto &node : nodes)
+                lambda->params.push_back(cast_node<ast::Declarator>(std::move(node))->name);
+            if (dynamic_cast<ast::Block *>(body.get())) {
+                lambda->body = cast_node<ast::Block>(std::move(body));
+            } else {
+                lambda->result = cast_node<ast::Expression>(std::move(body));
+            }
+            state.node_stack.push_back(std::move(lambda));
+        }
+    };
+
+    // ---------------- 语句 ----------------
+    // 每条语句恰好留下一个 Statement 节点
+    template<>
+    struct action<grammar::block> {
+        template<typename ActionInput>
+        static void apply(const ActionInput &, AstBuilderState &state) {
+            auto nodes = take_nodes(state, state.marks.back().nodes);
+            auto block = std::make_unique<ast::Block>(false);
+            for (auto &node : nodes)
+                block->statements.push_back(cast_node<ast::Statement>(std::move(node)));
+            state.node_stack.push_back(std::move(block));
+        }
+    };
+
+    template<>
+    struct action<grammar::let_stmt> {
+        template<typename ActionInput>
+        static void apply(const ActionInput &in, AstBuilderState &state) {
+            auto nodes = take_nodes(state, state.marks.back().nodes);
+            auto let = std::make_unique<ast::LetStatement>(false);
+            // 直接用文法判断 let 后面是不是 mut
+            const auto rest = in.string_view().substr(3);
+            pegtl::memory_input after_let(rest.data(), rest.size(), "");
+            let->isMut = pegtl::parse<pegtl::seq<grammar::ignored, grammar::K_MUT>>(
+                    after_let);
+            for (auto &node : nodes) {
+                if (auto *name = dynamic_cast<ast::Declarator *>(node.get())) {
+                    let->names.push_back(std::move(name->name));
+                } else {
+                    let->value = cast_node<ast::Expression>(std::move(node));
+                }
+            }
+            state.node_stack.push_back(std::move(let));
+        }
+    };
+
+    template<>
+    struct action<grammar::expression_stmt> {
+        template<typename ActionInput>
+        static void apply(const ActionInput &, AstBuilderState &state) {
+            auto expr = pop_node<ast::Expression>(state);
+            state.node_stack.push_back(
+                    std::make_unique<ast::ExprStatement>(std::move(expr), false));
+        }
+    };
+
+    template<>
+    struct action<grammar::if_stmt> {
+        template<typename ActionInput>
+        static void apply(const ActionInput &, AstBuilderState &state) {
+            auto nodes = take_nodes(state, state.marks.back().nodes);
+            auto statement = std::make_unique<ast::IfStatement>(false);
+            statement->condition = cast_node<ast::Expression>(std::move(nodes[0]));
+            statement->thenBlock = cast_node<ast::Block>(std::move(nodes[1]));
+            if (nodes.size() > 2) {
+                if (dynamic_cast<ast::Block *>(nodes[2].get())) {
+                    statement->elseBlock = cast_node<ast::Block>(std::move(nodes[2]));
+                } else {
+                    statement->elseBlock = std::make_unique<ast::Block>(false);
+                    statement->elseBlock->statements.push_back(
+                            cast_node<ast::Statement>(std::move(nodes[2])));
+                }
+            }
+            state.node_stack.push_back(std::move(statement));
+        }
+    };
+
+    template<>
+    struct action<grammar::loop_stmt> {
+        template<typename ActionInput>
+        static void apply(const ActionInput &, AstBuilderState &state) {
+            auto loop = std::make_unique<ast::LoopStatement>(false);
+            loop->body = pop_node<ast::Block>(state);
+            state.node_stack.push_back(std::move(loop));
+        }
+    };
+
+    template<>
+    struct action<grammar::until_stmt> {
+        template<typename ActionInput>
+        static void apply(const ActionInput &, AstBuilderState &state) {
+            auto loop = std::make_unique<ast::LoopStatement>(false);
+            loop->body = pop_node<ast::Block>(state);
+            loop->until = pop_node<ast::Expression>(state);
+            state.node_stack.push_back(std::move(loop));
+        }
+    };
+
+    template<>
+    struct action<grammar::do_until_stmt> {
+        template<typename ActionInput>
+        static void apply(const ActionInput &, AstBuilderState &state) {
+            auto loop = std::make_unique<ast::LoopStatement>(false);
+            loop->until = pop_node<ast::Expression>(state);
+            loop->body = pop_node<ast::Block>(state);
+            loop->untilAfterBody = true;
+            state.node_stack.push_back(std::move(loop));
+        }
+    };
+
+    template<>
+    struct action<grammar::break_stmt> {
+        template<typename ActionInput>
+        static void apply(const ActionInput &, AstBuilderState &state) {
+            state.node_stack.push_back(std::make_unique<ast::BreakStatement>(false));
+        }
+    };
+
+    template<>
+    struct action<grammar::continue_stmt> {
+        template<typename ActionInput>
+        static void apply(const ActionInput &, AstBuilderState &state) {
+            state.node_stack.push_back(std::make_unique<ast::ContinueStatement>(false));
+        }
+    };
+
+    template<>
+    struct action<grammar::return_stmt> {
+        template<typename ActionInput>
+        static void apply(const ActionInput &, AstBuilderState &state) {
+            std::unique_ptr<ast::Expression> value;
+            if (state.node_stack.size() > state.marks.back().nodes)
+                value = pop_node<ast::Expression>(state);
+            state.node_stack.push_back(
+                    std::make_unique<ast::ReturnStatement>(std::move(value), false));
+        }
+    };
+
+    template<>
+    struct action<grammar::assert_stmt> {
+        template<typename ActionInput>
+        static void apply(const ActionInput &, AstBuilderState &state) {
+            auto condition = pop_node<ast::Expression>(state);
+            state.node_stack.push_back(
+                    std::make_unique<ast::AssertStatement>(std::move(condition), false));
+        }
+    };
+
+    template<>
+    struct action<grammar::defer_stmt> {
+        template<typename ActionInput>
+        static void apply(const ActionInput &, AstBuilderState &state) {
+            auto body = pop_node<ast::Block>(state);
+            state.node_stack.push_back(
+                    std::make_unique<ast::DeferStatement>(std::move(body), false));
+        }
+    };
+
+    // for-in 还没有建树：执行到它时所在函数返回 NotImplementedError，
+    // 而不是悄悄跳过整个循环
+    template<>
+    struct action<grammar::for_in_stmt> {
+        template<typename ActionInput>
+        static void apply(const ActionInput &in, AstBuilderState &state) {
+            collapse(in, state, state.marks.back().nodes);
+            auto error = pop_node<ast::Expression>(state);
+            state.node_stack.push_back(
+                    std::make_unique<ast::ReturnStatement>(std::move(error), false));
+        }
+    };
 
-            // --- 步骤 2: 创建你的 AST 节点 ---
-            // 这里我们调用 IntegerLiteral 的构造函数来创建一个实例。
-            // 注意：你需要确保你的 IntegerLiteral 类有一个接收 int64_t 的构造函数。
-            // 例如:
-            // explicit IntegerLiteral(int64_t v) : value(v) {}
-            auto node = std::make_unique<ast::IntegerLiteral>(val);
+    // ---------------- 函数 ----------------
+    template<>
+    struct action<grammar::func_def> {
+        template<typename ActionInput>
+        static void apply(const ActionInput &in, AstBuilderState &state) {
+            // 函数名、泛型参数（没有类型）、形参（带类型），最后是函数体
+            auto nodes = take_nodes(state, state.marks.back().nodes);
+            auto body = cast_node<ast::Block>(std::move(nodes.back()));
+            nodes.pop_back();
+            auto name = cast_node<ast::Declarator>(std::move(nodes.front()));
+            const bool is_async = in.string_view().starts_with("async");
+            auto function = std::make_unique<ast::FunctionDefinition>(
+                    std::move(name->name), is_async, false);
+            for (auto &node : llvm::drop_begin(nodes)) {
+                auto declarator = cast_node<ast::Declarator>(std::move(node));
+                if (declarator->typeName.empty()) {
+                    function->genericParams.push_back(std::move(declarator->name));
+                    continue;
+                }
+                function->params.push_back(std::move(declarator->name));
+                function->paramTypes.push_back(std::move(declarator->typeName));
+            }
+            function->body = std::move(body);
+            state.node_stack.push_back(std::move(function));
+        }
+    };
 
-            // --- 步骤 3: 将新节点压入状态栈 ---
-            // 这个节点现在位于栈顶，等待被它的父节点（例如一个二元表达式）使用。
-            state.node_stack.push_back(std::move(node));
+    // 还不生成代码的声明（类、接口、类型、枚举）和注解：丢掉其中建出的节点
+    struct discard_action {
+        template<typename ActionInput>
+        static void apply(const ActionInput &, AstBuilderState &state) {
+            take_nodes(state, state.marks.back().nodes);
+        }
+    };
+    template<>
+    struct action<grammar::class_def> : discard_action { };
+    template<>
+    struct action<grammar::interface_def> : discard_action { };
+    template<>
+    struct action<grammar::type_def> : discard_action { };
+    template<>
+    struct action<grammar::enum_def> : discard_action { };
+    template<>
+    struct action<grammar::annotation> : discard_action { };
+
+    // ---------------- 顶层绑定 ----------------
+    template<>
+    struct action<grammar::binding_name> {
+        template<typename ActionInput>
+        static void apply(const ActionInput &in, AstBuilderState &state) {
+            state.node_stack.push_back(
+                    std::make_unique<ast::Identifier>(in.string(), false));
+        }
+    };
+
+    template<>
+    struct action<grammar::binding_stmt> {
+        template<typename ActionInput>
+        static void apply(const ActionInput &in, AstBuilderState &state) {
+            auto value = pop_node<ast::Expression>(state);
+            auto name = pop_node<ast::Identifier>(state);
+            const bool is_static = in.string_view().starts_with("static");
+            state.node_stack.push_back(std::make_unique<ast::BindingStatement>(
+                    std::move(name->name), std::move(value), is_static, false));
         }
     };
 }
\ No newline at end of file
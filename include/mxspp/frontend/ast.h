@@ -1,6 +1,8 @@
 #pragma once
 #include "mxspp/backend/codegen.h"
 #include "mxspp/core/MXObject.h"
+#include <optional>
+#include <span>
 
 namespace mxs::frontend {
     namespace ast {
@@ -12,6 +14,8 @@ namespace mxs::frontend {
         public:
             virtual ~MXASTNode() = default;
             MXASTNode(bool is_static) : core::MXObject(is_static) { }
+            // Where the node's rule started matching; set by actions::control.
+            backend::codegen::SourceLocation location;
         };
 
         // ============================
@@ -22,10 +26,18 @@ namespace mxs::frontend {
             virtual void codegen(mxs::backend::codegen::CodegenContext &ctx) const = 0;
         };
 
+        using backend::codegen::ConstantTable;
+        using backend::codegen::ConstantValue;
+
         class Expression : public virtual MXASTNode {
         public:
             virtual llvm::Value *
             codegen(mxs::backend::codegen::CodegenContext &ctx) const = 0;
+            // Compile-time value when the expression is pure and every name it
+            // reads is a folded `static let` in `constants`; std::nullopt
+            // otherwise (the default), and also when evaluating would raise.
+            virtual auto evaluate(const ConstantTable &constants) const
+                    -> std::optional<ConstantValue>;
         };
 
         // ============================
@@ -40,8 +52,11 @@ namespace mxs::frontend {
         // ============================
         // Block of Statements
         // ============================
+        // Names bound inside a block, and the static lets they shadow, go out of
+        // scope when it ends.
         class Block : public virtual Statement {
         public:
+            explicit Block(bool is_static);
             std::vector<std::unique_ptr<Statement>> statements;
             void codegen(mxs::backend::codegen::CodegenContext &ctx) const override;
         };
@@ -49,24 +64,53 @@ namespace mxs::frontend {
         // ============================
         // Statement Nodes
         // ============================
+        // `let` binds each name to the value. A `let mut` variable lives in a
+        // stack slot holding a boxed value, so it takes any value; the slot
+        // keeps an unboxed int or float only when the initial value and every
+        // assignment to the variable in its scope are provably that kind.
         class LetStatement : public virtual Statement {
         public:
+            explicit LetStatement(bool is_static);
             std::vector<std::string> names;
             std::unique_ptr<Expression> value;
             std::optional<std::string> typeName;
             bool isMut = false;
 
+            // Binds the names; `scope` is the statements after this one in its
+            // block, where the uses of a `let mut` variable are looked up.
+            // codegen() does not know its scope and binds with std::nullopt,
+            // which keeps every `let mut` variable in a heap cell.
+            void bind(mxs::backend::codegen::CodegenContext &ctx,
+                      std::optional<std::span<const std::unique_ptr<Statement>>> scope)
+                    const;
+            void codegen(mxs::backend::codegen::CodegenContext &ctx) const override;
+        };
+
+        // Top-level `static let` / `dynamic let`. A static binding whose value
+        // folds is emitted as constant data and inlined into every use; any
+        // other binding is evaluated at run time into a module global.
+        class BindingStatement : public virtual Statement {
+        public:
+            BindingStatement(std::string name, std::unique_ptr<Expression> value,
+                             bool is_static_binding, bool is_static);
+            std::string name;
+            std::unique_ptr<Expression> value;
+            bool isStatic = false;
+
             void codegen(mxs::backend::codegen::CodegenContext &ctx) const override;
         };
 
         class ExprStatement : public virtual Statement {
         public:
+            ExprStatement(std::unique_ptr<Expression> expr, bool is_static);
             std::unique_ptr<Expression> expr;
             void codegen(mxs::backend::codegen::CodegenContext &ctx) const override;
         };
 
+        // `else if` is an else block holding the inner if.
         class IfStatement : public virtual Statement {
         public:
+            explicit IfStatement(bool is_static);
             std::unique_ptr<Expression> condition;
             std::unique_ptr<Block> thenBlock;
             std::unique_ptr<Block> elseBlock;
@@ -76,6 +120,7 @@ namespace mxs::frontend {
 
         class ReturnStatement : public virtual Statement {
         public:
+            ReturnStatement(std::unique_ptr<Expression> value, bool is_static);
             std::unique_ptr<Expression> value;
             void codegen(mxs::backend::codegen::CodegenContext &ctx) const override;
         };
@@ -90,19 +135,89 @@ namespace mxs::frontend {
             void codegen(mxs::backend::codegen::CodegenContext &ctx) const override;
         };
 
+        // `loop`, `until (c)` and `do ... until (c);`. With a condition the
+        // loop ends once it is truthy, checked before each iteration or, for
+        // do-until, after it.
         class LoopStatement : public virtual Statement {
         public:
+            explicit LoopStatement(bool is_static);
             std::unique_ptr<Block> body;
+            std::unique_ptr<Expression> until;
+            bool untilAfterBody = false;
             void codegen(mxs::backend::codegen::CodegenContext &ctx) const override;
         };
 
+        class FunctionDefinition : public virtual Statement {
+        public:
+            FunctionDefinition(std::string name, bool is_async, bool is_static);
+            std::string name;
+            std::vector<std::string> params;
+            // Declared type of each parameter, parallel to params; empty when
+            // the parameter has no annotation.
+            std::vector<std::string> paramTypes;
+            // Names from `<T, U>`. A generic function emits nothing itself; each
+            // call site instantiates it (see declare()).
+            std::vector<std::string> genericParams;
+            std::unique_ptr<Block> body;
+            bool isAsync = false;
+
+            // Makes the function callable from any body in the module, including
+            // ones generated before this definition: records its arity in
+            // ctx.functions, or its instantiator in ctx.generics.
+            void declare(mxs::backend::codegen::CodegenContext &ctx) const;
+            void codegen(mxs::backend::codegen::CodegenContext &ctx) const override;
+
+        private:
+            // Creates the entry block, names the arguments and starts the debug
+            // scope; returns the arguments.
+            auto begin_function(mxs::backend::codegen::CodegenContext &ctx,
+                                llvm::Function *fn) const -> std::vector<llvm::Value *>;
+            // Emits the body with the parameters bound to `values`, plus the
+            // implicit `return nil`.
+            void emit_body(mxs::backend::codegen::CodegenContext &ctx, llvm::Function *fn,
+                           llvm::ArrayRef<llvm::Value *> values) const;
+            // The instance for `type_args` (one per generic parameter, ptr for
+            // a boxed type), created in ctx.module on first use.
+            auto instantiate(mxs::backend::codegen::CodegenContext &ctx,
+                             const std::vector<llvm::Type *> &type_args) const
+                    -> llvm::Function *;
+            // Emits the OSR continuation of each top-level loop in `loops`
+            // (indices into body->statements) as emitted into `version`, the
+            // baseline or the speculated function, into ctx.osr_module.
+            void emit_osr_continuations(mxs::backend::codegen::CodegenContext &ctx,
+                                        const llvm::Function *version,
+                                        const std::vector<std::size_t> &loops) const;
+        };
+
         class BreakStatement : public virtual Statement {
         public:
+            explicit BreakStatement(bool is_static);
             void codegen(mxs::backend::codegen::CodegenContext &ctx) const override;
         };
 
         class ContinueStatement : public virtual Statement {
         public:
+            explicit ContinueStatement(bool is_static);
+            void codegen(mxs::backend::codegen::CodegenContext &ctx) const override;
+        };
+
+        // `assert condition;`. A false condition returns an AssertionError from
+        // the enclosing function, after its pending defers. Emits nothing with
+        // ctx.strip_asserts or when the condition folds to true.
+        class AssertStatement : public virtual Statement {
+        public:
+            AssertStatement(std::unique_ptr<Expression> condition, bool is_static);
+            std::unique_ptr<Expression> condition;
+            void codegen(mxs::backend::codegen::CodegenContext &ctx) const override;
+        };
+
+        // `defer { ... }`: runs the block when the enclosing block exits, after
+        // any defer registered later in it. The body is emitted on each exit
+        // edge rather than pushed onto a runtime stack.
+        class DeferStatement : public virtual Statement {
+        public:
+            DeferStatement(std::unique_ptr<Block> body, bool is_static);
+            std::unique_ptr<Block> body;
             void codegen(mxs::backend::codegen::CodegenContext &ctx) const override;
         };
 
@@ -111,9 +226,12 @@ namespace mxs::frontend {
         // ============================
         class Identifier : public virtual Expression {
         public:
+            Identifier(std::string name, bool is_static);
             std::string name;
             llvm::Value *
             codegen(mxs::backend::codegen::CodegenContext &ctx) const override;
+            auto evaluate(const ConstantTable &constants) const
+                    -> std::optional<ConstantValue> override;
         };
 
         class IntegerLiteral : public virtual Expression {
@@ -122,57 +240,150 @@ namespace mxs::frontend {
             int64_t value;
             llvm::Value *
             codegen(mxs::backend::codegen::CodegenContext &ctx) const override;
+            auto evaluate(const ConstantTable &constants) const
+                    -> std::optional<ConstantValue> override;
         };
 
         class FloatLiteral : public virtual Expression {
         public:
+            FloatLiteral(double value, bool is_static);
             double value;
             llvm::Value *
             codegen(mxs::backend::codegen::CodegenContext &ctx) const override;
+            auto evaluate(const ConstantTable &constants) const
+                    -> std::optional<ConstantValue> override;
         };
 
         class BooleanLiteral : public virtual Expression {
         public:
+            BooleanLiteral(bool value, bool is_static);
             bool value;
             llvm::Value *
             codegen(mxs::backend::codegen::CodegenContext &ctx) const override;
+            auto evaluate(const ConstantTable &constants) const
+                    -> std::optional<ConstantValue> override;
         };
 
         class StringLiteral : public virtual Expression {
         public:
+            StringLiteral(std::string value, bool is_static);
             std::string value;
             llvm::Value *
             codegen(mxs::backend::codegen::CodegenContext &ctx) const override;
+            auto evaluate(const ConstantTable &constants) const
+                    -> std::optional<ConstantValue> override;
+        };
+
+        class NilLiteral : public virtual Expression {
+        public:
+            explicit NilLiteral(bool is_static);
+            llvm::Value *
+            codegen(mxs::backend::codegen::CodegenContext &ctx) const override;
+            auto evaluate(const ConstantTable &constants) const
+                    -> std::optional<ConstantValue> override;
         };
 
         class BinaryOp : public virtual Expression {
         public:
+            BinaryOp(std::unique_ptr<Expression> left, std::string op,
+                     std::unique_ptr<Expression> right, bool is_static);
             std::unique_ptr<Expression> left;
             std::string op;
             std::unique_ptr<Expression> right;
 
             llvm::Value *
             codegen(mxs::backend::codegen::CodegenContext &ctx) const override;
+            auto evaluate(const ConstantTable &constants) const
+                    -> std::optional<ConstantValue> override;
         };
 
         class UnaryOp : public virtual Expression {
         public:
+            UnaryOp(std::string op, std::unique_ptr<Expression> operand, bool is_static);
+            std::string op;
+            std::unique_ptr<Expression> operand;
+
+            llvm::Value *
+            codegen(mxs::backend::codegen::CodegenContext &ctx) const override;
+            auto evaluate(const ConstantTable &constants) const
+                    -> std::optional<ConstantValue> override;
+        };
+
+        // An expression the frontend parses but does not build a tree for yet
+        // (member access, indexing, match, keyword arguments, ...). Never folds;
+        // evaluates to a NotImplementedError at run time.
+        class OpaqueExpression : public virtual Expression {
+        public:
+            OpaqueExpression(std::string source, bool is_static);
+            std::string source;
+
+            llvm::Value *
+            codegen(mxs::backend::codegen::CodegenContext &ctx) const override;
+        };
+
+        // `name = value` or a compound `name += value` on a `let mut` variable.
+        // Evaluates to the stored value, or to a TypeError that leaves the
+        // variable unchanged when it is immutable.
+        class Assignment : public virtual Expression {
+        public:
+            Assignment(std::string name, std::string op, std::unique_ptr<Expression> value,
+                       bool is_static);
+            std::string name;
             std::string op;
+            std::unique_ptr<Expression> value;
+
+            llvm::Value *
+            codegen(mxs::backend::codegen::CodegenContext &ctx) const override;
+        };
+
+        class AwaitExpression : public virtual Expression {
+        public:
+            AwaitExpression(std::unique_ptr<Expression> operand, bool is_static);
             std::unique_ptr<Expression> operand;
 
             llvm::Value *
             codegen(mxs::backend::codegen::CodegenContext &ctx) const override;
         };
 
+        // `(params) => expr` or `(params) => { ... }`. Evaluates to a closure
+        // whose environment holds the enclosing values the body reads; a `let mut`
+        // variable is held as its heap cell, so writes on either side are shared.
+        // Exactly one of result and body is set.
+        class LambdaExpression : public virtual Expression {
+        public:
+            LambdaExpression(bool is_static);
+            std::vector<std::string> params;
+            std::unique_ptr<Expression> result;
+            std::unique_ptr<Block> body;
+
+            llvm::Value *
+            codegen(mxs::backend::codegen::CodegenContext &ctx) const override;
+        };
+
+        // A call of a function defined in the same program, or of a closure
+        // held by a local name. Generic functions take explicit `<...>` type
+        // arguments or infer them from the arguments' compile-time types.
         class FunctionCall : public virtual Expression {
         public:
+            FunctionCall(std::string name, bool is_static);
             std::string name;
+            std::vector<std::string> typeArgs;
             std::vector<std::unique_ptr<Expression>> args;
 
             llvm::Value *
             codegen(mxs::backend::codegen::CodegenContext &ctx) const override;
         };
 
+        // A declared name, or with an empty name a type: only lives on the
+        // parser's stack until the enclosing signature, `let` or call takes it.
+        // typeName is the declared type of a parameter.
+        class Declarator : public virtual MXASTNode {
+        public:
+            Declarator(std::string name, bool is_static);
+            std::string name;
+            std::string typeName;
+        };
+
         class MatchStatment : public virtual Statement { };
 
     }// namespace mxs::ast
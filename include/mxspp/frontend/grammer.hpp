@@ -53,6 +53,8 @@ namespace mxs::frontend::grammar {
 
     struct K_AS : keyword<'a', 's'> { };
     struct K_ASSERT : keyword<'a', 's', 's', 'e', 'r', 't'> { };
+    struct K_ASYNC : keyword<'a', 's', 'y', 'n', 'c'> { };
+    struct K_AWAIT : keyword<'a', 'w', 'a', 'i', 't'> { };
     struct K_BREAK : keyword<'b', 'r', 'e', 'a', 'k'> { };
     struct K_CASE : keyword<'c', 'a', 's', 'e'> { };
     struct K_CLASS : keyword<'c', 'l', 'a', 's', 's'> { };
@@ -87,8 +89,11 @@ namespace mxs::frontend::grammar {
     // General Components
     // ===================================================================
     struct fqdn : pegtl::list<identifier, pegtl::one<'.'>> { };
+    // An identifier that introduces a name: a function, a generic or ordinary
+    // parameter, or a `let` variable.
+    struct declared_name : identifier { };
     struct identifier_list
-        : pegtl::list<identifier, pegtl::seq<ignored, pegtl::one<','>, ignored>> { };
+        : pegtl::list<declared_name, pegtl::seq<ignored, pegtl::one<','>, ignored>> { };
     struct generic_param : pegtl::seq<pegtl::one<'<'>, ignored, identifier_list, ignored,
                                       pegtl::one<'>'>> { };
     struct generic_inst
@@ -98,10 +103,11 @@ namespace mxs::frontend::grammar {
                   ignored, pegtl::one<'>'>> { };
 
     struct param;
+    struct param_type;
     struct param_list
         : pegtl::list<param, pegtl::seq<ignored, pegtl::one<','>, ignored>> { };
     struct param
-        : pegtl::seq<identifier_list, ignored, pegtl::one<':'>, ignored, type_spec,
+        : pegtl::seq<identifier_list, ignored, pegtl::one<':'>, ignored, param_type,
                      pegtl::opt<ignored, pegtl::one<'='>, ignored, expression>> { };
 
     struct func_type
@@ -115,6 +121,13 @@ namespace mxs::frontend::grammar {
         : pegtl::sor<pegtl::seq<fqdn, pegtl::opt<ignored, generic_inst>>, func_type> { };
     struct type_spec
         : pegtl::list<single_type, pegtl::seq<ignored, pegtl::one<'|'>, ignored>> { };
+    // The declared type of a parameter, and an explicit type argument of a call.
+    struct param_type : type_spec { };
+    struct type_arg : type_spec { };
+    struct type_args
+        : pegtl::seq<pegtl::one<'<'>, ignored,
+                     pegtl::list<type_arg, pegtl::seq<ignored, pegtl::one<','>, ignored>>,
+                     ignored, pegtl::one<'>'>> { };
 
     struct func_sig
         : pegtl::seq<pegtl::one<'('>, ignored, pegtl::opt<param_list>, ignored,
@@ -131,12 +144,20 @@ namespace mxs::frontend::grammar {
     struct raise_expr;
     struct lambda_expr;
 
+    // An identifier read as a value, as opposed to one that declares a name.
+    struct name_ref : identifier { };
+
+    // A call by name, `f(x)` or `f<int>(x)`. Calls of any other callee are
+    // postfix operators.
+    struct call_expr
+        : pegtl::seq<name_ref, pegtl::opt<ignored, type_args>, ignored, call_args> { };
+
     struct primary_expr
         : pegtl::sor<literal,
                      pegtl::seq<pegtl::one<'('>, ignored, expression, ignored,
                                 pegtl::one<')'>>,
-                     block_expr, match_expr, raise_expr, lambda_expr,
-                     identifier// Must be last to avoid greedily matching keywords
+                     block_expr, match_expr, raise_expr, lambda_expr, call_expr,
+                     name_ref// Must be last to avoid greedily matching keywords
                      > { };
 
     struct postfix_op
@@ -146,72 +167,75 @@ namespace mxs::frontend::grammar {
                      pegtl::seq<ignored, generic_inst>, pegtl::seq<ignored, call_args>,
                      pegtl::seq<ignored, pegtl::one<'?'>>> { };
 
-    struct postfix_expr : pegtl::seq<primary_expr, pegtl::star<postfix_op>> { };
+    struct postfix_tail : pegtl::plus<postfix_op> { };
+    struct postfix_expr : pegtl::seq<primary_expr, pegtl::opt<postfix_tail>> { };
 
     struct unary_op : pegtl::one<'!', '+', '-'> { };
-    struct unary_expr
-        : pegtl::sor<pegtl::seq<unary_op, ignored, postfix_expr>, postfix_expr> { };
+    struct await_expr : pegtl::seq<K_AWAIT, ignored, postfix_expr> { };
+    struct prefix_expr : pegtl::seq<unary_op, ignored, postfix_expr> { };
+    struct unary_expr : pegtl::sor<prefix_expr, await_expr, postfix_expr> { };
 
+    // Binary levels are `operand (op operand)*`; each matched tail combines the
+    // operand to its left with its own, which makes the operators left
+    // associative.
     struct multiplicative_op
         : pegtl::sor<pegtl::one<'*'>, pegtl::one<'/'>, pegtl::one<'%'>> { };
+    struct multiplicative_tail
+        : pegtl::seq<ignored, multiplicative_op, ignored, unary_expr> { };
     struct multiplicative_expr
-        : pegtl::list<unary_expr, pegtl::seq<ignored, multiplicative_op, ignored>,
-                      unary_expr> { };
+        : pegtl::seq<unary_expr, pegtl::star<multiplicative_tail>> { };
 
     struct additive_op : pegtl::sor<pegtl::one<'+'>, pegtl::one<'-'>> { };
+    struct additive_tail
+        : pegtl::seq<ignored, additive_op, ignored, multiplicative_expr> { };
     struct additive_expr
-        : pegtl::list<multiplicative_expr, pegtl::seq<ignored, additive_op, ignored>,
-                      multiplicative_expr> { };
+        : pegtl::seq<multiplicative_expr, pegtl::star<additive_tail>> { };
 
     struct range_op : pegtl::string<'.', '.'> { };
-    struct range_expr : pegtl::list<additive_expr, pegtl::seq<ignored, range_op, ignored>,
-                                    additive_expr> { };
+    struct range_tail : pegtl::seq<ignored, range_op, ignored, additive_expr> { };
+    struct range_expr : pegtl::seq<additive_expr, pegtl::star<range_tail>> { };
 
     struct relational_op : pegtl::sor<pegtl::string<'<', '='>, pegtl::string<'>', '='>,
                                       pegtl::one<'<'>, pegtl::one<'>'>> { };
-    struct relational_expr
-        : pegtl::list<range_expr, pegtl::seq<ignored, relational_op, ignored>,
-                      range_expr> { };
+    struct relational_tail : pegtl::seq<ignored, relational_op, ignored, range_expr> { };
+    struct relational_expr : pegtl::seq<range_expr, pegtl::star<relational_tail>> { };
 
     struct equality_op : pegtl::sor<pegtl::string<'=', '='>, pegtl::string<'!', '='>> { };
-    struct equality_expr
-        : pegtl::list<relational_expr, pegtl::seq<ignored, equality_op, ignored>,
-                      relational_expr> { };
+    struct equality_tail
+        : pegtl::seq<ignored, equality_op, ignored, relational_expr> { };
+    struct equality_expr : pegtl::seq<relational_expr, pegtl::star<equality_tail>> { };
 
     struct logic_and_op : pegtl::string<'&', '&'> { };
-    struct logic_and_expr
-        : pegtl::list<equality_expr, pegtl::seq<ignored, logic_and_op, ignored>,
-                      equality_expr> { };
+    struct logic_and_tail : pegtl::seq<ignored, logic_and_op, ignored, equality_expr> { };
+    struct logic_and_expr : pegtl::seq<equality_expr, pegtl::star<logic_and_tail>> { };
 
     struct logic_or_op : pegtl::string<'|', '|'> { };
-    struct logic_or_expr
-        : pegtl::list<logic_and_expr, pegtl::seq<ignored, logic_or_op, ignored>,
-                      logic_and_expr> { };
+    struct logic_or_tail : pegtl::seq<ignored, logic_or_op, ignored, logic_and_expr> { };
+    struct logic_or_expr : pegtl::seq<logic_and_expr, pegtl::star<logic_or_tail>> { };
 
     // Right-associative assignment
     struct assign_op
         : pegtl::sor<pegtl::string<'+', '='>, pegtl::string<'-', '='>,
                      pegtl::string<'*', '='>, pegtl::string<'/', '='>, pegtl::one<'='>> {
     };
-    struct assign_expr
-        : pegtl::seq<logic_or_expr, pegtl::opt<ignored, assign_op, ignored, expression>> {
-    };
+    struct assign_tail : pegtl::seq<ignored, assign_op, ignored, expression> { };
+    struct assign_expr : pegtl::seq<logic_or_expr, pegtl::opt<assign_tail>> { };
 
     struct expression : assign_expr { };
 
     // Expression sub-components
-    struct arg;
-    struct arg_list : pegtl::list<arg, pegtl::seq<ignored, pegtl::one<','>, ignored>> { };
-    struct argument
-        : pegtl::sor<
-                  pegtl::seq<identifier, ignored, pegtl::one<'='>, ignored, expression>,
-                  expression> { };
+    struct keyword_argument
+        : pegtl::seq<identifier, ignored, pegtl::one<'='>, ignored, expression> { };
+    struct argument : pegtl::sor<keyword_argument, expression> { };
+    struct arg_list
+        : pegtl::list<argument, pegtl::seq<ignored, pegtl::one<','>, ignored>> { };
     struct call_args : pegtl::seq<pegtl::one<'('>, ignored, pegtl::opt<arg_list>, ignored,
                                   pegtl::one<')'>> { };
 
     struct raise_expr : pegtl::seq<K_RAISE, ignored, expression> { };
+    // A block body is tried first: as an expression it would be a block_expr.
     struct lambda_expr : pegtl::seq<func_sig, ignored, pegtl::string<'=', '>'>, ignored,
-                                    pegtl::sor<expression, block>> { };
+                                    pegtl::sor<block, expression>> { };
     struct block_expr : pegtl::seq<pegtl::one<'{'>, ignored, pegtl::star<statement>,
                                    pegtl::opt<expression>, ignored, pegtl::one<'}'>> { };
 
@@ -269,8 +293,10 @@ namespace mxs::frontend::grammar {
                                      until_stmt, break_stmt, continue_stmt, return_stmt> {
     };
 
+    // assert and defer go before expression_stmt, which would read `assert (x);`
+    // as a call.
     struct statement
-        : pegtl::sor<let_stmt, control_stmt, expression_stmt, assert_stmt, defer_stmt> {
+        : pegtl::sor<let_stmt, control_stmt, assert_stmt, defer_stmt, expression_stmt> {
     };
     struct block
         : pegtl::seq<pegtl::one<'{'>, ignored,
@@ -280,10 +306,12 @@ namespace mxs::frontend::grammar {
     // Definitions
     // ===================================================================
     struct func_def
-        : pegtl::seq<K_FUNC, ignored, identifier, pegtl::opt<ignored, generic_param>,
-                     ignored, func_sig, ignored, block> { };
+        : pegtl::seq<pegtl::opt<K_ASYNC, ignored>, K_FUNC, ignored, declared_name,
+                     pegtl::opt<ignored, generic_param>, ignored, func_sig, ignored,
+                     block> { };
     struct field_def_class : let_stmt { };
-    struct method_def : pegtl::seq<pegtl::opt<K_OVERRIDE, ignored>, K_FUNC, ignored,
+    struct method_def : pegtl::seq<pegtl::opt<K_OVERRIDE, ignored>,
+                                   pegtl::opt<K_ASYNC, ignored>, K_FUNC, ignored,
                                    identifier, pegtl::opt<ignored, generic_param>,
                                    ignored, func_sig, ignored, block> { };
     struct op_symbol
@@ -359,9 +387,11 @@ namespace mxs::frontend::grammar {
     struct import_stmt
         : pegtl::seq<K_IMPORT, ignored, fqdn,
                      pegtl::opt<ignored, K_AS, ignored, identifier>, pegtl::one<';'>> { };
+    struct binding_name : identifier { };
     struct binding_stmt
-        : pegtl::seq<pegtl::sor<K_STATIC, K_DYNAMIC>, ignored, K_LET, ignored, identifier,
-                     ignored, pegtl::one<'='>, ignored, expression, pegtl::one<';'>> { };
+        : pegtl::seq<pegtl::sor<K_STATIC, K_DYNAMIC>, ignored, K_LET, ignored,
+                     binding_name, ignored, pegtl::one<'='>, ignored, expression,
+                     pegtl::one<';'>> { };
 
     struct annotatable_decl
         : pegtl::sor<func_def, class_def, interface_def, type_def, enum_def> { };
@@ -376,4 +406,12 @@ namespace mxs::frontend::grammar {
     // ===================================================================
     struct mxscript : pegtl::star<pegtl::seq<top_level_decl, ignored>> { };
     struct grammar : pegtl::must<ignored, mxscript, pegtl::eof> { };
+
+    // REPL entries: the shell tries each one in turn, every attempt on a fresh
+    // AST state, so a failed alternative never leaves nodes behind.
+    struct repl_declaration : pegtl::seq<ignored, top_level_decl, ignored, pegtl::eof> { };
+    struct repl_expression
+        : pegtl::seq<ignored, expression, ignored, pegtl::opt<pegtl::one<';'>, ignored>,
+                     pegtl::eof> { };
+    struct repl_statement : pegtl::seq<ignored, statement, ignored, pegtl::eof> { };
 }
\ No newline at end of file
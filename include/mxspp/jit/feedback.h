@@ -0,0 +1,65 @@
+#pragma once
+
+#include "mxspp/core/MXMacro.h"
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <span>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace mxs::jit {
+    // Argument type profiles of compiled functions, kept across runs of the
+    // same program within one process, e.g. `mxs serve` answering many
+    // requests for one script.
+    //
+    // Baseline code counts the MXSValueKind of every argument in the global
+    // "mxs.feedback.<function>". After a run the shell merges those counters
+    // here, and the next compile of the program asks speculation() which
+    // parameters to assume a kind for. A speculated function checks those
+    // kinds on entry, unboxes the arguments and runs its body on raw numbers.
+    // When a check fails it calls the baseline version instead and counts a
+    // deoptimization in "mxs.deopt.<function>". A function that deoptimizes
+    // too often is never speculated on again for that program.
+    //
+    // Programs are identified by the hash of their source, so a changed
+    // script starts without feedback. Older runs count half as much as each
+    // new one, so profiles follow a workload that shifts.
+    class MXS_API MXTypeFeedback {
+    public:
+        // Profiled calls needed before speculating, and the share of them a
+        // kind must have to be assumed.
+        static constexpr std::uint64_t MIN_SAMPLES = 100;
+        static constexpr double MIN_SHARE = 0.95;
+        // Share of one run's calls that may fail the guards.
+        static constexpr double MAX_DEOPT_SHARE = 0.05;
+
+        static auto get_feedback() -> MXTypeFeedback &;
+
+        // Merges one run: `counts` holds parameters * MXS_KIND_COUNT counters
+        // as laid out in "mxs.feedback.<function>", `deopts` the value of
+        // "mxs.deopt.<function>" (0 when it was not speculated).
+        auto record(std::uint64_t program, const std::string &function,
+                    std::span<const std::uint64_t> counts, std::uint64_t deopts) -> void;
+
+        // The MXSValueKind to assume for each of the `params` parameters, or
+        // an empty vector when the function should be compiled without
+        // assumptions.
+        [[nodiscard]] auto speculation(std::uint64_t program, const std::string &function,
+                                       std::size_t params) const
+                -> std::vector<std::int32_t>;
+
+    private:
+        MXTypeFeedback() = default;
+
+        struct Profile {
+            std::vector<std::uint64_t> counts;
+            bool unstable = false;
+        };
+
+        mutable std::mutex lock_;
+        std::map<std::pair<std::uint64_t, std::string>, Profile> profiles_;
+    };
+}
@@ -5,4 +5,102 @@
 #ifndef JIT_H
 #define JIT_H
 
+#include "mxspp/core/MXMacro.h"
+#include <cstdint>
+#include <llvm/ExecutionEngine/JITEventListener.h>
+#include <llvm/ExecutionEngine/Orc/LLJIT.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace mxs::jit {
+    // ORC LLJIT wrapper for incremental compilation. Every added module gets its
+    // own JITDylib whose link order is: itself, then all earlier inputs newest
+    // first, then the main JITDylib holding runtime.bc and process symbols. A
+    // later input can therefore call (and shadow) anything defined before it,
+    // and nothing that is already compiled is ever compiled again.
+    //
+    // Whole programs go into isolated JITDylibs instead (linked only against
+    // the main one) and are removed after running. With a cache directory,
+    // the object code of modules named "script.<key>" is stored there and
+    // reused the next time a module with that name is compiled.
+    //
+    // Modules run through the O0 pipeline, except on-stack-replacement
+    // continuations ("script.<key>.osr"), which get O2: they are only compiled
+    // once a loop has proved hot.
+    //
+    // Profiling hooks, read from the environment by create():
+    //   MXS_PERF=1     append every loaded function to /tmp/perf-<pid>.map and,
+    //                  when LLVM was built with LLVM_USE_PERF, write a jitdump
+    //                  for `perf inject --jit`;
+    //   MXS_GDB_JIT=1  register objects with GDB's JIT interface.
+    // Either, like an enabled MXProfiler, switches object linking to
+    // RuntimeDyld, where LLVM's JITEventListeners attach.
+    class MXS_API MXJit {
+    public:
+        static auto create(const std::string &cache_dir = {})
+                -> llvm::Expected<std::unique_ptr<MXJit>>;
+
+        // Loads runtime.bc into the main JITDylib shared by every input.
+        auto load_runtime(const std::string &path) -> llvm::Error;
+
+        // Adds `module` in a fresh JITDylib; `module` should carry the data
+        // layout and triple returned below.
+        auto add_module(llvm::orc::ThreadSafeModule module)
+                -> llvm::Expected<llvm::orc::JITDylib *>;
+
+        // Resolves `name` through the same order a new input would link against.
+        auto lookup(llvm::StringRef name) -> llvm::Expected<llvm::orc::ExecutorAddr>;
+
+        // Adds `module` in a JITDylib that sees only the main JITDylib.
+        auto add_isolated_module(llvm::orc::ThreadSafeModule module)
+                -> llvm::Expected<llvm::orc::JITDylib *>;
+        // Same as above for an object file built by compile_object(); the linker
+        // applies its relocations when the dylib's symbols are first looked up.
+        auto add_isolated_object(std::unique_ptr<llvm::MemoryBuffer> object)
+                -> llvm::Expected<llvm::orc::JITDylib *>;
+        // Adds another module to an isolated JITDylib. Nothing in it is
+        // compiled until one of its symbols is looked up.
+        auto add_to(llvm::orc::JITDylib &dylib, llvm::orc::ThreadSafeModule module)
+                -> llvm::Error;
+        // Defines `name` in `dylib` as a host address, e.g. a callback that
+        // JIT code calls or the data it passes to it.
+        auto define_absolute(llvm::orc::JITDylib &dylib, llvm::StringRef name,
+                             const void *address) -> llvm::Error;
+        auto lookup_in(llvm::orc::JITDylib &dylib, llvm::StringRef name)
+                -> llvm::Expected<llvm::orc::ExecutorAddr>;
+        // Frees the code and symbols of an isolated JITDylib.
+        auto remove(llvm::orc::JITDylib &dylib) -> llvm::Error;
+
+        // Lowers `module` through the same pipeline as the JIT and returns a
+        // relocatable object file for this host, e.g. to store in an image.
+        auto compile_object(llvm::orc::ThreadSafeModule module)
+                -> llvm::Expected<std::unique_ptr<llvm::MemoryBuffer>>;
+
+        // Hash of runtime.bc, the LLVM version, the target triple and the host
+        // CPU; object code built by compile_object() is only valid for this key.
+        [[nodiscard]] auto runtime_key() const -> std::uint64_t;
+        [[nodiscard]] auto data_layout() const -> const llvm::DataLayout &;
+        [[nodiscard]] auto target_triple() const -> const llvm::Triple &;
+
+    private:
+        MXJit(std::unique_ptr<llvm::orc::LLJIT> jit,
+              std::shared_ptr<llvm::ObjectCache> cache,
+              std::vector<std::unique_ptr<llvm::JITEventListener>> listeners);
+
+        auto search_order() const -> llvm::orc::JITDylibSearchOrder;
+        auto new_isolated_dylib() -> llvm::Expected<llvm::orc::JITDylib &>;
+
+        // listeners_ 和 cache_ 必须比 jit_ 活得久：链接层和编译器持有它们的裸指针
+        std::vector<std::unique_ptr<llvm::JITEventListener>> listeners_;
+        std::shared_ptr<llvm::ObjectCache> cache_;
+        std::unique_ptr<llvm::orc::LLJIT> jit_;
+        std::size_t isolated_ = 0;
+        std::uint64_t runtime_key_ = 0;
+        // 按添加顺序保存每次输入的 JITDylib
+        std::vector<llvm::orc::JITDylib *> inputs_;
+    };
+}
+
 #endif//JIT_H
@@ -0,0 +1,94 @@
+#pragma once
+
+#include "mxspp/core/MXAllocationProfiler.h"
+#include "mxspp/core/MXMacro.h"
+#include <atomic>
+#include <csignal>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace mxs::jit {
+    // Sampling CPU profiler behind `mxs --profile`, usable without perf.
+    //
+    // start() arms a CPU-time timer for the calling thread. Each expiry
+    // delivers SIGPROF to that thread, and the handler walks the frame-pointer
+    // chain into a preallocated buffer without allocating or locking. Once
+    // enabled, MXJit keeps frame pointers in the code it compiles and reports
+    // every function it loads through add_function(). write_folded()
+    // symbolizes the samples afterwards: first against those JIT functions
+    // (script code and runtime.bc), then via dladdr() for the host process
+    // and shared libraries.
+    //
+    // Frames in native code built without frame pointers end the walk early.
+    // Samples beyond the buffer's capacity are counted and dropped. Linux only;
+    // elsewhere start() returns false.
+    class MXS_API MXProfiler {
+    public:
+        static constexpr std::size_t MAX_DEPTH = 64;
+        static constexpr std::size_t CAPACITY = 1 << 15;
+
+        static auto get_profiler() -> MXProfiler &;
+
+        // Must be called before the JIT is created. Enabling without start()
+        // still yields frame pointers and JIT symbols for frame().
+        auto enable(unsigned frequency_hz = 997) -> void;
+        [[nodiscard]] auto enabled() const -> bool;
+
+        // Samples the calling thread until stop(); false if the timer or the
+        // signal handler could not be installed.
+        auto start() -> bool;
+        auto stop() -> void;
+
+        // Records a JIT-compiled function; called by MXJit as objects load.
+        // `script` is false for functions from runtime.bc.
+        auto add_function(std::uint64_t address, std::uint64_t size, std::string name,
+                          bool script) -> void;
+        // Names `address` the same way write_folded() does, for
+        // MXAllocationProfiler::report().
+        [[nodiscard]] auto frame(std::uintptr_t address) const
+                -> core::MXAllocationProfiler::Frame;
+
+        // One line per distinct stack, "root;...;leaf count", as consumed by
+        // flamegraph.pl, speedscope and similar tools.
+        auto write_folded(std::ostream &out) const -> void;
+        [[nodiscard]] auto sample_count() const -> std::size_t;
+        [[nodiscard]] auto dropped_count() const -> std::size_t;
+
+    private:
+        MXProfiler() = default;
+
+        struct Sample {
+            std::uint32_t depth;
+            std::uintptr_t frames[MAX_DEPTH];
+        };
+
+        struct Function {
+            std::uint64_t address;
+            std::uint64_t size;
+            std::string name;
+            bool script;
+        };
+
+        static void on_sample(int signal, siginfo_t *info, void *context);
+        auto symbolize(std::uintptr_t address, bool *script = nullptr) const
+                -> std::string;
+
+        bool enabled_ = false;
+        unsigned frequency_hz_ = 997;
+        bool running_ = false;
+        void *timer_ = nullptr;
+        // 信号处理函数只读写下面这些：预先分配，按槽位原子递增
+        std::unique_ptr<Sample[]> samples_;
+        std::atomic<std::size_t> next_{ 0 };
+        std::atomic<std::size_t> dropped_{ 0 };
+        std::uintptr_t stack_low_ = 0;
+        std::uintptr_t stack_high_ = 0;
+
+        mutable std::mutex lock_;
+        std::vector<Function> functions_;
+    };
+}
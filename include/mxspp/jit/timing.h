@@ -0,0 +1,73 @@
+#pragma once
+
+#include "mxspp/core/MXMacro.h"
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace mxs::jit {
+    // Wall time and malloc growth per compilation phase for `mxs --time-passes`,
+    // plus named counters (AST nodes, IR instructions, object code bytes).
+    // Phases nest: a phase begun while another is open is reported under it
+    // and its time is included in its parent's. Entering a phase again adds to
+    // it. Disabled by default, in which case every call returns immediately.
+    // Not thread-safe; the JIT compiles on the thread that looks symbols up.
+    class MXS_API MXCompileTimer {
+    public:
+        // Begins a phase on construction and ends it on destruction.
+        class Scope {
+        public:
+            Scope(MXCompileTimer &timer, std::string_view phase);
+            ~Scope();
+            Scope(const Scope &) = delete;
+            auto operator=(const Scope &) -> Scope & = delete;
+
+        private:
+            MXCompileTimer &timer_;
+            bool active_;
+        };
+
+        static auto get_timer() -> MXCompileTimer &;
+
+        auto enable() -> void;
+        [[nodiscard]] auto enabled() const -> bool;
+
+        auto begin(std::string_view phase) -> void;
+        auto end() -> void;
+        auto count(std::string_view counter, std::uint64_t amount) -> void;
+
+        // Writes the phase tree, then the counters.
+        auto report(std::ostream &out) const -> void;
+
+    private:
+        MXCompileTimer() = default;
+
+        static constexpr std::size_t NO_PARENT = static_cast<std::size_t>(-1);
+
+        struct Phase {
+            std::string name;
+            std::size_t parent;
+            std::chrono::nanoseconds time{};
+            std::int64_t memory = 0;
+            std::size_t runs = 0;
+        };
+
+        struct OpenPhase {
+            std::size_t phase;
+            std::chrono::steady_clock::time_point started;
+            std::size_t malloc_usage;
+        };
+
+        auto report_children(std::ostream &out, std::size_t parent, std::size_t depth,
+                             double total_ms) const -> void;
+
+        bool enabled_ = false;
+        std::vector<Phase> phases_;
+        std::vector<OpenPhase> open_;
+        std::vector<std::pair<std::string, std::uint64_t>> counters_;
+    };
+}
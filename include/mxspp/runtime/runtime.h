@@ -5,4 +5,152 @@
 #ifndef RUNTIME_H
 #define RUNTIME_H
 
+#include <cstdint>
+
+namespace mxs::core {
+    class MXObject;
+}
+
+// Operator codes passed by generated code to mxs_runtime_unary / _binary.
+enum MXSOperator : std::int32_t {
+    MXS_OP_ADD,
+    MXS_OP_SUB,
+    MXS_OP_MUL,
+    MXS_OP_DIV,
+    MXS_OP_MOD,
+    MXS_OP_LT,
+    MXS_OP_LE,
+    MXS_OP_GT,
+    MXS_OP_GE,
+    MXS_OP_EQ,
+    MXS_OP_NE,
+    MXS_OP_NEG,
+    MXS_OP_POS,
+    MXS_OP_NOT,
+};
+
+// Value kinds returned by mxs_runtime_value_kind(), the unit of type feedback
+// (see jit/feedback.h).
+enum MXSValueKind : std::int32_t {
+    MXS_KIND_OTHER,
+    MXS_KIND_INTEGER,
+    MXS_KIND_FLOAT,
+    MXS_KIND_COUNT,
+};
+
+// C-ABI entry points called from JIT-compiled code. Compiled into runtime.bc so
+// the JIT can inline them into user code.
+extern "C" {
+// --- async func support (see backend/coroutine.h) ---
+auto mxs_runtime_coro_alloc(std::uint64_t size) -> void *;
+auto mxs_runtime_coro_free(void *frame) -> void;
+auto mxs_runtime_coro_complete(void *handle) -> void;
+// Registers a compiled coroutine's frame as an awaitable task; a non-task
+// operand makes mxs_runtime_await_resume return a TypeError.
+auto mxs_runtime_coro_begin(void *handle) -> void;
+auto mxs_runtime_await(void *handle, void *task) -> void;
+auto mxs_runtime_await_resume(void *task) -> mxs::core::MXObject *;
+auto mxs_runtime_run_until_complete(void *task) -> mxs::core::MXObject *;
+
+// Boxing of unboxed IR values (i64 / double / i1), e.g. a REPL result.
+auto mxs_runtime_box_integer(std::int64_t value) -> mxs::core::MXObject *;
+auto mxs_runtime_box_float(double value) -> mxs::core::MXObject *;
+auto mxs_runtime_box_bool(bool value) -> mxs::core::MXObject *;
+auto mxs_runtime_box_string(const char *data, std::int64_t size)
+        -> mxs::core::MXObject *;
+// Frees a value boxed only to pass it to one runtime call, once that call has
+// returned. Static objects are left alone.
+auto mxs_runtime_release(mxs::core::MXObject *value) -> void;
+
+// Operators on boxed values, used when the operand types are not known at
+// compile time. Integers wrap like unboxed i64 code and floats follow IEEE;
+// the result is a new value or an MXError (TypeError, or ZeroDivisionError for
+// integer / and %). Static lets are folded with the same rules.
+auto mxs_runtime_unary(std::int32_t op, mxs::core::MXObject *operand)
+        -> mxs::core::MXObject *;
+auto mxs_runtime_binary(std::int32_t op, mxs::core::MXObject *lhs,
+                        mxs::core::MXObject *rhs) -> mxs::core::MXObject *;
+// nil, false, 0, 0.0 and "" are false; everything else is true.
+auto mxs_runtime_truthy(mxs::core::MXObject *value) -> bool;
+// Type feedback and speculation guards. The unbox functions store the number
+// in `out` and return true, or return false when `value` is of another kind;
+// generated code then takes its deoptimization or mismatch path.
+auto mxs_runtime_value_kind(mxs::core::MXObject *value) -> std::int32_t;
+auto mxs_runtime_unbox_integer(mxs::core::MXObject *value, std::int64_t *out) -> bool;
+auto mxs_runtime_unbox_float(mxs::core::MXObject *value, double *out) -> bool;
+// The cold failure path of `assert`: builds the AssertionError for the
+// statement at line:column. Nothing is allocated until an assert fails.
+auto mxs_runtime_assert_failed(std::int32_t line, std::int32_t column)
+        -> mxs::core::MXObject *;
+// Closures (see core/MXClosure.h). closure_new allocates the closure and its
+// environment of `slots` zeroed 8-byte slots in one go; closure_code returns
+// the code of a closure taking `arity` arguments, nullptr for anything else.
+auto mxs_runtime_closure_new(void *code, std::int64_t arity, std::int64_t slots)
+        -> mxs::core::MXObject *;
+auto mxs_runtime_closure_environment(mxs::core::MXObject *closure) -> void *;
+auto mxs_runtime_closure_code(mxs::core::MXObject *value, std::int64_t arity) -> void *;
+// A heap cell for a `let mut` variable that lambdas capture: one slot holding
+// the variable's boxed value, shared by the frame and every closure over it.
+// Like closures, cells are never freed.
+auto mxs_runtime_cell_new() -> mxs::core::MXObject **;
+// Creates an MXError from NUL-terminated strings, e.g. for constructs the
+// code generator does not support yet.
+auto mxs_runtime_error(const char *type, const char *message) -> mxs::core::MXObject *;
+
+// Module globals: values set up by a script's init(), restored from a startup
+// image (see core/MXSnapshot.h) instead of recomputed. store() keeps a deep copy
+// of `value`, which stays owned by the caller, and returns nil or a TypeError
+// for values an image cannot hold. An Error `value` is not stored but returned
+// as is, so a failed initializer reaches the caller. load() borrows, nil when
+// unset.
+auto mxs_runtime_global_store(mxs::core::MXObject *name, mxs::core::MXObject *value)
+        -> mxs::core::MXObject *;
+auto mxs_runtime_global_load(mxs::core::MXObject *name) -> mxs::core::MXObject *;
+// The Dict holding every global, in definition order.
+auto mxs_runtime_globals() -> mxs::core::MXObject *;
+
+// --- std.io asynchronous I/O (see core/MXAsyncIO.h), each returns a task ---
+auto mxs_io_async_read(mxs::core::MXObject *fd, mxs::core::MXObject *length,
+                       mxs::core::MXObject *offset) -> void *;
+auto mxs_io_async_write(mxs::core::MXObject *fd, mxs::core::MXObject *data,
+                        mxs::core::MXObject *offset) -> void *;
+auto mxs_io_async_accept(mxs::core::MXObject *fd) -> void *;
+auto mxs_io_async_connect(mxs::core::MXObject *fd, mxs::core::MXObject *host,
+                          mxs::core::MXObject *port) -> void *;
+
+// --- std.io buffered output and std.file.File (see core/MXOutputStream.h) ---
+// These return nil (nullptr) on success and an MXError on failure.
+auto mxs_io_stdout() -> mxs::core::MXObject *;
+auto mxs_io_stderr() -> mxs::core::MXObject *;
+auto mxs_io_print(mxs::core::MXObject *value) -> mxs::core::MXObject *;
+auto mxs_io_println(mxs::core::MXObject *value) -> mxs::core::MXObject *;
+auto mxs_io_write_file(mxs::core::MXObject *stream, mxs::core::MXObject *value)
+        -> mxs::core::MXObject *;
+auto mxs_io_flush(mxs::core::MXObject *stream) -> mxs::core::MXObject *;
+auto mxs_file_open(mxs::core::MXObject *path, mxs::core::MXObject *mode)
+        -> mxs::core::MXObject *;
+auto mxs_file_write(mxs::core::MXObject *file, mxs::core::MXObject *value)
+        -> mxs::core::MXObject *;
+auto mxs_file_close(mxs::core::MXObject *file) -> mxs::core::MXObject *;
+// Line iteration over a mapped file: next_line returns a StringView borrowing
+// from the mapping, or nil at end of file. string_own copies a StringView into
+// a new owned String; a String argument is copied as well, since the argument
+// stays borrowed.
+auto mxs_file_lines(mxs::core::MXObject *file) -> mxs::core::MXObject *;
+auto mxs_file_next_line(mxs::core::MXObject *lines) -> mxs::core::MXObject *;
+auto mxs_string_own(mxs::core::MXObject *value) -> mxs::core::MXObject *;
+
+// --- std.json / std.csv streaming parsers (see core/MXJson.h, core/MXCsv.h) ---
+// Readers accept a File (parsed straight from its mapping) or a string.
+auto mxs_json_parse(mxs::core::MXObject *text) -> mxs::core::MXObject *;
+auto mxs_json_reader(mxs::core::MXObject *source) -> mxs::core::MXObject *;
+auto mxs_json_next(mxs::core::MXObject *reader) -> mxs::core::MXObject *;
+auto mxs_json_done(mxs::core::MXObject *reader) -> mxs::core::MXObject *;
+auto mxs_csv_reader(mxs::core::MXObject *source, mxs::core::MXObject *delimiter)
+        -> mxs::core::MXObject *;
+auto mxs_csv_next_row(mxs::core::MXObject *reader) -> mxs::core::MXObject *;
+auto mxs_csv_next_batch(mxs::core::MXObject *reader, mxs::core::MXObject *rows)
+        -> mxs::core::MXObject *;
+}
+
 #endif//RUNTIME_H
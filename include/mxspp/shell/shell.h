@@ -5,4 +5,99 @@
 #ifndef SHELL_H
 #define SHELL_H
 
+#include "mxspp/backend/codegen.h"
+#include "mxspp/core/MXMacro.h"
+#include "mxspp/core/MXObject.h"
+#include "mxspp/jit/jit.h"
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace mxs::shell {
+    // Interactive interpreter. Each entry is parsed on its own, lowered into a
+    // module of its own and added to the JIT as a new JITDylib, so definitions
+    // from earlier entries stay compiled and only the new code is compiled.
+    // The runtime (runtime.bc, event loop, open files) lives for the session.
+    class MXS_API MXShell {
+    public:
+        // `cache_dir` enables the JIT's on-disk object cache for run_program().
+        static auto create(const std::string &runtime_path,
+                           const std::string &cache_dir = {})
+                -> llvm::Expected<std::unique_ptr<MXShell>>;
+
+        // Compiles and runs one complete entry (a declaration, a statement or
+        // an expression) and returns the text to echo: the repr of an
+        // expression's value, an error repr, or "" when there is nothing to show.
+        auto eval(std::string_view source) -> std::string;
+
+        // Compiles a whole script into an isolated JITDylib, calls its `main`
+        // (running an async main to completion) and drops the code again.
+        // Returns the exit status: main's int result, 1 on errors (reported on
+        // stderr), 0 otherwise. With execute = false the script is only
+        // compiled, which fills the object cache for later runs. `name` is the
+        // script path used in syntax errors and in the debug info.
+        auto run_program(std::string_view source, bool execute = true,
+                         std::string_view name = "<script>") -> int;
+        // Time the last run_program() spent parsing, lowering and compiling,
+        // up to the point where the script starts running. Zero if it failed
+        // before the code was compiled.
+        auto last_compile_time() const -> std::chrono::nanoseconds;
+        // Compiles `assert` statements to nothing from now on (--strip-asserts).
+        // Stripped programs have their own object-cache entries.
+        auto set_strip_asserts(bool strip) -> void;
+        // Object-cache key of a script: covers the source, its name, the LLVM
+        // version, this compiler build, the runtime (MXJit::runtime_key()) and
+        // --strip-asserts. Type feedback is mixed in later, per program.
+        static auto program_key(std::string_view source, std::string_view name,
+                                std::uint64_t runtime_key, bool strip_asserts)
+                -> std::uint64_t;
+
+        // Startup images (see core/MXSnapshot.h). snapshot() compiles the script
+        // to object code, runs its `init` function if it has one, and writes
+        // the resulting module globals and the code to `image_path`.
+        // run_image() restores the globals, links the stored code without
+        // compiling anything and calls `main`. Both return an exit status like
+        // run_program(). An image built for another runtime.bc, LLVM version
+        // or host CPU is rejected.
+        auto snapshot(std::string_view source, const std::string &image_path,
+                      std::string_view name = "<script>") -> int;
+        auto run_image(const std::string &image_path) -> int;
+
+        // Prompts on `out` until end of input or ":quit". An entry spans lines
+        // while it has unclosed brackets.
+        auto run(std::istream &in, std::ostream &out) -> int;
+
+    private:
+        explicit MXShell(std::unique_ptr<jit::MXJit> jit);
+
+        auto call_entry(llvm::orc::JITDylib &dylib, llvm::StringRef name, bool is_async)
+                -> llvm::Expected<core::MXObject *>;
+        // Looks up `main`, which compiles and links the dylib's code; timed as
+        // the first-call latency under --time-passes.
+        auto first_call(llvm::orc::JITDylib &dylib)
+                -> llvm::Expected<llvm::orc::ExecutorAddr>;
+        // Runs the top-level bindings that could not be folded at compile time.
+        // Returns 1 after reporting the error of the first binding that failed.
+        auto init_module(llvm::orc::JITDylib &dylib) -> int;
+        auto run_main(llvm::orc::JITDylib &dylib, bool is_async) -> int;
+
+        std::unique_ptr<jit::MXJit> jit_;
+        std::size_t entries_ = 0;
+        std::chrono::nanoseconds last_compile_time_{};
+        // `static let` values folded by earlier entries; later entries inline
+        // them even though each entry is compiled into a module of its own.
+        backend::codegen::ConstantTable constants_;
+        // Arity of the plain functions defined by earlier entries, so later
+        // entries can call them. Generic functions do not outlive their entry.
+        std::unordered_map<std::string, std::size_t> functions_;
+        bool strip_asserts_ = false;
+    };
+}
+
 #endif//SHELL_H
@@ -61,6 +61,14 @@ PEGTL_CONFIG = {
     "target_dir_name": "pegtl",
 }
 
+# --- Google Benchmark Configuration (only for -DMXS_BUILD_BENCH=ON) ---
+BENCHMARK_VERSION_TAG = "1.9.1"
+BENCHMARK_CONFIG = {
+    "url": f"https://github.com/google/benchmark/archive/refs/tags/v{BENCHMARK_VERSION_TAG}.tar.gz",
+    "archive_name": f"benchmark-{BENCHMARK_VERSION_TAG}.tar.gz",
+    "inner_dir_prefix": f"benchmark-{BENCHMARK_VERSION_TAG}",
+    "target_dir_name": "benchmark_src",
+}
 
 # ==============================================================================
 # Helper Functions for Colored Output
@@ -412,6 +420,54 @@ def setup_pegtl():
     success(f"PEGTL is ready at '{install_path}'.")
 
 
+
+def setup_benchmark():
+    """Downloads Google Benchmark and installs it into lib/benchmark for the bench target."""
+    config = BENCHMARK_CONFIG
+    source_path = LIB_DIR / config["target_dir_name"]
+    install_path = LIB_DIR / "benchmark"
+
+    if install_path.is_dir():
+        success(f"Google Benchmark already found at '{install_path}'. Skipping build.")
+        return
+
+    info("Setting up Google Benchmark...")
+    LIB_DIR.mkdir(exist_ok=True)
+    if not source_path.is_dir():
+        download_and_extract(
+            config["url"],
+            config["archive_name"],
+            LIB_DIR,
+            config["inner_dir_prefix"],
+            config["target_dir_name"],
+        )
+
+    build_dir = source_path / "build"
+    try:
+        subprocess.run(
+            [
+                "cmake",
+                "-S",
+                str(source_path),
+                "-B",
+                str(build_dir),
+                f"-DCMAKE_INSTALL_PREFIX={install_path}",
+                "-DCMAKE_BUILD_TYPE=Release",
+                "-DBENCHMARK_ENABLE_TESTING=OFF",
+                "-DBENCHMARK_ENABLE_GTEST_TESTS=OFF",
+                "-DBENCHMARK_INSTALL_DOCS=OFF",
+            ],
+            check=True,
+        )
+        subprocess.run(
+            ["cmake", "--build", str(build_dir), "--target", "install"], check=True
+        )
+    except subprocess.CalledProcessError as e:
+        error(f"Google Benchmark build failed: {e}")
+        sys.exit(1)
+    shutil.rmtree(source_path, ignore_errors=True)
+    success(f"Google Benchmark is ready at '{install_path}'.")
+
 # ==============================================================================
 # Main Execution
 # ==============================================================================
@@ -434,6 +490,11 @@ def main():
         action="store_true",
         help="Force download and setup of LLVM (either pre-built or from source).",
     )
+    parser.add_argument(
+        "--benchmark",
+        action="store_true",
+        help="Download and build Google Benchmark into lib/benchmark (needed for -DMXS_BUILD_BENCH=ON).",
+    )
     args = parser.parse_args()
 
     try:
@@ -453,6 +514,10 @@ def main():
         print()
         setup_pegtl()
 
+        if args.benchmark:
+            print()
+            setup_benchmark()
+
         print()
         success("Project dependencies are successfully set up.")
 
@@ -0,0 +1,143 @@
+#include "mxspp/backend/codegen.h"
+#include <llvm/BinaryFormat/Dwarf.h>
+#include <llvm/Support/Path.h>
+#include <format>
+
+namespace mxs::backend::codegen {
+    namespace {
+        auto object_ptr_type(CodegenContext &ctx) -> llvm::PointerType * {
+            return llvm::PointerType::getUnqual(ctx.llvmContext);
+        }
+
+        // 字符串常量的字节放进模块的只读数据段
+        auto string_bytes(CodegenContext &ctx, const std::string &text, const char *name)
+                -> llvm::GlobalVariable * {
+            auto *data = llvm::ConstantDataArray::getString(ctx.llvmContext, text, false);
+            return new llvm::GlobalVariable(*ctx.module, data->getType(), true,
+                                            llvm::GlobalValue::PrivateLinkage, data,
+                                            name);
+        }
+    }
+
+    auto runtime_function(CodegenContext &ctx, const char *name, llvm::Type *ret,
+                          llvm::ArrayRef<llvm::Type *> params) -> llvm::FunctionCallee {
+        return ctx.module->getOrInsertFunction(
+                name, llvm::FunctionType::get(ret, params, false));
+    }
+
+    auto emit_constant(CodegenContext &ctx, const ConstantValue &value) -> llvm::Value * {
+        auto &builder = *ctx.builder;
+        auto *ptr_ty = object_ptr_type(ctx);
+        if (const auto *integer = std::get_if<std::int64_t>(&value))
+            return builder.getInt64(static_cast<std::uint64_t>(*integer));
+        if (const auto *number = std::get_if<double>(&value))
+            return llvm::ConstantFP::get(builder.getDoubleTy(), *number);
+        if (const auto *boolean = std::get_if<bool>(&value))
+            return builder.getInt1(*boolean);
+        if (const auto *text = std::get_if<std::string>(&value)) {
+            auto box = runtime_function(ctx, "mxs_runtime_box_string", ptr_ty,
+                                        { ptr_ty, builder.getInt64Ty() });
+            auto *bytes = string_bytes(ctx, *text, "mxs.str");
+            return builder.CreateCall(box, { bytes, builder.getInt64(text->size()) });
+        }
+        return llvm::ConstantPointerNull::get(ptr_ty);
+    }
+
+    auto emit_box(CodegenContext &ctx, llvm::Value *value) -> llvm::Value * {
+        auto &builder = *ctx.builder;
+        auto *ptr_ty = object_ptr_type(ctx);
+        auto *type = value->getType();
+        if (type->isPointerTy()) return value;
+        const char *boxer = nullptr;
+        if (type->isIntegerTy(1)) {
+            boxer = "mxs_runtime_box_bool";
+        } else if (type->isIntegerTy()) {
+            value = builder.CreateSExtOrTrunc(value, builder.getInt64Ty());
+            boxer = "mxs_runtime_box_integer";
+        } else if (type->isDoubleTy()) {
+            boxer = "mxs_runtime_box_float";
+        } else {
+            return llvm::ConstantPointerNull::get(ptr_ty);
+        }
+        auto callee = runtime_function(ctx, boxer, ptr_ty, { value->getType() });
+        return builder.CreateCall(callee, { value });
+    }
+
+    auto emit_static_data(CodegenContext &ctx, const std::string &name,
+                          const ConstantValue &value) -> void {
+        auto &builder = *ctx.builder;
+        llvm::Constant *data = nullptr;
+        if (const auto *integer = std::get_if<std::int64_t>(&value)) {
+            data = builder.getInt64(static_cast<std::uint64_t>(*integer));
+        } else if (const auto *number = std::get_if<double>(&value)) {
+            data = llvm::ConstantFP::get(builder.getDoubleTy(), *number);
+        } else if (const auto *boolean = std::get_if<bool>(&value)) {
+            data = builder.getInt1(*boolean);
+        } else if (const auto *text = std::get_if<std::string>(&value)) {
+            data = llvm::ConstantDataArray::getString(ctx.llvmContext, *text, false);
+        } else {
+            data = llvm::ConstantPointerNull::get(object_ptr_type(ctx));
+        }
+        // 同一模块里重复绑定同名 static let 时，以最后一次为准
+        const std::string symbol = "mxs.static." + name;
+        if (auto *old = ctx.module->getNamedGlobal(symbol)) {
+            old->setName("");
+            old->setLinkage(llvm::GlobalValue::PrivateLinkage);
+        }
+        new llvm::GlobalVariable(*ctx.module, data->getType(), true,
+                                 llvm::GlobalValue::ExternalLinkage, data, symbol);
+    }
+
+    auto begin_debug_info(CodegenContext &ctx, llvm::StringRef path) -> void {
+        ctx.debug = std::make_unique<DebugInfo>(*ctx.module);
+        auto &debug = *ctx.debug;
+        debug.file = debug.builder.createFile(llvm::sys::path::filename(path),
+                                              llvm::sys::path::parent_path(path));
+        // DWARF 没有为 mxs 分配语言码，沿用自定义语言常用的 C
+        debug.unit = debug.builder.createCompileUnit(
+                llvm::dwarf::DW_LANG_C, debug.file, "mxs", false, "", 0, "",
+                llvm::DICompileUnit::LineTablesOnly);
+    }
+
+    auto begin_function_scope(CodegenContext &ctx, llvm::Function *fn,
+                              SourceLocation location) -> void {
+        if (!ctx.debug) return;
+        auto &debug = ctx.debug->builder;
+        auto *type = debug.createSubroutineType(debug.getOrCreateTypeArray({}));
+        auto *subprogram = debug.createFunction(
+                ctx.debug->file, fn->getName(), fn->getName(), ctx.debug->file,
+                location.line, type, location.line, llvm::DINode::FlagPrototyped,
+                llvm::DISubprogram::SPFlagDefinition);
+        fn->setSubprogram(subprogram);
+        // 函数里的每条调用都必须带位置，先以函数头作为默认位置
+        ctx.builder->SetCurrentDebugLocation(llvm::DILocation::get(
+                ctx.llvmContext, location.line, location.column, subprogram));
+    }
+
+    CompileError::CompileError(SourceLocation location, const std::string &message)
+        : std::runtime_error(std::format("{}:{}: {}", location.line, location.column,
+                                         message)),
+          location(location) { }
+
+    auto set_location(CodegenContext &ctx, SourceLocation location) -> void {
+        if (!ctx.debug || location.line == 0) return;
+        auto *block = ctx.builder->GetInsertBlock();
+        auto *subprogram = block ? block->getParent()->getSubprogram() : nullptr;
+        if (!subprogram) return;
+        ctx.builder->SetCurrentDebugLocation(llvm::DILocation::get(
+                ctx.llvmContext, location.line, location.column, subprogram));
+    }
+
+    auto end_function_scope(CodegenContext &ctx) -> void {
+        // 位置属于当前函数的 subprogram，不能带进下一个函数
+        if (ctx.debug) ctx.builder->SetCurrentDebugLocation(llvm::DebugLoc());
+    }
+
+    auto finish_debug_info(CodegenContext &ctx) -> void {
+        if (!ctx.debug) return;
+        ctx.debug->builder.finalize();
+        // 缺少这个标记时 LLVM 会把模块里的调试信息整体丢弃
+        ctx.module->addModuleFlag(llvm::Module::Warning, "Debug Info Version",
+                                  llvm::DEBUG_METADATA_VERSION);
+    }
+}
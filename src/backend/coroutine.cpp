@@ -0,0 +1,135 @@
+#include "mxspp/backend/coroutine.h"
+#include <llvm/IR/Intrinsics.h>
+
+namespace mxs::backend::codegen {
+    namespace {
+        auto object_ptr_type(CodegenContext &ctx) -> llvm::PointerType * {
+            return llvm::PointerType::getUnqual(ctx.llvmContext);
+        }
+
+        // Dispatches the i8 result of llvm.coro.suspend: 0 resumes, 1 destroys,
+        // anything else (-1) means the coroutine suspended and must return.
+        auto emit_suspend_switch(CodegenContext &ctx, const CoroutineFrame &frame,
+                                 llvm::Value *state, llvm::BasicBlock *resume) -> void {
+            auto *sw = ctx.builder->CreateSwitch(state, frame.suspend, 2);
+            sw->addCase(ctx.builder->getInt8(0), resume);
+            sw->addCase(ctx.builder->getInt8(1), frame.cleanup);
+        }
+    }
+
+    auto emit_coroutine_begin(CodegenContext &ctx, llvm::Function *fn) -> CoroutineFrame {
+        auto &builder = *ctx.builder;
+        auto *ptr_ty = object_ptr_type(ctx);
+        auto *promise_ty = llvm::StructType::get(ctx.llvmContext, { ptr_ty, ptr_ty });
+
+        CoroutineFrame frame{};
+        frame.promise = builder.CreateAlloca(promise_ty, nullptr, "coro.promise");
+        builder.CreateStore(llvm::Constant::getNullValue(promise_ty), frame.promise);
+
+        auto *null_ptr = llvm::ConstantPointerNull::get(ptr_ty);
+        frame.id = builder.CreateIntrinsic(
+                llvm::Intrinsic::coro_id, {},
+                { builder.getInt32(0), frame.promise, null_ptr, null_ptr }, nullptr,
+                "coro.id");
+
+        auto *entry = builder.GetInsertBlock();
+        auto *dyn_alloc = llvm::BasicBlock::Create(ctx.llvmContext, "coro.alloc", fn);
+        auto *begin = llvm::BasicBlock::Create(ctx.llvmContext, "coro.begin", fn);
+        auto *need_alloc = builder.CreateIntrinsic(llvm::Intrinsic::coro_alloc, {},
+                                                   { frame.id }, nullptr, "need.alloc");
+        builder.CreateCondBr(need_alloc, dyn_alloc, begin);
+
+        builder.SetInsertPoint(dyn_alloc);
+        auto *size = builder.CreateIntrinsic(llvm::Intrinsic::coro_size,
+                                             { builder.getInt64Ty() }, {}, nullptr,
+                                             "coro.size");
+        auto alloc = runtime_function(ctx, "mxs_runtime_coro_alloc", ptr_ty,
+                                      { builder.getInt64Ty() });
+        auto *mem = builder.CreateCall(alloc, { size }, "coro.mem");
+        builder.CreateBr(begin);
+
+        builder.SetInsertPoint(begin);
+        auto *phi = builder.CreatePHI(ptr_ty, 2, "coro.mem.phi");
+        phi->addIncoming(null_ptr, entry);
+        phi->addIncoming(mem, dyn_alloc);
+        frame.handle = builder.CreateIntrinsic(llvm::Intrinsic::coro_begin, {},
+                                               { frame.id, phi }, nullptr, "coro.hdl");
+        // Register the frame so `await` can tell it apart from any other value.
+        auto adopt = runtime_function(ctx, "mxs_runtime_coro_begin", builder.getVoidTy(),
+                                      { ptr_ty });
+        builder.CreateCall(adopt, { frame.handle });
+        auto *body = builder.GetInsertBlock();
+
+        frame.final_suspend = llvm::BasicBlock::Create(ctx.llvmContext, "coro.final", fn);
+        frame.cleanup = llvm::BasicBlock::Create(ctx.llvmContext, "coro.cleanup", fn);
+        frame.suspend = llvm::BasicBlock::Create(ctx.llvmContext, "coro.suspend", fn);
+        auto *unreachable =
+                llvm::BasicBlock::Create(ctx.llvmContext, "coro.final.resume", fn);
+
+        // Final suspend: wake whoever awaits us, then park until destroyed.
+        builder.SetInsertPoint(frame.final_suspend);
+        auto complete = runtime_function(ctx, "mxs_runtime_coro_complete",
+                                         builder.getVoidTy(), { ptr_ty });
+        builder.CreateCall(complete, { frame.handle });
+        auto *final_state = builder.CreateIntrinsic(
+                llvm::Intrinsic::coro_suspend, {},
+                { llvm::ConstantTokenNone::get(ctx.llvmContext), builder.getTrue() });
+        emit_suspend_switch(ctx, frame, final_state, unreachable);
+
+        builder.SetInsertPoint(unreachable);
+        builder.CreateUnreachable();
+
+        // coro.free yields null when the frame was elided into the caller.
+        builder.SetInsertPoint(frame.cleanup);
+        auto *to_free = builder.CreateIntrinsic(llvm::Intrinsic::coro_free, {},
+                                                { frame.id, frame.handle }, nullptr,
+                                                "coro.free");
+        auto release = runtime_function(ctx, "mxs_runtime_coro_free", builder.getVoidTy(),
+                                        { ptr_ty });
+        builder.CreateCall(release, { to_free });
+        builder.CreateBr(frame.suspend);
+
+        builder.SetInsertPoint(frame.suspend);
+        builder.CreateIntrinsic(llvm::Intrinsic::coro_end, {},
+                                { frame.handle, builder.getFalse(),
+                                  llvm::ConstantTokenNone::get(ctx.llvmContext) });
+        builder.CreateRet(frame.handle);
+
+        builder.SetInsertPoint(body);
+        return frame;
+    }
+
+    auto emit_coroutine_await(CodegenContext &ctx, const CoroutineFrame &frame,
+                              llvm::Value *task) -> llvm::Value * {
+        auto &builder = *ctx.builder;
+        auto *ptr_ty = object_ptr_type(ctx);
+        auto *fn = builder.GetInsertBlock()->getParent();
+
+        auto *save = builder.CreateIntrinsic(llvm::Intrinsic::coro_save, {},
+                                             { frame.handle }, nullptr, "coro.save");
+        auto await = runtime_function(ctx, "mxs_runtime_await", builder.getVoidTy(),
+                                      { ptr_ty, ptr_ty });
+        builder.CreateCall(await, { frame.handle, task });
+        auto *state = builder.CreateIntrinsic(llvm::Intrinsic::coro_suspend, {},
+                                              { save, builder.getFalse() });
+
+        auto *resume = llvm::BasicBlock::Create(ctx.llvmContext, "await.resume", fn);
+        emit_suspend_switch(ctx, frame, state, resume);
+
+        builder.SetInsertPoint(resume);
+        auto await_resume = runtime_function(ctx, "mxs_runtime_await_resume", ptr_ty,
+                                             { ptr_ty });
+        return builder.CreateCall(await_resume, { task }, "await.result");
+    }
+
+    auto emit_coroutine_return(CodegenContext &ctx, const CoroutineFrame &frame,
+                               llvm::Value *value) -> void {
+        auto &builder = *ctx.builder;
+        auto *ptr_ty = object_ptr_type(ctx);
+        auto *promise_ty = llvm::StructType::get(ctx.llvmContext, { ptr_ty, ptr_ty });
+        auto *result =
+                builder.CreateStructGEP(promise_ty, frame.promise, 0, "promise.result");
+        builder.CreateStore(value, result);
+        builder.CreateBr(frame.final_suspend);
+    }
+}
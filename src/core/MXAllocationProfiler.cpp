@@ -0,0 +1,229 @@
+#include "mxspp/core/MXAllocationProfiler.h"
+#include <algorithm>
+#include <cmath>
+#include <dlfcn.h>
+#include <format>
+#include <random>
+#include <llvm/Demangle/Demangle.h>
+#if defined(__linux__)
+#include <pthread.h>
+#endif
+
+namespace mxs::core {
+    namespace {
+        // 每个线程独立计数：距离下一次采样还差多少字节
+        thread_local std::int64_t until_sample = 0;
+        thread_local bool armed = false;
+        thread_local std::uintptr_t stack_high = 0;
+
+        auto next_distance(std::size_t mean) -> std::int64_t {
+            thread_local std::minstd_rand generator{ std::random_device{}() };
+            const auto rate = 1.0 / static_cast<double>(mean);
+            std::exponential_distribution<double> distance(rate);
+            return static_cast<std::int64_t>(distance(generator)) + 1;
+        }
+
+        // 沿帧指针回溯，跳过最内层的 skip 帧；只读本线程栈范围内的地址
+        [[gnu::noinline]] auto capture_stack(std::uintptr_t *frames, std::size_t max,
+                                             std::size_t skip) -> std::uint32_t {
+            std::uint32_t depth = 0;
+#if defined(__linux__)
+            if (stack_high == 0) {
+                pthread_attr_t attributes;
+                if (pthread_getattr_np(pthread_self(), &attributes) != 0) return 0;
+                void *stack = nullptr;
+                std::size_t stack_size = 0;
+                pthread_attr_getstack(&attributes, &stack, &stack_size);
+                pthread_attr_destroy(&attributes);
+                stack_high = reinterpret_cast<std::uintptr_t>(stack) + stack_size;
+            }
+            auto fp = reinterpret_cast<std::uintptr_t>(__builtin_frame_address(0));
+            const auto low = fp;
+            while (depth < max && fp >= low && fp % sizeof(std::uintptr_t) == 0
+                   && fp + 2 * sizeof(std::uintptr_t) <= stack_high) {
+                const auto *frame = reinterpret_cast<const std::uintptr_t *>(fp);
+                if (frame[1] == 0) break;
+                if (skip > 0)
+                    --skip;
+                else
+                    frames[depth++] = frame[1] - 1;
+                if (frame[0] <= fp) break;
+                fp = frame[0];
+            }
+#else
+            (void) frames;
+            (void) max;
+            (void) skip;
+#endif
+            return depth;
+        }
+
+        auto dladdr_frame(std::uintptr_t address) -> MXAllocationProfiler::Frame {
+            Dl_info info{};
+            if (dladdr(reinterpret_cast<void *>(address), &info) != 0 && info.dli_sname)
+                return { llvm::demangle(info.dli_sname), false };
+            return { std::format("0x{:x}", address), false };
+        }
+
+        struct SiteTotals {
+            double allocations = 0;
+            double bytes = 0;
+            double live_bytes = 0;
+        };
+
+        struct TypeTotals {
+            double objects = 0;
+            double bytes = 0;
+        };
+
+        // 按字节降序取前 top 项
+        template<class Totals>
+        auto largest(const std::map<std::string, Totals> &groups, std::size_t top)
+                -> std::vector<std::pair<std::string, Totals>> {
+            std::vector<std::pair<std::string, Totals>> sorted(groups.begin(),
+                                                               groups.end());
+            std::ranges::sort(sorted, [](const auto &a, const auto &b) {
+                return a.second.bytes > b.second.bytes;
+            });
+            if (sorted.size() > top) sorted.resize(top);
+            return sorted;
+        }
+    }
+
+    auto MXAllocationProfiler::get_profiler() -> MXAllocationProfiler & {
+        static MXAllocationProfiler instance{};
+        return instance;
+    }
+
+    auto MXAllocationProfiler::enable(std::size_t sample_bytes) -> void {
+        this->sample_bytes_ = std::max<std::size_t>(1, sample_bytes);
+        this->enabled_.store(true, std::memory_order_relaxed);
+    }
+
+    auto MXAllocationProfiler::on_allocate(void *memory, std::size_t size) -> void {
+        if (!armed) {
+            until_sample = next_distance(this->sample_bytes_);
+            armed = true;
+        }
+        until_sample -= static_cast<std::int64_t>(size);
+        if (until_sample > 0) return;
+        until_sample = next_distance(this->sample_bytes_);
+
+        Sample sample{ memory, size };
+        // 跳过 on_allocate 和 MXObject::operator new 两帧，第一帧就是 new 的调用方
+        sample.depth = capture_stack(sample.frames, MAX_DEPTH, 2);
+        const auto estimate = this->weight(size);
+        std::scoped_lock guard(this->lock_);
+        ++this->samples_;
+        auto &site = this->sites_[{ sample.frames, sample.frames + sample.depth }];
+        site.allocations += estimate;
+        site.bytes += estimate * static_cast<double>(size);
+        this->pending_.push_back(sample);
+        this->pending_count_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    auto MXAllocationProfiler::on_construct(MXObject *object) -> void {
+        if (this->pending_count_.load(std::memory_order_relaxed) == 0) return;
+        const auto address = reinterpret_cast<std::uintptr_t>(object);
+        std::scoped_lock guard(this->lock_);
+        // 虚继承时 MXObject 子对象不一定在分配块的开头，按地址范围匹配。
+        // 最外层对象的 MXObject 基类总是最先构造，先认领样本
+        auto it = std::ranges::find_if(this->pending_, [address](const Sample &sample) {
+            const auto start = reinterpret_cast<std::uintptr_t>(sample.memory);
+            return address >= start && address < start + sample.size;
+        });
+        if (it == this->pending_.end()) return;
+        this->live_.emplace(object, *it);
+        this->pending_.erase(it);
+        this->pending_count_.fetch_sub(1, std::memory_order_relaxed);
+        object->allocation_sampled = true;
+    }
+
+    auto MXAllocationProfiler::on_destroy(const MXObject *object) -> void {
+        std::scoped_lock guard(this->lock_);
+        this->live_.erase(object);
+    }
+
+    auto MXAllocationProfiler::on_free(void *memory) -> void {
+        // 只有构造函数抛出异常时，样本才会停留在 pending_ 里直到释放
+        if (this->pending_count_.load(std::memory_order_relaxed) == 0) return;
+        std::scoped_lock guard(this->lock_);
+        const auto removed = std::erase_if(this->pending_, [memory](const Sample &s) {
+            return s.memory == memory;
+        });
+        this->pending_count_.fetch_sub(removed, std::memory_order_relaxed);
+    }
+
+    auto MXAllocationProfiler::weight(std::size_t size) const -> double {
+        // 大小为 size 的分配被采中的概率是 1 - e^(-size/mean)，取倒数得到无偏估计
+        const auto rate =
+                static_cast<double>(size) / static_cast<double>(this->sample_bytes_);
+        return 1.0 / -std::expm1(-rate);
+    }
+
+    auto MXAllocationProfiler::report(std::ostream &out, const Symbolizer &symbolize,
+                                      std::size_t top) const -> void {
+        std::scoped_lock guard(this->lock_);
+        std::unordered_map<std::uintptr_t, Frame> frames;
+        auto frame = [&](std::uintptr_t address) -> const Frame & {
+            auto [it, inserted] = frames.try_emplace(address);
+            if (inserted)
+                it->second = symbolize ? symbolize(address) : dladdr_frame(address);
+            return it->second;
+        };
+        // 分配点取最内层的脚本帧，并注明实际执行 new 的函数
+        auto site_name = [&](const std::uintptr_t *stack, std::size_t depth) {
+            if (depth == 0) return std::string{ "(unknown)" };
+            const auto &allocator = frame(stack[0]);
+            for (std::size_t i = 0; i < depth; ++i) {
+                const auto &caller = frame(stack[i]);
+                if (!caller.script) continue;
+                if (i == 0) return caller.name;
+                return std::format("{} via {}", caller.name, allocator.name);
+            }
+            return allocator.name;
+        };
+
+        std::map<std::string, SiteTotals> sites;
+        for (const auto &[stack, site] : this->sites_) {
+            auto &totals = sites[site_name(stack.data(), stack.size())];
+            totals.allocations += site.allocations;
+            totals.bytes += site.bytes;
+        }
+        std::map<std::string, TypeTotals> types;
+        double live_objects = 0, live_bytes = 0;
+        for (const auto &[object, sample] : this->live_) {
+            const auto estimate = this->weight(sample.size);
+            const auto bytes = estimate * static_cast<double>(sample.size);
+            sites[site_name(sample.frames, sample.depth)].live_bytes += bytes;
+            auto &totals = types[object->runtime_type().name];
+            totals.objects += estimate;
+            totals.bytes += bytes;
+            live_objects += estimate;
+            live_bytes += bytes;
+        }
+
+        out << "===-------------------------------------------------------------===\n"
+               "                   mxs allocation profile\n"
+               "===-------------------------------------------------------------===\n";
+        out << std::format("  {} samples, one per ~{} bytes allocated; {} sampled "
+                           "objects live.\n  Counts and sizes are estimates.\n",
+                           this->samples_, this->sample_bytes_, this->live_.size());
+        out << "\n  Top allocation sites\n";
+        out << std::format("  {:>10}  {:>12}  {:>12}  {}\n", "Allocs", "Bytes (KiB)",
+                           "Live (KiB)", "Site");
+        for (const auto &[name, totals] : largest(sites, top)) {
+            out << std::format("  {:>10.0f}  {:>12.1f}  {:>12.1f}  {}\n",
+                               totals.allocations, totals.bytes / 1024.0,
+                               totals.live_bytes / 1024.0, name);
+        }
+        out << "\n  Live heap by type\n";
+        out << std::format("  {:>10}  {:>12}  {}\n", "Objects", "Bytes (KiB)", "Type");
+        for (const auto &[name, totals] : largest(types, top)) {
+            out << std::format("  {:>10.0f}  {:>12.1f}  {}\n", totals.objects,
+                               totals.bytes / 1024.0, name);
+        }
+        out << std::format("  {:>10.0f}  {:>12.1f}  Total\n", live_objects,
+                           live_bytes / 1024.0);
+    }
+}
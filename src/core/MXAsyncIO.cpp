@@ -0,0 +1,593 @@
+#include "mxspp/core/MXAsyncIO.h"
+#include "mxspp/core/MXError.h"
+#include "mxspp/core/MXNumeric.h"
+#include "mxspp/core/MXString.h"
+#include <algorithm>
+#include <arpa/inet.h>
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <netinet/in.h>
+#include <string_view>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <unordered_map>
+
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <sys/syscall.h>
+#define MXS_HAVE_IO_URING 1
+#endif
+
+namespace mxs::core {
+    namespace {
+        constexpr std::size_t BUFFER_SLOT_COUNT = 64;
+        constexpr std::size_t BUFFER_SLOT_SIZE = 16 * 1024;
+
+        auto io_error(std::int64_t result) -> MXObject * {
+            const auto *message = std::strerror(static_cast<int>(-result));
+            return std::make_unique<MXError>("IOError", message).release();
+        }
+
+        // Performs the request synchronously; used by the epoll backend once the
+        // fd is ready (or immediately for regular files, which epoll rejects).
+        auto perform(MXIORequest &request) -> std::int64_t {
+            ssize_t n = -1;
+            switch (request.op) {
+                case MXIOOp::READ:
+                    n = request.offset < 0
+                                ? ::read(request.fd, request.buffer, request.length)
+                                : ::pread(request.fd, request.buffer, request.length,
+                                          request.offset);
+                    break;
+                case MXIOOp::WRITE:
+                    n = request.offset < 0
+                                ? ::write(request.fd, request.buffer, request.length)
+                                : ::pwrite(request.fd, request.buffer, request.length,
+                                           request.offset);
+                    break;
+                case MXIOOp::ACCEPT:
+                    n = ::accept4(request.fd, nullptr, nullptr, SOCK_CLOEXEC);
+                    break;
+                case MXIOOp::CONNECT: {
+                    // 非阻塞 connect 已经发起，就绪后从 SO_ERROR 取结果
+                    int error = 0;
+                    socklen_t len = sizeof(error);
+                    if (::getsockopt(request.fd, SOL_SOCKET, SO_ERROR, &error, &len) != 0)
+                        return -errno;
+                    return -error;
+                }
+            }
+            return n < 0 ? -errno : n;
+        }
+
+        auto readiness_events(MXIOOp op) -> std::uint32_t {
+            return op == MXIOOp::READ || op == MXIOOp::ACCEPT ? EPOLLIN : EPOLLOUT;
+        }
+
+        class MXEpollIOBackend final : public MXIOBackend {
+        private:
+            // 同一 fd 上可能有多个协程在等待，按方向排队；epoll 只登记 fd 本身，
+            // 关注集随队列是否为空调整
+            struct FdWaiters {
+                std::deque<MXIORequest *> readers;
+                std::deque<MXIORequest *> writers;
+                std::uint32_t armed = 0;
+            };
+
+            int epoll_fd;
+            std::vector<MXIORequest *> queued;
+            std::vector<MXIORequest *> completed;
+            std::unordered_map<int, FdWaiters> waiters;
+
+            auto rearm(int fd, FdWaiters &entry) -> bool {
+                const std::uint32_t events = (entry.readers.empty() ? 0u : EPOLLIN)
+                                             | (entry.writers.empty() ? 0u : EPOLLOUT);
+                if (events == entry.armed) return true;
+                epoll_event ev{};
+                ev.events = events;
+                ev.data.fd = fd;
+                const int op = entry.armed == 0 ? EPOLL_CTL_ADD
+                               : events == 0    ? EPOLL_CTL_DEL
+                                                : EPOLL_CTL_MOD;
+                if (::epoll_ctl(this->epoll_fd, op, fd, &ev) != 0) return false;
+                entry.armed = events;
+                return true;
+            }
+
+            auto park(MXIORequest &request) -> bool {
+                auto &entry = this->waiters[request.fd];
+                auto &queue = readiness_events(request.op) == EPOLLIN ? entry.readers
+                                                                      : entry.writers;
+                queue.push_back(&request);
+                if (this->rearm(request.fd, entry)) return true;
+                const int error = errno;
+                queue.pop_back();
+                if (entry.readers.empty() && entry.writers.empty())
+                    this->waiters.erase(request.fd);
+                errno = error;
+                return false;
+            }
+
+            // 依次完成队首请求，直到某个请求再次 EAGAIN（伪唤醒，或数据已被前面的
+            // 请求取完），剩下的继续等待下一次就绪
+            static auto drain(std::deque<MXIORequest *> &queue, MXEventLoop &loop)
+                    -> std::size_t {
+                std::size_t finished = 0;
+                while (!queue.empty()) {
+                    auto *request = queue.front();
+                    request->result = perform(*request);
+                    if (request->result == -EAGAIN) break;
+                    queue.pop_front();
+                    loop.schedule(request->waiter);
+                    ++finished;
+                }
+                return finished;
+            }
+
+            static auto fail(std::deque<MXIORequest *> &queue, std::int64_t result,
+                             MXEventLoop &loop) -> std::size_t {
+                const std::size_t finished = queue.size();
+                for (auto *request : queue) {
+                    request->result = result;
+                    loop.schedule(request->waiter);
+                }
+                queue.clear();
+                return finished;
+            }
+
+        public:
+            MXEpollIOBackend() : epoll_fd(::epoll_create1(EPOLL_CLOEXEC)) { }
+            ~MXEpollIOBackend() override {
+                if (this->epoll_fd >= 0) ::close(this->epoll_fd);
+            }
+
+            auto submit(MXIORequest &request) -> void override {
+                this->queued.push_back(&request);
+                ++this->pending;
+            }
+
+            auto flush() -> void override {
+                for (auto *request : this->queued) {
+                    if (request->op == MXIOOp::CONNECT) {
+                        if (::connect(request->fd, request->address,
+                                      request->address_length)
+                            == 0) {
+                            request->result = 0;
+                            this->completed.push_back(request);
+                            continue;
+                        }
+                        if (errno != EINPROGRESS) {
+                            request->result = -errno;
+                            this->completed.push_back(request);
+                            continue;
+                        }
+                    }
+                    if (this->park(*request)) continue;
+                    // EPERM: 普通文件不支持 epoll，直接同步完成
+                    request->result = errno == EPERM ? perform(*request) : -errno;
+                    this->completed.push_back(request);
+                }
+                this->queued.clear();
+            }
+
+            auto reap(MXEventLoop &loop) -> std::size_t override {
+                std::size_t finished = this->completed.size();
+                for (auto *request : this->completed) loop.schedule(request->waiter);
+                this->completed.clear();
+
+                std::array<epoll_event, 64> events{};
+                const int n = ::epoll_wait(this->epoll_fd, events.data(),
+                                           static_cast<int>(events.size()), 0);
+                for (int i = 0; i < n; ++i) {
+                    const int fd = events[i].data.fd;
+                    const auto it = this->waiters.find(fd);
+                    if (it == this->waiters.end()) continue;
+                    auto &entry = it->second;
+                    const std::uint32_t ready = events[i].events;
+                    // 出错或挂断时两个方向都去执行一次，由系统调用给出具体错误
+                    const bool broken = ready & (EPOLLERR | EPOLLHUP);
+                    if (broken || (ready & EPOLLIN))
+                        finished += drain(entry.readers, loop);
+                    if (broken || (ready & EPOLLOUT))
+                        finished += drain(entry.writers, loop);
+                    if (!this->rearm(fd, entry)) {
+                        const std::int64_t error = -errno;
+                        finished += fail(entry.readers, error, loop);
+                        finished += fail(entry.writers, error, loop);
+                    }
+                    if (entry.readers.empty() && entry.writers.empty())
+                        this->waiters.erase(it);
+                }
+                this->pending -= finished;
+                return finished;
+            }
+
+            auto completion_fd() const -> int override { return this->epoll_fd; }
+            auto name() const -> const char * override { return "epoll"; }
+        };
+
+#ifdef MXS_HAVE_IO_URING
+        class MXIOUringBackend final : public MXIOBackend {
+        private:
+            int ring_fd = -1;
+            int event_fd = -1;
+            unsigned entries = 0;
+            unsigned to_submit = 0;
+            bool buffers_registered = false;
+
+            void *sq_ring = MAP_FAILED;
+            void *cq_ring = MAP_FAILED;
+            std::size_t sq_ring_size = 0;
+            std::size_t cq_ring_size = 0;
+            io_uring_sqe *sqes = static_cast<io_uring_sqe *>(MAP_FAILED);
+            std::size_t sqes_size = 0;
+
+            unsigned *sq_head = nullptr;
+            unsigned *sq_tail = nullptr;
+            unsigned *sq_mask = nullptr;
+            unsigned *sq_array = nullptr;
+            unsigned *cq_head = nullptr;
+            unsigned *cq_tail = nullptr;
+            unsigned *cq_mask = nullptr;
+            io_uring_cqe *cqes = nullptr;
+
+            // 提交队列满时暂存，下次 flush 后补交
+            std::vector<MXIORequest *> overflow;
+            // 在 flush 里就已结束的请求（提交失败，或为腾出完成队列提前收割的），
+            // 由下一次 reap 调度
+            std::vector<MXIORequest *> completed;
+            MXIOUringEnter enter_hook = nullptr;
+
+            static auto load_acquire(unsigned *p) -> unsigned {
+                return std::atomic_ref<unsigned>(*p).load(std::memory_order_acquire);
+            }
+            static auto store_release(unsigned *p, unsigned v) -> void {
+                std::atomic_ref<unsigned>(*p).store(v, std::memory_order_release);
+            }
+
+            auto enter(unsigned submit) -> int {
+                if (this->enter_hook) return this->enter_hook(this->ring_fd, submit);
+                const long n = ::syscall(__NR_io_uring_enter, this->ring_fd, submit, 0, 0,
+                                         nullptr, 0);
+                return static_cast<int>(n);
+            }
+
+            // 把完成队列里的结果搬进 completed，返回搬了几个
+            auto collect() -> std::size_t {
+                unsigned head = *this->cq_head;
+                const unsigned tail = load_acquire(this->cq_tail);
+                const std::size_t before = this->completed.size();
+                for (; head != tail; ++head) {
+                    const auto &cqe = this->cqes[head & *this->cq_mask];
+                    auto *request = reinterpret_cast<MXIORequest *>(cqe.user_data);
+                    request->result = cqe.res;
+                    this->completed.push_back(request);
+                }
+                store_release(this->cq_head, head);
+                return this->completed.size() - before;
+            }
+
+            // 提交失败：内核还没取走的提交队列项退回去，和暂存的请求一起以
+            // -error 结束。没有 SQPOLL 时内核只在 io_uring_enter 里读队尾，
+            // 两次调用之间改写它是安全的
+            auto fail_unsubmitted(int error) -> void {
+                const unsigned tail = *this->sq_tail;
+                const unsigned first = tail - this->to_submit;
+                for (unsigned i = first; i != tail; ++i) {
+                    const auto &sqe = this->sqes[i & *this->sq_mask];
+                    auto *request = reinterpret_cast<MXIORequest *>(sqe.user_data);
+                    request->result = -error;
+                    this->completed.push_back(request);
+                }
+                store_release(this->sq_tail, first);
+                this->to_submit = 0;
+                for (auto *request : this->overflow) {
+                    request->result = -error;
+                    this->completed.push_back(request);
+                }
+                this->overflow.clear();
+            }
+
+            auto prepare(MXIORequest &request) -> bool {
+                const unsigned tail = *this->sq_tail;
+                if (tail - load_acquire(this->sq_head) >= this->entries) return false;
+                const unsigned index = tail & *this->sq_mask;
+                auto &sqe = this->sqes[index];
+                std::memset(&sqe, 0, sizeof(sqe));
+                sqe.fd = request.fd;
+                sqe.user_data = reinterpret_cast<std::uint64_t>(&request);
+                const bool fixed = request.buffer_index >= 0 && this->buffers_registered;
+                switch (request.op) {
+                    case MXIOOp::READ:
+                    case MXIOOp::WRITE:
+                        if (request.op == MXIOOp::READ) {
+                            sqe.opcode = fixed ? IORING_OP_READ_FIXED : IORING_OP_READ;
+                        } else {
+                            sqe.opcode = fixed ? IORING_OP_WRITE_FIXED : IORING_OP_WRITE;
+                        }
+                        sqe.addr = reinterpret_cast<std::uint64_t>(request.buffer);
+                        sqe.len = static_cast<std::uint32_t>(request.length);
+                        sqe.off = static_cast<std::uint64_t>(request.offset);
+                        if (fixed) {
+                            sqe.buf_index =
+                                    static_cast<std::uint16_t>(request.buffer_index);
+                        }
+                        break;
+                    case MXIOOp::ACCEPT:
+                        sqe.opcode = IORING_OP_ACCEPT;
+                        sqe.accept_flags = SOCK_CLOEXEC;
+                        break;
+                    case MXIOOp::CONNECT:
+                        sqe.opcode = IORING_OP_CONNECT;
+                        sqe.addr = reinterpret_cast<std::uint64_t>(request.address);
+                        sqe.off = request.address_length;
+                        break;
+                }
+                this->sq_array[index] = index;
+                store_release(this->sq_tail, tail + 1);
+                ++this->to_submit;
+                return true;
+            }
+
+        public:
+            explicit MXIOUringBackend(MXIOUringEnter enter) : enter_hook(enter) { }
+            ~MXIOUringBackend() override {
+                if (this->sqes != MAP_FAILED) ::munmap(this->sqes, this->sqes_size);
+                if (this->cq_ring != MAP_FAILED && this->cq_ring != this->sq_ring)
+                    ::munmap(this->cq_ring, this->cq_ring_size);
+                if (this->sq_ring != MAP_FAILED) {
+                    ::munmap(this->sq_ring, this->sq_ring_size);
+                }
+                if (this->event_fd >= 0) ::close(this->event_fd);
+                if (this->ring_fd >= 0) ::close(this->ring_fd);
+            }
+
+            // Returns false when io_uring is unavailable (old kernel, seccomp).
+            auto setup(unsigned queue_depth) -> bool {
+                io_uring_params params{};
+                this->ring_fd = static_cast<int>(
+                        ::syscall(__NR_io_uring_setup, queue_depth, &params));
+                if (this->ring_fd < 0) return false;
+                this->entries = params.sq_entries;
+
+                this->sq_ring_size =
+                        params.sq_off.array + params.sq_entries * sizeof(unsigned);
+                this->cq_ring_size =
+                        params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+                const bool single_mmap = params.features & IORING_FEAT_SINGLE_MMAP;
+                if (single_mmap) {
+                    this->sq_ring_size = this->cq_ring_size =
+                            std::max(this->sq_ring_size, this->cq_ring_size);
+                }
+                constexpr int prot = PROT_READ | PROT_WRITE;
+                constexpr int flags = MAP_SHARED | MAP_POPULATE;
+                this->sq_ring = ::mmap(nullptr, this->sq_ring_size, prot, flags,
+                                       this->ring_fd, IORING_OFF_SQ_RING);
+                if (this->sq_ring == MAP_FAILED) return false;
+                this->cq_ring = single_mmap ? this->sq_ring
+                                            : ::mmap(nullptr, this->cq_ring_size, prot,
+                                                     flags, this->ring_fd,
+                                                     IORING_OFF_CQ_RING);
+                if (this->cq_ring == MAP_FAILED) return false;
+                this->sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+                void *sqes_ptr = ::mmap(nullptr, this->sqes_size, prot, flags,
+                                        this->ring_fd, IORING_OFF_SQES);
+                this->sqes = static_cast<io_uring_sqe *>(sqes_ptr);
+                if (this->sqes == MAP_FAILED) return false;
+
+                auto *sq = static_cast<std::byte *>(this->sq_ring);
+                auto *cq = static_cast<std::byte *>(this->cq_ring);
+                auto field = [](std::byte *ring, std::uint32_t offset) {
+                    return reinterpret_cast<unsigned *>(ring + offset);
+                };
+                this->sq_head = field(sq, params.sq_off.head);
+                this->sq_tail = field(sq, params.sq_off.tail);
+                this->sq_mask = field(sq, params.sq_off.ring_mask);
+                this->sq_array = field(sq, params.sq_off.array);
+                this->cq_head = field(cq, params.cq_off.head);
+                this->cq_tail = field(cq, params.cq_off.tail);
+                this->cq_mask = field(cq, params.cq_off.ring_mask);
+                this->cqes = reinterpret_cast<io_uring_cqe *>(cq + params.cq_off.cqes);
+
+                // 完成事件通过 eventfd 通知，事件循环的 epoll 只需监听这一个 fd
+                this->event_fd = ::eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+                if (this->event_fd < 0) return false;
+                if (::syscall(__NR_io_uring_register, this->ring_fd,
+                              IORING_REGISTER_EVENTFD, &this->event_fd, 1)
+                    != 0)
+                    return false;
+
+                auto iov = this->pool.iovecs();
+                this->buffers_registered =
+                        ::syscall(__NR_io_uring_register, this->ring_fd,
+                                  IORING_REGISTER_BUFFERS, iov.data(), iov.size())
+                        == 0;
+                return true;
+            }
+
+            auto submit(MXIORequest &request) -> void override {
+                ++this->pending;
+                if (!this->overflow.empty() || !this->prepare(request))
+                    this->overflow.push_back(&request);
+            }
+
+            auto flush() -> void override {
+                while (this->to_submit > 0) {
+                    const int submitted = this->enter(this->to_submit);
+                    if (submitted < 0) {
+                        const int error = errno;
+                        if (error == EINTR) continue;
+                        // 完成队列满（EBUSY）或内核暂时缺资源（EAGAIN）：收割腾出
+                        // 空间后重试。什么也没收割到时，还有在途的请求就留到下一次
+                        // flush（它们完成时事件循环会再来）；没有的话再等也不会有
+                        // 转机，按其他错误处理
+                        if (error == EAGAIN || error == EBUSY) {
+                            if (this->collect() > 0) continue;
+                            const std::size_t queued = this->to_submit
+                                                       + this->overflow.size()
+                                                       + this->completed.size();
+                            if (this->pending > queued) break;
+                        }
+                        this->fail_unsubmitted(error);
+                        break;
+                    }
+                    this->to_submit -= static_cast<unsigned>(submitted);
+                    std::size_t moved = 0;
+                    while (moved < this->overflow.size()
+                           && this->prepare(*this->overflow[moved]))
+                        ++moved;
+                    this->overflow.erase(this->overflow.begin(),
+                                         this->overflow.begin()
+                                                 + static_cast<std::ptrdiff_t>(moved));
+                }
+            }
+
+            auto reap(MXEventLoop &loop) -> std::size_t override {
+                std::uint64_t count = 0;
+                [[maybe_unused]] auto _ = ::read(this->event_fd, &count, sizeof(count));
+
+                this->collect();
+                const std::size_t finished = this->completed.size();
+                for (auto *request : this->completed) loop.schedule(request->waiter);
+                this->completed.clear();
+                this->pending -= finished;
+                return finished;
+            }
+
+            auto completion_fd() const -> int override { return this->event_fd; }
+            auto name() const -> const char * override { return "io_uring"; }
+        };
+#endif
+    }
+
+    MXIOBufferPool::MXIOBufferPool(std::size_t slot_count, std::size_t slot_size)
+        : slot_size(slot_size),
+          storage(static_cast<std::byte *>(
+                  std::aligned_alloc(4096, slot_count * slot_size))) {
+        for (std::size_t i = 0; i < slot_count && this->storage; ++i) {
+            this->slots.push_back({ this->storage + i * slot_size, slot_size });
+            this->free_slots.push_back(static_cast<int>(slot_count - 1 - i));
+        }
+    }
+    MXIOBufferPool::~MXIOBufferPool() { std::free(this->storage); }
+
+    auto MXIOBufferPool::acquire(std::size_t length) -> std::optional<int> {
+        if (length > this->slot_size || this->free_slots.empty()) return std::nullopt;
+        const int index = this->free_slots.back();
+        this->free_slots.pop_back();
+        return index;
+    }
+    auto MXIOBufferPool::release(int index) -> void { this->free_slots.push_back(index); }
+    auto MXIOBufferPool::data(int index) const -> std::byte * {
+        const auto &slot = this->slots[static_cast<std::size_t>(index)];
+        return static_cast<std::byte *>(slot.iov_base);
+    }
+    auto MXIOBufferPool::iovecs() -> std::span<iovec> { return this->slots; }
+
+    MXIOBackend::MXIOBackend() : pool(BUFFER_SLOT_COUNT, BUFFER_SLOT_SIZE) { }
+    MXIOBackend::~MXIOBackend() = default;
+
+    auto mx_make_io_backend() -> std::unique_ptr<MXIOBackend> {
+#ifdef MXS_HAVE_IO_URING
+        const char *forced = std::getenv("MXS_IO_BACKEND");
+        if (!forced || std::string_view{ forced } != "epoll") {
+            if (auto uring = mx_make_io_uring_backend()) return uring;
+        }
+#endif
+        return std::make_unique<MXEpollIOBackend>();
+    }
+
+    auto mx_make_io_uring_backend([[maybe_unused]] MXIOUringEnter enter)
+            -> std::unique_ptr<MXIOBackend> {
+#ifdef MXS_HAVE_IO_URING
+        auto uring = std::make_unique<MXIOUringBackend>(enter);
+        if (uring->setup(256)) return uring;
+#endif
+        return nullptr;
+    }
+
+    auto MXIOAwaiter::await_suspend(std::coroutine_handle<> handle) const -> void {
+        this->request.waiter = handle;
+        MXEventLoop::get_loop().io().submit(this->request);
+    }
+
+    auto mx_async_read(int fd, std::size_t length, std::int64_t offset) -> MXTask {
+        auto &pool = MXEventLoop::get_loop().io().buffers();
+        MXIORequest request{
+            .op = MXIOOp::READ, .fd = fd, .length = length, .offset = offset
+        };
+        std::string data;
+        const auto slot = pool.acquire(length);
+        if (slot) {
+            request.buffer = pool.data(*slot);
+            request.buffer_index = *slot;
+        } else {
+            data.resize(length);
+            request.buffer = data.data();
+        }
+
+        co_await MXIOAwaiter{ request };
+
+        if (slot) {
+            if (request.result > 0)
+                data.assign(reinterpret_cast<const char *>(pool.data(*slot)),
+                            static_cast<std::size_t>(request.result));
+            pool.release(*slot);
+        } else if (request.result >= 0) {
+            data.resize(static_cast<std::size_t>(request.result));
+        }
+        if (request.result < 0) co_return io_error(request.result);
+        co_return std::make_unique<MXString>(std::move(data)).release();
+    }
+
+    auto mx_async_write(int fd, std::string data, std::int64_t offset) -> MXTask {
+        auto &pool = MXEventLoop::get_loop().io().buffers();
+        MXIORequest request{
+            .op = MXIOOp::WRITE, .fd = fd, .length = data.size(), .offset = offset
+        };
+        const auto slot = pool.acquire(data.size());
+        if (slot) {
+            std::memcpy(pool.data(*slot), data.data(), data.size());
+            request.buffer = pool.data(*slot);
+            request.buffer_index = *slot;
+        } else {
+            request.buffer = data.data();
+        }
+
+        co_await MXIOAwaiter{ request };
+
+        if (slot) pool.release(*slot);
+        if (request.result < 0) co_return io_error(request.result);
+        co_return std::make_unique<builtin::MXInteger>(request.result).release();
+    }
+
+    auto mx_async_accept(int fd) -> MXTask {
+        MXIORequest request{ .op = MXIOOp::ACCEPT, .fd = fd };
+        co_await MXIOAwaiter{ request };
+        if (request.result < 0) co_return io_error(request.result);
+        co_return std::make_unique<builtin::MXInteger>(request.result).release();
+    }
+
+    auto mx_async_connect(int fd, std::string host, std::uint16_t port) -> MXTask {
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_port = htons(port);
+        if (::inet_pton(AF_INET, host.c_str(), &address.sin_addr) != 1) {
+            auto message = "invalid IPv4 address: " + host;
+            co_return std::make_unique<MXError>("IOError", std::move(message)).release();
+        }
+        MXIORequest request{ .op = MXIOOp::CONNECT,
+                             .fd = fd,
+                             .address = reinterpret_cast<const sockaddr *>(&address),
+                             .address_length = sizeof(address) };
+        co_await MXIOAwaiter{ request };
+        if (request.result < 0) co_return io_error(request.result);
+        co_return std::make_unique<builtin::MXInteger>(0).release();
+    }
+}
@@ -0,0 +1,23 @@
+#include "mxspp/core/MXBoolean.h"
+
+namespace mxs::builtin {
+    MXBoolean::MXBoolean(bool value, bool is_static)
+        : core::MXObject(is_static), value(value) { }
+
+    MXBoolean::~MXBoolean() = default;
+
+    auto MXBoolean::get_rtti() -> const core::MXRuntimeTypeInfo & {
+        static core::MXRuntimeTypeInfo instance{ "Boolean", &core::MXObject::get_rtti() };
+        return instance;
+    }
+
+    auto MXBoolean::runtime_type() const -> const core::MXRuntimeTypeInfo & {
+        return get_rtti();
+    }
+
+    auto MXBoolean::get_hash_code() const -> MXHashCode_t { return this->value ? 1 : 0; }
+
+    auto MXBoolean::repr() const -> core::repr_t {
+        return this->value ? "true" : "false";
+    }
+}
@@ -0,0 +1,26 @@
+#include "mxspp/core/MXClosure.h"
+#include <format>
+
+namespace mxs::core {
+    MXClosure::MXClosure(void *code, std::int64_t arity, std::size_t slots,
+                         bool is_static)
+        : MXObject(is_static), code(code), arity(arity) {
+        // 没有捕获的 lambda 不分配环境
+        if (slots) this->environment_ = std::make_unique<std::uint64_t[]>(slots);
+    }
+
+    MXClosure::~MXClosure() = default;
+
+    auto MXClosure::get_rtti() -> const MXRuntimeTypeInfo & {
+        static MXRuntimeTypeInfo instance{ "Closure", &MXObject::get_rtti() };
+        return instance;
+    }
+
+    auto MXClosure::runtime_type() const -> const MXRuntimeTypeInfo & {
+        return get_rtti();
+    }
+
+    auto MXClosure::repr() const -> repr_t {
+        return std::format("Closure(arity={})", this->arity);
+    }
+}
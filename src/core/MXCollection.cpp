@@ -0,0 +1,154 @@
+#include "mxspp/core/MXCollection.h"
+#include <format>
+#include <utility>
+
+namespace mxs::builtin {
+    namespace {
+        auto repr_of(const core::MXObject *value) -> core::repr_t {
+            return value ? value->repr() : "nil";
+        }
+    }
+
+    MXList::MXList(bool is_static) : core::MXObject(is_static) { }
+
+    MXList::~MXList() = default;
+
+    auto MXList::get_rtti() -> const core::MXRuntimeTypeInfo & {
+        static core::MXRuntimeTypeInfo instance{ "List", &core::MXObject::get_rtti() };
+        return instance;
+    }
+
+    auto MXList::runtime_type() const -> const core::MXRuntimeTypeInfo & {
+        return get_rtti();
+    }
+
+    auto MXList::append(MXObjectOwned value) -> void {
+        std::scoped_lock guard(this->lock_);
+        this->items_.push_back(std::move(value));
+    }
+
+    auto MXList::reserve(std::size_t capacity) -> void {
+        std::scoped_lock guard(this->lock_);
+        this->items_.reserve(capacity);
+    }
+
+    auto MXList::repr() const -> core::repr_t {
+        std::scoped_lock guard(this->lock_);
+        core::repr_t out = "[";
+        for (std::size_t i = 0; i < this->items_.size(); ++i) {
+            if (i > 0) out += ", ";
+            out += repr_of(this->items_[i].get());
+        }
+        return out + "]";
+    }
+
+    auto MXList::visit_references(const core::MXReferenceVisitor &visit) const -> void {
+        core::MXObject::visit_references(visit);
+        std::scoped_lock guard(this->lock_);
+        for (std::size_t i = 0; i < this->items_.size(); ++i) {
+            if (this->items_[i]) visit(std::format("[{}]", i), this->items_[i].get());
+        }
+    }
+
+    MXDict::MXDict(bool is_static) : core::MXObject(is_static) { }
+
+    MXDict::~MXDict() = default;
+
+    auto MXDict::get_rtti() -> const core::MXRuntimeTypeInfo & {
+        static core::MXRuntimeTypeInfo instance{ "Dict", &core::MXObject::get_rtti() };
+        return instance;
+    }
+
+    auto MXDict::runtime_type() const -> const core::MXRuntimeTypeInfo & {
+        return get_rtti();
+    }
+
+    auto MXDict::set(std::string key, MXObjectOwned value) -> void {
+        // 被替换的旧值在锁外析构：析构要通知分配分析器，而堆快照正持有分析器
+        // 的锁等本对象的锁
+        MXObjectOwned replaced;
+        std::scoped_lock guard(this->lock_);
+        if (auto it = this->items_.find(key); it != this->items_.end()) {
+            replaced = std::exchange(it->second, std::move(value));
+            return;
+        }
+        this->order_.push_back(key);
+        this->items_.emplace(std::move(key), std::move(value));
+    }
+
+    auto MXDict::contains(std::string_view key) const -> bool {
+        std::scoped_lock guard(this->lock_);
+        return this->items_.find(key) != this->items_.end();
+    }
+
+    auto MXDict::get(std::string_view key) const -> core::MXObject * {
+        std::scoped_lock guard(this->lock_);
+        auto it = this->items_.find(key);
+        return it == this->items_.end() ? nullptr : it->second.get();
+    }
+
+    auto MXDict::repr() const -> core::repr_t {
+        std::scoped_lock guard(this->lock_);
+        core::repr_t out = "{";
+        for (std::size_t i = 0; i < this->order_.size(); ++i) {
+            if (i > 0) out += ", ";
+            const auto &key = this->order_[i];
+            const auto &value = this->items_.find(key)->second;
+            out += std::format("\"{}\": {}", key, repr_of(value.get()));
+        }
+        return out + "}";
+    }
+
+    auto MXDict::visit_references(const core::MXReferenceVisitor &visit) const -> void {
+        core::MXObject::visit_references(visit);
+        std::scoped_lock guard(this->lock_);
+        for (const auto &key : this->order_) {
+            const auto &value = this->items_.find(key)->second;
+            if (value) visit(std::format("[\"{}\"]", key), value.get());
+        }
+    }
+
+    MXArray::MXArray(storage_t values, bool is_static)
+        : core::MXObject(is_static), values_(std::move(values)) { }
+
+    MXArray::~MXArray() = default;
+
+    auto MXArray::get_rtti() -> const core::MXRuntimeTypeInfo & {
+        static core::MXRuntimeTypeInfo instance{ "Array", &core::MXObject::get_rtti() };
+        return instance;
+    }
+
+    auto MXArray::runtime_type() const -> const core::MXRuntimeTypeInfo & {
+        return get_rtti();
+    }
+
+    auto MXArray::size() const -> std::size_t {
+        return std::visit([](const auto &values) { return values.size(); },
+                          this->values_);
+    }
+
+    auto MXArray::integers() const -> std::span<const std::int64_t> {
+        if (auto *values = std::get_if<std::vector<std::int64_t>>(&this->values_))
+            return *values;
+        return {};
+    }
+
+    auto MXArray::floats() const -> std::span<const double> {
+        if (auto *values = std::get_if<std::vector<double>>(&this->values_))
+            return *values;
+        return {};
+    }
+
+    auto MXArray::repr() const -> core::repr_t {
+        return std::visit(
+                [](const auto &values) {
+                    core::repr_t out = "Array[";
+                    for (std::size_t i = 0; i < values.size(); ++i) {
+                        if (i > 0) out += ", ";
+                        out += std::format("{}", values[i]);
+                    }
+                    return out + "]";
+                },
+                this->values_);
+    }
+}
@@ -0,0 +1,179 @@
+#include "mxspp/core/MXCsv.h"
+#include "mxspp/core/MXCollection.h"
+#include "mxspp/core/MXSimdScan.h"
+#include "mxspp/core/MXString.h"
+#include <algorithm>
+#include <charconv>
+#include <format>
+
+namespace mxs::core {
+    namespace {
+        constexpr auto npos = static_cast<std::size_t>(-1);
+
+        template<typename T>
+        auto parse_number(std::string_view text, T &out) -> bool {
+            const char *last = text.data() + text.size();
+            const auto [ptr, ec] = std::from_chars(text.data(), last, out);
+            return !text.empty() && ec == std::errc{} && ptr == last;
+        }
+    }
+
+    MXCsvReader::MXCsvReader(std::shared_ptr<const MXMappedRegion> input, char delimiter,
+                             bool is_static)
+        : MXObject(is_static), input_(std::move(input)), bytes_(input_->view()),
+          delimiter_(delimiter) { }
+
+    MXCsvReader::~MXCsvReader() = default;
+
+    auto MXCsvReader::get_rtti() -> const MXRuntimeTypeInfo & {
+        static MXRuntimeTypeInfo instance{ "CsvReader", &MXObject::get_rtti() };
+        return instance;
+    }
+
+    auto MXCsvReader::runtime_type() const -> const MXRuntimeTypeInfo & {
+        return get_rtti();
+    }
+
+    auto MXCsvReader::index_block(std::size_t base) -> void {
+        const MXScanBlock block{ this->bytes_.data() + base,
+                                 std::min(MX_SCAN_BLOCK, this->bytes_.size() - base) };
+        // "" 转义会让引号状态翻转两次，前缀异或天然正确
+        const std::uint64_t in_quotes = mx_prefix_xor(block.eq('"')) ^ this->in_quotes_;
+        this->in_quotes_ =
+                static_cast<std::uint64_t>(static_cast<std::int64_t>(in_quotes) >> 63);
+        std::uint64_t separators =
+                (block.eq(this->delimiter_) | block.eq('\n')) & ~in_quotes;
+        while (separators != 0)
+            this->separators_.push_back(base + mx_pop_bit(separators));
+    }
+
+    auto MXCsvReader::index_chunk() -> bool {
+        if (this->indexed_ >= this->bytes_.size()) return false;
+        this->separators_.clear();
+        this->cursor_ = 0;
+        const std::size_t stop =
+                std::min(this->bytes_.size(), this->indexed_ + INDEX_CHUNK);
+        for (std::size_t base = this->indexed_; base < stop; base += MX_SCAN_BLOCK)
+            this->index_block(base);
+        this->indexed_ = stop;
+        return true;
+    }
+
+    auto MXCsvReader::next_separator() -> std::size_t {
+        while (this->cursor_ == this->separators_.size()) {
+            if (!this->index_chunk()) return npos;
+        }
+        return this->separators_[this->cursor_++];
+    }
+
+    auto MXCsvReader::add_field(std::vector<Field> &fields, std::size_t begin,
+                                std::size_t end) const -> void {
+        std::string_view text = this->bytes_.substr(begin, end - begin);
+        const bool at_record_end =
+                end == this->bytes_.size() || this->bytes_[end] == '\n';
+        if (at_record_end && text.ends_with('\r')) text.remove_suffix(1);
+        const bool quoted = text.size() >= 2 && text.front() == '"' && text.back() == '"';
+        if (quoted) text = text.substr(1, text.size() - 2);
+        fields.push_back({ text, quoted });
+    }
+
+    auto MXCsvReader::read_record(std::vector<Field> &fields) -> bool {
+        fields.clear();
+        const std::size_t size = this->bytes_.size();
+        while (true) {
+            const std::size_t sep = this->next_separator();
+            if (sep == npos) {
+                // 末尾没有换行的最后一条记录
+                if (this->field_start_ > size) return false;
+                if (this->field_start_ == size && fields.empty()) return false;
+                this->add_field(fields, this->field_start_, size);
+                this->field_start_ = size + 1;
+                return true;
+            }
+            this->add_field(fields, this->field_start_, sep);
+            this->field_start_ = sep + 1;
+            if (this->bytes_[sep] != '\n') continue;
+            const bool blank =
+                    fields.size() == 1 && fields[0].text.empty() && !fields[0].quoted;
+            if (!blank) return true;
+            fields.clear();
+        }
+    }
+
+    auto MXCsvReader::make_string(const Field &field) const -> MXObjectOwned {
+        if (!field.quoted || field.text.find('"') == std::string_view::npos)
+            return std::make_unique<MXStringView>(this->input_, field.text);
+        std::string text;
+        text.reserve(field.text.size());
+        // 引号内的 "" 还原成一个 "
+        const std::string_view raw = field.text;
+        for (std::size_t i = 0; i < raw.size(); ++i) {
+            text += raw[i];
+            if (raw[i] == '"' && i + 1 < raw.size() && raw[i + 1] == '"') ++i;
+        }
+        return std::make_unique<MXString>(std::move(text));
+    }
+
+    auto MXCsvReader::make_column(const std::vector<const Field *> &cells) const
+            -> MXObjectOwned {
+        std::vector<std::int64_t> integers;
+        integers.reserve(cells.size());
+        for (const Field *cell : cells) {
+            std::int64_t value = 0;
+            if (!cell || !parse_number(cell->text, value)) break;
+            integers.push_back(value);
+        }
+        if (integers.size() == cells.size())
+            return std::make_unique<builtin::MXArray>(std::move(integers));
+
+        std::vector<double> floats;
+        floats.reserve(cells.size());
+        for (const Field *cell : cells) {
+            double value = 0;
+            if (!cell || !parse_number(cell->text, value)) break;
+            floats.push_back(value);
+        }
+        if (floats.size() == cells.size())
+            return std::make_unique<builtin::MXArray>(std::move(floats));
+
+        auto column = std::make_unique<builtin::MXList>();
+        column->reserve(cells.size());
+        for (const Field *cell : cells)
+            column->append(cell ? this->make_string(*cell)
+                                : std::make_unique<MXString>(std::string{}));
+        return column;
+    }
+
+    auto MXCsvReader::next_row() -> MXObjectOwned {
+        if (!this->read_record(this->record_)) return nullptr;
+        auto row = std::make_unique<builtin::MXList>();
+        row->reserve(this->record_.size());
+        for (const Field &field : this->record_) row->append(this->make_string(field));
+        return row;
+    }
+
+    auto MXCsvReader::next_batch(std::size_t rows) -> MXObjectOwned {
+        std::vector<std::vector<Field>> records;
+        std::size_t width = 0;
+        while (records.size() < rows && this->read_record(this->record_)) {
+            width = std::max(width, this->record_.size());
+            records.push_back(this->record_);
+        }
+        if (records.empty()) return nullptr;
+
+        auto columns = std::make_unique<builtin::MXList>();
+        columns->reserve(width);
+        std::vector<const Field *> cells(records.size());
+        for (std::size_t col = 0; col < width; ++col) {
+            // 短行缺失的单元格记为 nullptr，按空字符串处理
+            for (std::size_t row = 0; row < records.size(); ++row)
+                cells[row] = col < records[row].size() ? &records[row][col] : nullptr;
+            columns->append(this->make_column(cells));
+        }
+        return columns;
+    }
+
+    auto MXCsvReader::repr() const -> repr_t {
+        return std::format("CsvReader(offset={})", this->indexed_);
+    }
+}
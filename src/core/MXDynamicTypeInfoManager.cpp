@@ -17,6 +17,11 @@ namespace mxs::core {
 
         return rtti;
     }
+
+    auto MXDynamicTypeInfoManager::runtime_type() const -> const MXRuntimeTypeInfo & {
+        return get_rtti();
+    }
+
     auto MXDynamicTypeInfoManager::register_newtype(const MXRuntimeTypeInfo *const obj)
             -> void {
         std::scoped_lock guard(this->lock);
@@ -19,6 +19,13 @@ namespace mxs::core {
         return instance;
     }
 
+    auto MXError::runtime_type() const -> const MXRuntimeTypeInfo & { return get_rtti(); }
+
+    auto MXError::visit_references(const MXReferenceVisitor &visit) const -> void {
+        MXObject::visit_references(visit);
+        if (this->alternative_) visit("alternative", this->alternative_.get());
+    }
+
     auto MXError::repr() const -> repr_t {
         return std::format("{}(panic={}): {}", this->error_type_, this->panic_,
                            this->message_);
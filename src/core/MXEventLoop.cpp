@@ -0,0 +1,145 @@
+#include "mxspp/core/MXEventLoop.h"
+#include "mxspp/core/MXAsyncIO.h"
+#include "mxspp/core/MXMetrics.h"
+#include "mxspp/core/MXPopulationManager.h"
+#include "mxspp/core/MXTrace.h"
+#include <array>
+#include <cerrno>
+#include <sys/epoll.h>
+#include <exception>
+#include <unistd.h>
+
+namespace mxs::core {
+    auto MXTask::FinalAwaiter::await_suspend(std::coroutine_handle<> handle) const
+            noexcept -> void {
+        auto &promise = MXCoroutineHandle::from_address(handle.address()).promise();
+        if (auto *continuation = promise.continuation) {
+            MXEventLoop::get_loop().schedule(
+                    std::coroutine_handle<>::from_address(continuation));
+        }
+    }
+    auto MXTask::promise_type::get_return_object() -> MXTask {
+        auto handle = std::coroutine_handle<promise_type>::from_promise(*this);
+        return MXTask{ handle.address() };
+    }
+    auto MXTask::promise_type::unhandled_exception() -> void { std::terminate(); }
+    MXTask::~MXTask() {
+        if (this->frame) std::coroutine_handle<>::from_address(this->frame).destroy();
+    }
+    auto MXTask::release() -> void * {
+        if (this->frame) MXEventLoop::get_loop().adopt_task(this->frame);
+        return std::exchange(this->frame, nullptr);
+    }
+
+    MXEventLoop::MXEventLoop() : epoll_fd(::epoll_create1(EPOLL_CLOEXEC)) { }
+    MXEventLoop::~MXEventLoop() {
+        this->io_backend.reset();
+        if (this->epoll_fd >= 0) ::close(this->epoll_fd);
+    }
+
+    auto MXEventLoop::get_loop() -> MXEventLoop & {
+        static thread_local MXEventLoop instance{};
+        return instance;
+    }
+    auto MXEventLoop::get_rtti() -> MXRuntimeTypeInfo & {
+        static MXRuntimeTypeInfo instance{ "mxs::core::MXEventLoop", nullptr };
+        return instance;
+    }
+
+    auto MXEventLoop::io() -> MXIOBackend & {
+        if (!this->io_backend) {
+            this->io_backend = mx_make_io_backend();
+            // 完成通知 fd 保持水平触发，用 this 作为哨兵与协程句柄区分
+            epoll_event ev{};
+            ev.events = EPOLLIN;
+            ev.data.ptr = this;
+            const int fd = this->io_backend->completion_fd();
+            if (this->epoll_fd >= 0) ::epoll_ctl(this->epoll_fd, EPOLL_CTL_ADD, fd, &ev);
+        }
+        return *this->io_backend;
+    }
+
+    auto MXEventLoop::schedule(std::coroutine_handle<> handle) -> void {
+        if (handle) this->ready.push_back(handle);
+    }
+
+    auto MXEventLoop::adopt_task(void *frame) -> void {
+        if (frame) this->tasks.insert(frame);
+    }
+    auto MXEventLoop::owns_task(void *frame) const -> bool {
+        return this->tasks.contains(frame);
+    }
+    auto MXEventLoop::forget_task(void *frame) -> bool {
+        return this->tasks.erase(frame) != 0;
+    }
+
+    auto MXEventLoop::await_fd(std::coroutine_handle<> handle, int fd,
+                               std::uint32_t events) -> bool {
+        if (this->epoll_fd < 0) return false;
+        epoll_event ev{};
+        ev.events = events | EPOLLONESHOT;
+        ev.data.ptr = handle.address();
+        // ONESHOT 触发后 fd 仍留在 epoll 集合中，再次等待时需要 MOD
+        if (::epoll_ctl(this->epoll_fd, EPOLL_CTL_ADD, fd, &ev) != 0) {
+            if (errno != EEXIST) return false;
+            if (::epoll_ctl(this->epoll_fd, EPOLL_CTL_MOD, fd, &ev) != 0) return false;
+        }
+        ++this->waiting_io;
+        return true;
+    }
+
+    auto MXEventLoop::run_once(int timeout_ms) -> std::size_t {
+        std::size_t resumed = 0;
+        // 只处理本轮开始时已就绪的协程，它们新调度的协程留到下一轮
+        for (auto n = this->ready.size(); n > 0; --n) {
+            auto handle = this->ready.front();
+            this->ready.pop_front();
+            handle.resume();
+            ++resumed;
+        }
+        static auto &resumptions = MXMetricsRegistry::get_registry().counter(
+                "mxs_event_loop_resumptions_total", "Coroutines resumed by event loops.");
+        if (resumed > 0) resumptions.add(resumed);
+        // 本轮发起的所有 I/O 一次性提交给内核
+        const bool io_pending = this->io_backend && this->io_backend->in_flight() > 0;
+        if (io_pending) {
+            this->io_backend->flush();
+            if (this->io_backend->reap(*this) > 0) return resumed;
+        }
+        if ((this->waiting_io == 0 && !io_pending) || this->epoll_fd < 0) return resumed;
+
+        std::array<epoll_event, 64> events{};
+        const int timeout = this->ready.empty() ? timeout_ms : 0;
+        MXTracer::Scope trace("io", "epoll wait");
+        const int n = [&] {
+            // 等待期间不碰对象，堆快照不必等这个线程
+            MXPopulationManager::Parked parked;
+            return ::epoll_wait(this->epoll_fd, events.data(),
+                                static_cast<int>(events.size()), timeout);
+        }();
+        trace.set_value(n);
+        for (int i = 0; i < n; ++i) {
+            if (events[i].data.ptr == this) {
+                this->io_backend->reap(*this);
+                continue;
+            }
+            --this->waiting_io;
+            this->ready.push_back(
+                    std::coroutine_handle<>::from_address(events[i].data.ptr));
+        }
+        return resumed;
+    }
+
+    auto MXEventLoop::run_until(std::coroutine_handle<> handle) -> void {
+        while (!handle.done() && this->has_pending()) this->run_once(-1);
+    }
+
+    auto MXEventLoop::run() -> void {
+        while (this->has_pending()) this->run_once(-1);
+    }
+
+    auto MXEventLoop::has_pending() const -> bool {
+        return !this->ready.empty() || this->waiting_io > 0
+               || (this->io_backend && this->io_backend->in_flight() > 0);
+    }
+}
@@ -0,0 +1,88 @@
+#include "mxspp/core/MXFile.h"
+#include "mxspp/core/MXError.h"
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <format>
+#include <unistd.h>
+
+namespace mxs::core {
+    MXFile::MXFile(std::string path, int fd, bool writable)
+        : MXObject(false), path_(std::move(path)), fd_(fd) {
+        if (writable) {
+            // fd 的所有权交给 writer，由它负责 flush 和 close
+            this->writer_ = std::make_unique<MXOutputStream>(
+                    fd, MXOutputStream::default_policy(fd), true);
+        }
+    }
+
+    MXFile::~MXFile() { this->close(); }
+
+    auto MXFile::get_rtti() -> const MXRuntimeTypeInfo & {
+        static MXRuntimeTypeInfo instance{ "File", &MXObject::get_rtti() };
+        return instance;
+    }
+
+    auto MXFile::runtime_type() const -> const MXRuntimeTypeInfo & { return get_rtti(); }
+
+    auto MXFile::open(const std::string &path, std::string_view mode) -> MXObjectOwned {
+        int flags = 0;
+        if (mode == "r" || mode == "rm") {
+            flags = O_RDONLY;
+        } else if (mode == "w") {
+            flags = O_WRONLY | O_CREAT | O_TRUNC;
+        } else if (mode == "a") {
+            flags = O_WRONLY | O_CREAT | O_APPEND;
+        } else {
+            return std::make_unique<MXError>("ValueError",
+                                             std::format("invalid file mode '{}'", mode));
+        }
+        const int fd = ::open(path.c_str(), flags | O_CLOEXEC, 0644);
+        if (fd < 0) {
+            return std::make_unique<MXError>(
+                    "IOError", std::format("{}: {}", path, std::strerror(errno)));
+        }
+        const bool writable = mode == "w" || mode == "a";
+        auto file = std::unique_ptr<MXFile>(new MXFile(path, fd, writable));
+        if (mode == "rm" && !file->mapping()) {
+            return std::make_unique<MXError>(
+                    "IOError", std::format("{}: mmap: {}", path, std::strerror(errno)));
+        }
+        return file;
+    }
+
+    auto MXFile::write(std::string_view data) -> bool {
+        return this->writer_ && this->writer_->write(data);
+    }
+
+    auto MXFile::flush() -> bool { return !this->writer_ || this->writer_->flush(); }
+
+    auto MXFile::close() -> bool {
+        if (this->fd_ < 0) return true;
+        const bool ok = this->writer_ ? this->writer_->close() : ::close(this->fd_) == 0;
+        this->fd_ = -1;
+        return ok;
+    }
+
+    auto MXFile::mapping() -> std::shared_ptr<const MXMappedRegion> {
+        if (!this->mapping_ && this->fd_ >= 0 && !this->writer_)
+            this->mapping_ = MXMappedRegion::map(this->fd_);
+        return this->mapping_;
+    }
+
+    auto MXFile::lines() -> MXObjectOwned {
+        auto region = this->mapping();
+        if (!region) {
+            return std::make_unique<MXError>(
+                    "IOError", std::format("{}: file is not readable", this->path_));
+        }
+        return std::make_unique<MXLineIterator>(std::move(region));
+    }
+
+    auto MXFile::visit_references(const MXReferenceVisitor &visit) const -> void {
+        MXObject::visit_references(visit);
+        if (this->writer_) visit("writer", this->writer_.get());
+    }
+
+    auto MXFile::repr() const -> repr_t { return std::format("File({})", this->path_); }
+}
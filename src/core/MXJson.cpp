@@ -0,0 +1,410 @@
+#include "mxspp/core/MXJson.h"
+#include "mxspp/core/MXBoolean.h"
+#include "mxspp/core/MXCollection.h"
+#include "mxspp/core/MXError.h"
+#include "mxspp/core/MXNil.h"
+#include "mxspp/core/MXNumeric.h"
+#include "mxspp/core/MXSimdScan.h"
+#include "mxspp/core/MXString.h"
+#include <algorithm>
+#include <charconv>
+#include <format>
+
+namespace mxs::core {
+    namespace {
+        constexpr auto npos = static_cast<std::size_t>(-1);
+
+        // 标记被奇数个反斜杠转义的字节（simdjson 的 find_escaped）
+        auto find_escaped(std::uint64_t backslash, std::uint64_t &prev_escaped)
+                -> std::uint64_t {
+            constexpr std::uint64_t even_bits = 0x5555555555555555ULL;
+            backslash &= ~prev_escaped;
+            const std::uint64_t follows_escape = backslash << 1 | prev_escaped;
+            const std::uint64_t odd_starts = backslash & ~even_bits & ~follows_escape;
+            std::uint64_t even_starts = 0;
+            prev_escaped = __builtin_add_overflow(odd_starts, backslash, &even_starts);
+            const std::uint64_t invert_mask = even_starts << 1;
+            return (even_bits ^ invert_mask) & follows_escape;
+        }
+
+        auto is_delimiter(char c) -> bool {
+            constexpr std::string_view delimiters{ " \t\n\r{}[]:,\"" };
+            return delimiters.find(c) != std::string_view::npos;
+        }
+
+        // RFC 8259 的 number 文法：-?(0|[1-9][0-9]*)(.[0-9]+)?([eE][+-]?[0-9]+)?
+        // from_chars 还接受 nan、inf 和前导零，转换前先按文法过滤
+        auto is_json_number(std::string_view token) -> bool {
+            std::size_t i = 0;
+            const auto digits = [&] {
+                const std::size_t start = i;
+                while (i < token.size() && token[i] >= '0' && token[i] <= '9') ++i;
+                return i > start;
+            };
+            if (i < token.size() && token[i] == '-') ++i;
+            if (i < token.size() && token[i] == '0') {
+                ++i;
+            } else if (!digits()) {
+                return false;
+            }
+            if (i < token.size() && token[i] == '.') {
+                ++i;
+                if (!digits()) return false;
+            }
+            if (i < token.size() && (token[i] == 'e' || token[i] == 'E')) {
+                ++i;
+                if (i < token.size() && (token[i] == '+' || token[i] == '-')) ++i;
+                if (!digits()) return false;
+            }
+            return i == token.size();
+        }
+
+        auto hex_value(std::string_view digits, std::uint32_t &out) -> bool {
+            const char *last = digits.data() + digits.size();
+            const auto [ptr, ec] = std::from_chars(digits.data(), last, out, 16);
+            return ec == std::errc{} && ptr == last;
+        }
+
+        auto append_utf8(std::string &out, std::uint32_t code) -> void {
+            if (code < 0x80) {
+                out += static_cast<char>(code);
+            } else if (code < 0x800) {
+                out += static_cast<char>(0xC0 | (code >> 6));
+                out += static_cast<char>(0x80 | (code & 0x3F));
+            } else if (code < 0x10000) {
+                out += static_cast<char>(0xE0 | (code >> 12));
+                out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+                out += static_cast<char>(0x80 | (code & 0x3F));
+            } else {
+                out += static_cast<char>(0xF0 | (code >> 18));
+                out += static_cast<char>(0x80 | ((code >> 12) & 0x3F));
+                out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+                out += static_cast<char>(0x80 | (code & 0x3F));
+            }
+        }
+    }
+
+    MXJsonReader::MXJsonReader(std::shared_ptr<const MXMappedRegion> input,
+                               bool is_static)
+        : MXObject(is_static), input_(std::move(input)), bytes_(input_->view()) { }
+
+    MXJsonReader::~MXJsonReader() = default;
+
+    auto MXJsonReader::get_rtti() -> const MXRuntimeTypeInfo & {
+        static MXRuntimeTypeInfo instance{ "JsonReader", &MXObject::get_rtti() };
+        return instance;
+    }
+
+    auto MXJsonReader::runtime_type() const -> const MXRuntimeTypeInfo & {
+        return get_rtti();
+    }
+
+    auto MXJsonReader::parse(std::string text) -> MXObjectOwned {
+        MXJsonReader reader{ MXMappedRegion::adopt(std::move(text)) };
+        const std::size_t first = reader.peek_structural();
+        if (first == npos) return reader.fail("empty input", 0);
+        auto value = reader.next();
+        if (!reader.error_.empty()) return value;
+        if (const std::size_t extra = reader.peek_structural(); extra != npos)
+            return reader.fail("trailing content", extra);
+        return value;
+    }
+
+    auto MXJsonReader::done() -> bool {
+        return this->reported_ || this->peek_structural() == npos;
+    }
+
+    auto MXJsonReader::next() -> MXObjectOwned {
+        if (!this->error_.empty()) {
+            return std::make_unique<MXError>("JSONError", this->error_);
+        }
+        const std::size_t pos = this->next_structural();
+        if (pos == npos) return nullptr;
+        auto value = this->parse_value(pos, 0);
+        if (!this->error_.empty()) {
+            this->reported_ = true;
+            return std::make_unique<MXError>("JSONError", this->error_);
+        }
+        // 顶层 null 不能返回 nullptr，那表示输入已经读完
+        if (!value) return std::make_unique<builtin::MXNil>();
+        return value;
+    }
+
+    auto MXJsonReader::fail(std::string_view what, std::size_t pos) -> MXObjectOwned {
+        if (this->error_.empty()) this->error_ = std::format("{} at byte {}", what, pos);
+        this->reported_ = true;
+        return std::make_unique<MXError>("JSONError", this->error_);
+    }
+
+    // --- Stage 1: structural index ---
+
+    auto MXJsonReader::index_block(std::size_t base) -> void {
+        const MXScanBlock block{ this->bytes_.data() + base,
+                                 std::min(MX_SCAN_BLOCK, this->bytes_.size() - base) };
+        const std::uint64_t escaped = find_escaped(block.eq('\\'), this->escaped_);
+        const std::uint64_t quotes = block.eq('"') & ~escaped;
+        const std::uint64_t in_string = mx_prefix_xor(quotes) ^ this->in_string_;
+        this->in_string_ =
+                static_cast<std::uint64_t>(static_cast<std::int64_t>(in_string) >> 63);
+        // RFC 8259 要求字符串里的控制字节必须转义；这里只记下第一个的位置
+        if (const std::uint64_t control = block.control() & in_string;
+            control != 0 && this->control_ == npos)
+            this->control_ = base + static_cast<std::size_t>(__builtin_ctzll(control));
+
+        const std::uint64_t whitespace =
+                block.eq(' ') | block.eq('\t') | block.eq('\n') | block.eq('\r');
+        const std::uint64_t operators = block.eq('{') | block.eq('}') | block.eq('[')
+                                        | block.eq(']') | block.eq(':') | block.eq(',');
+        // 标量（数字、true/false/null）只记录起点
+        const std::uint64_t scalar = ~(operators | whitespace | quotes) & ~in_string;
+        const std::uint64_t scalar_start = scalar & ~(scalar << 1 | this->in_scalar_);
+        this->in_scalar_ = scalar >> 63;
+
+        std::uint64_t structural =
+                (operators & ~in_string) | (quotes & in_string) | scalar_start;
+        while (structural != 0)
+            this->structurals_.push_back(base + mx_pop_bit(structural));
+    }
+
+    auto MXJsonReader::index_chunk() -> bool {
+        if (this->indexed_ >= this->bytes_.size()) return false;
+        this->structurals_.clear();
+        this->cursor_ = 0;
+        const std::size_t stop =
+                std::min(this->bytes_.size(), this->indexed_ + INDEX_CHUNK);
+        for (std::size_t base = this->indexed_; base < stop; base += MX_SCAN_BLOCK)
+            this->index_block(base);
+        this->indexed_ = stop;
+        return true;
+    }
+
+    auto MXJsonReader::peek_structural() -> std::size_t {
+        while (this->cursor_ == this->structurals_.size()) {
+            if (!this->index_chunk()) return npos;
+        }
+        return this->structurals_[this->cursor_];
+    }
+
+    auto MXJsonReader::next_structural() -> std::size_t {
+        const std::size_t pos = this->peek_structural();
+        if (pos != npos) ++this->cursor_;
+        return pos;
+    }
+
+    // --- Stage 2: build values from the index ---
+
+    auto MXJsonReader::parse_value(std::size_t pos, int depth) -> MXObjectOwned {
+        switch (this->bytes_[pos]) {
+            case '{':
+                return this->parse_object(depth + 1);
+            case '[':
+                return this->parse_array(depth + 1);
+            case '"': {
+                std::string_view text;
+                bool borrowed = false;
+                if (!this->read_string(pos, text, borrowed)) return nullptr;
+                if (borrowed) return std::make_unique<MXStringView>(this->input_, text);
+                return std::make_unique<MXString>(std::string{ text });
+            }
+            case '}':
+            case ']':
+            case ':':
+            case ',':
+                return this->fail(std::format("unexpected '{}'", this->bytes_[pos]), pos);
+            default:
+                return this->parse_scalar(pos);
+        }
+    }
+
+    auto MXJsonReader::parse_object(int depth) -> MXObjectOwned {
+        const std::size_t end = this->bytes_.size();
+        std::size_t pos = this->next_structural();
+        if (depth > MAX_DEPTH) return this->fail("nesting too deep", std::min(pos, end));
+        auto dict = std::make_unique<builtin::MXDict>();
+        if (pos != npos && this->bytes_[pos] == '}') return dict;
+        while (true) {
+            if (pos == npos) return this->fail("unterminated object", end);
+            if (this->bytes_[pos] != '"') return this->fail("expected string key", pos);
+            std::string_view text;
+            bool borrowed = false;
+            if (!this->read_string(pos, text, borrowed)) return nullptr;
+            // 解析值可能复用 scratch_，先把键拷出来
+            std::string key{ text };
+
+            pos = this->next_structural();
+            if (pos == npos || this->bytes_[pos] != ':')
+                return this->fail("expected ':'", std::min(pos, end));
+            pos = this->next_structural();
+            if (pos == npos) return this->fail("missing value", end);
+            auto value = this->parse_value(pos, depth);
+            if (!this->error_.empty()) return nullptr;
+            dict->set(std::move(key), std::move(value));
+
+            pos = this->next_structural();
+            if (pos != npos && this->bytes_[pos] == '}') return dict;
+            if (pos == npos || this->bytes_[pos] != ',')
+                return this->fail("expected ',' or '}'", std::min(pos, end));
+            pos = this->next_structural();
+        }
+    }
+
+    auto MXJsonReader::parse_array(int depth) -> MXObjectOwned {
+        const std::size_t end = this->bytes_.size();
+        std::size_t pos = this->next_structural();
+        if (depth > MAX_DEPTH) return this->fail("nesting too deep", std::min(pos, end));
+        auto list = std::make_unique<builtin::MXList>();
+        if (pos != npos && this->bytes_[pos] == ']') return list;
+        while (true) {
+            if (pos == npos) return this->fail("unterminated array", end);
+            auto value = this->parse_value(pos, depth);
+            if (!this->error_.empty()) return nullptr;
+            list->append(std::move(value));
+
+            pos = this->next_structural();
+            if (pos != npos && this->bytes_[pos] == ']') return list;
+            if (pos == npos || this->bytes_[pos] != ',')
+                return this->fail("expected ',' or ']'", std::min(pos, end));
+            pos = this->next_structural();
+        }
+    }
+
+    auto MXJsonReader::parse_scalar(std::size_t pos) -> MXObjectOwned {
+        const char *first = this->bytes_.data() + pos;
+        const char *last = first;
+        const char *end = this->bytes_.data() + this->bytes_.size();
+        while (last != end && !is_delimiter(*last)) ++last;
+        const std::string_view token{ first, static_cast<std::size_t>(last - first) };
+        // 空格、\t、\n、\r 之外的控制字节不是空白，会被索引成标量的起点
+        const auto control = std::ranges::find_if(
+                token, [](char c) { return static_cast<unsigned char>(c) < 0x20; });
+        if (control != token.end())
+            return this->fail("control character outside a string",
+                              pos + static_cast<std::size_t>(control - token.begin()));
+
+        if (token == "true") return std::make_unique<builtin::MXBoolean>(true);
+        if (token == "false") return std::make_unique<builtin::MXBoolean>(false);
+        if (token == "null") return nullptr;
+        if (!is_json_number(token))
+            return this->fail(std::format("invalid literal '{}'", token), pos);
+
+        std::int64_t integer = 0;
+        if (auto [ptr, ec] = std::from_chars(first, last, integer);
+            ec == std::errc{} && ptr == last)
+            return std::make_unique<builtin::MXInteger>(integer);
+        // 带小数点 / 指数，或超出 int64 范围的整数按浮点数处理
+        double number = 0;
+        if (auto [ptr, ec] = std::from_chars(first, last, number);
+            ec == std::errc{} && ptr == last)
+            return std::make_unique<builtin::MXFloat>(number);
+        return this->fail(std::format("number out of range '{}'", token), pos);
+    }
+
+    auto MXJsonReader::read_string(std::size_t pos, std::string_view &text,
+                                   bool &borrowed) -> bool {
+        const char *begin = this->bytes_.data() + pos + 1;
+        const char *end = this->bytes_.data() + this->bytes_.size();
+        const char *quote = mx_find_byte(begin, end, '"');
+        const char *slash = mx_find_byte(begin, quote, '\\');
+        if (slash == quote) {
+            if (quote == end) {
+                this->fail("unterminated string", pos);
+                return false;
+            }
+            if (!this->check_control(pos, quote)) return false;
+            text = { begin, static_cast<std::size_t>(quote - begin) };
+            borrowed = true;
+            return true;
+        }
+
+        // 有转义：从第一个反斜杠开始解码到 scratch_
+        auto &out = this->scratch_;
+        out.assign(begin, slash);
+        const char *cursor = slash;
+        while (true) {
+            if (cursor == end) {
+                this->fail("unterminated string", pos);
+                return false;
+            }
+            if (*cursor == '"') break;
+            if (*cursor != '\\') {
+                const char *next_quote = mx_find_byte(cursor, end, '"');
+                const char *next_slash = mx_find_byte(cursor, next_quote, '\\');
+                out.append(cursor, next_slash);
+                cursor = next_slash;
+                continue;
+            }
+            const std::size_t at = static_cast<std::size_t>(cursor - this->bytes_.data());
+            if (++cursor == end) {
+                this->fail("unterminated string", pos);
+                return false;
+            }
+            switch (const char c = *cursor++) {
+                case '"':
+                case '\\':
+                case '/':
+                    out += c;
+                    break;
+                case 'b':
+                    out += '\b';
+                    break;
+                case 'f':
+                    out += '\f';
+                    break;
+                case 'n':
+                    out += '\n';
+                    break;
+                case 'r':
+                    out += '\r';
+                    break;
+                case 't':
+                    out += '\t';
+                    break;
+                case 'u': {
+                    std::uint32_t code = 0;
+                    if (end - cursor < 4 || !hex_value({ cursor, 4 }, code)) {
+                        this->fail("invalid \\u escape", at);
+                        return false;
+                    }
+                    cursor += 4;
+                    // UTF-16 代理对；单独出现的低位代理同样无效
+                    if (code >= 0xDC00 && code <= 0xDFFF) {
+                        this->fail("unpaired surrogate", at);
+                        return false;
+                    }
+                    if (code >= 0xD800 && code <= 0xDBFF) {
+                        std::uint32_t low = 0;
+                        if (end - cursor < 6 || cursor[0] != '\\' || cursor[1] != 'u'
+                            || !hex_value({ cursor + 2, 4 }, low) || low < 0xDC00
+                            || low > 0xDFFF) {
+                            this->fail("unpaired surrogate", at);
+                            return false;
+                        }
+                        cursor += 6;
+                        code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+                    }
+                    append_utf8(out, code);
+                    break;
+                }
+                default:
+                    this->fail("invalid escape", at);
+                    return false;
+            }
+        }
+        if (!this->check_control(pos, cursor)) return false;
+        text = out;
+        borrowed = false;
+        return true;
+    }
+
+    auto MXJsonReader::check_control(std::size_t pos, const char *quote) -> bool {
+        const auto close = static_cast<std::size_t>(quote - this->bytes_.data());
+        if (this->control_ == npos || this->control_ < pos || this->control_ > close)
+            return true;
+        this->fail("control character in string", this->control_);
+        return false;
+    }
+
+    auto MXJsonReader::repr() const -> repr_t {
+        return std::format("JsonReader(offset={})", this->indexed_);
+    }
+}
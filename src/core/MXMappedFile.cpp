@@ -0,0 +1,142 @@
+#include "mxspp/core/MXMappedFile.h"
+#include <cstdint>
+#include <cstring>
+#include <format>
+#include <functional>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace mxs::core {
+    auto mx_find_byte(const char *first, const char *last, char byte) -> const char * {
+#if defined(__SSE2__)
+        const __m128i needle = _mm_set1_epi8(byte);
+        while (last - first >= 16) {
+            const __m128i chunk =
+                    _mm_loadu_si128(reinterpret_cast<const __m128i *>(first));
+            const int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(chunk, needle));
+            if (mask != 0) return first + __builtin_ctz(static_cast<unsigned>(mask));
+            first += 16;
+        }
+#elif defined(__ARM_NEON)
+        const uint8x16_t needle = vdupq_n_u8(static_cast<std::uint8_t>(byte));
+        while (last - first >= 16) {
+            const uint8x16_t eq = vceqq_u8(
+                    vld1q_u8(reinterpret_cast<const std::uint8_t *>(first)), needle);
+            // 每个字节压缩成 4 bit，得到 64 位掩码
+            const std::uint64_t mask = vget_lane_u64(
+                    vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(eq), 4)), 0);
+            if (mask != 0) return first + (__builtin_ctzll(mask) >> 2);
+            first += 16;
+        }
+#endif
+        // 不足 16 字节的尾部（或无 SIMD 的平台）交给 memchr
+        if (first == last) return last;
+        const auto rest = static_cast<std::size_t>(last - first);
+        const void *hit = std::memchr(first, byte, rest);
+        return hit ? static_cast<const char *>(hit) : last;
+    }
+
+    MXMappedRegion::MXMappedRegion(const char *data, std::size_t size)
+        : data_(data), size_(size), mapped_(size > 0) { }
+
+    MXMappedRegion::MXMappedRegion(std::string bytes)
+        : owned_(std::move(bytes)), data_(owned_.data()), size_(owned_.size()),
+          mapped_(false) { }
+
+    MXMappedRegion::~MXMappedRegion() {
+        if (this->mapped_) ::munmap(const_cast<char *>(this->data_), this->size_);
+    }
+
+    auto MXMappedRegion::adopt(std::string bytes)
+            -> std::shared_ptr<const MXMappedRegion> {
+        return std::shared_ptr<const MXMappedRegion>(
+                new MXMappedRegion(std::move(bytes)));
+    }
+
+    auto MXMappedRegion::map(int fd) -> std::shared_ptr<const MXMappedRegion> {
+        struct stat info{};
+        if (::fstat(fd, &info) != 0) return nullptr;
+        const auto size = static_cast<std::size_t>(info.st_size);
+        // mmap 不接受长度 0，空文件直接给一个空区域
+        if (size == 0)
+            return std::shared_ptr<const MXMappedRegion>(new MXMappedRegion("", 0));
+
+        void *data = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data == MAP_FAILED) return nullptr;
+        // 逐行处理是顺序访问，提示内核加大预读
+        ::madvise(data, size, MADV_SEQUENTIAL);
+        return std::shared_ptr<const MXMappedRegion>(
+                new MXMappedRegion(static_cast<const char *>(data), size));
+    }
+
+    MXStringView::MXStringView(std::shared_ptr<const MXMappedRegion> region,
+                               std::string_view value, bool is_static)
+        : MXObject(is_static), region_(std::move(region)), value_(value) { }
+
+    MXStringView::~MXStringView() = default;
+
+    auto MXStringView::get_rtti() -> const MXRuntimeTypeInfo & {
+        static MXRuntimeTypeInfo instance{ "StringView", &MXObject::get_rtti() };
+        return instance;
+    }
+
+    auto MXStringView::runtime_type() const -> const MXRuntimeTypeInfo & {
+        return get_rtti();
+    }
+
+    auto MXStringView::materialize() const -> std::unique_ptr<MXString> {
+        return std::make_unique<MXString>(std::string{ this->value_ });
+    }
+
+    // 与 MXString 保持一致，内容相同的 view 和 string 哈希相同
+    auto MXStringView::get_hash_code() const -> MXHashCode_t {
+        return std::hash<std::string_view>{}(this->value_);
+    }
+
+    auto MXStringView::repr() const -> repr_t { return repr_t{ this->value_ }; }
+
+    MXLineIterator::MXLineIterator(std::shared_ptr<const MXMappedRegion> region,
+                                   bool is_static)
+        : MXObject(is_static), region_(std::move(region)) {
+        const auto bytes = this->region_->view();
+        this->cursor_ = bytes.data();
+        this->end_ = bytes.data() + bytes.size();
+    }
+
+    MXLineIterator::~MXLineIterator() = default;
+
+    auto MXLineIterator::get_rtti() -> const MXRuntimeTypeInfo & {
+        static MXRuntimeTypeInfo instance{ "LineIterator", &MXObject::get_rtti() };
+        return instance;
+    }
+
+    auto MXLineIterator::runtime_type() const -> const MXRuntimeTypeInfo & {
+        return get_rtti();
+    }
+
+    auto MXLineIterator::next_view(std::string_view &line) -> bool {
+        if (this->cursor_ == this->end_) return false;
+        const char *newline = mx_find_byte(this->cursor_, this->end_, '\n');
+        const char *stop = newline;
+        if (stop != this->cursor_ && stop[-1] == '\r') --stop;
+        line = { this->cursor_, static_cast<std::size_t>(stop - this->cursor_) };
+        this->cursor_ = newline == this->end_ ? this->end_ : newline + 1;
+        return true;
+    }
+
+    auto MXLineIterator::next() -> std::unique_ptr<MXStringView> {
+        std::string_view line;
+        if (!this->next_view(line)) return nullptr;
+        return std::make_unique<MXStringView>(this->region_, line);
+    }
+
+    auto MXLineIterator::repr() const -> repr_t {
+        return std::format("LineIterator(remaining={})", this->end_ - this->cursor_);
+    }
+}
@@ -0,0 +1,162 @@
+#include "mxspp/core/MXMetrics.h"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <format>
+#include <utility>
+#include <vector>
+
+namespace mxs::core {
+    auto MXHistogram::bucket_of(std::uint64_t value) -> std::size_t {
+        if (value < SUB_BUCKETS) return static_cast<std::size_t>(value);
+        // 最高位所在的二次幂区间里，再取其后 SUB_BUCKET_BITS 位做线性细分
+        const unsigned exponent = 63 - std::countl_zero(value);
+        const unsigned shift = exponent - SUB_BUCKET_BITS;
+        const auto sub = static_cast<std::size_t>(value >> shift) - SUB_BUCKETS;
+        return SUB_BUCKETS + shift * SUB_BUCKETS + sub;
+    }
+
+    auto MXHistogram::bucket_limit(std::size_t bucket) -> std::uint64_t {
+        if (bucket < SUB_BUCKETS) return bucket;
+        const auto shift = (bucket - SUB_BUCKETS) / SUB_BUCKETS;
+        const auto sub = (bucket - SUB_BUCKETS) % SUB_BUCKETS;
+        const auto lower = static_cast<std::uint64_t>(SUB_BUCKETS + sub) << shift;
+        return lower + ((std::uint64_t{ 1 } << shift) - 1);
+    }
+
+    auto MXHistogram::record(std::uint64_t value) -> void {
+        this->buckets_[bucket_of(value)].fetch_add(1, std::memory_order_relaxed);
+        this->count_.fetch_add(1, std::memory_order_relaxed);
+        this->sum_.fetch_add(value, std::memory_order_relaxed);
+    }
+
+    auto MXHistogram::count() const -> std::uint64_t {
+        return this->count_.load(std::memory_order_relaxed);
+    }
+
+    auto MXHistogram::sum() const -> std::uint64_t {
+        return this->sum_.load(std::memory_order_relaxed);
+    }
+
+    auto MXHistogram::count_at_or_below(std::uint64_t limit) const -> std::uint64_t {
+        std::uint64_t total = 0;
+        const auto last = bucket_of(limit);
+        for (std::size_t i = 0; i <= last; ++i)
+            total += this->buckets_[i].load(std::memory_order_relaxed);
+        return total;
+    }
+
+    auto MXHistogram::value_at_quantile(double q) const -> std::uint64_t {
+        const auto total = this->count();
+        if (total == 0) return 0;
+        const auto rank = std::max<std::uint64_t>(
+                1, static_cast<std::uint64_t>(std::ceil(q * static_cast<double>(total))));
+        std::uint64_t seen = 0;
+        for (std::size_t i = 0; i < BUCKETS; ++i) {
+            seen += this->buckets_[i].load(std::memory_order_relaxed);
+            if (seen >= rank) return bucket_limit(i);
+        }
+        return bucket_limit(BUCKETS - 1);
+    }
+
+    auto MXMetricsRegistry::get_registry() -> MXMetricsRegistry & {
+        static MXMetricsRegistry instance{};
+        return instance;
+    }
+
+    auto MXMetricsRegistry::family(const std::string &name, const std::string &help,
+                                   const std::string &type) -> Family & {
+        auto [it, inserted] = this->families_.try_emplace(name);
+        if (inserted) {
+            it->second.help = help;
+            it->second.type = type;
+        }
+        return it->second;
+    }
+
+    auto MXMetricsRegistry::counter(const std::string &name, const std::string &help)
+            -> MXCounter & {
+        std::scoped_lock guard(this->lock_);
+        auto &family = this->family(name, help, "counter");
+        if (!family.counter) family.counter = &this->counters_.emplace_back();
+        return *family.counter;
+    }
+
+    auto MXMetricsRegistry::gauge(const std::string &name, const std::string &help)
+            -> MXGauge & {
+        std::scoped_lock guard(this->lock_);
+        auto &family = this->family(name, help, "gauge");
+        if (!family.gauge) family.gauge = &this->gauges_.emplace_back();
+        return *family.gauge;
+    }
+
+    auto MXMetricsRegistry::histogram(const std::string &name, const std::string &help,
+                                      double scale) -> MXHistogram & {
+        std::scoped_lock guard(this->lock_);
+        auto &family = this->family(name, help, "histogram");
+        if (!family.histogram) {
+            family.histogram = &this->histograms_.emplace_back();
+            family.scale = scale;
+        }
+        return *family.histogram;
+    }
+
+    auto MXMetricsRegistry::collector(const std::string &name, const std::string &help,
+                                      Kind kind, const std::string &label,
+                                      Collector collect) -> void {
+        std::scoped_lock guard(this->lock_);
+        const auto *type = kind == Kind::COUNTER ? "counter" : "gauge";
+        auto &family = this->family(name, help, type);
+        family.label = label;
+        family.collect = std::move(collect);
+    }
+
+    auto MXMetricsRegistry::write_prometheus(std::ostream &out) const -> void {
+        // 只在锁内拷贝族列表。收集回调可能很慢，也可能自己注册或更新指标；
+        // 在锁内调用会阻塞所有注册，回调再取锁就会死锁。计数器等对象存放在
+        // deque 里、从不删除，拷出来的指针在锁外仍然有效
+        std::vector<std::pair<std::string, Family>> families;
+        {
+            std::scoped_lock guard(this->lock_);
+            families.assign(this->families_.begin(), this->families_.end());
+        }
+        for (const auto &[name, family] : families) {
+            out << "# HELP " << name << ' ' << family.help << '\n';
+            out << "# TYPE " << name << ' ' << family.type << '\n';
+            if (family.counter) out << name << ' ' << family.counter->value() << '\n';
+            if (family.gauge) out << name << ' ' << family.gauge->value() << '\n';
+            if (family.histogram) {
+                const auto &histogram = *family.histogram;
+                // 固定输出 2^10 到 2^36 之间每隔 4 倍一个桶：纳秒计时即 1µs 到约 69s。
+                // 上界取 2^j - 1，恰好落在 HDR 桶的边界上
+                for (unsigned j = 10; j <= 36; j += 2) {
+                    const std::uint64_t limit = std::uint64_t{ 1 } << j;
+                    out << std::format("{}_bucket{{le=\"{}\"}} {}\n", name,
+                                       static_cast<double>(limit) * family.scale,
+                                       histogram.count_at_or_below(limit - 1));
+                }
+                out << std::format("{}_bucket{{le=\"+Inf\"}} {}\n", name,
+                                   histogram.count());
+                out << std::format("{}_sum {}\n", name,
+                                   static_cast<double>(histogram.sum()) * family.scale);
+                out << std::format("{}_count {}\n", name, histogram.count());
+            }
+            if (family.collect) {
+                for (const auto &[value, sample] : family.collect()) {
+                    if (family.label.empty()) {
+                        out << std::format("{} {}\n", name, sample);
+                        continue;
+                    }
+                    // 标签值里的反斜杠、引号和换行需要转义
+                    std::string escaped;
+                    for (char c : value) {
+                        if (c == '\\' || c == '"') escaped += '\\';
+                        escaped += c == '\n' ? std::string{ "\\n" } : std::string{ c };
+                    }
+                    out << std::format("{}{{{}=\"{}\"}} {}\n", name, family.label,
+                                       escaped, sample);
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,20 @@
+#include "mxspp/core/MXNil.h"
+
+namespace mxs::builtin {
+    MXNil::MXNil(bool is_static) : core::MXObject(is_static) { }
+
+    MXNil::~MXNil() = default;
+
+    auto MXNil::get_rtti() -> const core::MXRuntimeTypeInfo & {
+        static core::MXRuntimeTypeInfo instance{ "Nil", &core::MXObject::get_rtti() };
+        return instance;
+    }
+
+    auto MXNil::runtime_type() const -> const core::MXRuntimeTypeInfo & {
+        return get_rtti();
+    }
+
+    auto MXNil::get_hash_code() const -> MXHashCode_t { return 0; }
+
+    auto MXNil::repr() const -> core::repr_t { return "nil"; }
+}
@@ -0,0 +1,48 @@
+#include "mxspp/core/MXNumeric.h"
+#include <format>
+#include <functional>
+
+namespace mxs::builtin {
+    MXInteger::MXInteger(std::int64_t value, bool is_static)
+        : core::MXObject(is_static), MXNumeric(is_static), value(value) { }
+
+    MXInteger::~MXInteger() = default;
+
+    auto MXInteger::get_rtti() -> const core::MXRuntimeTypeInfo & {
+        static core::MXRuntimeTypeInfo instance{ "Integer",
+                                                 &core::MXObject::get_rtti() };
+        return instance;
+    }
+
+    auto MXInteger::runtime_type() const -> const core::MXRuntimeTypeInfo & {
+        return get_rtti();
+    }
+
+    auto MXInteger::get_hash_code() const -> MXHashCode_t {
+        return static_cast<MXHashCode_t>(this->value);
+    }
+
+    auto MXInteger::repr() const -> core::repr_t {
+        return std::format("{}", this->value);
+    }
+
+    MXFloat::MXFloat(double value, bool is_static)
+        : core::MXObject(is_static), MXNumeric(is_static), value(value) { }
+
+    MXFloat::~MXFloat() = default;
+
+    auto MXFloat::get_rtti() -> const core::MXRuntimeTypeInfo & {
+        static core::MXRuntimeTypeInfo instance{ "Float", &core::MXObject::get_rtti() };
+        return instance;
+    }
+
+    auto MXFloat::runtime_type() const -> const core::MXRuntimeTypeInfo & {
+        return get_rtti();
+    }
+
+    auto MXFloat::get_hash_code() const -> MXHashCode_t {
+        return std::hash<double>{}(this->value);
+    }
+
+    auto MXFloat::repr() const -> core::repr_t { return std::format("{}", this->value); }
+}
@@ -1,21 +1,73 @@
 #include "mxspp/core/MXObject.h"
+#include "mxspp/core/MXAllocationProfiler.h"
 #include "mxspp/core/MXPopulationManager.h"
 #include "mxspp/core/MXType.h"
 #include "mxspp/core/_type_def.h"
 #include "llvm/IR/Instruction.h"
 namespace mxs::core {
+    namespace {
+        // operator new 记下本线程最近一次分配，随后运行的构造函数据此认领分配大小
+        thread_local std::uintptr_t last_allocation = 0;
+        thread_local std::size_t last_allocation_size = 0;
+    }
 
     MXObject::MXObject(bool is_static) : is_static(is_static) {
+        // 虚继承时 MXObject 子对象不一定在分配块的开头，按地址范围匹配；
+        // 构造参数里嵌套的 new 会覆盖记录，外层对象这时记为 0
+        const auto address = reinterpret_cast<std::uintptr_t>(this);
+        const auto allocation_end = last_allocation + last_allocation_size;
+        if (address >= last_allocation && address < allocation_end) {
+            this->heap_bytes = static_cast<std::uint32_t>(last_allocation_size);
+            last_allocation_size = 0;
+        }
         MXPopulationManager::get_manager().register_object(this);
+        auto &profiler = MXAllocationProfiler::get_profiler();
+        if (profiler.enabled()) profiler.on_construct(this);
     }
 
-    MXObject::~MXObject() { MXPopulationManager::get_manager().unregister_object(this); }
+    MXObject::~MXObject() {
+        MXPopulationManager::get_manager().unregister_object(this);
+        if (this->allocation_sampled)
+            MXAllocationProfiler::get_profiler().on_destroy(this);
+    }
 
     auto MXObject::get_rtti() -> const core::MXRuntimeTypeInfo & {
         static MXRuntimeTypeInfo instance{ "MXObject", nullptr };
         return instance;
     }
 
+    auto MXObject::runtime_type() const -> const MXRuntimeTypeInfo & {
+        return get_rtti();
+    }
+
+    auto MXObject::operator new(std::size_t size) -> void * {
+        void *memory = ::operator new(size);
+        last_allocation = reinterpret_cast<std::uintptr_t>(memory);
+        last_allocation_size = size;
+        auto &profiler = MXAllocationProfiler::get_profiler();
+        if (profiler.enabled()) profiler.on_allocate(memory, size);
+        return memory;
+    }
+
+    auto MXObject::operator delete(void *memory, std::size_t size) -> void {
+        auto &profiler = MXAllocationProfiler::get_profiler();
+        if (profiler.enabled()) profiler.on_free(memory);
+        ::operator delete(memory, size);
+    }
+
+    auto MXObject::visit_references(const MXReferenceVisitor &visit) const -> void {
+        // 堆快照在持有 MXPopulationManager 的锁时调用。替换属性的线程可能正持有
+        // 本对象的锁、等着注销被替换掉的旧值，这里等锁会死锁，拿不到就跳过
+        std::unique_lock guard(this->lock, std::try_to_lock);
+        if (!guard.owns_lock()) return;
+        for (const auto &[name, value] : this->dynamic_owned_properties) {
+            if (value) visit("." + name, value.get());
+        }
+        for (const auto &[name, value] : this->dynamic_shared_properties) {
+            if (value) visit("." + name, value.get());
+        }
+    }
+
     auto MXObject::get_hash_code() const -> MXHashCode_t {
         return reinterpret_cast<MXHashCode_t>(this);
     }
@@ -0,0 +1,129 @@
+#include "mxspp/core/MXOutputStream.h"
+#include <array>
+#include <cerrno>
+#include <cstring>
+#include <format>
+#include <sys/uio.h>
+#include <unistd.h>
+
+namespace mxs::core {
+    auto MXOutputStream::default_policy(int fd) -> MXFlushPolicy {
+        return ::isatty(fd) ? MXFlushPolicy::LINE : MXFlushPolicy::FULL;
+    }
+
+    MXOutputStream::MXOutputStream(int fd, MXFlushPolicy policy, bool owns_fd,
+                                   bool is_static)
+        : MXObject(is_static), fd_(fd), policy_(policy), owns_fd_(owns_fd),
+          buffer_(BUFFER_SIZE) { }
+
+    MXOutputStream::~MXOutputStream() { this->close(); }
+
+    auto MXOutputStream::get_rtti() -> const MXRuntimeTypeInfo & {
+        static MXRuntimeTypeInfo instance{ "OutputStream", &MXObject::get_rtti() };
+        return instance;
+    }
+
+    auto MXOutputStream::runtime_type() const -> const MXRuntimeTypeInfo & {
+        return get_rtti();
+    }
+
+    auto MXOutputStream::standard_output() -> MXOutputStream & {
+        static MXOutputStream instance{ STDOUT_FILENO, default_policy(STDOUT_FILENO),
+                                        false, true };
+        return instance;
+    }
+    auto MXOutputStream::standard_error() -> MXOutputStream & {
+        static MXOutputStream instance{ STDERR_FILENO, default_policy(STDERR_FILENO),
+                                        false, true };
+        return instance;
+    }
+
+    auto MXOutputStream::write(std::string_view data) -> bool {
+        return this->append(data, {});
+    }
+    auto MXOutputStream::write_line(std::string_view data) -> bool {
+        return this->append(data, "\n");
+    }
+
+    auto MXOutputStream::flush() -> bool {
+        std::scoped_lock guard(this->lock_);
+        return this->drain({}, {});
+    }
+
+    auto MXOutputStream::close() -> bool {
+        std::scoped_lock guard(this->lock_);
+        if (this->fd_ < 0) return true;
+        bool ok = this->drain({}, {});
+        if (this->owns_fd_ && ::close(this->fd_) != 0) ok = false;
+        this->fd_ = -1;
+        return ok;
+    }
+
+    auto MXOutputStream::set_policy(MXFlushPolicy policy) -> void {
+        std::scoped_lock guard(this->lock_);
+        this->policy_ = policy;
+        if (policy == MXFlushPolicy::NONE) this->drain({}, {});
+    }
+
+    auto MXOutputStream::append(std::string_view data, std::string_view suffix) -> bool {
+        std::scoped_lock guard(this->lock_);
+        if (this->fd_ < 0) return false;
+        const std::size_t total = data.size() + suffix.size();
+        // 大块数据不拷贝：和缓冲区中已有的数据一起用一次 writev 直接写出
+        if (this->policy_ == MXFlushPolicy::NONE || total >= DIRECT_WRITE_THRESHOLD)
+            return this->drain(data, suffix);
+        if (this->used_ + total > this->buffer_.size() && !this->drain({}, {}))
+            return false;
+
+        std::memcpy(this->buffer_.data() + this->used_, data.data(), data.size());
+        std::memcpy(this->buffer_.data() + this->used_ + data.size(), suffix.data(),
+                    suffix.size());
+        this->used_ += total;
+
+        if (this->policy_ == MXFlushPolicy::LINE
+            && (suffix.find('\n') != std::string_view::npos
+                || data.find('\n') != std::string_view::npos))
+            return this->drain({}, {});
+        return true;
+    }
+
+    auto MXOutputStream::drain(std::string_view tail, std::string_view tail_suffix)
+            -> bool {
+        std::array<iovec, 3> parts{};
+        std::size_t count = 0;
+        auto push = [&](const char *data, std::size_t size) {
+            if (size > 0) parts[count++] = { const_cast<char *>(data), size };
+        };
+        push(this->buffer_.data(), this->used_);
+        push(tail.data(), tail.size());
+        push(tail_suffix.data(), tail_suffix.size());
+
+        iovec *next = parts.data();
+        while (count > 0) {
+            const ssize_t written = ::writev(this->fd_, next, static_cast<int>(count));
+            if (written < 0) {
+                if (errno == EINTR) continue;
+                // 写失败时丢弃缓冲内容，避免后续每次写入都重复失败
+                this->used_ = 0;
+                return false;
+            }
+            // 处理部分写入：跳过已完整写出的 iovec，调整剩余那个的起点
+            auto remaining = static_cast<std::size_t>(written);
+            while (count > 0 && remaining >= next->iov_len) {
+                remaining -= next->iov_len;
+                ++next;
+                --count;
+            }
+            if (count > 0) {
+                next->iov_base = static_cast<char *>(next->iov_base) + remaining;
+                next->iov_len -= remaining;
+            }
+        }
+        this->used_ = 0;
+        return true;
+    }
+
+    auto MXOutputStream::repr() const -> repr_t {
+        return std::format("OutputStream(fd={})", this->fd_);
+    }
+}
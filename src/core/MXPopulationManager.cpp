@@ -1,10 +1,61 @@
 #include "mxspp/core/MXPopulationManager.h"
+#include "mxspp/core/MXMetrics.h"
 #include "mxspp/core/MXObject.h"
 #include "mxspp/core/MXType.h"
+#include <algorithm>
+#include <chrono>
 #include <cstddef>
+#include <format>
 #include <mutex>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
 
 namespace mxs::core {
+    namespace {
+        struct SnapshotRecord {
+            const MXObject *object;
+            const MXRuntimeTypeInfo *type;
+            std::size_t size;
+            bool is_static;
+            // 引用在 edges 里的起点，终点是下一条记录的起点
+            std::size_t first_edge;
+        };
+
+        struct SnapshotEdge {
+            std::string name;
+            const MXObject *target;
+        };
+
+        // 类型名、属性名和字典键都可能含有引号或控制字符
+        auto json_string(std::string_view text) -> std::string {
+            std::string out = "\"";
+            for (const char c : text) {
+                if (c == '"' || c == '\\') {
+                    out += '\\';
+                    out += c;
+                } else if (static_cast<unsigned char>(c) < 0x20) {
+                    out += std::format("\\u{:04x}", static_cast<int>(c));
+                } else {
+                    out += c;
+                }
+            }
+            return out + '"';
+        }
+
+        // 快照等其他线程停到安全点的上限；超过说明有线程在不调用运行时的循环里
+        constexpr auto STOP_TIMEOUT = std::chrono::seconds(5);
+    }
+
+    // 本线程是否在 world 里；线程退出时离开，不再拖住之后的快照
+    struct MXPopulationManager::Member {
+        bool joined = false;
+        ~Member() {
+            if (this->joined) get_manager().leave_world();
+        }
+    };
+    thread_local MXPopulationManager::Member MXPopulationManager::member;
+
     auto MXPopulationManager::get_manager() -> MXPopulationManager & {
         static MXPopulationManager instance{};
         return instance;
@@ -13,36 +64,174 @@ namespace mxs::core {
         static MXRuntimeTypeInfo instance{ "mxs::core::MXPopulationManager", nullptr };
         return instance;
     }
+    // 构造或析构对象的线程加入 world，此后只在安全点或 Parked 里停下：
+    // 快照开始时它不可能停在某个对象的构造函数或析构函数中间。
+    // 加入时若快照正在进行就等它结束，这时本线程还没有构造到一半的对象
+    auto MXPopulationManager::join_world() -> void {
+        if (member.joined) return;
+        std::unique_lock guard(this->world_lock);
+        this->world_changed.wait(guard, [this] { return !this->stopped; });
+        ++this->running;
+        member.joined = true;
+    }
+    auto MXPopulationManager::leave_world() -> void {
+        {
+            std::scoped_lock guard(this->world_lock);
+            --this->running;
+            member.joined = false;
+        }
+        this->world_changed.notify_all();
+    }
+    auto MXPopulationManager::safepoint() -> void {
+        if (!member.joined || !this->stop_requested.load(std::memory_order_relaxed))
+            return;
+        this->leave_world();
+        this->join_world();
+    }
+    MXPopulationManager::Parked::Parked() : joined(member.joined) {
+        if (this->joined) get_manager().leave_world();
+    }
+    MXPopulationManager::Parked::~Parked() {
+        if (this->joined) get_manager().join_world();
+    }
+
     auto MXPopulationManager::register_object(const MXObject *const obj) -> void {
+        this->join_world();
         std::scoped_lock guard(this->lock);
-        if (obj) this->populations.insert(obj);
+        if (!obj) return;
+        this->populations.insert(obj);
+        ++this->registrations;
     }
     auto MXPopulationManager::unregister_object(const MXObject *const obj) -> void {
+        this->join_world();
         std::scoped_lock guard(this->lock);
         if (obj) this->populations.erase(obj);
     }
+    auto MXPopulationManager::total_registered() const -> std::uint64_t {
+        std::scoped_lock guard(this->lock);
+        return this->registrations;
+    }
+    auto MXPopulationManager::live_count() const -> std::size_t {
+        std::scoped_lock guard(this->lock);
+        return this->populations.size();
+    }
 
-    MXPopulationManager::MXPopulationManager() = default;
-    MXPopulationManager::~MXPopulationManager() = default;
-    auto MXPopulationManager::repr() const -> std::string {
+    auto MXPopulationManager::live_by_type() const -> std::map<std::string, std::size_t> {
         std::scoped_lock guard(this->lock);
-        std::string result = "MXPopulationManager{";
-        bool first = true;
-
-        for (const auto *obj : populations) {
-            if (!first) result += ", ";
-            first = false;
-            if (obj) {
-                result += std::format("\n    MXObject at: {}, with repr: {{ \n"
-                                      "        {}\n"
-                                      "    }}",
-                                      static_cast<const void *>(obj), obj->repr());
-            } else {
-                result += "<nullptr>";
+        std::map<std::string, std::size_t> counts;
+        for (const auto *obj : this->populations) ++counts[obj->runtime_type().name];
+        return counts;
+    }
+
+    // 分配速率和按类型的存活数在抓取时才计算，对象的构造和析构路径没有额外开销
+    MXPopulationManager::MXPopulationManager() {
+        auto &registry = MXMetricsRegistry::get_registry();
+        registry.collector("mxs_objects_allocated_total", "MXObjects constructed.",
+                           MXMetricsRegistry::Kind::COUNTER, "", [this] {
+                               const auto total = this->total_registered();
+                               return std::map<std::string, double>{
+                                   { "", static_cast<double>(total) }
+                               };
+                           });
+        registry.collector("mxs_objects_alive", "MXObjects alive, by type.",
+                           MXMetricsRegistry::Kind::GAUGE, "type", [this] {
+                               std::map<std::string, double> alive;
+                               for (const auto &[type, count] : this->live_by_type())
+                                   alive[type] = static_cast<double>(count);
+                               return alive;
+                           });
+    }
+    MXPopulationManager::~MXPopulationManager() = default;
+    auto MXPopulationManager::write_snapshot(std::ostream &out) -> bool {
+        // 先让出自己的位置，否则要等的正是本线程
+        const bool joined = member.joined;
+        if (joined) this->leave_world();
+        const auto resume = [this, joined] {
+            {
+                std::scoped_lock guard(this->world_lock);
+                this->stopped = false;
+                this->stop_requested.store(false, std::memory_order_relaxed);
+            }
+            this->world_changed.notify_all();
+            if (joined) this->join_world();
+        };
+        {
+            std::unique_lock guard(this->world_lock);
+            // 同时只有一个快照
+            this->world_changed.wait(guard, [this] { return !this->stopped; });
+            this->stopped = true;
+            this->stop_requested.store(true, std::memory_order_relaxed);
+            if (!this->world_changed.wait_for(guard, STOP_TIMEOUT,
+                                              [this] { return this->running == 0; })) {
+                guard.unlock();
+                resume();
+                return false;
+            }
+        }
+
+        std::vector<SnapshotRecord> records;
+        std::vector<SnapshotEdge> edges;
+        // 动态类型的类型信息可能随类型表释放，类型名在锁内复制，每个类型一份
+        std::unordered_map<const MXRuntimeTypeInfo *, std::string> type_names;
+        {
+            // 其他线程都停在安全点，对象都已构造完成且没有在析构；
+            // 锁内只复制地址、类型和引用，不格式化也不做 I/O
+            std::scoped_lock guard(this->lock);
+            records.reserve(this->populations.size());
+            for (const auto *obj : this->populations) {
+                const auto *type = &obj->runtime_type();
+                type_names.try_emplace(type, type->name);
+                records.push_back({ obj, type, obj->allocation_size(), obj->is_static,
+                                    edges.size() });
+                obj->visit_references([&edges](std::string_view name,
+                                               const MXObject *target) {
+                    edges.push_back({ std::string{ name }, target });
+                });
             }
         }
+        resume();
 
-        result += "\n}";
-        return result;
+        out << std::format("{{\"format\":\"mxs-heap-snapshot\",\"version\":1,"
+                           "\"objects\":{}}}\n",
+                           records.size());
+        std::string line;
+        for (std::size_t i = 0; i < records.size(); ++i) {
+            const auto &record = records[i];
+            const auto end = i + 1 < records.size() ? records[i + 1].first_edge
+                                                    : edges.size();
+            line = std::format("{{\"id\":\"{}\",\"type\":{},\"size\":{},"
+                               "\"static\":{},\"refs\":[",
+                               static_cast<const void *>(record.object),
+                               json_string(type_names.at(record.type)), record.size,
+                               record.is_static);
+            for (auto e = record.first_edge; e < end; ++e) {
+                if (e > record.first_edge) line += ',';
+                line += std::format("[{},\"{}\"]", json_string(edges[e].name),
+                                    static_cast<const void *>(edges[e].target));
+            }
+            line += "]}\n";
+            out << line;
+        }
+        return true;
+    }
+
+    auto MXPopulationManager::repr() const -> std::string {
+        // 只列出存活数最多的几个类型，输出长度与对象数量无关
+        std::vector<std::pair<std::string, std::size_t>> types;
+        std::size_t total = 0;
+        for (auto &[type, count] : this->live_by_type()) {
+            total += count;
+            types.emplace_back(type, count);
+        }
+        std::ranges::sort(types, [](const auto &a, const auto &b) {
+            return a.second > b.second;
+        });
+        std::string result = std::format("MXPopulationManager{{{} live", total);
+        for (std::size_t i = 0; i < types.size() && i < 10; ++i) {
+            result += std::format("{} {}: {}", i == 0 ? ";" : ",", types[i].first,
+                                  types[i].second);
+        }
+        if (types.size() > 10) result += ", ...";
+        return result + "}";
     }
-}
\ No newline at end of file
+}
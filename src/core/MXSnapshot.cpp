@@ -0,0 +1,375 @@
+#include "mxspp/core/MXSnapshot.h"
+#include "mxspp/core/MXBoolean.h"
+#include "mxspp/core/MXCollection.h"
+#include "mxspp/core/MXError.h"
+#include "mxspp/core/MXNumeric.h"
+#include "mxspp/core/MXOutputStream.h"
+#include "mxspp/core/MXString.h"
+#include <bit>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <format>
+#include <unistd.h>
+
+namespace mxs::core {
+    namespace {
+        using builtin::MXArray;
+        using builtin::MXBoolean;
+        using builtin::MXDict;
+        using builtin::MXFloat;
+        using builtin::MXInteger;
+        using builtin::MXList;
+
+        constexpr char image_magic[4] = { 'M', 'X', 'S', 'I' };
+        constexpr std::uint32_t format_version = 1;
+
+        enum Tag : std::uint64_t {
+            INTEGER = 1,
+            FLOAT,
+            BOOLEAN,
+            STRING,
+            LIST,
+            DICT,
+            INTEGER_ARRAY,
+            FLOAT_ARRAY,
+        };
+        enum Section { OBJECTS, REFS, ROOTS, DATA, STRINGS, CODE, SECTION_COUNT };
+
+        struct Extent {
+            std::uint64_t offset;
+            std::uint64_t size;
+        };
+        struct Header {
+            char magic[4];
+            std::uint32_t version;
+            std::uint64_t key;
+            std::uint32_t flags;
+            std::uint32_t reserved;
+            Extent sections[SECTION_COUNT];
+        };
+        static_assert(sizeof(Header) % 8 == 0);
+
+        auto padding(std::size_t size) -> std::size_t { return (8 - size % 8) % 8; }
+
+        auto bytes_of(const std::vector<std::uint64_t> &words) -> std::string_view {
+            return { reinterpret_cast<const char *>(words.data()), words.size() * 8 };
+        }
+
+        // [offset, offset + count) 落在 [0, limit) 内，写法避免加法溢出
+        auto fits(std::uint64_t offset, std::uint64_t count, std::uint64_t limit)
+                -> bool {
+            return offset <= limit && count <= limit - offset;
+        }
+
+        // 返回第一个不能放进镜像的值；文件、流、任务等持有进程状态，无法重建
+        auto find_unsupported(const MXObject *value) -> const MXObject * {
+            if (!value || dynamic_cast<const MXInteger *>(value)
+                || dynamic_cast<const MXFloat *>(value)
+                || dynamic_cast<const MXBoolean *>(value)
+                || dynamic_cast<const MXString *>(value)
+                || dynamic_cast<const MXStringView *>(value)
+                || dynamic_cast<const MXArray *>(value))
+                return nullptr;
+            if (auto *list = dynamic_cast<const MXList *>(value)) {
+                for (std::size_t i = 0; i < list->size(); ++i) {
+                    if (auto *bad = find_unsupported(list->at(i))) return bad;
+                }
+                return nullptr;
+            }
+            if (auto *dict = dynamic_cast<const MXDict *>(value)) {
+                for (const auto &key : dict->keys()) {
+                    if (auto *bad = find_unsupported(dict->get(key))) return bad;
+                }
+                return nullptr;
+            }
+            return value;
+        }
+    }
+
+    auto MXSnapshotWriter::add_root(std::string name, const MXObject *value)
+            -> MXObjectOwned {
+        if (auto *bad = find_unsupported(value)) {
+            return std::make_unique<MXError>(
+                    "SnapshotError",
+                    std::format("'{}': {} cannot be stored in an image", name,
+                                bad->repr()));
+        }
+        const auto name_ref = this->intern(name);
+        const auto value_ref = this->serialize(value);
+        this->roots_.push_back(name_ref);
+        this->roots_.push_back(value_ref);
+        return nullptr;
+    }
+
+    auto MXSnapshotWriter::set_code(std::string object) -> void {
+        this->code_ = std::move(object);
+    }
+
+    auto MXSnapshotWriter::set_flags(std::uint32_t flags) -> void {
+        this->flags_ = flags;
+    }
+
+    auto MXSnapshotWriter::push(std::uint64_t tag, std::uint64_t count,
+                                std::uint64_t payload) -> std::uint64_t {
+        this->objects_.insert(this->objects_.end(), { tag, count, payload });
+        return this->objects_.size() / 3;
+    }
+
+    auto MXSnapshotWriter::intern(std::string_view text) -> std::uint64_t {
+        std::string key{ text };
+        if (auto it = this->interned_.find(key); it != this->interned_.end())
+            return it->second;
+        const auto ref = this->push(STRING, text.size(), this->strings_.size());
+        this->strings_ += text;
+        this->interned_.emplace(std::move(key), ref);
+        return ref;
+    }
+
+    // 先写子对象再写父对象，镜像里的引用总是指向更早的记录
+    auto MXSnapshotWriter::serialize(const MXObject *value) -> std::uint64_t {
+        if (!value) return 0;
+        if (auto *integer = dynamic_cast<const MXInteger *>(value))
+            return this->push(INTEGER, 0, std::bit_cast<std::uint64_t>(integer->value));
+        if (auto *number = dynamic_cast<const MXFloat *>(value))
+            return this->push(FLOAT, 0, std::bit_cast<std::uint64_t>(number->value));
+        if (auto *boolean = dynamic_cast<const MXBoolean *>(value))
+            return this->push(BOOLEAN, 0, boolean->value ? 1 : 0);
+        if (auto *str = dynamic_cast<const MXString *>(value))
+            return this->intern(str->view());
+        if (auto *view = dynamic_cast<const MXStringView *>(value))
+            return this->intern(view->view());
+        if (auto *list = dynamic_cast<const MXList *>(value)) {
+            std::vector<std::uint64_t> items;
+            items.reserve(list->size());
+            for (std::size_t i = 0; i < list->size(); ++i)
+                items.push_back(this->serialize(list->at(i)));
+            const auto offset = this->refs_.size();
+            this->refs_.insert(this->refs_.end(), items.begin(), items.end());
+            return this->push(LIST, items.size(), offset);
+        }
+        if (auto *dict = dynamic_cast<const MXDict *>(value)) {
+            std::vector<std::uint64_t> pairs;
+            pairs.reserve(dict->size() * 2);
+            for (const auto &key : dict->keys()) {
+                pairs.push_back(this->intern(key));
+                pairs.push_back(this->serialize(dict->get(key)));
+            }
+            const auto offset = this->refs_.size();
+            this->refs_.insert(this->refs_.end(), pairs.begin(), pairs.end());
+            return this->push(DICT, dict->size(), offset);
+        }
+        // 只剩 MXArray：add_root 已经排除了其他类型
+        const auto *array = dynamic_cast<const MXArray *>(value);
+        const auto offset = this->data_.size();
+        if (array->is_integer()) {
+            const auto values = array->integers();
+            this->data_.append(reinterpret_cast<const char *>(values.data()),
+                               values.size_bytes());
+            return this->push(INTEGER_ARRAY, values.size(), offset);
+        }
+        const auto values = array->floats();
+        this->data_.append(reinterpret_cast<const char *>(values.data()),
+                           values.size_bytes());
+        return this->push(FLOAT_ARRAY, values.size(), offset);
+    }
+
+    auto MXSnapshotWriter::write(const std::string &path, std::uint64_t key) const
+            -> MXObjectOwned {
+        Header header{};
+        std::memcpy(header.magic, image_magic, sizeof image_magic);
+        header.version = format_version;
+        header.key = key;
+        header.flags = this->flags_;
+
+        const std::string_view sections[SECTION_COUNT] = {
+            bytes_of(this->objects_), bytes_of(this->refs_), bytes_of(this->roots_),
+            this->data_,              this->strings_,        this->code_,
+        };
+        std::uint64_t offset = sizeof(Header);
+        for (int i = 0; i < SECTION_COUNT; ++i) {
+            header.sections[i] = { offset, sections[i].size() };
+            offset += sections[i].size() + padding(sections[i].size());
+        }
+
+        const std::string temp = path + ".tmp";
+        const int fd =
+                ::open(temp.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (fd < 0) {
+            return std::make_unique<MXError>(
+                    "IOError", std::format("{}: {}", temp, std::strerror(errno)));
+        }
+        MXOutputStream out(fd, MXFlushPolicy::FULL, true);
+        bool ok = out.write({ reinterpret_cast<const char *>(&header), sizeof header });
+        constexpr std::string_view zeros{ "\0\0\0\0\0\0\0", 7 };
+        for (const auto section : sections) {
+            ok = ok && out.write(section)
+                 && out.write(zeros.substr(0, padding(section.size())));
+        }
+        ok = out.close() && ok;
+        if (!ok || ::rename(temp.c_str(), path.c_str()) != 0) {
+            const int saved = errno;
+            ::unlink(temp.c_str());
+            return std::make_unique<MXError>(
+                    "IOError", std::format("{}: {}", path, std::strerror(saved)));
+        }
+        return nullptr;
+    }
+
+    MXSnapshotImage::MXSnapshotImage(std::shared_ptr<const MXMappedRegion> region)
+        : region_(std::move(region)) { }
+
+    auto MXSnapshotImage::open(const std::string &path, std::uint64_t key)
+            -> std::unique_ptr<MXSnapshotImage> {
+        const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) return nullptr;
+        auto region = MXMappedRegion::map(fd);
+        ::close(fd);
+        if (!region) return nullptr;
+
+        const auto bytes = region->view();
+        Header header{};
+        if (bytes.size() < sizeof header) return nullptr;
+        std::memcpy(&header, bytes.data(), sizeof header);
+        if (std::memcmp(header.magic, image_magic, sizeof image_magic) != 0
+            || header.version != format_version || header.key != key)
+            return nullptr;
+        for (const auto &extent : header.sections) {
+            if (extent.offset % 8 != 0 || !fits(extent.offset, extent.size, bytes.size()))
+                return nullptr;
+        }
+        const auto &objects = header.sections[OBJECTS];
+        const auto &refs = header.sections[REFS];
+        const auto &roots = header.sections[ROOTS];
+        if (objects.size % 24 != 0 || refs.size % 8 != 0 || roots.size % 16 != 0)
+            return nullptr;
+
+        // 映射按页对齐、各段按 8 字节对齐，可以直接当 u64 数组读
+        auto image = std::unique_ptr<MXSnapshotImage>(new MXSnapshotImage(region));
+        auto section = [&](Section which) {
+            const auto &extent = header.sections[which];
+            return bytes.substr(extent.offset, extent.size);
+        };
+        auto words = [&](Section which) {
+            return reinterpret_cast<const std::uint64_t *>(section(which).data());
+        };
+        image->objects_ = words(OBJECTS);
+        image->refs_ = words(REFS);
+        image->roots_ = words(ROOTS);
+        image->data_ = section(DATA);
+        image->strings_ = section(STRINGS);
+        image->code_ = section(CODE);
+        image->object_count_ = objects.size / 24;
+        image->ref_count_ = refs.size / 8;
+        image->root_count_ = roots.size / 16;
+        image->flags_ = header.flags;
+
+        // 一次性校验所有记录：引用只能指向更早的记录（不会成环），
+        // 偏移都在段内，之后 build() 不必再做边界检查
+        auto is_string = [&](std::uint64_t ref, std::uint64_t limit) {
+            return ref > 0 && ref <= limit && image->objects_[(ref - 1) * 3] == STRING;
+        };
+        for (std::uint64_t i = 0; i < image->object_count_; ++i) {
+            const auto *record = image->objects_ + i * 3;
+            const auto count = record[1];
+            const auto payload = record[2];
+            switch (record[0]) {
+                case INTEGER:
+                case FLOAT:
+                case BOOLEAN:
+                    break;
+                case STRING:
+                    if (!fits(payload, count, image->strings_.size())) return nullptr;
+                    break;
+                case LIST:
+                    if (!fits(payload, count, image->ref_count_)) return nullptr;
+                    for (std::uint64_t j = 0; j < count; ++j) {
+                        if (image->refs_[payload + j] > i) return nullptr;
+                    }
+                    break;
+                case DICT:
+                    if (count > image->ref_count_ / 2
+                        || !fits(payload, count * 2, image->ref_count_))
+                        return nullptr;
+                    for (std::uint64_t j = 0; j < count; ++j) {
+                        if (!is_string(image->refs_[payload + j * 2], i)
+                            || image->refs_[payload + j * 2 + 1] > i)
+                            return nullptr;
+                    }
+                    break;
+                case INTEGER_ARRAY:
+                case FLOAT_ARRAY:
+                    if (payload % 8 != 0 || count > image->data_.size() / 8
+                        || !fits(payload, count * 8, image->data_.size()))
+                        return nullptr;
+                    break;
+                default:
+                    return nullptr;
+            }
+        }
+        for (std::uint64_t i = 0; i < image->root_count_; ++i) {
+            if (!is_string(image->roots_[i * 2], image->object_count_)
+                || image->roots_[i * 2 + 1] > image->object_count_)
+                return nullptr;
+        }
+        return image;
+    }
+
+    auto MXSnapshotImage::text(std::uint64_t ref) const -> std::string_view {
+        const auto *record = this->objects_ + (ref - 1) * 3;
+        return this->strings_.substr(record[2], record[1]);
+    }
+
+    auto MXSnapshotImage::build(std::uint64_t ref) const -> MXObjectOwned {
+        if (ref == 0) return nullptr;
+        const auto *record = this->objects_ + (ref - 1) * 3;
+        const auto count = record[1];
+        const auto payload = record[2];
+        switch (record[0]) {
+            case INTEGER:
+                return std::make_unique<MXInteger>(std::bit_cast<std::int64_t>(payload));
+            case FLOAT:
+                return std::make_unique<MXFloat>(std::bit_cast<double>(payload));
+            case BOOLEAN:
+                return std::make_unique<MXBoolean>(payload != 0);
+            case STRING:
+                return std::make_unique<MXString>(std::string{ this->text(ref) });
+            case LIST: {
+                auto list = std::make_unique<MXList>();
+                list->reserve(count);
+                for (std::uint64_t i = 0; i < count; ++i)
+                    list->append(this->build(this->refs_[payload + i]));
+                return list;
+            }
+            case DICT: {
+                auto dict = std::make_unique<MXDict>();
+                for (std::uint64_t i = 0; i < count; ++i) {
+                    const auto *pair = this->refs_ + payload + i * 2;
+                    dict->set(std::string{ this->text(pair[0]) }, this->build(pair[1]));
+                }
+                return dict;
+            }
+            case INTEGER_ARRAY: {
+                std::vector<std::int64_t> values(count);
+                std::memcpy(values.data(), this->data_.data() + payload, count * 8);
+                return std::make_unique<MXArray>(std::move(values));
+            }
+            default: {
+                std::vector<double> values(count);
+                std::memcpy(values.data(), this->data_.data() + payload, count * 8);
+                return std::make_unique<MXArray>(std::move(values));
+            }
+        }
+    }
+
+    auto MXSnapshotImage::restore() const
+            -> std::vector<std::pair<std::string, MXObjectOwned>> {
+        std::vector<std::pair<std::string, MXObjectOwned>> roots;
+        roots.reserve(this->root_count_);
+        for (std::uint64_t i = 0; i < this->root_count_; ++i) {
+            roots.emplace_back(std::string{ this->text(this->roots_[i * 2]) },
+                               this->build(this->roots_[i * 2 + 1]));
+        }
+        return roots;
+    }
+}
@@ -0,0 +1,28 @@
+#include "mxspp/core/MXString.h"
+#include <functional>
+#include <utility>
+
+namespace mxs::core {
+    MXString::MXString(std::string value, bool is_static)
+        : MXObject(is_static), value_(std::move(value)) { }
+
+    MXString::~MXString() = default;
+
+    auto MXString::get_rtti() -> const MXRuntimeTypeInfo & {
+        static MXRuntimeTypeInfo instance{ "String", &MXObject::get_rtti() };
+        return instance;
+    }
+
+    auto MXString::runtime_type() const -> const MXRuntimeTypeInfo & {
+        return get_rtti();
+    }
+
+    auto MXString::view() const -> std::string_view { return this->value_; }
+    auto MXString::size() const -> std::size_t { return this->value_.size(); }
+
+    auto MXString::get_hash_code() const -> MXHashCode_t {
+        return std::hash<std::string_view>{}(this->value_);
+    }
+
+    auto MXString::repr() const -> repr_t { return this->value_; }
+}
@@ -0,0 +1,151 @@
+#include "mxspp/core/MXTrace.h"
+#include <algorithm>
+#include <format>
+#include <string>
+#include <unistd.h>
+#if defined(__linux__)
+#include <pthread.h>
+#endif
+
+namespace mxs::core {
+    struct MXTracer::Ring {
+        std::unique_ptr<Event[]> events{ new Event[CAPACITY] };
+        // 只有所属线程写入；release 保证读到 head 的线程也能看到之前写好的事件
+        std::atomic<std::uint64_t> head{ 0 };
+        std::uint64_t thread_id = 0;
+        std::string thread_name;
+    };
+
+    std::atomic<bool> MXTracer::enabled_{ false };
+    thread_local MXTracer::Ring *MXTracer::current_ring_ = nullptr;
+
+    auto MXTracer::get_tracer() -> MXTracer & {
+        static MXTracer instance{};
+        return instance;
+    }
+
+    auto MXTracer::enable() -> void {
+        this->base_ticks_ = now();
+        this->base_time_ = std::chrono::steady_clock::now();
+        enabled_.store(true, std::memory_order_relaxed);
+    }
+
+    auto MXTracer::ring() -> Ring & {
+        if (current_ring_) return *current_ring_;
+        auto ring = std::make_unique<Ring>();
+#if defined(__linux__)
+        char name[16] = {};
+        if (pthread_getname_np(pthread_self(), name, sizeof(name)) == 0)
+            ring->thread_name = name;
+#endif
+        std::scoped_lock guard(this->lock_);
+        // 线程号按首次记录的顺序编号，主线程通常是 1
+        ring->thread_id = this->rings_.size() + 1;
+        current_ring_ = ring.get();
+        this->rings_.push_back(std::move(ring));
+        return *current_ring_;
+    }
+
+    auto MXTracer::record(const Event &event) -> void {
+        auto &ring = this->ring();
+        const auto head = ring.head.load(std::memory_order_relaxed);
+        ring.events[head % CAPACITY] = event;
+        ring.head.store(head + 1, std::memory_order_release);
+    }
+
+    auto MXTracer::complete(const char *category, const char *name, std::uint64_t start,
+                            std::int64_t value) -> void {
+        this->record({ category, name, start, now() - start, value, 'X' });
+    }
+
+    auto MXTracer::instant(const char *category, const char *name, std::int64_t value)
+            -> void {
+        this->record({ category, name, now(), 0, value, 'i' });
+    }
+
+    auto MXTracer::counter(const char *category, const char *name, std::int64_t value)
+            -> void {
+        this->record({ category, name, now(), 0, value, 'C' });
+    }
+
+    auto MXTracer::overwritten_count() const -> std::uint64_t {
+        std::scoped_lock guard(this->lock_);
+        std::uint64_t lost = 0;
+        for (const auto &ring : this->rings_) {
+            const auto head = ring->head.load(std::memory_order_acquire);
+            if (head > CAPACITY) lost += head - CAPACITY;
+        }
+        return lost;
+    }
+
+    auto MXTracer::write_chrome_trace(std::ostream &out) const -> void {
+        // 用写出时的第二组读数标定 TSC 频率；非 x86 上两者都是纳秒，比例为 1
+        const auto ticks = now() - this->base_ticks_;
+        const std::chrono::duration<double, std::micro> elapsed =
+                std::chrono::steady_clock::now() - this->base_time_;
+        const double ticks_per_us = elapsed.count() > 0
+                                            ? static_cast<double>(ticks) / elapsed.count()
+                                            : 1000.0;
+        auto micros = [&](std::uint64_t at) {
+            return static_cast<double>(static_cast<std::int64_t>(at - this->base_ticks_))
+                   / ticks_per_us;
+        };
+
+        const auto pid = static_cast<long>(::getpid());
+        std::scoped_lock guard(this->lock_);
+        out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+        bool first = true;
+        auto emit = [&](const std::string &event) {
+            if (!first) out << ",\n";
+            first = false;
+            out << event;
+        };
+        std::vector<Event> events;
+        for (const auto &ring : this->rings_) {
+            const auto tid = ring->thread_id;
+            const auto &thread = ring->thread_name.empty() ? std::string{ "mxs" }
+                                                           : ring->thread_name;
+            emit(std::format("{{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":{},"
+                             "\"tid\":{},\"args\":{{\"name\":\"{}\"}}}}",
+                             pid, tid, thread));
+
+            // 先复制再检查：复制期间被写入线程覆盖的槽位丢弃，不输出撕裂的事件
+            const auto head = ring->head.load(std::memory_order_acquire);
+            const auto first_kept = head > CAPACITY ? head - CAPACITY : 0;
+            events.clear();
+            for (auto i = first_kept; i < head; ++i)
+                events.push_back(ring->events[i % CAPACITY]);
+            const auto after = ring->head.load(std::memory_order_acquire);
+            const auto valid_from = after + 1 > CAPACITY ? after + 1 - CAPACITY : 0;
+            const auto skip = std::min<std::uint64_t>(
+                    events.size(), valid_from > first_kept ? valid_from - first_kept : 0);
+
+            for (auto it = events.begin() + static_cast<std::ptrdiff_t>(skip);
+                 it != events.end(); ++it) {
+                const auto common = std::format("\"cat\":\"{}\",\"name\":\"{}\","
+                                                "\"pid\":{},\"tid\":{},\"ts\":{:.3f}",
+                                                it->category, it->name, pid, tid,
+                                                micros(it->start));
+                switch (it->phase) {
+                    case 'X':
+                        emit(std::format("{{\"ph\":\"X\",{},\"dur\":{:.3f},"
+                                         "\"args\":{{\"value\":{}}}}}",
+                                         common,
+                                         static_cast<double>(it->duration) / ticks_per_us,
+                                         it->value));
+                        break;
+                    case 'i':
+                        emit(std::format("{{\"ph\":\"i\",\"s\":\"t\",{},"
+                                         "\"args\":{{\"value\":{}}}}}",
+                                         common, it->value));
+                        break;
+                    default:
+                        emit(std::format("{{\"ph\":\"C\",{},\"args\":{{\"{}\":{}}}}}",
+                                         common, it->name, it->value));
+                        break;
+                }
+            }
+        }
+        out << "\n]}\n";
+    }
+}
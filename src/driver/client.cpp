@@ -0,0 +1,58 @@
+// mxs-client: thin front end of `mxs serve`. Links nothing but libc so that
+// starting it costs a fork/exec, not an LLVM initialization.
+#include "mxspp/driver/driver.h"
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string_view>
+#include <unistd.h>
+
+namespace {
+    auto usage() -> int {
+        std::cerr << "usage: mxs-client run <script.mxs>\n"
+                     "       mxs-client compile <script.mxs>\n"
+                     "       mxs-client shutdown\n";
+        return 2;
+    }
+}
+
+int main(int argc, char **argv) {
+    using namespace mxs::driver;
+    if (argc < 2) return usage();
+    const std::string_view verb{ argv[1] };
+
+    Request request;
+    if (verb == "shutdown") {
+        request.command = Command::SHUTDOWN;
+    } else if ((verb == "run" || verb == "compile") && argc >= 3) {
+        request.command = verb == "run" ? Command::RUN : Command::COMPILE;
+        request.name = argv[2];
+        std::ifstream file(request.name, std::ios::binary);
+        if (!file) {
+            std::perror(("mxs-client: " + request.name).c_str());
+            return 2;
+        }
+        std::ostringstream source;
+        source << file.rdbuf();
+        request.source = std::move(source).str();
+    } else {
+        return usage();
+    }
+    request.fds = { STDIN_FILENO, STDOUT_FILENO, STDERR_FILENO };
+
+    const std::string path = default_socket_path();
+    const int server = connect_server(path);
+    if (server < 0) {
+        std::cerr << "mxs-client: no server at " << path
+                  << " (start one with `mxs serve`)\n";
+        return 2;
+    }
+    std::int32_t status = 1;
+    if (!send_request(server, request) || !receive_status(server, status)) {
+        std::cerr << "mxs-client: connection to " << path << " lost\n";
+        status = 1;
+    }
+    ::close(server);
+    return status;
+}
@@ -1,7 +1,290 @@
+#include "mxspp/core/MXAllocationProfiler.h"
 #include "mxspp/core/MXError.h"
 #include "mxspp/core/MXPopulationManager.h"
+#include "mxspp/core/MXTrace.h"
+#include "mxspp/driver/driver.h"
+#include "mxspp/jit/profiler.h"
+#include "mxspp/jit/timing.h"
+#include "mxspp/shell/shell.h"
+#include <csignal>
+#include <cstdlib>
+#include <format>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <optional>
+#include <pthread.h>
+#include <sstream>
+#include <thread>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/Path.h>
+#include <string_view>
 
-int main() {
+namespace {
+    // runtime.bc 默认与可执行文件放在同一目录，可用 MXS_RUNTIME_BC 覆盖
+    auto runtime_bitcode_path(const char *argv0) -> std::string {
+        if (const char *path = std::getenv("MXS_RUNTIME_BC")) return path;
+        auto executable = llvm::sys::fs::getMainExecutable(
+                argv0, reinterpret_cast<void *>(&runtime_bitcode_path));
+        llvm::SmallString<256> path{ llvm::sys::path::parent_path(executable) };
+        llvm::sys::path::append(path, "runtime.bc");
+        return std::string{ path };
+    }
+
+    // 编译服务的目标文件缓存：$XDG_CACHE_HOME/mxs 或 ~/.cache/mxs
+    auto object_cache_dir() -> std::string {
+        llvm::SmallString<256> path;
+        if (const char *dir = std::getenv("XDG_CACHE_HOME")) {
+            path = dir;
+        } else if (!llvm::sys::path::cache_directory(path)) {
+            return {};
+        }
+        llvm::sys::path::append(path, "mxs");
+        return std::string{ path };
+    }
+
+    // --strip-asserts：发布构建里 assert 不生成任何代码
+    bool strip_asserts = false;
+
+    auto make_shell(const char *argv0, const std::string &cache_dir = {})
+            -> std::unique_ptr<mxs::shell::MXShell> {
+        auto shell = mxs::shell::MXShell::create(runtime_bitcode_path(argv0), cache_dir);
+        if (!shell) {
+            std::cerr << "mxs: " << llvm::toString(shell.takeError()) << '\n';
+            return nullptr;
+        }
+        (*shell)->set_strip_asserts(strip_asserts);
+        return std::move(*shell);
+    }
+
+    auto run_repl(const char *argv0) -> int {
+        auto shell = make_shell(argv0);
+        return shell ? shell->run(std::cin, std::cout) : 1;
+    }
+
+    auto read_script(const char *script, std::string &source) -> bool {
+        auto &timer = mxs::jit::MXCompileTimer::get_timer();
+        mxs::jit::MXCompileTimer::Scope scope(timer, "Read source file");
+        std::ifstream file(script, std::ios::binary);
+        if (!file) {
+            std::cerr << "mxs: cannot open " << script << '\n';
+            return false;
+        }
+        std::ostringstream text;
+        text << file.rdbuf();
+        source = text.str();
+        timer.count("source bytes", source.size());
+        return true;
+    }
+
+    auto run_script(const char *argv0, const char *script) -> int {
+        std::string source;
+        if (!read_script(script, source)) return 2;
+        auto shell = make_shell(argv0);
+        if (!shell) return 1;
+        const auto allocations = mxs::driver::allocation_count();
+        const int status = shell->run_program(source, true, script);
+        mxs::driver::write_run_stats(*shell, allocations);
+        return status;
+    }
+
+    // 运行 init() 后把全局值和目标代码写进启动镜像；默认输出 <script>.mxsi
+    auto build_snapshot(const char *argv0, int argc, char **argv) -> int {
+        const char *script = argv[2];
+        std::string image = argc > 3 ? argv[3] : std::string{ script } + "i";
+        std::string source;
+        if (!read_script(script, source)) return 2;
+        auto shell = make_shell(argv0);
+        return shell ? shell->snapshot(source, image, script) : 1;
+    }
+
+    auto run_image(const char *argv0, const char *image) -> int {
+        auto shell = make_shell(argv0);
+        return shell ? shell->run_image(image) : 1;
+    }
+
+    // LLVM、runtime.bc 和 JIT 只初始化一次，之后由 mxs-client 提交脚本
+    auto run_server(const char *argv0, int argc, char **argv) -> int {
+        std::string socket = mxs::driver::default_socket_path();
+        for (int i = 2; i + 1 < argc; ++i) {
+            if (std::string_view{ argv[i] } == "--socket") socket = argv[++i];
+        }
+        auto shell = make_shell(argv0, object_cache_dir());
+        return shell ? mxs::driver::serve(socket, *shell) : 1;
+    }
+
+    // --time-passes 可以出现在任意位置：摘掉后其余参数照常按位置解析
+    auto take_flag(int &argc, char **argv, std::string_view flag) -> bool {
+        bool found = false;
+        int kept = 1;
+        for (int i = 1; i < argc; ++i) {
+            if (flag == argv[i])
+                found = true;
+            else
+                argv[kept++] = argv[i];
+        }
+        argc = kept;
+        return found;
+    }
+
+    // --flag 或 --flag=VALUE，同样可以出现在任意位置；不带 "=VALUE" 时返回空串
+    auto take_option(int &argc, char **argv, std::string_view flag)
+            -> std::optional<std::string> {
+        std::optional<std::string> value;
+        int kept = 1;
+        for (int i = 1; i < argc; ++i) {
+            const std::string_view arg{ argv[i] };
+            if (arg == flag)
+                value.emplace();
+            else if (arg.starts_with(flag) && arg[flag.size()] == '=')
+                value = std::string{ arg.substr(flag.size() + 1) };
+            else
+                argv[kept++] = argv[i];
+        }
+        argc = kept;
+        return value;
+    }
+
+    auto write_profile(const std::string &path) -> void {
+        auto &profiler = mxs::jit::MXProfiler::get_profiler();
+        profiler.stop();
+        std::ofstream out(path);
+        if (!out) {
+            std::cerr << "mxs: cannot write profile to '" << path << "'\n";
+            return;
+        }
+        profiler.write_folded(out);
+        std::cerr << "mxs: " << profiler.sample_count() << " samples ("
+                  << profiler.dropped_count() << " dropped) written to '" << path
+                  << "'\n";
+    }
+
+    auto write_trace(const std::string &path) -> void {
+        auto &tracer = mxs::core::MXTracer::get_tracer();
+        std::ofstream out(path, std::ios::trunc);
+        if (!out) {
+            std::cerr << "mxs: cannot write trace to '" << path << "'\n";
+            return;
+        }
+        tracer.write_chrome_trace(out);
+        std::cerr << "mxs: trace written to '" << path << "' ("
+                  << tracer.overwritten_count() << " events overwritten)\n";
+    }
+
+    // 没有给路径时写到 stderr；写文件时追加，SIGUSR2 触发的多份报告依次排列
+    auto write_alloc_report(const std::string &path) -> void {
+        auto &jit_profiler = mxs::jit::MXProfiler::get_profiler();
+        auto symbolize = [&jit_profiler](std::uintptr_t address) {
+            return jit_profiler.frame(address);
+        };
+        auto &profiler = mxs::core::MXAllocationProfiler::get_profiler();
+        if (path.empty()) return profiler.report(std::cerr, symbolize);
+        std::ofstream out(path, std::ios::app);
+        if (!out) {
+            std::cerr << "mxs: cannot write allocation profile to '" << path << "'\n";
+            return;
+        }
+        profiler.report(out, symbolize);
+    }
+
+    // 在专用线程里用 sigwait 同步处理 signal，之后创建的线程都继承对它的屏蔽。
+    // 处理线程创建时屏蔽全部信号，不会截走另一个处理线程等待的信号
+    auto on_signal(int signal, std::function<void()> handler) -> void {
+        sigset_t wanted, all, previous;
+        sigemptyset(&wanted);
+        sigaddset(&wanted, signal);
+        sigfillset(&all);
+        pthread_sigmask(SIG_BLOCK, &all, &previous);
+        std::thread([wanted, handler = std::move(handler)] {
+            int received = 0;
+            while (sigwait(&wanted, &received) == 0) handler();
+        }).detach();
+        sigaddset(&previous, signal);
+        pthread_sigmask(SIG_SETMASK, &previous, nullptr);
+    }
+
+    auto start_alloc_profile(const std::string &path) -> void {
+        std::size_t sample_bytes = 512 * 1024;
+        if (const char *value = std::getenv("MXS_ALLOC_SAMPLE_BYTES")) {
+            const auto parsed = std::strtoull(value, nullptr, 10);
+            if (parsed > 0) sample_bytes = parsed;
+        }
+        mxs::core::MXAllocationProfiler::get_profiler().enable(sample_bytes);
+        // 回溯要穿过 JIT 代码，并且要认出脚本函数：只打开 JIT 一侧，不启动 CPU 采样
+        mxs::jit::MXProfiler::get_profiler().enable();
+        on_signal(SIGUSR2, [path] { write_alloc_report(path); });
+    }
+
+    auto write_heap_snapshot(const std::string &path) -> void {
+        std::ofstream out(path, std::ios::trunc);
+        if (!out) {
+            std::cerr << "mxs: cannot write heap snapshot to '" << path << "'\n";
+            return;
+        }
+        if (!mxs::core::MXPopulationManager::get_manager().write_snapshot(out)) {
+            std::cerr << "mxs: heap snapshot to '" << path
+                      << "' skipped: the script did not reach a safepoint\n";
+            return;
+        }
+        std::cerr << "mxs: heap snapshot written to '" << path << "'\n";
+    }
+
+    // 退出时写到 PATH；SIGUSR1 触发的快照依次写到 PATH.1、PATH.2……，两两可以对比
+    auto start_heap_snapshots(const std::string &path) -> void {
+        on_signal(SIGUSR1, [path, taken = 0]() mutable {
+            write_heap_snapshot(std::format("{}.{}", path, ++taken));
+        });
+    }
+
+    auto dispatch(int argc, char **argv) -> std::optional<int> {
+        const std::string_view command{ argv[1] };
+        if (command == "repl") return run_repl(argv[0]);
+        if (command == "serve") return run_server(argv[0], argc, argv);
+        if (command == "snapshot" && argc > 2) return build_snapshot(argv[0], argc, argv);
+        if (command == "run" && argc > 3 && std::string_view{ argv[2] } == "--image")
+            return run_image(argv[0], argv[3]);
+        if (command == "run" && argc > 2) return run_script(argv[0], argv[2]);
+        return std::nullopt;
+    }
+}
+
+int main(int argc, char **argv) {
+    if (take_flag(argc, argv, "--time-passes"))
+        mxs::jit::MXCompileTimer::get_timer().enable();
+    strip_asserts = take_flag(argc, argv, "--strip-asserts");
+    // 分析器要在创建 JIT 之前打开，JIT 才会保留帧指针并登记加载的函数
+    auto profile = take_option(argc, argv, "--profile");
+    if (profile) {
+        if (profile->empty()) *profile = "mxs.folded";
+        auto &profiler = mxs::jit::MXProfiler::get_profiler();
+        profiler.enable();
+        if (!profiler.start()) std::cerr << "mxs: --profile is not available here\n";
+    }
+    auto trace = take_option(argc, argv, "--trace");
+    if (trace) {
+        if (trace->empty()) *trace = "mxs.trace.json";
+        mxs::core::MXTracer::get_tracer().enable();
+    }
+    const auto alloc_profile = take_option(argc, argv, "--alloc-profile");
+    if (alloc_profile) start_alloc_profile(*alloc_profile);
+    auto heap_snapshot = take_option(argc, argv, "--heap-snapshot");
+    if (heap_snapshot) {
+        if (heap_snapshot->empty()) *heap_snapshot = "mxs.heapsnapshot";
+        start_heap_snapshots(*heap_snapshot);
+    }
+    mxs::driver::start_metrics_export();
+    if (argc > 1) {
+        if (auto status = dispatch(argc, argv)) {
+            auto &timer = mxs::jit::MXCompileTimer::get_timer();
+            if (timer.enabled()) timer.report(std::cerr);
+            if (profile) write_profile(*profile);
+            if (trace) write_trace(*trace);
+            if (alloc_profile) write_alloc_report(*alloc_profile);
+            if (heap_snapshot) write_heap_snapshot(*heap_snapshot);
+            mxs::driver::dump_metrics();
+            return *status;
+        }
+    }
     mxs::core::MXError *error[21] = {
         new mxs::core::MXError{ "SyntaxError", "This is a messange", nullptr, false,
                                 false },
@@ -0,0 +1,131 @@
+#include "mxspp/core/MXMetrics.h"
+#include "mxspp/driver/driver.h"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <format>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+#include <string_view>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <thread>
+#include <unistd.h>
+
+namespace mxs::driver {
+    namespace {
+        auto metrics_text() -> std::string {
+            std::ostringstream out;
+            core::MXMetricsRegistry::get_registry().write_prometheus(out);
+            return out.str();
+        }
+
+        auto send_all(int fd, std::string_view data) -> void {
+            while (!data.empty()) {
+                const ssize_t sent = ::send(fd, data.data(), data.size(), MSG_NOSIGNAL);
+                if (sent < 0 && errno == EINTR) continue;
+                if (sent <= 0) return;
+                data.remove_prefix(static_cast<std::size_t>(sent));
+            }
+        }
+
+        // 先读完请求头再应答：客户端还在发送时就关闭连接，它会收到 RST。
+        // 什么都不发的客户端（socat、nc）等一秒超时后照样拿到指标
+        auto answer_scrape(int client) -> void {
+            timeval timeout{ 1, 0 };
+            ::setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+            std::string request;
+            char buffer[1024];
+            while (!request.contains("\r\n\r\n") && request.size() < 8192) {
+                const ssize_t got = ::read(client, buffer, sizeof(buffer));
+                if (got < 0 && errno == EINTR) continue;
+                if (got <= 0) break;
+                request.append(buffer, static_cast<std::size_t>(got));
+            }
+            const auto body = metrics_text();
+            if (request.starts_with("GET ")) {
+                send_all(client, std::format("HTTP/1.0 200 OK\r\n"
+                                             "Content-Type: text/plain; version=0.0.4\r\n"
+                                             "Content-Length: {}\r\n\r\n",
+                                             body.size()));
+            }
+            send_all(client, body);
+        }
+
+        // 描述符或内存耗尽时监听套接字一直可读，立即重试只会空转：退避后重试，
+        // 最长等一秒。其他错误（套接字失效等）重试也不会好，报告后停止导出
+        auto serve_scrapes(int listener) -> void {
+            constexpr auto MAX_BACKOFF = std::chrono::milliseconds(1000);
+            auto backoff = std::chrono::milliseconds(10);
+            while (true) {
+                const int client = ::accept4(listener, nullptr, nullptr, SOCK_CLOEXEC);
+                if (client >= 0) {
+                    backoff = std::chrono::milliseconds(10);
+                    answer_scrape(client);
+                    ::close(client);
+                    continue;
+                }
+                if (errno == EINTR || errno == ECONNABORTED) continue;
+                if (errno == EMFILE || errno == ENFILE || errno == ENOBUFS
+                    || errno == ENOMEM) {
+                    std::this_thread::sleep_for(backoff);
+                    backoff = std::min(backoff * 2, MAX_BACKOFF);
+                    continue;
+                }
+                std::perror("mxs: metrics socket accept failed, export stopped");
+                ::close(listener);
+                return;
+            }
+        }
+
+        // 先写临时文件再改名，读取方不会看到写了一半的内容；
+        // 定时线程和退出时的最后一次写入共用同一个临时文件，需要互斥
+        auto write_metrics_file(const std::string &path) -> void {
+            static std::mutex lock;
+            std::scoped_lock guard(lock);
+            const auto temp = path + ".tmp";
+            {
+                std::ofstream out(temp, std::ios::trunc);
+                if (!out) return;
+                out << metrics_text();
+                if (!out.flush()) return;
+            }
+            std::rename(temp.c_str(), path.c_str());
+        }
+
+        auto metrics_file() -> const char * {
+            const char *path = std::getenv("MXS_METRICS_FILE");
+            return path && *path ? path : nullptr;
+        }
+    }
+
+    auto start_metrics_export() -> void {
+        const char *socket_path = std::getenv("MXS_METRICS_SOCKET");
+        if (socket_path && *socket_path) {
+            const int listener = listen_socket(socket_path);
+            if (listener < 0) {
+                std::perror(std::format("mxs: cannot listen on {}", socket_path).c_str());
+            } else {
+                std::thread([listener] { serve_scrapes(listener); }).detach();
+            }
+        }
+        if (const char *path = metrics_file()) {
+            long interval = 10;
+            if (const char *value = std::getenv("MXS_METRICS_INTERVAL"))
+                interval = std::max(1L, std::strtol(value, nullptr, 10));
+            std::thread([path = std::string{ path }, interval] {
+                while (true) {
+                    write_metrics_file(path);
+                    std::this_thread::sleep_for(std::chrono::seconds(interval));
+                }
+            }).detach();
+        }
+    }
+
+    auto dump_metrics() -> void {
+        if (const char *path = metrics_file()) write_metrics_file(path);
+    }
+}
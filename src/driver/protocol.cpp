@@ -0,0 +1,181 @@
+#include "mxspp/driver/driver.h"
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <format>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace mxs::driver {
+    namespace {
+        auto write_all(int fd, const void *data, std::size_t size) -> bool {
+            const auto *bytes = static_cast<const char *>(data);
+            while (size > 0) {
+                const ssize_t written = ::write(fd, bytes, size);
+                if (written < 0) {
+                    if (errno == EINTR) continue;
+                    return false;
+                }
+                bytes += written;
+                size -= static_cast<std::size_t>(written);
+            }
+            return true;
+        }
+
+        auto read_all(int fd, void *data, std::size_t size) -> bool {
+            auto *bytes = static_cast<char *>(data);
+            while (size > 0) {
+                const ssize_t got = ::read(fd, bytes, size);
+                if (got < 0 && errno == EINTR) continue;
+                if (got <= 0) return false;
+                bytes += got;
+                size -= static_cast<std::size_t>(got);
+            }
+            return true;
+        }
+
+        auto socket_address(const std::string &path, sockaddr_un &address) -> bool {
+            address = {};
+            address.sun_family = AF_UNIX;
+            if (path.size() >= sizeof(address.sun_path)) return false;
+            std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+            return true;
+        }
+
+        // 头部来自另一个进程，先校验再按其中的长度分配内存
+        auto valid_header(const RequestHeader &header) -> bool {
+            if (header.magic != RequestHeader::MAGIC) return false;
+            switch (header.command) {
+                case Command::RUN:
+                case Command::COMPILE:
+                case Command::SHUTDOWN:
+                    break;
+                default:
+                    return false;
+            }
+            return header.name_size <= RequestHeader::MAX_NAME_SIZE
+                   && header.source_size <= RequestHeader::MAX_SOURCE_SIZE;
+        }
+    }
+
+    auto default_socket_path() -> std::string {
+        if (const char *path = std::getenv("MXS_SOCKET")) return path;
+        if (const char *dir = std::getenv("XDG_RUNTIME_DIR"))
+            return std::format("{}/mxs.sock", dir);
+        return std::format("/tmp/mxs-{}.sock", ::getuid());
+    }
+
+    auto connect_server(const std::string &path) -> int {
+        sockaddr_un address{};
+        if (!socket_address(path, address)) return -1;
+        const int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (fd < 0) return -1;
+        if (::connect(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0) {
+            ::close(fd);
+            return -1;
+        }
+        return fd;
+    }
+
+    auto listen_socket(const std::string &path) -> int {
+        sockaddr_un address{};
+        if (!socket_address(path, address)) return -1;
+        const int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (fd < 0) return -1;
+        ::unlink(path.c_str());
+        // 套接字只允许当前用户连接：脚本以服务进程的权限运行
+        const mode_t mask = ::umask(0077);
+        const auto *raw = reinterpret_cast<sockaddr *>(&address);
+        const bool bound = ::bind(fd, raw, sizeof(address)) == 0;
+        ::umask(mask);
+        if (!bound || ::listen(fd, 64) != 0) {
+            ::close(fd);
+            return -1;
+        }
+        return fd;
+    }
+
+    auto send_request(int socket, const Request &request) -> bool {
+        RequestHeader header;
+        header.command = request.command;
+        header.name_size = request.name.size();
+        header.source_size = request.source.size();
+
+        // 头部和三个描述符放在同一条消息里发送
+        iovec part{ &header, sizeof(header) };
+        alignas(cmsghdr) char control[CMSG_SPACE(sizeof(request.fds))]{};
+        msghdr message{};
+        message.msg_iov = &part;
+        message.msg_iovlen = 1;
+        message.msg_control = control;
+        message.msg_controllen = sizeof(control);
+        cmsghdr *fds = CMSG_FIRSTHDR(&message);
+        fds->cmsg_level = SOL_SOCKET;
+        fds->cmsg_type = SCM_RIGHTS;
+        fds->cmsg_len = CMSG_LEN(sizeof(request.fds));
+        std::memcpy(CMSG_DATA(fds), request.fds.data(), sizeof(request.fds));
+
+        ssize_t sent = 0;
+        do {
+            sent = ::sendmsg(socket, &message, MSG_NOSIGNAL);
+        } while (sent < 0 && errno == EINTR);
+        if (sent < 0) return false;
+        const auto rest = static_cast<std::size_t>(sent);
+        return write_all(socket, reinterpret_cast<char *>(&header) + rest,
+                         sizeof(header) - rest)
+               && write_all(socket, request.name.data(), request.name.size())
+               && write_all(socket, request.source.data(), request.source.size());
+    }
+
+    auto receive_request(int socket, Request &request) -> bool {
+        RequestHeader header;
+        iovec part{ &header, sizeof(header) };
+        alignas(cmsghdr) char control[CMSG_SPACE(sizeof(request.fds))]{};
+        msghdr message{};
+        message.msg_iov = &part;
+        message.msg_iovlen = 1;
+        message.msg_control = control;
+        message.msg_controllen = sizeof(control);
+
+        ssize_t got = 0;
+        do {
+            got = ::recvmsg(socket, &message, MSG_CMSG_CLOEXEC);
+        } while (got < 0 && errno == EINTR);
+        if (got <= 0) return false;
+
+        request.fds = { -1, -1, -1 };
+        for (cmsghdr *c = CMSG_FIRSTHDR(&message); c; c = CMSG_NXTHDR(&message, c)) {
+            if (c->cmsg_level == SOL_SOCKET && c->cmsg_type == SCM_RIGHTS
+                && c->cmsg_len == CMSG_LEN(sizeof(request.fds)))
+                std::memcpy(request.fds.data(), CMSG_DATA(c), sizeof(request.fds));
+        }
+        const auto rest = static_cast<std::size_t>(got);
+        bool ok = read_all(socket, reinterpret_cast<char *>(&header) + rest,
+                           sizeof(header) - rest)
+                  && valid_header(header);
+        if (ok) {
+            request.command = header.command;
+            request.name.resize(header.name_size);
+            request.source.resize(header.source_size);
+            ok = read_all(socket, request.name.data(), request.name.size())
+                 && read_all(socket, request.source.data(), request.source.size());
+        }
+        if (!ok) {
+            for (int &fd : request.fds) {
+                if (fd >= 0) ::close(fd);
+                fd = -1;
+            }
+        }
+        return ok;
+    }
+
+    auto send_status(int socket, std::int32_t status) -> bool {
+        return write_all(socket, &status, sizeof(status));
+    }
+
+    auto receive_status(int socket, std::int32_t &status) -> bool {
+        return read_all(socket, &status, sizeof(status));
+    }
+}
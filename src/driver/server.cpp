@@ -0,0 +1,139 @@
+#include "mxspp/core/MXMetrics.h"
+#include "mxspp/core/MXOutputStream.h"
+#include "mxspp/core/MXPopulationManager.h"
+#include "mxspp/driver/driver.h"
+#include "mxspp/shell/shell.h"
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <iostream>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <thread>
+#include <unistd.h>
+
+namespace mxs::driver {
+    namespace {
+        // 请求串行处理，一个连上却迟迟不发完请求的客户端会卡住所有后来者。
+        // 超时按单次 read 计：只要数据还在流动，大的源码也能慢慢传完
+        constexpr auto REQUEST_TIMEOUT = std::chrono::seconds(5);
+
+        auto set_receive_timeout(int socket) -> bool {
+            timeval timeout{ .tv_sec = static_cast<time_t>(REQUEST_TIMEOUT.count()),
+                             .tv_usec = 0 };
+            return ::setsockopt(socket, SOL_SOCKET, SO_RCVTIMEO, &timeout,
+                                sizeof(timeout))
+                   == 0;
+        }
+
+        // 运行脚本期间把客户端的 stdin/stdout/stderr 装到 0-2 号描述符上
+        class StdioRedirect {
+        public:
+            explicit StdioRedirect(const std::array<int, 3> &fds) {
+                for (int i = 0; i < 3; ++i) {
+                    this->saved_[i] = ::dup(i);
+                    if (fds[i] >= 0) ::dup2(fds[i], i);
+                }
+                reset_policies();
+            }
+
+            ~StdioRedirect() {
+                flush_all();
+                for (int i = 0; i < 3; ++i) {
+                    if (this->saved_[i] < 0) continue;
+                    ::dup2(this->saved_[i], i);
+                    ::close(this->saved_[i]);
+                }
+                reset_policies();
+            }
+
+            StdioRedirect(const StdioRedirect &) = delete;
+            auto operator=(const StdioRedirect &) -> StdioRedirect & = delete;
+
+        private:
+            static auto flush_all() -> void {
+                core::MXOutputStream::standard_output().flush();
+                core::MXOutputStream::standard_error().flush();
+                std::cout.flush();
+                std::cerr.flush();
+                std::fflush(nullptr);
+            }
+
+            // 终端行缓冲、管道全缓冲，策略跟着当前的 fd 1/2 走
+            static auto reset_policies() -> void {
+                using core::MXOutputStream;
+                MXOutputStream::standard_output().set_policy(
+                        MXOutputStream::default_policy(STDOUT_FILENO));
+                MXOutputStream::standard_error().set_policy(
+                        MXOutputStream::default_policy(STDERR_FILENO));
+            }
+
+            std::array<int, 3> saved_{ -1, -1, -1 };
+        };
+    }
+
+    auto serve(const std::string &path, shell::MXShell &shell) -> int {
+        auto &registry = core::MXMetricsRegistry::get_registry();
+        auto &requests = registry.counter("mxs_server_requests_total",
+                                          "Run and compile requests served.");
+        auto &failures = registry.counter("mxs_server_request_failures_total",
+                                          "Requests whose script exited non-zero.");
+        auto &latency = registry.histogram("mxs_server_request_seconds",
+                                           "Time to compile and run one request.", 1e-9);
+        std::signal(SIGPIPE, SIG_IGN);
+        const int listener = listen_socket(path);
+        if (listener < 0) {
+            std::perror(("mxs: cannot listen on " + path).c_str());
+            return 1;
+        }
+        std::cerr << "mxs: serving on " << path << std::endl;
+
+        bool running = true;
+        while (running) {
+            const int client = [listener] {
+                // 请求之间主线程空闲，堆快照不必等它
+                mxs::core::MXPopulationManager::Parked parked;
+                return ::accept4(listener, nullptr, nullptr, SOCK_CLOEXEC);
+            }();
+            if (client < 0) {
+                // 描述符或内存耗尽时监听套接字一直可读，立即重试只会空转；
+                // 等一会儿让正在运行的脚本释放资源
+                if (errno == EMFILE || errno == ENFILE || errno == ENOBUFS
+                    || errno == ENOMEM)
+                    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+                continue;
+            }
+            Request request;
+            // 超时后 receive_request 失败，连接被丢弃
+            if (set_receive_timeout(client) && receive_request(client, request)) {
+                std::int32_t status = 0;
+                if (request.command == Command::SHUTDOWN) {
+                    running = false;
+                } else {
+                    // 请求串行执行：JIT 和运行时状态在所有脚本间共享
+                    StdioRedirect redirect{ request.fds };
+                    const auto allocations = allocation_count();
+                    const auto started = std::chrono::steady_clock::now();
+                    status = shell.run_program(request.source,
+                                               request.command == Command::RUN,
+                                               request.name);
+                    const std::chrono::nanoseconds elapsed =
+                            std::chrono::steady_clock::now() - started;
+                    requests.add();
+                    if (status != 0) failures.add();
+                    latency.record(static_cast<std::uint64_t>(elapsed.count()));
+                    write_run_stats(shell, allocations);
+                }
+                for (int fd : request.fds) {
+                    if (fd >= 0) ::close(fd);
+                }
+                send_status(client, status);
+            }
+            ::close(client);
+        }
+        ::close(listener);
+        ::unlink(path.c_str());
+        return 0;
+    }
+}
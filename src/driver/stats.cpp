@@ -0,0 +1,28 @@
+#include "mxspp/core/MXPopulationManager.h"
+#include "mxspp/driver/driver.h"
+#include "mxspp/shell/shell.h"
+#include <chrono>
+#include <cstdlib>
+#include <format>
+#include <fstream>
+
+namespace mxs::driver {
+    auto allocation_count() -> std::uint64_t {
+        return core::MXPopulationManager::get_manager().total_registered();
+    }
+
+    auto write_run_stats(const shell::MXShell &shell, std::uint64_t allocations_before)
+            -> void {
+        const char *path = std::getenv("MXS_STATS_FILE");
+        if (!path || !*path) return;
+        const auto &manager = core::MXPopulationManager::get_manager();
+        const std::chrono::duration<double, std::milli> compile =
+                shell.last_compile_time();
+        const auto allocations = manager.total_registered() - allocations_before;
+        // 每次运行覆盖写入，读取方只关心最近一次
+        std::ofstream file(path, std::ios::trunc);
+        file << std::format("{{\"compile_ms\": {:.3f}, \"allocations\": {}, "
+                            "\"live_objects\": {}}}\n",
+                            compile.count(), allocations, manager.live_count());
+    }
+}
@@ -1,7 +1,709 @@
 #include "mxspp/frontend/ast.h"
+#include "mxspp/backend/coroutine.h"
 #include "mxspp/core/MXObject.h"
+#include "mxspp/runtime/runtime.h"
+#include <algorithm>
+#include <cassert>
+#include <format>
+#include <llvm/IR/MDBuilder.h>
+#include <unordered_set>
+#include <variant>
 
 namespace mxs::frontend::ast {
+    namespace {
+        using backend::codegen::CodegenContext;
+        using backend::codegen::emit_box;
+        using backend::codegen::emit_constant;
+        using backend::codegen::OsrEntry;
+        using backend::codegen::runtime_function;
+
+        // 回边执行这么多次后转入 O2 编译的续体。O0 下这大约是几毫秒，
+        // 更短的循环不值得再编译一次
+        constexpr std::int64_t OSR_THRESHOLD = 100'000;
+
+        // 每个泛型函数最多生成这么多个未装箱的实例，之后的类型组合共用装箱实例
+        constexpr std::size_t MAX_SPECIALIZATIONS = 16;
+
+        // 一个块的 defer 在各出口上复制的指令总数超过这个值后，
+        // 之后的出口改为跳进共享的清理块
+        constexpr std::size_t DEFER_CLONE_BUDGET = 256;
+
+        auto object_ptr_type(CodegenContext &ctx) -> llvm::PointerType * {
+            return llvm::PointerType::getUnqual(ctx.llvmContext);
+        }
+
+        auto operator_code(std::string_view op, bool unary)
+                -> std::optional<MXSOperator> {
+            if (unary) {
+                if (op == "-") return MXS_OP_NEG;
+                if (op == "+") return MXS_OP_POS;
+                if (op == "!") return MXS_OP_NOT;
+                return std::nullopt;
+            }
+            if (op == "+") return MXS_OP_ADD;
+            if (op == "-") return MXS_OP_SUB;
+            if (op == "*") return MXS_OP_MUL;
+            if (op == "/") return MXS_OP_DIV;
+            if (op == "%") return MXS_OP_MOD;
+            if (op == "<") return MXS_OP_LT;
+            if (op == "<=") return MXS_OP_LE;
+            if (op == ">") return MXS_OP_GT;
+            if (op == ">=") return MXS_OP_GE;
+            if (op == "==") return MXS_OP_EQ;
+            if (op == "!=") return MXS_OP_NE;
+            return std::nullopt;
+        }
+
+        auto raise(CodegenContext &ctx, const char *type, const std::string &message)
+                -> llvm::Value * {
+            auto &builder = *ctx.builder;
+            auto *ptr_ty = object_ptr_type(ctx);
+            auto error = runtime_function(ctx, "mxs_runtime_error", ptr_ty,
+                                          { ptr_ty, ptr_ty });
+            return builder.CreateCall(error, { builder.CreateGlobalString(type),
+                                               builder.CreateGlobalString(message) });
+        }
+
+        // 条件值统一成 i1：未装箱的数字直接比较，对象交给运行时
+        auto truthy(CodegenContext &ctx, llvm::Value *value) -> llvm::Value * {
+            auto &builder = *ctx.builder;
+            auto *type = value->getType();
+            if (type->isIntegerTy(1)) return value;
+            if (type->isIntegerTy())
+                return builder.CreateICmpNE(value, llvm::ConstantInt::get(type, 0));
+            if (type->isDoubleTy())
+                return builder.CreateFCmpUNE(value, llvm::ConstantFP::get(type, 0.0));
+            auto callee = runtime_function(ctx, "mxs_runtime_truthy", builder.getInt1Ty(),
+                                           { object_ptr_type(ctx) });
+            return builder.CreateCall(callee, { value });
+        }
+
+        auto is_number(llvm::Value *value) -> bool {
+            auto *type = value->getType();
+            return type->isIntegerTy(64) || type->isDoubleTy();
+        }
+
+        // 函数入口处的栈槽：优化时 mem2reg 把它提升回寄存器，async 函数里
+        // 跨越挂起点的槽由 coro-split 搬进协程帧
+        auto entry_alloca(CodegenContext &ctx, llvm::Type *type, const llvm::Twine &name)
+                -> llvm::AllocaInst * {
+            auto &entry = ctx.builder->GetInsertBlock()->getParent()->getEntryBlock();
+            llvm::IRBuilder<> builder(&entry, entry.begin());
+            return builder.CreateAlloca(type, nullptr, name);
+        }
+
+        // 两侧都是未装箱 i64 时内联的运算；整数 / 和 % 需要除零检查，交给运行时
+        auto integer_binary(CodegenContext &ctx, MXSOperator op, llvm::Value *lhs,
+                            llvm::Value *rhs) -> llvm::Value * {
+            auto &builder = *ctx.builder;
+            switch (op) {
+                case MXS_OP_ADD: return builder.CreateAdd(lhs, rhs);
+                case MXS_OP_SUB: return builder.CreateSub(lhs, rhs);
+                case MXS_OP_MUL: return builder.CreateMul(lhs, rhs);
+                case MXS_OP_LT: return builder.CreateICmpSLT(lhs, rhs);
+                case MXS_OP_LE: return builder.CreateICmpSLE(lhs, rhs);
+                case MXS_OP_GT: return builder.CreateICmpSGT(lhs, rhs);
+                case MXS_OP_GE: return builder.CreateICmpSGE(lhs, rhs);
+                case MXS_OP_EQ: return builder.CreateICmpEQ(lhs, rhs);
+                case MXS_OP_NE: return builder.CreateICmpNE(lhs, rhs);
+                default: return nullptr;
+            }
+        }
+
+        auto float_binary(CodegenContext &ctx, MXSOperator op, llvm::Value *lhs,
+                          llvm::Value *rhs) -> llvm::Value * {
+            auto &builder = *ctx.builder;
+            auto *double_ty = builder.getDoubleTy();
+            if (lhs->getType()->isIntegerTy()) lhs = builder.CreateSIToFP(lhs, double_ty);
+            if (rhs->getType()->isIntegerTy()) rhs = builder.CreateSIToFP(rhs, double_ty);
+            switch (op) {
+                case MXS_OP_ADD: return builder.CreateFAdd(lhs, rhs);
+                case MXS_OP_SUB: return builder.CreateFSub(lhs, rhs);
+                case MXS_OP_MUL: return builder.CreateFMul(lhs, rhs);
+                case MXS_OP_DIV: return builder.CreateFDiv(lhs, rhs);
+                case MXS_OP_MOD: return builder.CreateFRem(lhs, rhs);
+                case MXS_OP_LT: return builder.CreateFCmpOLT(lhs, rhs);
+                case MXS_OP_LE: return builder.CreateFCmpOLE(lhs, rhs);
+                case MXS_OP_GT: return builder.CreateFCmpOGT(lhs, rhs);
+                case MXS_OP_GE: return builder.CreateFCmpOGE(lhs, rhs);
+                case MXS_OP_EQ: return builder.CreateFCmpOEQ(lhs, rhs);
+                case MXS_OP_NE: return builder.CreateFCmpUNE(lhs, rhs);
+                default: return nullptr;
+            }
+        }
+
+        // 二元运算：两侧类型在编译期已知为数字时直接生成指令，否则走装箱的运行时路径
+        auto emit_binary(CodegenContext &ctx, MXSOperator code, llvm::Value *lhs,
+                         llvm::Value *rhs) -> llvm::Value * {
+            auto &builder = *ctx.builder;
+            if (is_number(lhs) && is_number(rhs)) {
+                const bool integers =
+                        lhs->getType()->isIntegerTy() && rhs->getType()->isIntegerTy();
+                auto *result = integers ? integer_binary(ctx, code, lhs, rhs)
+                                        : float_binary(ctx, code, lhs, rhs);
+                if (result) return result;
+            }
+            auto *ptr_ty = object_ptr_type(ctx);
+            auto binary = runtime_function(ctx, "mxs_runtime_binary", ptr_ty,
+                                           { builder.getInt32Ty(), ptr_ty, ptr_ty });
+            auto *boxed_lhs = emit_box(ctx, lhs);
+            auto *boxed_rhs = emit_box(ctx, rhs);
+            auto *result = builder.CreateCall(binary, { builder.getInt32(code), boxed_lhs,
+                                                        boxed_rhs });
+            // 为这次调用装箱的操作数只活到调用返回：运算结果总是新对象，
+            // 不会是操作数本身。推测版本里一侧未装箱时每次运算都会走到这里
+            auto release = runtime_function(ctx, "mxs_runtime_release",
+                                            builder.getVoidTy(), { ptr_ty });
+            if (boxed_lhs != lhs) builder.CreateCall(release, { boxed_lhs });
+            if (boxed_rhs != rhs) builder.CreateCall(release, { boxed_rhs });
+            return result;
+        }
+
+        // 把装箱的 value 拆成 type（i64 或 double），整数不会拆成浮点。
+        // 拆箱失败（对象不是这种数字）时跳到 mismatch，否则在新的插入点返回拆出的值
+        auto emit_unbox(CodegenContext &ctx, llvm::Value *value, llvm::Type *type,
+                        llvm::BasicBlock *mismatch) -> llvm::Value * {
+            auto &builder = *ctx.builder;
+            auto *fn = builder.GetInsertBlock()->getParent();
+            auto *ptr_ty = object_ptr_type(ctx);
+            const bool integer = type->isIntegerTy(64);
+            const auto *name =
+                    integer ? "mxs_runtime_unbox_integer" : "mxs_runtime_unbox_float";
+            auto unbox =
+                    runtime_function(ctx, name, builder.getInt1Ty(), { ptr_ty, ptr_ty });
+            auto *slot = entry_alloca(ctx, type, "unboxed");
+            auto *unboxed = llvm::BasicBlock::Create(
+                    ctx.llvmContext, integer ? "unbox.integer" : "unbox.float", fn);
+            builder.CreateCondBr(builder.CreateCall(unbox, { value, slot }), unboxed,
+                                 mismatch);
+            builder.SetInsertPoint(unboxed);
+            return builder.CreateLoad(type, slot);
+        }
+
+        // 全局 i64 计数器数组，外部链接：运行结束后 shell 按名字把它读回来
+        auto counter_array(CodegenContext &ctx, const std::string &name, std::size_t size)
+                -> llvm::GlobalVariable * {
+            auto *type = llvm::ArrayType::get(ctx.builder->getInt64Ty(), size);
+            return new llvm::GlobalVariable(*ctx.module, type, false,
+                                            llvm::GlobalValue::ExternalLinkage,
+                                            llvm::ConstantAggregateZero::get(type), name);
+        }
+
+        // 计数不是原子的：并发调用时偶尔丢一次计数，对类型反馈无妨
+        auto bump(CodegenContext &ctx, llvm::GlobalVariable *counters, llvm::Value *index)
+                -> void {
+            auto &builder = *ctx.builder;
+            auto *slot = builder.CreateInBoundsGEP(counters->getValueType(), counters,
+                                                   { builder.getInt64(0), index });
+            auto *count = builder.CreateLoad(builder.getInt64Ty(), slot);
+            builder.CreateStore(builder.CreateAdd(count, builder.getInt64(1)), slot);
+        }
+
+        // 取每个实参的 MXSValueKind；收集反馈时顺便计入
+        // mxs.feedback.<函数名>[参数序号 * MXS_KIND_COUNT + 类型]
+        auto argument_kinds(CodegenContext &ctx, const std::string &function,
+                            llvm::ArrayRef<llvm::Value *> args)
+                -> std::vector<llvm::Value *> {
+            auto &builder = *ctx.builder;
+            auto value_kind = runtime_function(ctx, "mxs_runtime_value_kind",
+                                               builder.getInt32Ty(),
+                                               { object_ptr_type(ctx) });
+            llvm::GlobalVariable *feedback = nullptr;
+            if (ctx.collect_feedback)
+                feedback = counter_array(ctx, "mxs.feedback." + function,
+                                         args.size() * MXS_KIND_COUNT);
+            std::vector<llvm::Value *> kinds;
+            for (std::size_t i = 0; i < args.size(); ++i) {
+                auto *kind = builder.CreateCall(value_kind, { args[i] });
+                kinds.push_back(kind);
+                if (!feedback) continue;
+                auto *offset = builder.CreateZExt(kind, builder.getInt64Ty());
+                auto *base = builder.getInt64(i * MXS_KIND_COUNT);
+                bump(ctx, feedback, builder.CreateAdd(base, offset));
+            }
+            return kinds;
+        }
+
+        // 类型名对应的实例表示：int / float / bool 不装箱，其余类型都装箱
+        auto instance_type(CodegenContext &ctx, std::string_view type) -> llvm::Type * {
+            auto &builder = *ctx.builder;
+            if (type == "int" || type == "Int") return builder.getInt64Ty();
+            if (type == "float" || type == "Float") return builder.getDoubleTy();
+            if (type == "bool" || type == "Bool") return builder.getInt1Ty();
+            return object_ptr_type(ctx);
+        }
+
+        // 实例符号形如 max<int,boxed>：所有装箱类型共用同一个实例
+        auto instance_symbol(const std::string &function,
+                             const std::vector<llvm::Type *> &type_args) -> std::string {
+            std::string symbol = function + "<";
+            for (std::size_t i = 0; i < type_args.size(); ++i) {
+                if (i) symbol += ",";
+                auto *type = type_args[i];
+                symbol += type->isIntegerTy(64) ? "int"
+                          : type->isDoubleTy()  ? "float"
+                          : type->isIntegerTy(1) ? "bool"
+                                                 : "boxed";
+            }
+            return symbol + ">";
+        }
+
+        // 泛型调用：定下类型参数后调用对应实例。实参的编译期类型对不上未装箱的
+        // 形参，或者该函数的特化实例已满时，退回全部装箱的共享实例
+        auto call_generic(CodegenContext &ctx, const std::string &function,
+                          const std::vector<std::string> &explicit_args,
+                          const backend::codegen::GenericFunction &generic,
+                          std::vector<llvm::Value *> values) -> llvm::Value * {
+            auto &builder = *ctx.builder;
+            auto *ptr_ty = object_ptr_type(ctx);
+            if (values.size() != generic.param_generics.size())
+                return raise(ctx, "TypeError",
+                             std::format("{}() takes {} arguments but {} were given",
+                                         function, generic.param_generics.size(),
+                                         values.size()));
+
+            std::vector<llvm::Type *> type_args;
+            if (!explicit_args.empty()) {
+                if (explicit_args.size() != generic.generic_count)
+                    return raise(
+                            ctx, "TypeError",
+                            std::format("{}() takes {} type arguments but {} were given",
+                                        function, generic.generic_count,
+                                        explicit_args.size()));
+                for (const auto &type : explicit_args)
+                    type_args.push_back(instance_type(ctx, type));
+            } else {
+                // 按实参的编译期类型推断；同一个类型参数推出不同类型时按装箱处理
+                type_args.assign(generic.generic_count, nullptr);
+                for (auto [value, index] : llvm::zip(values, generic.param_generics)) {
+                    if (index < 0) continue;
+                    auto *&type = type_args[index];
+                    type = !type || type == value->getType() ? value->getType() : ptr_ty;
+                }
+                for (auto *&type : type_args)
+                    if (!type) type = ptr_ty;
+            }
+
+            // 未装箱的形参要求实参已经是同一表示，整数可以提升为浮点
+            bool specialize = std::ranges::any_of(
+                    type_args, [](llvm::Type *type) { return !type->isPointerTy(); });
+            for (auto [value, index] : llvm::zip(values, generic.param_generics)) {
+                if (index < 0 || type_args[index]->isPointerTy()) continue;
+                auto *have = value->getType();
+                auto *want = type_args[index];
+                const bool promotes = want->isDoubleTy() && have->isIntegerTy(64);
+                specialize = specialize && (have == want || promotes);
+            }
+            if (specialize &&
+                !ctx.module->getFunction(instance_symbol(function, type_args))) {
+                auto &count = ctx.specializations[function];
+                specialize = count < MAX_SPECIALIZATIONS;
+                if (specialize) ++count;
+            }
+            if (!specialize) type_args.assign(generic.generic_count, ptr_ty);
+
+            auto *fn = generic.instantiate(ctx, type_args);
+            for (auto [value, param] : llvm::zip(values, fn->args())) {
+                auto *want = param.getType();
+                if (want->isPointerTy()) {
+                    value = emit_box(ctx, value);
+                } else if (value->getType() != want) {
+                    value = builder.CreateSIToFP(value, want);
+                }
+            }
+            return builder.CreateCall(fn, values);
+        }
+
+        // 在 scope 对应的 lambda 里取外层的名字：第一次读到时占一个环境槽，
+        // 在入口处载入一次。外层本身也是 lambda 时先让它捕获。let mut 变量
+        // 捕获的是它的格子，载入的指针同样是格子
+        auto capture(CodegenContext &ctx, backend::codegen::ClosureScope *scope,
+                     const std::string &name) -> llvm::Value * {
+            if (!scope) return nullptr;
+            auto it = scope->outer.find(name);
+            llvm::Value *value = it != scope->outer.end() ? it->second : nullptr;
+            if (!value) {
+                value = capture(ctx, scope->parent, name);
+                if (!value) return nullptr;
+                scope->outer[name] = value;
+            }
+            assert(!llvm::isa<llvm::AllocaInst>(value) &&
+                   "a let mut variable that lambdas capture lives in a cell");
+            const auto slot = scope->captured.size();
+            scope->captured.push_back(value);
+            llvm::IRBuilder<> builder(scope->entry->getTerminator());
+            auto *address = builder.CreateConstInBoundsGEP1_64(
+                    builder.getInt64Ty(), scope->environment, slot);
+            auto *loaded = builder.CreateLoad(value->getType(), address, name);
+            if (ctx.cells.contains(value)) ctx.cells.insert(loaded);
+            return loaded;
+        }
+
+        // let mut 变量的存放处和其中值的类型：栈槽，或者被 lambda 捕获时堆上的
+        // 格子（总是装箱的）。其他命名值返回 nullptr
+        auto mutable_storage(CodegenContext &ctx, llvm::Value *value)
+                -> std::pair<llvm::Value *, llvm::Type *> {
+            if (auto *variable = llvm::dyn_cast<llvm::AllocaInst>(value))
+                return { variable, variable->getAllocatedType() };
+            if (ctx.cells.contains(value)) return { value, object_ptr_type(ctx) };
+            return { nullptr, nullptr };
+        }
+
+        // 局部名字：本函数的命名值，或者 lambda 从外层捕获的值。
+        // let mut 变量的命名值是它的栈槽或格子，读的是当前值
+        auto local_value(CodegenContext &ctx, const std::string &name) -> llvm::Value * {
+            auto it = ctx.namedValues.find(name);
+            llvm::Value *value = it != ctx.namedValues.end() ? it->second : nullptr;
+            if (!value) {
+                value = capture(ctx, ctx.closure, name);
+                if (!value) return nullptr;
+                ctx.namedValues[name] = value;
+            }
+            if (auto [address, type] = mutable_storage(ctx, value); address)
+                return ctx.builder->CreateLoad(type, address, name);
+            return value;
+        }
+
+        // 不捕获地查找局部名字：本函数的命名值，或者外层 lambda 创建处的值
+        auto find_local(CodegenContext &ctx, const std::string &name) -> llvm::Value * {
+            if (auto it = ctx.namedValues.find(name); it != ctx.namedValues.end())
+                return it->second;
+            for (auto *scope = ctx.closure; scope; scope = scope->parent) {
+                if (auto it = scope->outer.find(name); it != scope->outer.end())
+                    return it->second;
+            }
+            return nullptr;
+        }
+
+        // let mut 变量在它的作用域（之后的语句）里怎么被用到。不区分遮蔽它的
+        // 同名绑定：多算进来的用法只会让变量保守地装箱或放进格子
+        struct MutableUses {
+            // 函数体里对它的赋值；lambda 里的赋值写的是格子，不在这里
+            std::vector<const Assignment *> assignments;
+            // 作用域里被 let 重新绑定的名字，到赋值处时它们的类型可能已经变了
+            std::unordered_set<std::string> rebound;
+            // 有 lambda 读、写或调用它
+            bool captured = false;
+        };
+
+        auto collect_uses(const MXASTNode *node, const std::string &name,
+                          MutableUses &uses, bool in_lambda = false) -> void {
+            const auto visit = [&](const auto &child) {
+                if (child) collect_uses(child.get(), name, uses, in_lambda);
+            };
+            if (auto *block = dynamic_cast<const Block *>(node)) {
+                for (const auto &statement : block->statements) visit(statement);
+            } else if (auto *let = dynamic_cast<const LetStatement *>(node)) {
+                uses.rebound.insert(let->names.begin(), let->names.end());
+                visit(let->value);
+            } else if (auto *statement = dynamic_cast<const ExprStatement *>(node)) {
+                visit(statement->expr);
+            } else if (auto *branch = dynamic_cast<const IfStatement *>(node)) {
+                visit(branch->condition);
+                visit(branch->thenBlock);
+                visit(branch->elseBlock);
+            } else if (auto *loop = dynamic_cast<const LoopStatement *>(node)) {
+                visit(loop->until);
+                visit(loop->body);
+            } else if (auto *result = dynamic_cast<const ReturnStatement *>(node)) {
+                visit(result->value);
+            } else if (auto *check = dynamic_cast<const AssertStatement *>(node)) {
+                visit(check->condition);
+            } else if (auto *deferred = dynamic_cast<const DeferStatement *>(node)) {
+                visit(deferred->body);
+            } else if (auto *identifier = dynamic_cast<const Identifier *>(node)) {
+                if (in_lambda && identifier->name == name) uses.captured = true;
+            } else if (auto *assignment = dynamic_cast<const Assignment *>(node)) {
+                if (assignment->name == name) {
+                    if (in_lambda) {
+                        uses.captured = true;
+                    } else {
+                        uses.assignments.push_back(assignment);
+                    }
+                }
+                visit(assignment->value);
+            } else if (auto *binary = dynamic_cast<const BinaryOp *>(node)) {
+                visit(binary->left);
+                visit(binary->right);
+            } else if (auto *unary = dynamic_cast<const UnaryOp *>(node)) {
+                visit(unary->operand);
+            } else if (auto *await = dynamic_cast<const AwaitExpression *>(node)) {
+                visit(await->operand);
+            } else if (auto *call = dynamic_cast<const FunctionCall *>(node)) {
+                if (in_lambda && call->name == name) uses.captured = true;
+                for (const auto &arg : call->args) visit(arg);
+            } else if (auto *lambda = dynamic_cast<const LambdaExpression *>(node)) {
+                if (lambda->result) collect_uses(lambda->result.get(), name, uses, true);
+                if (lambda->body) collect_uses(lambda->body.get(), name, uses, true);
+            }
+        }
+
+        // 未装箱算术的结果类型，和 emit_binary 一致：+ - * 两侧都是整数时是
+        // 整数，/ 和 % 只有带浮点时才内联。nullptr 表示结果是装箱的
+        auto binary_kind(CodegenContext &ctx, std::string_view op, llvm::Type *lhs,
+                         llvm::Type *rhs) -> llvm::Type * {
+            if (!lhs || !rhs) return nullptr;
+            const bool integers = lhs->isIntegerTy() && rhs->isIntegerTy();
+            if (op == "+" || op == "-" || op == "*")
+                return integers ? lhs : ctx.builder->getDoubleTy();
+            if (op == "/" || op == "%")
+                return integers ? nullptr : ctx.builder->getDoubleTy();
+            return nullptr;
+        }
+
+        // 编译期能证明 expr 的值是未装箱的 i64 或 double 时返回这个类型，否则
+        // 返回 nullptr。let mut 变量 `name` 按 kind 算；其他名字按现在的绑定算，
+        // 但作用域里会重新绑定的名字和别的 let mut 变量（值会变）不算
+        auto numeric_kind(CodegenContext &ctx, const Expression *expr,
+                          const std::string &name, llvm::Type *kind,
+                          const MutableUses &uses) -> llvm::Type * {
+            auto &builder = *ctx.builder;
+            if (dynamic_cast<const IntegerLiteral *>(expr)) return builder.getInt64Ty();
+            if (dynamic_cast<const FloatLiteral *>(expr)) return builder.getDoubleTy();
+            if (auto *identifier = dynamic_cast<const Identifier *>(expr)) {
+                if (identifier->name == name) return kind;
+                if (uses.rebound.contains(identifier->name)) return nullptr;
+                if (auto *value = find_local(ctx, identifier->name))
+                    return is_number(value) ? value->getType() : nullptr;
+                auto it = ctx.constants.find(identifier->name);
+                if (it == ctx.constants.end()) return nullptr;
+                if (std::holds_alternative<std::int64_t>(it->second))
+                    return builder.getInt64Ty();
+                if (std::holds_alternative<double>(it->second))
+                    return builder.getDoubleTy();
+                return nullptr;
+            }
+            if (auto *unary = dynamic_cast<const UnaryOp *>(expr)) {
+                if (unary->op != "-" && unary->op != "+") return nullptr;
+                return numeric_kind(ctx, unary->operand.get(), name, kind, uses);
+            }
+            if (auto *binary = dynamic_cast<const BinaryOp *>(expr)) {
+                return binary_kind(
+                        ctx, binary->op,
+                        numeric_kind(ctx, binary->left.get(), name, kind, uses),
+                        numeric_kind(ctx, binary->right.get(), name, kind, uses));
+            }
+            return nullptr;
+        }
+
+        // let mut 变量的栈槽类型：初值和作用域里每次赋值的结果都能证明是同一种
+        // 数字时不装箱，否则装箱存放，任何值都能存进去
+        auto mutable_slot_type(CodegenContext &ctx, llvm::Value *initial,
+                               const std::string &name, const MutableUses &uses)
+                -> llvm::Type * {
+            auto *boxed = object_ptr_type(ctx);
+            if (!is_number(initial) || uses.captured) return boxed;
+            auto *kind = initial->getType();
+            for (const auto *assignment : uses.assignments) {
+                auto *assigned =
+                        numeric_kind(ctx, assignment->value.get(), name, kind, uses);
+                if (assignment->op != "=") {
+                    const auto op = std::string_view{ assignment->op }.substr(0, 1);
+                    assigned = binary_kind(ctx, op, kind, assigned);
+                }
+                if (assigned != kind) return boxed;
+            }
+            return kind;
+        }
+
+        // 依次生成语句，直到块被 return / break 终结。let 语句以它之后的语句
+        // 为作用域
+        auto emit_statements(CodegenContext &ctx,
+                             std::span<const std::unique_ptr<Statement>> statements)
+                -> void {
+            for (std::size_t i = 0; i < statements.size(); ++i) {
+                // 后续语句不可达
+                if (ctx.builder->GetInsertBlock()->getTerminator()) break;
+                const auto &statement = statements[i];
+                backend::codegen::set_location(ctx, statement->location);
+                if (auto *let = dynamic_cast<const LetStatement *>(statement.get())) {
+                    let->bind(ctx, statements.subspan(i + 1));
+                } else {
+                    statement->codegen(ctx);
+                }
+            }
+        }
+
+        // 调用闭包：来自本函数里 lambda 字面量的直接调用它的代码，优化时可以
+        // 内联；其他值由运行时核对是闭包且参数个数相符，再间接调用
+        auto call_closure(CodegenContext &ctx, const std::string &name,
+                          llvm::Value *closure, std::vector<llvm::Value *> values)
+                -> llvm::Value * {
+            auto &builder = *ctx.builder;
+            auto *ptr_ty = object_ptr_type(ctx);
+            const auto arity = values.size();
+            for (auto &value : values) value = emit_box(ctx, value);
+            auto environment = runtime_function(ctx, "mxs_runtime_closure_environment",
+                                                ptr_ty, { ptr_ty });
+            std::vector<llvm::Type *> param_types(arity + 1, ptr_ty);
+            auto *type = llvm::FunctionType::get(ptr_ty, param_types, false);
+            auto known = ctx.lambdas.find(closure);
+            if (known != ctx.lambdas.end() && known->second->getFunctionType() == type) {
+                auto *slots = builder.CreateCall(environment, { closure });
+                values.insert(values.begin(), slots);
+                return builder.CreateCall(known->second, values);
+            }
+
+            // 局部名字也可能绑定着未装箱的数字，由运行时报错
+            closure = emit_box(ctx, closure);
+            auto *fn = builder.GetInsertBlock()->getParent();
+            auto code_of = runtime_function(ctx, "mxs_runtime_closure_code", ptr_ty,
+                                            { ptr_ty, builder.getInt64Ty() });
+            auto *code = builder.CreateCall(
+                    code_of, { closure, builder.getInt64(arity) });
+            auto *call_block =
+                    llvm::BasicBlock::Create(ctx.llvmContext, "call.closure", fn);
+            auto *invalid = llvm::BasicBlock::Create(ctx.llvmContext, "call.invalid", fn);
+            auto *end = llvm::BasicBlock::Create(ctx.llvmContext, "call.end", fn);
+            builder.CreateCondBr(builder.CreateIsNull(code), invalid, call_block);
+
+            builder.SetInsertPoint(call_block);
+            values.insert(values.begin(), builder.CreateCall(environment, { closure }));
+            auto *result = builder.CreateCall(type, code, values);
+            builder.CreateBr(end);
+
+            builder.SetInsertPoint(invalid);
+            auto *error = raise(ctx, "TypeError",
+                                std::format("'{}' is not a closure taking {} arguments",
+                                            name, arity));
+            builder.CreateBr(end);
+
+            builder.SetInsertPoint(end);
+            auto *phi = builder.CreatePHI(ptr_ty, 2);
+            phi->addIncoming(result, call_block);
+            phi->addIncoming(error, invalid);
+            return phi;
+        }
+
+        // 按登记的逆序生成 scope 里前 count 个 defer，各自看到登记时的命名值
+        auto emit_deferred(CodegenContext &ctx, const backend::codegen::DeferScope &scope,
+                           std::size_t count) -> void {
+            for (auto i = count; i-- > 0;) {
+                if (ctx.builder->GetInsertBlock()->getTerminator()) return;
+                const auto &deferred = scope.deferred[i];
+                auto named = std::exchange(ctx.namedValues, deferred.named);
+                deferred.emit(ctx);
+                ctx.namedValues = std::move(named);
+            }
+        }
+
+        // 离开一个块：把它的 defer 复制到当前出口上；复制得太多以后改为带着
+        // 出口编号和结果跳进共享的清理块，从清理块分派回来后继续。返回之后
+        // 应使用的结果
+        auto unwind_scope(CodegenContext &ctx, backend::codegen::DeferScope &scope,
+                          llvm::Value *value) -> llvm::Value * {
+            if (scope.deferred.empty()) return value;
+            auto &builder = *ctx.builder;
+            auto *fn = builder.GetInsertBlock()->getParent();
+            if (scope.cloned < DEFER_CLONE_BUDGET) {
+                const auto before = fn->getInstructionCount();
+                emit_deferred(ctx, scope, scope.deferred.size());
+                scope.cloned += fn->getInstructionCount() - before;
+                return value;
+            }
+
+            auto &cleanup = scope.cleanups[scope.deferred.size()];
+            if (!cleanup.block) {
+                llvm::IRBuilderBase::InsertPointGuard guard(builder);
+                cleanup.block =
+                        llvm::BasicBlock::Create(ctx.llvmContext, "defer.cleanup", fn);
+                builder.SetInsertPoint(cleanup.block);
+                cleanup.exit = builder.CreatePHI(builder.getInt32Ty(), 2, "defer.exit");
+                cleanup.value = builder.CreatePHI(object_ptr_type(ctx), 2, "defer.value");
+                emit_deferred(ctx, scope, scope.deferred.size());
+                if (!builder.GetInsertBlock()->getTerminator()) {
+                    auto *invalid = llvm::BasicBlock::Create(ctx.llvmContext,
+                                                             "defer.invalid", fn);
+                    cleanup.dispatch = builder.CreateSwitch(cleanup.exit, invalid);
+                    builder.SetInsertPoint(invalid);
+                    builder.CreateUnreachable();
+                }
+            }
+            auto *from = builder.GetInsertBlock();
+            auto *exit = builder.getInt32(cleanup.exit->getNumIncomingValues());
+            cleanup.exit->addIncoming(exit, from);
+            cleanup.value->addIncoming(emit_box(ctx, value), from);
+            builder.CreateBr(cleanup.block);
+            // 清理代码总是 return 时，resume 不可达，后面的代码照常生成即可
+            auto *resume = llvm::BasicBlock::Create(ctx.llvmContext, "defer.resume", fn);
+            if (cleanup.dispatch) cleanup.dispatch->addCase(exit, resume);
+            builder.SetInsertPoint(resume);
+            return cleanup.value;
+        }
+
+        // 离开 defers[depth..] 这些块（内层在先），再由 leave 生成真正的出口。
+        // 生成某个块的 defer 时只有它外层的块仍然打开，defer 里的 return
+        // 只会再展开外层
+        auto unwind(CodegenContext &ctx, std::size_t depth, llvm::Value *value,
+                    const std::function<void(llvm::Value *)> &leave) -> void {
+            std::vector<backend::codegen::DeferScope> left;
+            bool terminated = false;
+            while (ctx.defers.size() > depth && !terminated) {
+                left.push_back(std::move(ctx.defers.back()));
+                ctx.defers.pop_back();
+                value = unwind_scope(ctx, left.back(), value);
+                terminated = ctx.builder->GetInsertBlock()->getTerminator();
+            }
+            if (!terminated) leave(value);
+            for (auto it = left.rbegin(); it != left.rend(); ++it)
+                ctx.defers.push_back(std::move(*it));
+        }
+
+        // 带着已装箱的 value 离开当前函数：先展开所有打开的块里的 defer
+        auto emit_return(CodegenContext &ctx, llvm::Value *value) -> void {
+            unwind(ctx, 0, value, [&](llvm::Value *result) {
+                if (ctx.coroutine) {
+                    backend::codegen::emit_coroutine_return(ctx, *ctx.coroutine, result);
+                } else {
+                    ctx.builder->CreateRet(result);
+                }
+            });
+        }
+
+        // 回边计数到阈值时请宿主（shell 定义的 mxs.osr.compile）编译续体；成功就
+        // 带着装箱的活跃值跳过去，续体的返回值就是整个函数的返回值。编译失败
+        // 则留在基线代码里继续循环，计数器越过阈值后不会再尝试
+        auto emit_osr_backedge(CodegenContext &ctx, const OsrEntry &entry,
+                               llvm::Value *counter, llvm::BasicBlock *resume) -> void {
+            auto &builder = *ctx.builder;
+            auto *fn = builder.GetInsertBlock()->getParent();
+            auto *ptr_ty = object_ptr_type(ctx);
+            auto *taken = builder.CreateLoad(builder.getInt64Ty(), counter);
+            auto *count = builder.CreateAdd(taken, builder.getInt64(1));
+            builder.CreateStore(count, counter);
+            auto *osr = llvm::BasicBlock::Create(ctx.llvmContext, "loop.osr", fn);
+            auto *hot = builder.CreateICmpEQ(count, builder.getInt64(OSR_THRESHOLD));
+            llvm::MDBuilder metadata(ctx.llvmContext);
+            auto *weights = metadata.createBranchWeights(1, OSR_THRESHOLD);
+            builder.CreateCondBr(hot, osr, resume, weights);
+
+            builder.SetInsertPoint(osr);
+            auto compile =
+                    runtime_function(ctx, "mxs.osr.compile", ptr_ty, { ptr_ty, ptr_ty });
+            auto *site =
+                    ctx.module->getOrInsertGlobal("mxs.osr.context", builder.getInt8Ty());
+            auto *target = builder.CreateCall(
+                    compile, { site, builder.CreateGlobalString(entry.symbol) });
+            auto *enter = llvm::BasicBlock::Create(ctx.llvmContext, "loop.osr.enter", fn);
+            builder.CreateCondBr(builder.CreateIsNull(target), resume, enter);
+
+            builder.SetInsertPoint(enter);
+            std::vector<llvm::Value *> live;
+            for (const auto &[name, value] : entry.live) {
+                // 栈槽里的 let mut 变量传它此刻的值，格子原样传过去，让续体和
+                // 闭包仍然共用它；其余命名值在循环开始前就已确定
+                auto *current = value;
+                if (auto *slot = llvm::dyn_cast<llvm::AllocaInst>(value))
+                    current = builder.CreateLoad(slot->getAllocatedType(), slot, name);
+                live.push_back(ctx.cells.contains(value) ? current
+                                                         : emit_box(ctx, current));
+            }
+            std::vector<llvm::Type *> live_types(live.size(), ptr_ty);
+            auto *type = llvm::FunctionType::get(ptr_ty, live_types, false);
+            builder.CreateRet(builder.CreateCall(type, target, live));
+        }
+    }
+
     IntegerLiteral::IntegerLiteral(int64_t value, bool is_static)
         : core::MXObject(is_static), MXASTNode(is_static), value(value) { }
     llvm::Value *
@@ -11,4 +713,829 @@ namespace mxs::frontend::ast {
                                       true// 有符号
         );
     }
-}
\ No newline at end of file
+
+    FloatLiteral::FloatLiteral(double value, bool is_static)
+        : core::MXObject(is_static), MXASTNode(is_static), value(value) { }
+    llvm::Value *FloatLiteral::codegen(mxs::backend::codegen::CodegenContext &ctx) const {
+        return emit_constant(ctx, value);
+    }
+
+    BooleanLiteral::BooleanLiteral(bool value, bool is_static)
+        : core::MXObject(is_static), MXASTNode(is_static), value(value) { }
+    llvm::Value *
+    BooleanLiteral::codegen(mxs::backend::codegen::CodegenContext &ctx) const {
+        return emit_constant(ctx, value);
+    }
+
+    StringLiteral::StringLiteral(std::string value, bool is_static)
+        : core::MXObject(is_static), MXASTNode(is_static), value(std::move(value)) { }
+    llvm::Value *
+    StringLiteral::codegen(mxs::backend::codegen::CodegenContext &ctx) const {
+        return emit_constant(ctx, value);
+    }
+
+    NilLiteral::NilLiteral(bool is_static)
+        : core::MXObject(is_static), MXASTNode(is_static) { }
+    llvm::Value *NilLiteral::codegen(mxs::backend::codegen::CodegenContext &ctx) const {
+        return emit_constant(ctx, ConstantValue{});
+    }
+
+    Identifier::Identifier(std::string name, bool is_static)
+        : core::MXObject(is_static), MXASTNode(is_static), name(std::move(name)) { }
+    llvm::Value *Identifier::codegen(mxs::backend::codegen::CodegenContext &ctx) const {
+        if (auto *value = local_value(ctx, name)) return value;
+        // 折叠过的 static let 直接内联成常量，其他模块里的也一样
+        if (auto it = ctx.constants.find(name); it != ctx.constants.end())
+            return emit_constant(ctx, it->second);
+        auto *ptr_ty = object_ptr_type(ctx);
+        auto load = runtime_function(ctx, "mxs_runtime_global_load", ptr_ty, { ptr_ty });
+        return ctx.builder->CreateCall(load, { emit_constant(ctx, name) });
+    }
+
+    BinaryOp::BinaryOp(std::unique_ptr<Expression> left, std::string op,
+                       std::unique_ptr<Expression> right, bool is_static)
+        : core::MXObject(is_static), MXASTNode(is_static), left(std::move(left)),
+          op(std::move(op)), right(std::move(right)) { }
+    llvm::Value *BinaryOp::codegen(mxs::backend::codegen::CodegenContext &ctx) const {
+        if (auto folded = evaluate(ctx.constants)) return emit_constant(ctx, *folded);
+        auto &builder = *ctx.builder;
+
+        if (op == "&&" || op == "||") {
+            auto *fn = builder.GetInsertBlock()->getParent();
+            auto *lhs = truthy(ctx, left->codegen(ctx));
+            auto *lhs_block = builder.GetInsertBlock();
+            auto *rhs_block = llvm::BasicBlock::Create(ctx.llvmContext, "logic.rhs", fn);
+            auto *end_block = llvm::BasicBlock::Create(ctx.llvmContext, "logic.end", fn);
+            if (op == "&&") {
+                builder.CreateCondBr(lhs, rhs_block, end_block);
+            } else {
+                builder.CreateCondBr(lhs, end_block, rhs_block);
+            }
+            builder.SetInsertPoint(rhs_block);
+            auto *rhs = truthy(ctx, right->codegen(ctx));
+            rhs_block = builder.GetInsertBlock();
+            builder.CreateBr(end_block);
+
+            builder.SetInsertPoint(end_block);
+            auto *result = builder.CreatePHI(builder.getInt1Ty(), 2);
+            result->addIncoming(builder.getInt1(op == "||"), lhs_block);
+            result->addIncoming(rhs, rhs_block);
+            return result;
+        }
+
+        const auto code = operator_code(op, false);
+        assert(code && "the grammar only produces known binary operators");
+        auto *lhs = left->codegen(ctx);
+        auto *rhs = right->codegen(ctx);
+        return emit_binary(ctx, *code, lhs, rhs);
+    }
+
+    UnaryOp::UnaryOp(std::string op, std::unique_ptr<Expression> operand, bool is_static)
+        : core::MXObject(is_static), MXASTNode(is_static), op(std::move(op)),
+          operand(std::move(operand)) { }
+    llvm::Value *UnaryOp::codegen(mxs::backend::codegen::CodegenContext &ctx) const {
+        if (auto folded = evaluate(ctx.constants)) return emit_constant(ctx, *folded);
+        auto &builder = *ctx.builder;
+        const auto code = operator_code(op, true);
+        assert(code && "the grammar only produces known unary operators");
+        auto *value = operand->codegen(ctx);
+        if (*code == MXS_OP_NOT) return builder.CreateNot(truthy(ctx, value));
+        if (is_number(value)) {
+            if (*code == MXS_OP_POS) return value;
+            return value->getType()->isDoubleTy() ? builder.CreateFNeg(value)
+                                                  : builder.CreateNeg(value);
+        }
+        auto *ptr_ty = object_ptr_type(ctx);
+        auto unary = runtime_function(ctx, "mxs_runtime_unary", ptr_ty,
+                                      { builder.getInt32Ty(), ptr_ty });
+        return builder.CreateCall(unary,
+                                  { builder.getInt32(*code), emit_box(ctx, value) });
+    }
+
+    OpaqueExpression::OpaqueExpression(std::string source, bool is_static)
+        : core::MXObject(is_static), MXASTNode(is_static), source(std::move(source)) { }
+    llvm::Value *
+    OpaqueExpression::codegen(mxs::backend::codegen::CodegenContext &ctx) const {
+        return raise(ctx, "NotImplementedError",
+                     std::format("'{}' is not supported by the code generator yet",
+                                 source));
+    }
+
+    BindingStatement::BindingStatement(std::string name,
+                                       std::unique_ptr<Expression> value,
+                                       bool is_static_binding, bool is_static)
+        : core::MXObject(is_static), MXASTNode(is_static), name(std::move(name)),
+          value(std::move(value)), isStatic(is_static_binding) { }
+    void BindingStatement::codegen(mxs::backend::codegen::CodegenContext &ctx) const {
+        backend::codegen::set_location(ctx, location);
+        if (isStatic) {
+            if (auto folded = value->evaluate(ctx.constants)) {
+                // 编译期求值成功：之后的使用处都内联这个值，不再有运行时初始化
+                ctx.constants[name] = *folded;
+                backend::codegen::emit_static_data(ctx, name, *folded);
+                return;
+            }
+        }
+        // 不可折叠（或 dynamic let）：在模块初始化时求值，存入全局表。store 保存
+        // 的是副本，值是另一个全局的借用指针也没关系
+        ctx.constants.erase(name);
+        auto &builder = *ctx.builder;
+        auto *ptr_ty = object_ptr_type(ctx);
+        auto store = runtime_function(ctx, "mxs_runtime_global_store", ptr_ty,
+                                      { ptr_ty, ptr_ty });
+        auto *key = emit_constant(ctx, name);
+        auto *boxed = emit_box(ctx, value->codegen(ctx));
+        auto *status = builder.CreateCall(store, { key, boxed });
+        // 求值得到 Error 或值放不进全局表：初始化函数带着错误返回，不再执行后面的绑定
+        auto *function = builder.GetInsertBlock()->getParent();
+        auto *failed = llvm::BasicBlock::Create(ctx.llvmContext, "init.failed", function);
+        auto *next = llvm::BasicBlock::Create(ctx.llvmContext, "init.next", function);
+        builder.CreateCondBr(builder.CreateIsNotNull(status), failed, next);
+        builder.SetInsertPoint(failed);
+        builder.CreateRet(status);
+        builder.SetInsertPoint(next);
+    }
+
+    Block::Block(bool is_static) : core::MXObject(is_static), MXASTNode(is_static) { }
+    void Block::codegen(mxs::backend::codegen::CodegenContext &ctx) const {
+        // 块里绑定的名字到块尾失效，被它们遮蔽的外层名字和 static let 随之恢复。
+        // let mut 的命名值是栈槽或格子，块里的赋值不受影响
+        auto named = ctx.namedValues;
+        auto constants = ctx.constants;
+        ctx.defers.emplace_back();
+        emit_statements(ctx, statements);
+        // 正常走到块尾也是一个出口
+        if (!ctx.builder->GetInsertBlock()->getTerminator()) {
+            unwind(ctx, ctx.defers.size() - 1,
+                   llvm::ConstantPointerNull::get(object_ptr_type(ctx)),
+                   [](llvm::Value *) { });
+        }
+        ctx.defers.pop_back();
+        ctx.namedValues = std::move(named);
+        ctx.constants = std::move(constants);
+    }
+
+    LetStatement::LetStatement(bool is_static)
+        : core::MXObject(is_static), MXASTNode(is_static) { }
+    void LetStatement::codegen(mxs::backend::codegen::CodegenContext &ctx) const {
+        bind(ctx, std::nullopt);
+    }
+    void LetStatement::bind(
+            mxs::backend::codegen::CodegenContext &ctx,
+            std::optional<std::span<const std::unique_ptr<Statement>>> scope) const {
+        auto &builder = *ctx.builder;
+        llvm::Value *initial = value ? value->codegen(ctx)
+                                     : llvm::ConstantPointerNull::get(object_ptr_type(ctx));
+        for (const auto &name : names) {
+            if (!isMut) {
+                // 局部名字遮蔽同名的 static let
+                ctx.constants.erase(name);
+                ctx.namedValues[name] = initial;
+                continue;
+            }
+            // 同一条 let 绑定的其他变量也会变，不能当成已知类型
+            MutableUses uses;
+            uses.rebound.insert(names.begin(), names.end());
+            // 不知道作用域（REPL 里逐条生成）时，之后的输入可能捕获或改写它
+            uses.captured = !scope;
+            if (scope) {
+                for (const auto &statement : *scope)
+                    collect_uses(statement.get(), name, uses);
+            }
+            ctx.constants.erase(name);
+            if (uses.captured) {
+                // lambda 捕获的变量放进堆上的格子，函数和各个闭包读写的是同一份
+                auto cell_new = runtime_function(ctx, "mxs_runtime_cell_new",
+                                                 object_ptr_type(ctx), {});
+                auto *cell = builder.CreateCall(cell_new, {}, name);
+                builder.CreateStore(emit_box(ctx, initial), cell);
+                ctx.cells.insert(cell);
+                ctx.namedValues[name] = cell;
+                continue;
+            }
+            auto *type = mutable_slot_type(ctx, initial, name, uses);
+            auto *variable = entry_alloca(ctx, type, name);
+            builder.CreateStore(type->isPointerTy() ? emit_box(ctx, initial) : initial,
+                                variable);
+            ctx.namedValues[name] = variable;
+        }
+    }
+
+    ExprStatement::ExprStatement(std::unique_ptr<Expression> expr, bool is_static)
+        : core::MXObject(is_static), MXASTNode(is_static), expr(std::move(expr)) { }
+    void ExprStatement::codegen(mxs::backend::codegen::CodegenContext &ctx) const {
+        expr->codegen(ctx);
+    }
+
+    IfStatement::IfStatement(bool is_static)
+        : core::MXObject(is_static), MXASTNode(is_static) { }
+    void IfStatement::codegen(mxs::backend::codegen::CodegenContext &ctx) const {
+        auto &builder = *ctx.builder;
+        auto *fn = builder.GetInsertBlock()->getParent();
+        auto *then_block = llvm::BasicBlock::Create(ctx.llvmContext, "if.then", fn);
+        auto *else_block =
+                elseBlock ? llvm::BasicBlock::Create(ctx.llvmContext, "if.else", fn)
+                          : nullptr;
+        auto *end = llvm::BasicBlock::Create(ctx.llvmContext, "if.end", fn);
+        builder.CreateCondBr(truthy(ctx, condition->codegen(ctx)), then_block,
+                             else_block ? else_block : end);
+
+        builder.SetInsertPoint(then_block);
+        if (thenBlock) thenBlock->codegen(ctx);
+        if (!builder.GetInsertBlock()->getTerminator()) builder.CreateBr(end);
+        if (else_block) {
+            builder.SetInsertPoint(else_block);
+            elseBlock->codegen(ctx);
+            if (!builder.GetInsertBlock()->getTerminator()) builder.CreateBr(end);
+        }
+        // 两个分支都 return 时 end 不可达，之后的语句照常生成进去
+        builder.SetInsertPoint(end);
+    }
+
+    DeferStatement::DeferStatement(std::unique_ptr<Block> body, bool is_static)
+        : core::MXObject(is_static), MXASTNode(is_static), body(std::move(body)) { }
+    void DeferStatement::codegen(mxs::backend::codegen::CodegenContext &ctx) const {
+        // 函数体总是块；只有 REPL 里的顶层语句在块外
+        if (ctx.defers.empty())
+            throw backend::codegen::CompileError(location,
+                                                 "defer is only valid inside a block");
+        // 这里不生成代码，只登记；块的每个出口各自展开一份
+        ctx.defers.back().deferred.push_back(
+                { [this](CodegenContext &ctx) {
+                     if (body) body->codegen(ctx);
+                 },
+                  ctx.namedValues });
+    }
+
+    LoopStatement::LoopStatement(bool is_static)
+        : core::MXObject(is_static), MXASTNode(is_static) { }
+    void LoopStatement::codegen(mxs::backend::codegen::CodegenContext &ctx) const {
+        auto &builder = *ctx.builder;
+        auto *fn = builder.GetInsertBlock()->getParent();
+        auto *start = llvm::BasicBlock::Create(ctx.llvmContext, "loop.start", fn);
+        auto *body_block = llvm::BasicBlock::Create(ctx.llvmContext, "loop.body", fn);
+        auto *latch = llvm::BasicBlock::Create(ctx.llvmContext, "loop.latch", fn);
+        auto *end = llvm::BasicBlock::Create(ctx.llvmContext, "loop.end", fn);
+
+        // 在这个函数版本里登记过 OSR 续体的循环：记下此刻的活跃值，在入口块里
+        // 放一个回边计数器。活跃值只能在这里取：到回边时 namedValues 可能已被
+        // 循环体里的同名绑定遮蔽，或者混进只在体内可见的值
+        llvm::Value *counter = nullptr;
+        auto osr = ctx.osr_module ? ctx.osr_entries.find({ this, fn })
+                                  : ctx.osr_entries.end();
+        if (osr != ctx.osr_entries.end()) {
+            auto &entry = osr->second;
+            entry.live.assign(ctx.namedValues.begin(), ctx.namedValues.end());
+            std::ranges::sort(entry.live, {},
+                              &std::pair<std::string, llvm::Value *>::first);
+            entry.used = true;
+            counter = entry_alloca(ctx, builder.getInt64Ty(), "loop.backedges");
+            builder.CreateStore(builder.getInt64(0), counter);
+        }
+        builder.CreateBr(start);
+
+        // start 是每一轮的开头，也是 OSR 续体进入循环的位置
+        builder.SetInsertPoint(start);
+        if (until && !untilAfterBody) {
+            builder.CreateCondBr(truthy(ctx, until->codegen(ctx)), end, body_block);
+        } else {
+            builder.CreateBr(body_block);
+        }
+
+        builder.SetInsertPoint(body_block);
+        ctx.loops.push_back({ latch, end, ctx.defers.size() });
+        if (body) body->codegen(ctx);
+        ctx.loops.pop_back();
+        if (!builder.GetInsertBlock()->getTerminator()) builder.CreateBr(latch);
+
+        builder.SetInsertPoint(latch);
+        if (until && untilAfterBody) {
+            auto *backedge =
+                    llvm::BasicBlock::Create(ctx.llvmContext, "loop.backedge", fn);
+            builder.CreateCondBr(truthy(ctx, until->codegen(ctx)), end, backedge);
+            builder.SetInsertPoint(backedge);
+        }
+        if (counter) {
+            emit_osr_backedge(ctx, osr->second, counter, start);
+        } else {
+            builder.CreateBr(start);
+        }
+        builder.SetInsertPoint(end);
+    }
+
+    BreakStatement::BreakStatement(bool is_static)
+        : core::MXObject(is_static), MXASTNode(is_static) { }
+    void BreakStatement::codegen(mxs::backend::codegen::CodegenContext &ctx) const {
+        // lambda 体不在外层的循环里
+        if (ctx.loops.empty())
+            throw backend::codegen::CompileError(location,
+                                                 "break is only valid inside a loop");
+        const auto &loop = ctx.loops.back();
+        auto *nil = llvm::ConstantPointerNull::get(object_ptr_type(ctx));
+        unwind(ctx, loop.defer_depth, nil,
+               [&](llvm::Value *) { ctx.builder->CreateBr(loop.break_target); });
+    }
+
+    ContinueStatement::ContinueStatement(bool is_static)
+        : core::MXObject(is_static), MXASTNode(is_static) { }
+    void ContinueStatement::codegen(mxs::backend::codegen::CodegenContext &ctx) const {
+        if (ctx.loops.empty())
+            throw backend::codegen::CompileError(location,
+                                                 "continue is only valid inside a loop");
+        const auto &loop = ctx.loops.back();
+        auto *nil = llvm::ConstantPointerNull::get(object_ptr_type(ctx));
+        unwind(ctx, loop.defer_depth, nil,
+               [&](llvm::Value *) { ctx.builder->CreateBr(loop.continue_target); });
+    }
+
+    ReturnStatement::ReturnStatement(std::unique_ptr<Expression> value, bool is_static)
+        : core::MXObject(is_static), MXASTNode(is_static), value(std::move(value)) { }
+    void ReturnStatement::codegen(mxs::backend::codegen::CodegenContext &ctx) const {
+        // 推测版本里参数是未装箱的数字，返回值可能也是，统一装箱
+        llvm::Value *result =
+                value ? emit_box(ctx, value->codegen(ctx))
+                      : llvm::ConstantPointerNull::get(
+                                llvm::PointerType::getUnqual(ctx.llvmContext));
+        // 返回值先求出来，再执行 defer
+        emit_return(ctx, result);
+    }
+
+    AssertStatement::AssertStatement(std::unique_ptr<Expression> condition,
+                                     bool is_static)
+        : core::MXObject(is_static), MXASTNode(is_static),
+          condition(std::move(condition)) { }
+    void AssertStatement::codegen(mxs::backend::codegen::CodegenContext &ctx) const {
+        if (ctx.strip_asserts) return;
+        auto &builder = *ctx.builder;
+        // 折叠成常量真的条件在编译期就成立，不留任何代码
+        auto *holds = truthy(ctx, condition->codegen(ctx));
+        auto *known = llvm::dyn_cast<llvm::ConstantInt>(holds);
+        if (known && known->isOne()) return;
+
+        auto *fn = builder.GetInsertBlock()->getParent();
+        auto *ok = llvm::BasicBlock::Create(ctx.llvmContext, "assert.ok", fn);
+        auto *fail = llvm::BasicBlock::Create(ctx.llvmContext, "assert.fail", fn);
+        auto *weights = llvm::MDBuilder(ctx.llvmContext).createBranchWeights(1 << 20, 1);
+        builder.CreateCondBr(holds, ok, fail, weights);
+
+        // 失败路径只有一次冷调用，错误对象和消息都由运行时在失败时才构造；
+        // 热路径里只剩比较和一条很少走的分支
+        builder.SetInsertPoint(fail);
+        auto *ptr_ty = object_ptr_type(ctx);
+        auto failed = runtime_function(ctx, "mxs_runtime_assert_failed", ptr_ty,
+                                       { builder.getInt32Ty(), builder.getInt32Ty() });
+        auto *callee = llvm::cast<llvm::Function>(failed.getCallee());
+        callee->addFnAttr(llvm::Attribute::Cold);
+        callee->addFnAttr(llvm::Attribute::NoInline);
+        auto *error = builder.CreateCall(failed, { builder.getInt32(location.line),
+                                                   builder.getInt32(location.column) });
+        emit_return(ctx, error);
+        builder.SetInsertPoint(ok);
+    }
+
+    FunctionDefinition::FunctionDefinition(std::string name, bool is_async,
+                                           bool is_static)
+        : core::MXObject(is_static), MXASTNode(is_static), name(std::move(name)),
+          isAsync(is_async) { }
+    void FunctionDefinition::declare(mxs::backend::codegen::CodegenContext &ctx) const {
+        if (genericParams.empty()) {
+            ctx.functions[name] = params.size();
+            return;
+        }
+        backend::codegen::GenericFunction generic;
+        generic.generic_count = genericParams.size();
+        for (std::size_t i = 0; i < params.size(); ++i) {
+            auto it = genericParams.end();
+            if (i < paramTypes.size())
+                it = std::ranges::find(genericParams, paramTypes[i]);
+            generic.param_generics.push_back(
+                    it == genericParams.end()
+                            ? -1
+                            : static_cast<int>(it - genericParams.begin()));
+        }
+        // AST 在整个模块的生成期间都存活，实例化回调可以直接持有 this
+        generic.instantiate = [this](CodegenContext &ctx,
+                                     const std::vector<llvm::Type *> &type_args) {
+            return instantiate(ctx, type_args);
+        };
+        ctx.generics[name] = std::move(generic);
+    }
+
+    auto FunctionDefinition::begin_function(mxs::backend::codegen::CodegenContext &ctx,
+                                            llvm::Function *fn) const
+            -> std::vector<llvm::Value *> {
+        auto *entry = llvm::BasicBlock::Create(ctx.llvmContext, "entry", fn);
+        ctx.builder->SetInsertPoint(entry);
+        backend::codegen::begin_function_scope(ctx, fn, location);
+        std::vector<llvm::Value *> args;
+        for (auto [arg, param_name] : llvm::zip(fn->args(), params)) {
+            arg.setName(param_name);
+            args.push_back(&arg);
+        }
+        return args;
+    }
+
+    // 参数取 values（推测版本和泛型实例里可能是未装箱的数字），
+    // 没有显式 return 时返回 nil
+    void FunctionDefinition::emit_body(mxs::backend::codegen::CodegenContext &ctx,
+                                       llvm::Function *fn,
+                                       llvm::ArrayRef<llvm::Value *> values) const {
+        auto &builder = *ctx.builder;
+        ctx.namedValues.clear();
+        // 参数遮蔽同名的 static let，函数体生成完后恢复
+        auto constants = ctx.constants;
+        for (auto [value, param_name] : llvm::zip(values, params)) {
+            ctx.namedValues[param_name] = value;
+            ctx.constants.erase(param_name);
+        }
+
+        backend::codegen::CoroutineFrame frame{};
+        if (isAsync) {
+            frame = backend::codegen::emit_coroutine_begin(ctx, fn);
+            ctx.coroutine = &frame;
+        }
+        if (body) body->codegen(ctx);
+        if (!builder.GetInsertBlock()->getTerminator()) {
+            auto *nil = llvm::ConstantPointerNull::get(object_ptr_type(ctx));
+            if (isAsync) {
+                backend::codegen::emit_coroutine_return(ctx, frame, nil);
+            } else {
+                builder.CreateRet(nil);
+            }
+        }
+        ctx.coroutine = nullptr;
+        ctx.constants = std::move(constants);
+    }
+
+    auto FunctionDefinition::instantiate(mxs::backend::codegen::CodegenContext &ctx,
+                                         const std::vector<llvm::Type *> &type_args) const
+            -> llvm::Function * {
+        const auto symbol = instance_symbol(name, type_args);
+        if (auto *existing = ctx.module->getFunction(symbol)) return existing;
+
+        // 类型是泛型参数的形参取实例的类型参数，其余形参照旧装箱传递；
+        // 返回值总是装箱的
+        auto *object_ptr = object_ptr_type(ctx);
+        std::vector<llvm::Type *> param_types;
+        for (auto index : ctx.generics.at(name).param_generics)
+            param_types.push_back(index < 0 ? object_ptr : type_args[index]);
+        auto *fn = llvm::Function::Create(
+                llvm::FunctionType::get(object_ptr, param_types, false),
+                llvm::Function::InternalLinkage, symbol, ctx.module);
+        if (isAsync) fn->setPresplitCoroutine();
+
+        // 实例在调用点所在函数体的中途生成：插入点、调试位置、命名值、
+        // 协程帧、循环栈和打开的 defer 都要原样恢复。调用点可能在 lambda 里，
+        // 实例是顶层函数，不能从那个 lambda 捕获，也不能直接调用它的闭包
+        llvm::IRBuilderBase::InsertPointGuard guard(*ctx.builder);
+        auto named = std::move(ctx.namedValues);
+        auto *coroutine = std::exchange(ctx.coroutine, nullptr);
+        auto loops = std::exchange(ctx.loops, {});
+        auto defers = std::exchange(ctx.defers, {});
+        auto *closure = std::exchange(ctx.closure, nullptr);
+        auto lambdas = std::exchange(ctx.lambdas, {});
+        emit_body(ctx, fn, begin_function(ctx, fn));
+        backend::codegen::end_function_scope(ctx);
+        ctx.namedValues = std::move(named);
+        ctx.coroutine = coroutine;
+        ctx.loops = std::move(loops);
+        ctx.defers = std::move(defers);
+        ctx.closure = closure;
+        ctx.lambdas = std::move(lambdas);
+        return fn;
+    }
+
+    void FunctionDefinition::codegen(mxs::backend::codegen::CodegenContext &ctx) const {
+        // 泛型函数没有自己的符号，实例由调用点按需生成
+        if (!genericParams.empty()) return;
+        auto &builder = *ctx.builder;
+        auto *object_ptr = object_ptr_type(ctx);
+        std::vector<llvm::Type *> param_types(params.size(), object_ptr);
+        // async func 返回的是协程句柄 (task)，普通函数返回 MXObject*，二者都是 ptr
+        auto *fn_type = llvm::FunctionType::get(object_ptr, param_types, false);
+
+        // 函数体顶层的循环可以在运行中转入 O2 编译的续体 (OSR)。续体从循环开头
+        // 执行到函数结束，所以只登记顶层循环；协程帧无法转移，async 函数不参与
+        std::vector<std::size_t> osr_loops;
+        const auto is_defer = [](const auto &statement) {
+            return dynamic_cast<const DeferStatement *>(statement.get()) != nullptr;
+        };
+        // 续体直接返回，不会展开函数体这一层的 defer，有 defer 的函数不参与
+        if (ctx.osr_module && !isAsync && body &&
+            std::ranges::none_of(body->statements, is_defer)) {
+            for (std::size_t i = 0; i < body->statements.size(); ++i) {
+                if (dynamic_cast<const LoopStatement *>(body->statements[i].get()))
+                    osr_loops.push_back(i);
+            }
+        }
+        // 基线和推测版本各有一份续体：两者的活跃值表示不同（推测版本里参数
+        // 已拆箱），续体按各自的表示恢复
+        const auto register_osr = [&](const llvm::Function *version,
+                                      const std::string &prefix) {
+            for (auto i : osr_loops) {
+                ctx.osr_entries[{ body->statements[i].get(), version }] = {
+                    std::format("{}.osr.{}", prefix, i)
+                };
+            }
+        };
+
+        // 有类型推测时先生成不带假设的基线版本，入口守卫失败就整体退回它
+        std::vector<std::int32_t> assumed;
+        if (auto it = ctx.speculation.find(name);
+            it != ctx.speculation.end() && !isAsync && it->second.size() == params.size())
+            assumed = it->second;
+        llvm::Function *baseline = nullptr;
+        if (!assumed.empty()) {
+            baseline = llvm::Function::Create(fn_type, llvm::Function::InternalLinkage,
+                                              name + ".baseline", ctx.module);
+            register_osr(baseline, baseline->getName().str());
+            emit_body(ctx, baseline, begin_function(ctx, baseline));
+            backend::codegen::end_function_scope(ctx);
+            emit_osr_continuations(ctx, baseline, osr_loops);
+        }
+
+        // 前面的调用点可能已经按 declare() 登记的签名声明过它
+        auto *fn = ctx.module->getFunction(name);
+        if (!fn)
+            fn = llvm::Function::Create(fn_type, llvm::Function::ExternalLinkage, name,
+                                        ctx.module);
+        if (isAsync) fn->setPresplitCoroutine();
+        register_osr(fn, name);
+        auto args = begin_function(ctx, fn);
+        std::vector<llvm::Value *> kinds;
+        if ((ctx.collect_feedback || baseline) && !args.empty())
+            kinds = argument_kinds(ctx, name, args);
+        if (!baseline) {
+            emit_body(ctx, fn, args);
+            backend::codegen::end_function_scope(ctx);
+            emit_osr_continuations(ctx, fn, osr_loops);
+            return;
+        }
+
+        // 守卫在函数体之前：退优化时还没有任何副作用，基线版本从头执行即可，
+        // 不需要栈映射或中途重建帧
+        llvm::Value *holds = builder.getTrue();
+        for (auto [kind, expected] : llvm::zip(kinds, assumed)) {
+            if (expected == MXS_KIND_OTHER) continue;
+            auto *matches = builder.CreateICmpEQ(kind, builder.getInt32(expected));
+            holds = builder.CreateAnd(holds, matches);
+        }
+        auto *speculated = llvm::BasicBlock::Create(ctx.llvmContext, "speculated", fn);
+        auto *deopt = llvm::BasicBlock::Create(ctx.llvmContext, "deopt", fn);
+        // 守卫几乎总是成立，退优化路径标成冷路径
+        auto *weights = llvm::MDBuilder(ctx.llvmContext).createBranchWeights(1 << 20, 1);
+        builder.CreateCondBr(holds, speculated, deopt, weights);
+
+        builder.SetInsertPoint(deopt);
+        bump(ctx, counter_array(ctx, "mxs.deopt." + name, 1), builder.getInt64(0));
+        auto *fallback = builder.CreateCall(baseline, args);
+        fallback->setTailCall();
+        builder.CreateRet(fallback);
+
+        // 守卫成立的参数直接拆箱，函数体里的算术随之走未装箱的快速路径。
+        // 拆箱本身也会失败（对象不是守卫认定的那种数字），同样退回基线版本；
+        // 浮点参数不接受整数，否则整数运算会变成浮点运算
+        builder.SetInsertPoint(speculated);
+        std::vector<llvm::Value *> values;
+        for (auto [arg, expected] : llvm::zip(args, assumed)) {
+            if (expected != MXS_KIND_INTEGER && expected != MXS_KIND_FLOAT) {
+                values.push_back(arg);
+                continue;
+            }
+            auto *type = expected == MXS_KIND_INTEGER
+                                 ? static_cast<llvm::Type *>(builder.getInt64Ty())
+                                 : builder.getDoubleTy();
+            values.push_back(emit_unbox(ctx, arg, type, deopt));
+        }
+        emit_body(ctx, fn, values);
+        backend::codegen::end_function_scope(ctx);
+        emit_osr_continuations(ctx, fn, osr_loops);
+    }
+
+    void FunctionDefinition::emit_osr_continuations(
+            mxs::backend::codegen::CodegenContext &ctx, const llvm::Function *version,
+            const std::vector<std::size_t> &loops) const {
+        auto &builder = *ctx.builder;
+        auto *object_ptr = llvm::PointerType::getUnqual(ctx.llvmContext);
+        // 先全部注销：续体里的循环已经是优化代码，不再带回边计数
+        std::vector<backend::codegen::OsrEntry> entries;
+        for (auto index : loops) {
+            const backend::codegen::OsrKey key{ body->statements[index].get(), version };
+            auto node = ctx.osr_entries.extract(key);
+            entries.push_back(std::move(node.mapped()));
+        }
+        for (auto [index, entry] : llvm::zip(loops, entries)) {
+            if (!entry.used) continue;
+            // 续体放进单独的模块、不带调试信息；活跃值装箱传入，重新成为命名值
+            auto *module = std::exchange(ctx.module, ctx.osr_module);
+            auto debug = std::move(ctx.debug);
+            builder.SetCurrentDebugLocation(llvm::DebugLoc());
+            std::vector<llvm::Type *> live_types(entry.live.size(), object_ptr);
+            auto *continuation = llvm::Function::Create(
+                    llvm::FunctionType::get(object_ptr, live_types, false),
+                    llvm::Function::ExternalLinkage, entry.symbol, ctx.module);
+            builder.SetInsertPoint(
+                    llvm::BasicBlock::Create(ctx.llvmContext, "entry", continuation));
+            ctx.namedValues.clear();
+            auto constants = ctx.constants;
+            // 回边装箱的数字在这里拆回原来的表示并释放箱子，let mut 变量重新
+            // 放进栈槽，续体里的运算和赋值与原版本生成的一样。回边传来的箱子
+            // 类型必然相符，拆箱失败的分支不可达
+            auto *mismatch = llvm::BasicBlock::Create(ctx.llvmContext, "osr.mismatch",
+                                                      continuation);
+            llvm::IRBuilder<>(mismatch).CreateUnreachable();
+            auto release = runtime_function(ctx, "mxs_runtime_release",
+                                            builder.getVoidTy(), { object_ptr });
+            for (auto [arg, live] : llvm::zip(continuation->args(), entry.live)) {
+                const auto &[live_name, original] = live;
+                arg.setName(live_name);
+                ctx.constants.erase(live_name);
+                if (ctx.cells.contains(original)) {
+                    ctx.cells.insert(&arg);
+                    ctx.namedValues[live_name] = &arg;
+                    continue;
+                }
+                auto *slot = llvm::dyn_cast<llvm::AllocaInst>(original);
+                auto *type = slot ? slot->getAllocatedType() : original->getType();
+                llvm::Value *value = &arg;
+                if (is_number(original) || (slot && !type->isPointerTy())) {
+                    value = emit_unbox(ctx, &arg, type, mismatch);
+                    builder.CreateCall(release, { &arg });
+                }
+                if (slot) {
+                    auto *copy = entry_alloca(ctx, type, live_name);
+                    builder.CreateStore(value, copy);
+                    value = copy;
+                }
+                ctx.namedValues[live_name] = value;
+            }
+            if (mismatch->hasNPredecessors(0)) mismatch->eraseFromParent();
+            emit_statements(ctx, std::span{ body->statements }.subspan(index));
+            if (!builder.GetInsertBlock()->getTerminator())
+                builder.CreateRet(llvm::ConstantPointerNull::get(object_ptr));
+            ctx.constants = std::move(constants);
+            ctx.debug = std::move(debug);
+            ctx.module = module;
+        }
+    }
+
+    Assignment::Assignment(std::string name, std::string op,
+                           std::unique_ptr<Expression> value, bool is_static)
+        : core::MXObject(is_static), MXASTNode(is_static), name(std::move(name)),
+          op(std::move(op)), value(std::move(value)) { }
+    llvm::Value *Assignment::codegen(mxs::backend::codegen::CodegenContext &ctx) const {
+        auto &builder = *ctx.builder;
+        // lambda 里第一次用到的外层 let mut 变量在这里捕获
+        if (!ctx.namedValues.contains(name)) local_value(ctx, name);
+        auto it = ctx.namedValues.find(name);
+        auto [variable, type] = it != ctx.namedValues.end()
+                                        ? mutable_storage(ctx, it->second)
+                                        : std::pair<llvm::Value *, llvm::Type *>{};
+        if (!variable) {
+            if (local_value(ctx, name))
+                return raise(ctx, "TypeError",
+                             std::format("cannot assign to immutable variable '{}'", name));
+            return raise(ctx, "NameError",
+                         std::format("'{}' is not a local variable", name));
+        }
+
+        auto *assigned = value->codegen(ctx);
+        if (op != "=") {
+            // 复合赋值 a op= b 就是 a = a op b
+            const auto code = operator_code(std::string_view{ op }.substr(0, 1), false);
+            assert(code && "the grammar only produces known compound assignments");
+            auto *current = builder.CreateLoad(type, variable, name);
+            assigned = emit_binary(ctx, *code, current, assigned);
+        }
+        // 不装箱的槽由 LetStatement 证明过每次赋值都是这种数字
+        if (type->isPointerTy()) assigned = emit_box(ctx, assigned);
+        assert(assigned->getType() == type && "an unboxed slot only takes its own kind");
+        builder.CreateStore(assigned, variable);
+        return assigned;
+    }
+
+    AwaitExpression::AwaitExpression(std::unique_ptr<Expression> operand, bool is_static)
+        : core::MXObject(is_static), MXASTNode(is_static), operand(std::move(operand)) { }
+    llvm::Value *
+    AwaitExpression::codegen(mxs::backend::codegen::CodegenContext &ctx) const {
+        // 非 async 函数和 lambda 体里都没有协程帧
+        if (!ctx.coroutine)
+            throw backend::codegen::CompileError(
+                    location, "await is only valid inside an async func");
+        auto *task = emit_box(ctx, operand->codegen(ctx));
+        return backend::codegen::emit_coroutine_await(ctx, *ctx.coroutine, task);
+    }
+
+    FunctionCall::FunctionCall(std::string name, bool is_static)
+        : core::MXObject(is_static), MXASTNode(is_static), name(std::move(name)) { }
+    llvm::Value *FunctionCall::codegen(mxs::backend::codegen::CodegenContext &ctx) const {
+        auto &builder = *ctx.builder;
+        auto *ptr_ty = object_ptr_type(ctx);
+        std::vector<llvm::Value *> values;
+        for (const auto &arg : args) values.push_back(arg->codegen(ctx));
+
+        // 局部名字遮蔽同名的函数
+        if (auto *closure = local_value(ctx, name))
+            return call_closure(ctx, name, closure, std::move(values));
+        if (auto generic = ctx.generics.find(name); generic != ctx.generics.end())
+            return call_generic(ctx, name, typeArgs, generic->second, std::move(values));
+        auto known = ctx.functions.find(name);
+        if (known == ctx.functions.end())
+            return raise(ctx, "NameError",
+                         std::format("'{}' is not a function of this program", name));
+        if (!typeArgs.empty())
+            return raise(ctx, "TypeError", std::format("{}() is not generic", name));
+        if (known->second != values.size())
+            return raise(ctx, "TypeError",
+                         std::format("{}() takes {} arguments but {} were given", name,
+                                     known->second, values.size()));
+
+        // 普通函数只有装箱的签名；定义可能还没生成，先按签名声明
+        std::vector<llvm::Type *> param_types(values.size(), ptr_ty);
+        auto callee = ctx.module->getOrInsertFunction(
+                name, llvm::FunctionType::get(ptr_ty, param_types, false));
+        for (auto &value : values) value = emit_box(ctx, value);
+        return builder.CreateCall(callee, values);
+    }
+
+    LambdaExpression::LambdaExpression(bool is_static)
+        : core::MXObject(is_static), MXASTNode(is_static) { }
+    llvm::Value *
+    LambdaExpression::codegen(mxs::backend::codegen::CodegenContext &ctx) const {
+        auto &builder = *ctx.builder;
+        auto *ptr_ty = object_ptr_type(ctx);
+        // 代码先取环境指针，其后是装箱的参数，返回值同样装箱
+        std::vector<llvm::Type *> param_types(params.size() + 1, ptr_ty);
+        auto *enclosing = builder.GetInsertBlock()->getParent();
+        auto *fn = llvm::Function::Create(
+                llvm::FunctionType::get(ptr_ty, param_types, false),
+                llvm::Function::InternalLinkage, enclosing->getName() + ".lambda",
+                ctx.module);
+
+        // 函数体在创建点的中途生成：外层的命名值交给 scope 供捕获，
+        // 插入点、协程帧、循环栈、打开的 defer 和被参数遮蔽的常量都在之后恢复
+        backend::codegen::ClosureScope scope{ std::move(ctx.namedValues), ctx.closure };
+        {
+            llvm::IRBuilderBase::InsertPointGuard guard(builder);
+            auto *coroutine = std::exchange(ctx.coroutine, nullptr);
+            auto loops = std::exchange(ctx.loops, {});
+            auto defers = std::exchange(ctx.defers, {});
+            auto constants = ctx.constants;
+            scope.entry = llvm::BasicBlock::Create(ctx.llvmContext, "entry", fn);
+            auto *body_block = llvm::BasicBlock::Create(ctx.llvmContext, "body", fn);
+            builder.SetInsertPoint(scope.entry);
+            backend::codegen::begin_function_scope(ctx, fn, location);
+            builder.CreateBr(body_block);
+            builder.SetInsertPoint(body_block);
+
+            scope.environment = fn->getArg(0);
+            scope.environment->setName("env");
+            ctx.namedValues.clear();
+            auto args = llvm::drop_begin(fn->args());
+            for (auto [arg, param_name] : llvm::zip(args, params)) {
+                arg.setName(param_name);
+                ctx.namedValues[param_name] = &arg;
+                ctx.constants.erase(param_name);
+            }
+            ctx.closure = &scope;
+            if (result) {
+                builder.CreateRet(emit_box(ctx, result->codegen(ctx)));
+            } else if (body) {
+                body->codegen(ctx);
+            }
+            if (!builder.GetInsertBlock()->getTerminator())
+                builder.CreateRet(llvm::ConstantPointerNull::get(ptr_ty));
+            ctx.closure = scope.parent;
+            backend::codegen::end_function_scope(ctx);
+            ctx.coroutine = coroutine;
+            ctx.loops = std::move(loops);
+            ctx.defers = std::move(defers);
+            ctx.constants = std::move(constants);
+        }
+        ctx.namedValues = std::move(scope.outer);
+
+        // 闭包和它的扁平环境在创建时一次分配，捕获的值按槽位存进去。let mut
+        // 变量存的是它的格子，外层和闭包之后的写彼此可见
+        auto closure_new = runtime_function(ctx, "mxs_runtime_closure_new", ptr_ty,
+                                            { ptr_ty, builder.getInt64Ty(),
+                                              builder.getInt64Ty() });
+        auto *closure = builder.CreateCall(
+                closure_new, { fn, builder.getInt64(params.size()),
+                               builder.getInt64(scope.captured.size()) });
+        if (!scope.captured.empty()) {
+            auto environment = runtime_function(ctx, "mxs_runtime_closure_environment",
+                                                ptr_ty, { ptr_ty });
+            auto *slots = builder.CreateCall(environment, { closure });
+            for (std::size_t slot = 0; slot < scope.captured.size(); ++slot) {
+                auto *address = builder.CreateConstInBoundsGEP1_64(builder.getInt64Ty(),
+                                                                   slots, slot);
+                builder.CreateStore(scope.captured[slot], address);
+            }
+        }
+        ctx.lambdas[closure] = fn;
+        return closure;
+    }
+
+    Declarator::Declarator(std::string name, bool is_static)
+        : core::MXObject(is_static), MXASTNode(is_static), name(std::move(name)) { }
+}
@@ -0,0 +1,168 @@
+#include "mxspp/frontend/ast.h"
+#include <cmath>
+#include <cstdint>
+#include <string_view>
+
+namespace mxs::frontend::ast {
+    namespace {
+        using Folded = std::optional<ConstantValue>;
+
+        // 与 runtime.cpp 的 mxs_runtime_truthy 保持一致：nil、false、0、0.0、"" 为假
+        auto truthy(const ConstantValue &value) -> bool {
+            if (std::holds_alternative<std::monostate>(value)) return false;
+            if (const auto *boolean = std::get_if<bool>(&value)) return *boolean;
+            if (const auto *integer = std::get_if<std::int64_t>(&value))
+                return *integer != 0;
+            if (const auto *number = std::get_if<double>(&value)) return *number != 0.0;
+            return !std::get<std::string>(value).empty();
+        }
+
+        template<typename T>
+        auto compare(std::string_view op, const T &lhs, const T &rhs) -> Folded {
+            if (op == "<") return lhs < rhs;
+            if (op == "<=") return lhs <= rhs;
+            if (op == ">") return lhs > rhs;
+            if (op == ">=") return lhs >= rhs;
+            if (op == "==") return lhs == rhs;
+            if (op == "!=") return lhs != rhs;
+            return std::nullopt;
+        }
+
+        // 整数运算按 64 位补码回绕，与生成的 i64 指令一致；除零留给运行时报错
+        auto integer_binary(std::string_view op, std::int64_t lhs, std::int64_t rhs)
+                -> Folded {
+            std::int64_t result = 0;
+            if (op == "+") {
+                __builtin_add_overflow(lhs, rhs, &result);
+                return result;
+            }
+            if (op == "-") {
+                __builtin_sub_overflow(lhs, rhs, &result);
+                return result;
+            }
+            if (op == "*") {
+                __builtin_mul_overflow(lhs, rhs, &result);
+                return result;
+            }
+            if (op == "/" || op == "%") {
+                if (rhs == 0) return std::nullopt;
+                if (rhs == -1) {
+                    if (op == "%") return std::int64_t{ 0 };
+                    __builtin_sub_overflow(std::int64_t{ 0 }, lhs, &result);
+                    return result;
+                }
+                return op == "/" ? lhs / rhs : lhs % rhs;
+            }
+            return compare(op, lhs, rhs);
+        }
+
+        auto float_binary(std::string_view op, double lhs, double rhs) -> Folded {
+            if (op == "+") return lhs + rhs;
+            if (op == "-") return lhs - rhs;
+            if (op == "*") return lhs * rhs;
+            if (op == "/") return lhs / rhs;
+            if (op == "%") return std::fmod(lhs, rhs);
+            return compare(op, lhs, rhs);
+        }
+
+        auto as_double(const ConstantValue &value) -> std::optional<double> {
+            if (const auto *integer = std::get_if<std::int64_t>(&value))
+                return static_cast<double>(*integer);
+            if (const auto *number = std::get_if<double>(&value)) return *number;
+            return std::nullopt;
+        }
+    }
+
+    auto Expression::evaluate(const ConstantTable &) const -> std::optional<ConstantValue> {
+        return std::nullopt;
+    }
+
+    auto IntegerLiteral::evaluate(const ConstantTable &) const
+            -> std::optional<ConstantValue> {
+        return value;
+    }
+
+    auto FloatLiteral::evaluate(const ConstantTable &) const
+            -> std::optional<ConstantValue> {
+        return value;
+    }
+
+    auto BooleanLiteral::evaluate(const ConstantTable &) const
+            -> std::optional<ConstantValue> {
+        return value;
+    }
+
+    auto StringLiteral::evaluate(const ConstantTable &) const
+            -> std::optional<ConstantValue> {
+        return value;
+    }
+
+    auto NilLiteral::evaluate(const ConstantTable &) const
+            -> std::optional<ConstantValue> {
+        return ConstantValue{};
+    }
+
+    auto Identifier::evaluate(const ConstantTable &constants) const
+            -> std::optional<ConstantValue> {
+        auto it = constants.find(name);
+        if (it == constants.end()) return std::nullopt;
+        return it->second;
+    }
+
+    auto UnaryOp::evaluate(const ConstantTable &constants) const
+            -> std::optional<ConstantValue> {
+        auto folded = operand->evaluate(constants);
+        if (!folded) return std::nullopt;
+        if (op == "!") return !truthy(*folded);
+        if (const auto *integer = std::get_if<std::int64_t>(&*folded)) {
+            if (op == "+") return *integer;
+            if (op == "-") {
+                std::int64_t result = 0;
+                __builtin_sub_overflow(std::int64_t{ 0 }, *integer, &result);
+                return result;
+            }
+        }
+        if (const auto *number = std::get_if<double>(&*folded)) {
+            if (op == "+") return *number;
+            if (op == "-") return -*number;
+        }
+        return std::nullopt;
+    }
+
+    auto BinaryOp::evaluate(const ConstantTable &constants) const
+            -> std::optional<ConstantValue> {
+        auto lhs = left->evaluate(constants);
+        if (!lhs) return std::nullopt;
+        // && 和 || 短路并产生布尔值：左侧已决定结果时右侧不必可折叠
+        if (op == "&&" || op == "||") {
+            const bool decided = op == "||";
+            if (truthy(*lhs) == decided) return decided;
+            auto rhs = right->evaluate(constants);
+            if (!rhs) return std::nullopt;
+            return truthy(*rhs);
+        }
+        auto rhs = right->evaluate(constants);
+        if (!rhs) return std::nullopt;
+
+        const auto *lhs_int = std::get_if<std::int64_t>(&*lhs);
+        const auto *rhs_int = std::get_if<std::int64_t>(&*rhs);
+        if (lhs_int && rhs_int) return integer_binary(op, *lhs_int, *rhs_int);
+
+        auto lhs_num = as_double(*lhs);
+        auto rhs_num = as_double(*rhs);
+        if (lhs_num && rhs_num) return float_binary(op, *lhs_num, *rhs_num);
+
+        const auto *lhs_str = std::get_if<std::string>(&*lhs);
+        const auto *rhs_str = std::get_if<std::string>(&*rhs);
+        if (lhs_str && rhs_str) {
+            if (op == "+") return *lhs_str + *rhs_str;
+            return compare(op, *lhs_str, *rhs_str);
+        }
+
+        // 剩下的组合里只有 nil / bool 之间的相等比较可以折叠，
+        // 数字与字符串混用等情况交给运行时报 TypeError
+        if (op != "==" && op != "!=") return std::nullopt;
+        if (lhs_str || rhs_str || lhs_num || rhs_num) return std::nullopt;
+        return (*lhs == *rhs) == (op == "==");
+    }
+}
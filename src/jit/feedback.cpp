@@ -0,0 +1,59 @@
+#include "mxspp/jit/feedback.h"
+#include "mxspp/runtime/runtime.h"
+#include <algorithm>
+#include <numeric>
+
+namespace mxs::jit {
+    auto MXTypeFeedback::get_feedback() -> MXTypeFeedback & {
+        static MXTypeFeedback instance{};
+        return instance;
+    }
+
+    auto MXTypeFeedback::record(std::uint64_t program, const std::string &function,
+                                std::span<const std::uint64_t> counts,
+                                std::uint64_t deopts) -> void {
+        // 每次调用都给第一个参数计一次数，它的各类型之和就是本次的调用次数
+        const auto first_param = counts.first(std::min<std::size_t>(counts.size(),
+                                                                    MXS_KIND_COUNT));
+        const auto calls = std::accumulate(first_param.begin(), first_param.end(),
+                                           std::uint64_t{ 0 });
+        std::scoped_lock guard(this->lock_);
+        auto &profile = this->profiles_[{ program, function }];
+        if (profile.counts.size() != counts.size())
+            profile.counts.assign(counts.size(), 0);
+        // 旧数据先减半再累加，类型分布变化后很快就能反映出来
+        for (std::size_t i = 0; i < counts.size(); ++i)
+            profile.counts[i] = profile.counts[i] / 2 + counts[i];
+        if (static_cast<double>(deopts) > MAX_DEOPT_SHARE * static_cast<double>(calls))
+            profile.unstable = true;
+    }
+
+    auto MXTypeFeedback::speculation(std::uint64_t program, const std::string &function,
+                                     std::size_t params) const
+            -> std::vector<std::int32_t> {
+        std::scoped_lock guard(this->lock_);
+        const auto it = this->profiles_.find({ program, function });
+        if (it == this->profiles_.end() || it->second.unstable) return {};
+        const auto &counts = it->second.counts;
+        if (params == 0 || counts.size() != params * MXS_KIND_COUNT) return {};
+
+        std::vector<std::int32_t> kinds(params, MXS_KIND_OTHER);
+        bool any = false;
+        for (std::size_t param = 0; param < params; ++param) {
+            const auto first = counts.begin() + param * MXS_KIND_COUNT;
+            const auto total = std::accumulate(first, first + MXS_KIND_COUNT,
+                                               std::uint64_t{ 0 });
+            if (total < MIN_SAMPLES) return {};
+            const auto top = std::max_element(first, first + MXS_KIND_COUNT);
+            const auto kind = static_cast<std::int32_t>(top - first);
+            // 只对数字做假设：其他对象拆箱不了，守卫它们没有收益
+            if (kind == MXS_KIND_OTHER ||
+                static_cast<double>(*top) < MIN_SHARE * static_cast<double>(total))
+                continue;
+            kinds[param] = kind;
+            any = true;
+        }
+        if (!any) return {};
+        return kinds;
+    }
+}
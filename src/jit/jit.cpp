@@ -1,3 +1,514 @@
 //
 // Created by mux on 2025/7/10.
 //
+#include "mxspp/jit/jit.h"
+#include "mxspp/core/MXMetrics.h"
+#include "mxspp/core/MXTrace.h"
+#include "mxspp/jit/profiler.h"
+#include "mxspp/jit/timing.h"
+#include <chrono>
+#include <cstdlib>
+#include <format>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <llvm/Config/llvm-config.h>
+#include <llvm/ExecutionEngine/JITEventListener.h>
+#include <llvm/ExecutionEngine/ObjectCache.h>
+#include <llvm/ExecutionEngine/Orc/CompileUtils.h>
+#include <llvm/ExecutionEngine/Orc/ExecutionUtils.h>
+#include <llvm/ExecutionEngine/Orc/RTDyldObjectLinkingLayer.h>
+#include <llvm/ExecutionEngine/SectionMemoryManager.h>
+#include <llvm/IRReader/IRReader.h>
+#include <llvm/Object/SymbolSize.h>
+#include <llvm/Passes/PassBuilder.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/Path.h>
+#include <llvm/Support/Process.h>
+#include <llvm/Support/SourceMgr.h>
+#include <llvm/Support/TargetSelect.h>
+#include <llvm/Support/xxhash.h>
+#include <llvm/TargetParser/Host.h>
+
+namespace mxs::jit {
+    namespace {
+        constexpr auto exported_only =
+                llvm::orc::JITDylibLookupFlags::MatchExportedSymbolsOnly;
+
+        // 计时打开时给最外层的每个 pass（函数级、CGSCC 级 pass 组的 adaptor
+        // 各算一个）计时；嵌套在里面的 pass 算进所属的组
+        auto time_pass_groups(llvm::PassInstrumentationCallbacks &callbacks) -> void {
+            auto depth = std::make_shared<int>(0);
+            auto &timer = MXCompileTimer::get_timer();
+            callbacks.registerBeforeNonSkippedPassCallback(
+                    [depth, &timer](llvm::StringRef pass, llvm::Any) {
+                        if ((*depth)++ == 0)
+                            timer.begin(std::format("LLVM pass: {}", pass.str()));
+                    });
+            auto after = [depth, &timer] {
+                if (--*depth == 0) timer.end();
+            };
+            callbacks.registerAfterPassCallback(
+                    [after](llvm::StringRef, llvm::Any, const llvm::PreservedAnalyses &) {
+                        after();
+                    });
+            callbacks.registerAfterPassInvalidatedCallback(
+                    [after](llvm::StringRef, const llvm::PreservedAnalyses &) {
+                        after();
+                    });
+        }
+
+        // OSR 续体模块（"script.<key>.osr"）只在循环跑热之后才编译，值得用 O2
+        auto is_osr_module(const llvm::Module &module) -> bool {
+            return llvm::StringRef(module.getModuleIdentifier()).ends_with(".osr");
+        }
+
+        // 其余模块只跑 O0 管线：其中包含把 async func 拆成状态机的协程 pass，
+        // 交互输入追求编译延迟而不是生成代码的质量
+        auto run_pipeline(llvm::Module &module) -> void {
+            // 采样分析器沿帧指针回溯，JIT 代码必须保留帧指针
+            if (MXProfiler::get_profiler().enabled()) {
+                for (auto &function : module) {
+                    if (!function.isDeclaration())
+                        function.addFnAttr("frame-pointer", "all");
+                }
+            }
+            const bool optimize = is_osr_module(module);
+            auto &timer = MXCompileTimer::get_timer();
+            MXCompileTimer::Scope scope(timer, optimize ? "IR pass pipeline (O2)"
+                                                        : "IR pass pipeline (O0)");
+            llvm::PassInstrumentationCallbacks callbacks;
+            if (timer.enabled()) time_pass_groups(callbacks);
+            llvm::LoopAnalysisManager lam;
+            llvm::FunctionAnalysisManager fam;
+            llvm::CGSCCAnalysisManager cgam;
+            llvm::ModuleAnalysisManager mam;
+            llvm::PassBuilder builder(nullptr, llvm::PipelineTuningOptions(),
+                                      std::nullopt, &callbacks);
+            builder.registerModuleAnalyses(mam);
+            builder.registerCGSCCAnalyses(cgam);
+            builder.registerFunctionAnalyses(fam);
+            builder.registerLoopAnalyses(lam);
+            builder.crossRegisterProxies(lam, fam, cgam, mam);
+            const auto level =
+                    optimize ? llvm::OptimizationLevel::O2 : llvm::OptimizationLevel::O0;
+            auto pipeline = optimize ? builder.buildPerModuleDefaultPipeline(level)
+                                     : builder.buildO0DefaultPipeline(level);
+            pipeline.run(module, mam);
+        }
+
+        auto lower_module(llvm::orc::ThreadSafeModule module,
+                          const llvm::orc::MaterializationResponsibility &)
+                -> llvm::Expected<llvm::orc::ThreadSafeModule> {
+            module.withModuleDo(run_pipeline);
+            return std::move(module);
+        }
+
+        // 整程序模块名带源码哈希，报告里统一显示为 "script"
+        auto module_label(const llvm::Module &module) -> std::string {
+            llvm::StringRef name = module.getModuleIdentifier();
+            if (!name.starts_with("script.")) return name.str();
+            return is_osr_module(module) ? "script OSR" : "script";
+        }
+
+        // 包住实际的 IR 编译器，统计机器码生成的耗时和目标文件大小
+        class TimedCompiler : public llvm::orc::IRCompileLayer::IRCompiler {
+        public:
+            explicit TimedCompiler(std::unique_ptr<IRCompiler> compiler)
+                : IRCompiler(compiler->getManglingOptions()),
+                  compiler_(std::move(compiler)) { }
+
+            auto operator()(llvm::Module &module)
+                    -> llvm::Expected<std::unique_ptr<llvm::MemoryBuffer>> override {
+                auto &registry = core::MXMetricsRegistry::get_registry();
+                static auto &in_flight = registry.gauge("mxs_jit_compiles_in_flight",
+                                                        "Modules being compiled now.");
+                // 有缓存时编译器自己先查缓存，命中的模块也计入这里
+                static auto &latency = registry.histogram(
+                        "mxs_jit_compile_seconds",
+                        "Machine code emission time per module.", 1e-9);
+                auto &timer = MXCompileTimer::get_timer();
+                const auto phase =
+                        std::format("Machine code emission ({})", module_label(module));
+                MXCompileTimer::Scope scope(timer, phase);
+                core::MXTracer::Scope trace("jit", "compile module");
+                in_flight.add(1);
+                const auto started = std::chrono::steady_clock::now();
+                auto object = (*this->compiler_)(module);
+                const std::chrono::nanoseconds elapsed =
+                        std::chrono::steady_clock::now() - started;
+                in_flight.add(-1);
+                latency.record(static_cast<std::uint64_t>(elapsed.count()));
+                if (object) {
+                    const auto bytes = (*object)->getBufferSize();
+                    timer.count("object code bytes", bytes);
+                    trace.set_value(static_cast<std::int64_t>(bytes));
+                }
+                return object;
+            }
+
+        private:
+            std::unique_ptr<IRCompiler> compiler_;
+        };
+
+        auto host_machine() -> llvm::Expected<llvm::orc::JITTargetMachineBuilder> {
+            auto machine = llvm::orc::JITTargetMachineBuilder::detectHost();
+            if (machine) machine->setCodeGenOptLevel(llvm::CodeGenOptLevel::Less);
+            return machine;
+        }
+
+        // 以模块名为键把目标文件落盘；只缓存 "script." 开头的整程序模块，
+        // REPL 输入每次都不同，缓存它们没有意义
+        class DiskObjectCache : public llvm::ObjectCache {
+        public:
+            explicit DiskObjectCache(std::string dir) : dir_(std::move(dir)) { }
+
+            void notifyObjectCompiled(const llvm::Module *module,
+                                      llvm::MemoryBufferRef object) override {
+                llvm::SmallString<256> path;
+                if (!this->path_for(*module, path)) return;
+                if (llvm::sys::fs::create_directories(this->dir_)) return;
+                // 先写临时文件再改名，并发的服务进程不会读到半个文件
+                llvm::SmallString<256> temp{ path };
+                temp += ".tmp";
+                std::error_code error;
+                llvm::raw_fd_ostream out(temp, error);
+                if (error) return;
+                out << object.getBuffer();
+                out.close();
+                if (!out.has_error()) llvm::sys::fs::rename(temp, path);
+            }
+
+            auto getObject(const llvm::Module *module)
+                    -> std::unique_ptr<llvm::MemoryBuffer> override {
+                auto &registry = core::MXMetricsRegistry::get_registry();
+                static auto &hits = registry.counter(
+                        "mxs_jit_object_cache_hits_total",
+                        "Script objects loaded from the cache.");
+                static auto &misses = registry.counter(
+                        "mxs_jit_object_cache_misses_total",
+                        "Script objects not in the cache and compiled.");
+                llvm::SmallString<256> path;
+                if (!this->path_for(*module, path)) return nullptr;
+                auto buffer = llvm::MemoryBuffer::getFile(path);
+                (buffer ? hits : misses).add();
+                if (core::MXTracer::enabled()) {
+                    core::MXTracer::get_tracer().instant(
+                            "jit", buffer ? "object cache hit" : "object cache miss");
+                }
+                return buffer ? std::move(*buffer) : nullptr;
+            }
+
+        private:
+            auto path_for(const llvm::Module &module, llvm::SmallString<256> &path) const
+                    -> bool {
+                llvm::StringRef name = module.getModuleIdentifier();
+                if (!name.starts_with("script.")) return false;
+                path = this->dir_;
+                llvm::sys::path::append(path, name + ".o");
+                return true;
+            }
+
+            std::string dir_;
+        };
+
+        auto env_enabled(const char *name) -> bool {
+            const char *value = std::getenv(name);
+            return value && *value && std::string_view{ value } != "0";
+        }
+
+        // 对象加载后逐个报告其中的函数：起始地址（运行时地址）、长度和符号名
+        class FunctionListener : public llvm::JITEventListener {
+        public:
+            // 参数依次是对象名（编译器以模块名命名）、地址、长度和符号名
+            using Sink = std::function<void(llvm::StringRef, std::uint64_t, std::uint64_t,
+                                            llvm::StringRef)>;
+
+            explicit FunctionListener(Sink sink) : sink_(std::move(sink)) { }
+
+            void notifyObjectLoaded(
+                    ObjectKey, const llvm::object::ObjectFile &object,
+                    const llvm::RuntimeDyld::LoadedObjectInfo &info) override {
+                // 重定位到加载地址后的副本，符号地址即运行时地址
+                auto relocated = info.getObjectForDebug(object);
+                if (!relocated.getBinary()) return;
+                std::scoped_lock guard(this->lock_);
+                for (const auto &[symbol, size] :
+                     llvm::object::computeSymbolSizes(*relocated.getBinary())) {
+                    auto type = symbol.getType();
+                    auto name = symbol.getName();
+                    auto address = symbol.getAddress();
+                    if (!type || !name || !address || size == 0
+                        || *type != llvm::object::SymbolRef::ST_Function) {
+                        llvm::consumeError(type.takeError());
+                        llvm::consumeError(name.takeError());
+                        llvm::consumeError(address.takeError());
+                        continue;
+                    }
+                    this->sink_(object.getFileName(), *address, size, *name);
+                }
+            }
+
+        private:
+            std::mutex lock_;
+            Sink sink_;
+        };
+
+        // perf 的约定：/tmp/perf-<pid>.map 中每行 "起始地址 长度 符号名"（十六进制）。
+        // 隔离模块移除后地址可能被复用，perf 以文件中较晚的一行为准
+        auto perf_map_listener() -> std::unique_ptr<llvm::JITEventListener> {
+            const auto pid = llvm::sys::Process::getProcessId();
+            const auto path = std::format("/tmp/perf-{}.map", pid);
+            std::error_code error;
+            auto out = std::make_shared<llvm::raw_fd_ostream>(
+                    path, error, llvm::sys::fs::OF_Append | llvm::sys::fs::OF_Text);
+            if (error) return nullptr;
+            auto write = [out](llvm::StringRef, std::uint64_t address, std::uint64_t size,
+                               llvm::StringRef name) {
+                *out << std::format("{:x} {:x} {}\n", address, size, name.str());
+                out->flush();
+            };
+            return std::make_unique<FunctionListener>(std::move(write));
+        }
+
+        // 采样分析器用登记的函数给 JIT 代码里的帧符号化；
+        // 除 runtime.bc 以外的模块都来自脚本
+        auto profiler_listener() -> std::unique_ptr<llvm::JITEventListener> {
+            auto add = [](llvm::StringRef object, std::uint64_t address,
+                          std::uint64_t size, llvm::StringRef name) {
+                const bool script = !object.starts_with("runtime.bc");
+                auto &profiler = MXProfiler::get_profiler();
+                profiler.add_function(address, size, name.str(), script);
+            };
+            return std::make_unique<FunctionListener>(std::move(add));
+        }
+
+        // 需要事件监听时换成 RTDyld 链接层：JITEventListener 只挂在它上面。
+        // GDB 和 jitdump 的监听器是 LLVM 内部的单例，无需持有
+        auto listening_object_layer(std::vector<llvm::JITEventListener *> listeners,
+                                    bool jitdump)
+                -> llvm::orc::LLJITBuilderState::ObjectLinkingLayerCreator {
+            return [listeners, jitdump](llvm::orc::ExecutionSession &session,
+                                        const auto &...)
+                           -> llvm::Expected<std::unique_ptr<llvm::orc::ObjectLayer>> {
+                auto layer = std::make_unique<llvm::orc::RTDyldObjectLinkingLayer>(
+                        session, [](const auto &...) {
+                            return std::make_unique<llvm::SectionMemoryManager>();
+                        });
+                if (env_enabled("MXS_GDB_JIT"))
+                    layer->registerJITEventListener(
+                            *llvm::JITEventListener::createGDBRegistrationListener());
+                for (auto *listener : listeners)
+                    layer->registerJITEventListener(*listener);
+                // 仅当 LLVM 以 LLVM_USE_PERF 构建时可用，否则返回 nullptr
+                if (jitdump) {
+                    auto *perf = llvm::JITEventListener::createPerfJITEventListener();
+                    if (perf) layer->registerJITEventListener(*perf);
+                }
+                return layer;
+            };
+        }
+    }
+
+    MXJit::MXJit(std::unique_ptr<llvm::orc::LLJIT> jit,
+                 std::shared_ptr<llvm::ObjectCache> cache,
+                 std::vector<std::unique_ptr<llvm::JITEventListener>> listeners)
+        : listeners_(std::move(listeners)), cache_(std::move(cache)),
+          jit_(std::move(jit)) { }
+
+    auto MXJit::create(const std::string &cache_dir)
+            -> llvm::Expected<std::unique_ptr<MXJit>> {
+        llvm::InitializeNativeTarget();
+        llvm::InitializeNativeTargetAsmPrinter();
+
+        auto machine = host_machine();
+        if (!machine) return machine.takeError();
+
+        std::shared_ptr<llvm::ObjectCache> cache;
+        if (!cache_dir.empty()) cache = std::make_shared<DiskObjectCache>(cache_dir);
+
+        std::vector<std::unique_ptr<llvm::JITEventListener>> listeners;
+        const bool perf = env_enabled("MXS_PERF");
+        if (perf) {
+            auto listener = perf_map_listener();
+            if (listener) listeners.push_back(std::move(listener));
+        }
+        if (MXProfiler::get_profiler().enabled())
+            listeners.push_back(profiler_listener());
+
+        llvm::orc::LLJITBuilder builder;
+        builder.setJITTargetMachineBuilder(std::move(*machine));
+        if (perf || !listeners.empty() || env_enabled("MXS_GDB_JIT")) {
+            std::vector<llvm::JITEventListener *> raw;
+            for (const auto &listener : listeners) raw.push_back(listener.get());
+            builder.setObjectLinkingLayerCreator(listening_object_layer(raw, perf));
+        }
+        // 与 LLJIT 的默认做法一致：没有缓存时复用同一个 TargetMachine
+        builder.setCompileFunctionCreator(
+                [cache](llvm::orc::JITTargetMachineBuilder machine)
+                        -> llvm::Expected<
+                                std::unique_ptr<llvm::orc::IRCompileLayer::IRCompiler>> {
+                    std::unique_ptr<llvm::orc::IRCompileLayer::IRCompiler> compiler;
+                    if (cache) {
+                        compiler = std::make_unique<llvm::orc::ConcurrentIRCompiler>(
+                                std::move(machine), cache.get());
+                    } else {
+                        auto target = machine.createTargetMachine();
+                        if (!target) return target.takeError();
+                        compiler = std::make_unique<llvm::orc::TMOwningSimpleCompiler>(
+                                std::move(*target));
+                    }
+                    return std::make_unique<TimedCompiler>(std::move(compiler));
+                });
+        auto jit = builder.create();
+        if (!jit) return jit.takeError();
+
+        // core 等宿主进程里的符号（运行时的 C++ 依赖）对所有输入可见
+        auto &main = (*jit)->getMainJITDylib();
+        auto process = llvm::orc::DynamicLibrarySearchGenerator::GetForCurrentProcess(
+                (*jit)->getDataLayout().getGlobalPrefix());
+        if (!process) return process.takeError();
+        main.addGenerator(std::move(*process));
+        (*jit)->getIRTransformLayer().setTransform(lower_module);
+
+        return std::unique_ptr<MXJit>(
+                new MXJit(std::move(*jit), std::move(cache), std::move(listeners)));
+    }
+
+    auto MXJit::load_runtime(const std::string &path) -> llvm::Error {
+        auto &timer = MXCompileTimer::get_timer();
+        MXCompileTimer::Scope load_scope(timer, "runtime.bc load and link");
+        core::MXTracer::Scope trace("jit", "load runtime.bc");
+        auto buffer = llvm::MemoryBuffer::getFile(path);
+        if (!buffer) return llvm::errorCodeToError(buffer.getError());
+        // 镜像里的目标代码只对同一份运行时、同一编译器和同一主机 CPU 有效
+        std::string key_source = (*buffer)->getBuffer().str();
+        key_source += '\0';
+        key_source += LLVM_VERSION_STRING;
+        key_source += '\0';
+        key_source += this->jit_->getTargetTriple().str();
+        key_source += '\0';
+        key_source += llvm::sys::getHostCPUName();
+        this->runtime_key_ = llvm::xxh3_64bits(llvm::StringRef(key_source));
+
+        auto context = std::make_unique<llvm::LLVMContext>();
+        llvm::SMDiagnostic diagnostic;
+        auto module = llvm::parseIR(**buffer, diagnostic, *context);
+        if (!module) {
+            return llvm::make_error<llvm::StringError>(
+                    std::format("{}: {}", path, diagnostic.getMessage().str()),
+                    llvm::inconvertibleErrorCode());
+        }
+        timer.count("runtime.bc bytes", (*buffer)->getBufferSize());
+        // 运行时的机器码在第一次查找其中的符号时才生成，记在 "runtime.bc" 名下
+        module->setModuleIdentifier("runtime.bc");
+        MXCompileTimer::Scope link_scope(timer, "link");
+        return this->jit_->addIRModule(
+                llvm::orc::ThreadSafeModule(std::move(module), std::move(context)));
+    }
+
+    auto MXJit::search_order() const -> llvm::orc::JITDylibSearchOrder {
+        llvm::orc::JITDylibSearchOrder order;
+        order.reserve(this->inputs_.size() + 1);
+        for (auto it = this->inputs_.rbegin(); it != this->inputs_.rend(); ++it)
+            order.emplace_back(*it, exported_only);
+        order.emplace_back(&this->jit_->getMainJITDylib(), exported_only);
+        return order;
+    }
+
+    auto MXJit::add_module(llvm::orc::ThreadSafeModule module)
+            -> llvm::Expected<llvm::orc::JITDylib *> {
+        auto order = this->search_order();
+        auto dylib = this->jit_->getExecutionSession().createJITDylib(
+                std::format("input.{}", this->inputs_.size()));
+        if (!dylib) return dylib.takeError();
+        // 新输入优先解析自身，再依次查找更早的输入和运行时
+        dylib->setLinkOrder(std::move(order), true);
+        if (auto error = this->jit_->addIRModule(*dylib, std::move(module)))
+            return std::move(error);
+        this->inputs_.push_back(&*dylib);
+        return &*dylib;
+    }
+
+    auto MXJit::lookup(llvm::StringRef name) -> llvm::Expected<llvm::orc::ExecutorAddr> {
+        auto symbol = this->jit_->getExecutionSession().lookup(
+                this->search_order(), this->jit_->mangleAndIntern(name));
+        if (!symbol) return symbol.takeError();
+        return symbol->getAddress();
+    }
+
+    auto MXJit::new_isolated_dylib() -> llvm::Expected<llvm::orc::JITDylib &> {
+        auto dylib = this->jit_->getExecutionSession().createJITDylib(
+                std::format("program.{}", this->isolated_++));
+        if (!dylib) return dylib.takeError();
+        dylib->setLinkOrder({ { &this->jit_->getMainJITDylib(), exported_only } }, true);
+        return dylib;
+    }
+
+    auto MXJit::add_isolated_module(llvm::orc::ThreadSafeModule module)
+            -> llvm::Expected<llvm::orc::JITDylib *> {
+        auto dylib = this->new_isolated_dylib();
+        if (!dylib) return dylib.takeError();
+        if (auto error = this->jit_->addIRModule(*dylib, std::move(module)))
+            return std::move(error);
+        return &*dylib;
+    }
+
+    auto MXJit::add_isolated_object(std::unique_ptr<llvm::MemoryBuffer> object)
+            -> llvm::Expected<llvm::orc::JITDylib *> {
+        auto dylib = this->new_isolated_dylib();
+        if (!dylib) return dylib.takeError();
+        if (auto error = this->jit_->addObjectFile(*dylib, std::move(object)))
+            return std::move(error);
+        return &*dylib;
+    }
+
+    auto MXJit::compile_object(llvm::orc::ThreadSafeModule module)
+            -> llvm::Expected<std::unique_ptr<llvm::MemoryBuffer>> {
+        auto machine = host_machine();
+        if (!machine) return machine.takeError();
+        auto target = machine->createTargetMachine();
+        if (!target) return target.takeError();
+        // 与 JIT 内部走同一条降级管线，生成的目标文件可以直接交给链接层
+        using Object = llvm::Expected<std::unique_ptr<llvm::MemoryBuffer>>;
+        return module.withModuleDo([&](llvm::Module &m) -> Object {
+            run_pipeline(m);
+            auto compiler = std::make_unique<llvm::orc::SimpleCompiler>(**target);
+            return TimedCompiler(std::move(compiler))(m);
+        });
+    }
+
+    auto MXJit::add_to(llvm::orc::JITDylib &dylib, llvm::orc::ThreadSafeModule module)
+            -> llvm::Error {
+        return this->jit_->addIRModule(dylib, std::move(module));
+    }
+
+    auto MXJit::define_absolute(llvm::orc::JITDylib &dylib, llvm::StringRef name,
+                                const void *address) -> llvm::Error {
+        llvm::orc::SymbolMap symbols;
+        symbols[this->jit_->mangleAndIntern(name)] = {
+            llvm::orc::ExecutorAddr::fromPtr(address), llvm::JITSymbolFlags::Exported
+        };
+        return dylib.define(llvm::orc::absoluteSymbols(std::move(symbols)));
+    }
+
+    auto MXJit::lookup_in(llvm::orc::JITDylib &dylib, llvm::StringRef name)
+            -> llvm::Expected<llvm::orc::ExecutorAddr> {
+        return this->jit_->lookup(dylib, name);
+    }
+
+    auto MXJit::remove(llvm::orc::JITDylib &dylib) -> llvm::Error {
+        return this->jit_->getExecutionSession().removeJITDylib(dylib);
+    }
+
+    auto MXJit::runtime_key() const -> std::uint64_t { return this->runtime_key_; }
+
+    auto MXJit::data_layout() const -> const llvm::DataLayout & {
+        return this->jit_->getDataLayout();
+    }
+
+    auto MXJit::target_triple() const -> const llvm::Triple & {
+        return this->jit_->getTargetTriple();
+    }
+}
@@ -0,0 +1,208 @@
+#include "mxspp/jit/profiler.h"
+#include <algorithm>
+#include <csignal>
+#include <ctime>
+#include <dlfcn.h>
+#include <format>
+#include <map>
+#include <pthread.h>
+#include <ucontext.h>
+#include <unordered_map>
+#include <llvm/Demangle/Demangle.h>
+#if defined(__linux__)
+#include <sys/syscall.h>
+#include <unistd.h>
+// 旧版 glibc 没有导出这个字段名
+#ifndef sigev_notify_thread_id
+#define sigev_notify_thread_id _sigev_un._tid
+#endif
+#endif
+
+namespace mxs::jit {
+    namespace {
+        // 从信号上下文取被打断时的 pc、帧指针和栈指针
+        auto interrupted_registers(const void *context, std::uintptr_t &pc,
+                                   std::uintptr_t &fp, std::uintptr_t &sp) -> bool {
+            const auto &machine = static_cast<const ucontext_t *>(context)->uc_mcontext;
+#if defined(__x86_64__)
+            pc = static_cast<std::uintptr_t>(machine.gregs[REG_RIP]);
+            fp = static_cast<std::uintptr_t>(machine.gregs[REG_RBP]);
+            sp = static_cast<std::uintptr_t>(machine.gregs[REG_RSP]);
+            return true;
+#elif defined(__aarch64__)
+            pc = static_cast<std::uintptr_t>(machine.pc);
+            fp = static_cast<std::uintptr_t>(machine.regs[29]);
+            sp = static_cast<std::uintptr_t>(machine.sp);
+            return true;
+#else
+            (void) machine;
+            return false;
+#endif
+        }
+    }
+
+    auto MXProfiler::get_profiler() -> MXProfiler & {
+        static MXProfiler instance{};
+        return instance;
+    }
+
+    auto MXProfiler::enable(unsigned frequency_hz) -> void {
+        this->enabled_ = true;
+        this->frequency_hz_ = std::max(1u, frequency_hz);
+    }
+
+    auto MXProfiler::enabled() const -> bool { return this->enabled_; }
+
+    auto MXProfiler::start() -> bool {
+#if defined(__linux__)
+        if (!this->enabled_ || this->running_) return false;
+        if (!this->samples_) this->samples_ = std::make_unique<Sample[]>(CAPACITY);
+
+        // 只在本线程栈的范围内沿帧指针回溯，读到的地址一定是已映射的内存
+        pthread_attr_t attributes;
+        if (pthread_getattr_np(pthread_self(), &attributes) != 0) return false;
+        void *stack = nullptr;
+        std::size_t stack_size = 0;
+        pthread_attr_getstack(&attributes, &stack, &stack_size);
+        pthread_attr_destroy(&attributes);
+        this->stack_low_ = reinterpret_cast<std::uintptr_t>(stack);
+        this->stack_high_ = this->stack_low_ + stack_size;
+
+        struct sigaction action {};
+        action.sa_sigaction = &MXProfiler::on_sample;
+        action.sa_flags = SA_SIGINFO | SA_RESTART;
+        sigemptyset(&action.sa_mask);
+        if (sigaction(SIGPROF, &action, nullptr) != 0) return false;
+
+        // 线程 CPU 时钟：线程阻塞时不采样，信号只投递给本线程
+        sigevent event{};
+        event.sigev_notify = SIGEV_THREAD_ID;
+        event.sigev_signo = SIGPROF;
+        event.sigev_notify_thread_id = static_cast<pid_t>(::syscall(SYS_gettid));
+        timer_t timer{};
+        if (timer_create(CLOCK_THREAD_CPUTIME_ID, &event, &timer) != 0) return false;
+        const long interval = 1'000'000'000L / this->frequency_hz_;
+        itimerspec spec{};
+        spec.it_interval.tv_sec = interval / 1'000'000'000L;
+        spec.it_interval.tv_nsec = interval % 1'000'000'000L;
+        spec.it_value = spec.it_interval;
+        if (timer_settime(timer, 0, &spec, nullptr) != 0) {
+            timer_delete(timer);
+            return false;
+        }
+        this->timer_ = timer;
+        this->running_ = true;
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    auto MXProfiler::stop() -> void {
+#if defined(__linux__)
+        if (!this->running_) return;
+        timer_delete(static_cast<timer_t>(this->timer_));
+        signal(SIGPROF, SIG_IGN);
+        this->running_ = false;
+#endif
+    }
+
+    void MXProfiler::on_sample(int, siginfo_t *, void *context) {
+        auto &profiler = get_profiler();
+        std::uintptr_t pc = 0, fp = 0, sp = 0;
+        if (!interrupted_registers(context, pc, fp, sp)) return;
+        const auto slot = profiler.next_.fetch_add(1, std::memory_order_relaxed);
+        if (slot >= CAPACITY) {
+            profiler.dropped_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        auto &sample = profiler.samples_[slot];
+        std::uint32_t depth = 0;
+        sample.frames[depth++] = pc;
+        // 帧布局：[fp] 是上一帧的 fp，[fp + 8] 是返回地址；栈向低地址增长，
+        // 所以合法的链必须严格递增且不越过栈顶
+        const auto low = std::max(sp, profiler.stack_low_);
+        while (depth < MAX_DEPTH && fp >= low && fp % sizeof(std::uintptr_t) == 0
+               && fp + 2 * sizeof(std::uintptr_t) <= profiler.stack_high_) {
+            const auto *frame = reinterpret_cast<const std::uintptr_t *>(fp);
+            const auto return_address = frame[1];
+            if (return_address == 0) break;
+            // 减一落在调用指令内部，符号化时不会错算到下一个函数
+            sample.frames[depth++] = return_address - 1;
+            if (frame[0] <= fp) break;
+            fp = frame[0];
+        }
+        sample.depth = depth;
+    }
+
+    auto MXProfiler::add_function(std::uint64_t address, std::uint64_t size,
+                                  std::string name, bool script) -> void {
+        std::scoped_lock guard(this->lock_);
+        this->functions_.push_back({ address, size, std::move(name), script });
+    }
+
+    auto MXProfiler::frame(std::uintptr_t address) const
+            -> core::MXAllocationProfiler::Frame {
+        std::scoped_lock guard(this->lock_);
+        core::MXAllocationProfiler::Frame frame;
+        frame.name = this->symbolize(address, &frame.script);
+        return frame;
+    }
+
+    auto MXProfiler::symbolize(std::uintptr_t address, bool *script) const
+            -> std::string {
+        // 隔离模块被移除后地址可能被新代码复用，较晚登记的函数优先
+        for (auto it = this->functions_.rbegin(); it != this->functions_.rend(); ++it) {
+            if (address < it->address || address >= it->address + it->size) continue;
+            if (script) *script = it->script;
+            return it->name;
+        }
+        Dl_info info{};
+        if (dladdr(reinterpret_cast<void *>(address), &info) != 0) {
+            if (info.dli_sname) return llvm::demangle(info.dli_sname);
+            if (info.dli_fname) {
+                const std::string_view library{ info.dli_fname };
+                const auto base = library.substr(library.rfind('/') + 1);
+                const auto offset =
+                        address - reinterpret_cast<std::uintptr_t>(info.dli_fbase);
+                return std::format("{}+0x{:x}", base, offset);
+            }
+        }
+        return std::format("[unknown 0x{:x}]", address);
+    }
+
+    auto MXProfiler::write_folded(std::ostream &out) const -> void {
+        std::scoped_lock guard(this->lock_);
+        std::unordered_map<std::uintptr_t, std::string> names;
+        std::map<std::string, std::size_t> stacks;
+        const auto count = std::min(this->next_.load(), CAPACITY);
+        for (std::size_t i = 0; i < count; ++i) {
+            const auto &sample = this->samples_[i];
+            std::string stack;
+            // 样本里叶子在前，折叠格式要求根在前
+            for (auto depth = sample.depth; depth > 0; --depth) {
+                const auto address = sample.frames[depth - 1];
+                auto [it, inserted] = names.try_emplace(address);
+                if (inserted) {
+                    it->second = this->symbolize(address);
+                    // ';' 是帧分隔符；空格无妨，计数取最后一个空格之后
+                    std::ranges::replace(it->second, ';', ':');
+                }
+                if (!stack.empty()) stack += ';';
+                stack += it->second;
+            }
+            ++stacks[stack];
+        }
+        for (const auto &[stack, samples] : stacks)
+            out << stack << ' ' << samples << '\n';
+    }
+
+    auto MXProfiler::sample_count() const -> std::size_t {
+        return std::min(this->next_.load(), CAPACITY);
+    }
+
+    auto MXProfiler::dropped_count() const -> std::size_t {
+        return this->dropped_.load();
+    }
+}
@@ -0,0 +1,95 @@
+#include "mxspp/jit/timing.h"
+#include <algorithm>
+#include <format>
+#include <llvm/Support/Process.h>
+
+namespace mxs::jit {
+    MXCompileTimer::Scope::Scope(MXCompileTimer &timer, std::string_view phase)
+        : timer_(timer), active_(timer.enabled()) {
+        if (this->active_) this->timer_.begin(phase);
+    }
+
+    MXCompileTimer::Scope::~Scope() {
+        if (this->active_) this->timer_.end();
+    }
+
+    auto MXCompileTimer::get_timer() -> MXCompileTimer & {
+        static MXCompileTimer instance{};
+        return instance;
+    }
+
+    auto MXCompileTimer::enable() -> void { this->enabled_ = true; }
+
+    auto MXCompileTimer::enabled() const -> bool { return this->enabled_; }
+
+    auto MXCompileTimer::begin(std::string_view phase) -> void {
+        if (!this->enabled_) return;
+        const auto parent = this->open_.empty() ? NO_PARENT : this->open_.back().phase;
+        // 同一父节点下的同名阶段合并，重复进入时累加
+        auto it = std::ranges::find_if(this->phases_, [&](const Phase &p) {
+            return p.parent == parent && p.name == phase;
+        });
+        if (it == this->phases_.end())
+            it = this->phases_.insert(it, Phase{ std::string{ phase }, parent });
+        this->open_.push_back({ static_cast<std::size_t>(it - this->phases_.begin()),
+                                std::chrono::steady_clock::now(),
+                                llvm::sys::Process::GetMallocUsage() });
+    }
+
+    auto MXCompileTimer::end() -> void {
+        if (!this->enabled_ || this->open_.empty()) return;
+        const auto open = this->open_.back();
+        this->open_.pop_back();
+        auto &phase = this->phases_[open.phase];
+        phase.time += std::chrono::steady_clock::now() - open.started;
+        phase.memory += static_cast<std::int64_t>(llvm::sys::Process::GetMallocUsage())
+                        - static_cast<std::int64_t>(open.malloc_usage);
+        ++phase.runs;
+    }
+
+    auto MXCompileTimer::count(std::string_view counter, std::uint64_t amount) -> void {
+        if (!this->enabled_) return;
+        auto it = std::ranges::find_if(this->counters_,
+                                       [&](const auto &c) { return c.first == counter; });
+        if (it == this->counters_.end())
+            this->counters_.emplace_back(std::string{ counter }, amount);
+        else
+            it->second += amount;
+    }
+
+    auto MXCompileTimer::report(std::ostream &out) const -> void {
+        double total_ms = 0;
+        for (const auto &phase : this->phases_) {
+            if (phase.parent == NO_PARENT)
+                total_ms += std::chrono::duration<double, std::milli>(phase.time).count();
+        }
+        out << "===-------------------------------------------------------------===\n"
+               "                    mxs compilation phases\n"
+               "===-------------------------------------------------------------===\n";
+        out << std::format("  {:>10}  {:>6}  {:>12}  {:>5}  {}\n", "Wall (ms)", "%",
+                           "Malloc (KiB)", "Runs", "Phase");
+        this->report_children(out, NO_PARENT, 0, total_ms);
+        out << std::format("  {:>10.3f}  {:>5.1f}%  {:>12}  {:>5}  Total\n", total_ms,
+                           total_ms > 0 ? 100.0 : 0.0, "", "");
+        if (this->counters_.empty()) return;
+        out << "\n  Counters\n";
+        for (const auto &[name, value] : this->counters_)
+            out << std::format("  {:>10}  {}\n", value, name);
+    }
+
+    auto MXCompileTimer::report_children(std::ostream &out, std::size_t parent,
+                                         std::size_t depth, double total_ms) const
+            -> void {
+        for (std::size_t i = 0; i < this->phases_.size(); ++i) {
+            const auto &phase = this->phases_[i];
+            if (phase.parent != parent) continue;
+            const double ms =
+                    std::chrono::duration<double, std::milli>(phase.time).count();
+            out << std::format("  {:>10.3f}  {:>5.1f}%  {:>+12.1f}  {:>5}  {:{}}{}\n", ms,
+                               total_ms > 0 ? ms / total_ms * 100.0 : 0.0,
+                               static_cast<double>(phase.memory) / 1024.0, phase.runs, "",
+                               depth * 2, phase.name);
+            this->report_children(out, i, depth + 1, total_ms);
+        }
+    }
+}
@@ -1,3 +1,626 @@
 //
 // Created by mux on 2025/7/10.
 //
+#include "mxspp/runtime/runtime.h"
+#include "mxspp/core/MXAsyncIO.h"
+#include "mxspp/core/MXBoolean.h"
+#include "mxspp/core/MXClosure.h"
+#include "mxspp/core/MXCollection.h"
+#include "mxspp/core/MXCsv.h"
+#include "mxspp/core/MXError.h"
+#include "mxspp/core/MXEventLoop.h"
+#include "mxspp/core/MXFile.h"
+#include "mxspp/core/MXJson.h"
+#include "mxspp/core/MXMappedFile.h"
+#include "mxspp/core/MXNil.h"
+#include "mxspp/core/MXNumeric.h"
+#include "mxspp/core/MXOutputStream.h"
+#include "mxspp/core/MXPopulationManager.h"
+#include "mxspp/core/MXString.h"
+#include "mxspp/core/MXTrace.h"
+#include <cmath>
+#include <cstdlib>
+#include <optional>
+#include <variant>
+
+using mxs::builtin::MXArray;
+using mxs::builtin::MXBoolean;
+using mxs::builtin::MXDict;
+using mxs::builtin::MXFloat;
+using mxs::builtin::MXInteger;
+using mxs::builtin::MXList;
+using mxs::builtin::MXNil;
+using mxs::core::MXClosure;
+using mxs::core::MXCoroutineHandle;
+using mxs::core::MXCsvReader;
+using mxs::core::MXError;
+using mxs::core::MXEventLoop;
+using mxs::core::MXFile;
+using mxs::core::MXJsonReader;
+using mxs::core::MXLineIterator;
+using mxs::core::MXMappedRegion;
+using mxs::core::MXObject;
+using mxs::core::MXOutputStream;
+using mxs::core::MXStringView;
+using mxs::core::MXString;
+using mxs::core::MXTask;
+using mxs::core::MXTracer;
+
+namespace {
+    // 参数类型错误时返回一个已经完成的 task，脚本侧 await 得到 MXError
+    auto failed_task(MXObject *error) -> MXTask { co_return error; }
+
+    auto type_error(const char *function, const char *argument) -> void * {
+        auto message =
+                std::format("{}: argument '{}' has the wrong type", function, argument);
+        auto error = std::make_unique<MXError>("TypeError", std::move(message));
+        return failed_task(error.release()).release();
+    }
+
+    auto error(const char *type, std::string message) -> MXObject * {
+        return std::make_unique<MXError>(type, std::move(message)).release();
+    }
+
+    // MXString / MXStringView 直接借用其存储，其他对象才需要 repr() 生成临时字符串
+    template<typename Writer>
+    auto write_text(MXObject *value, Writer &&writer) -> bool {
+        if (auto *str = dynamic_cast<MXString *>(value)) return writer(str->view());
+        if (auto *view = dynamic_cast<MXStringView *>(value)) return writer(view->view());
+        if (!value) return writer(std::string_view{ "nil" });
+        const auto text = value->repr();
+        return writer(std::string_view{ text });
+    }
+
+    // 模块全局值；启动镜像保存和恢复的就是这张表
+    auto module_globals() -> MXDict & {
+        static MXDict instance{ true };
+        return instance;
+    }
+
+    // 全局表只接受能写进镜像的数据，按值深拷贝。参数是借用的（比如另一个全局
+    // 的 load 结果），直接接管会让同一对象被释放两次
+    auto copy_value(const MXObject *value) -> std::optional<mxs::MXObjectOwned> {
+        if (!value || dynamic_cast<const MXNil *>(value)) return mxs::MXObjectOwned{};
+        if (auto *integer = dynamic_cast<const MXInteger *>(value))
+            return std::make_unique<MXInteger>(integer->value);
+        if (auto *number = dynamic_cast<const MXFloat *>(value))
+            return std::make_unique<MXFloat>(number->value);
+        if (auto *boolean = dynamic_cast<const MXBoolean *>(value))
+            return std::make_unique<MXBoolean>(boolean->value);
+        if (auto *str = dynamic_cast<const MXString *>(value))
+            return std::make_unique<MXString>(std::string{ str->view() });
+        if (auto *view = dynamic_cast<const MXStringView *>(value))
+            return std::make_unique<MXString>(std::string{ view->view() });
+        if (auto *list = dynamic_cast<const MXList *>(value)) {
+            auto copy = std::make_unique<MXList>();
+            copy->reserve(list->size());
+            for (std::size_t i = 0; i < list->size(); ++i) {
+                auto item = copy_value(list->at(i));
+                if (!item) return std::nullopt;
+                copy->append(std::move(*item));
+            }
+            return copy;
+        }
+        if (auto *dict = dynamic_cast<const MXDict *>(value)) {
+            auto copy = std::make_unique<MXDict>();
+            for (const auto &key : dict->keys()) {
+                auto item = copy_value(dict->get(key));
+                if (!item) return std::nullopt;
+                copy->set(key, std::move(*item));
+            }
+            return copy;
+        }
+        if (auto *array = dynamic_cast<const MXArray *>(value)) {
+            const auto integers = array->integers();
+            const auto floats = array->floats();
+            MXArray::storage_t storage;
+            if (array->is_integer()) {
+                storage = std::vector<std::int64_t>(integers.begin(), integers.end());
+            } else {
+                storage = std::vector<double>(floats.begin(), floats.end());
+            }
+            return std::make_unique<MXArray>(std::move(storage));
+        }
+        return std::nullopt;
+    }
+
+    auto string_of(MXObject *value) -> std::optional<std::string_view> {
+        if (auto *str = dynamic_cast<MXString *>(value)) return str->view();
+        if (auto *view = dynamic_cast<MXStringView *>(value)) return view->view();
+        return std::nullopt;
+    }
+
+    using Number = std::variant<std::int64_t, double>;
+
+    auto number_of(MXObject *value) -> std::optional<Number> {
+        if (auto *integer = dynamic_cast<MXInteger *>(value)) return integer->value;
+        if (auto *number = dynamic_cast<MXFloat *>(value)) return number->value;
+        return std::nullopt;
+    }
+
+    auto as_double(const Number &value) -> double {
+        return std::visit([](auto number) { return static_cast<double>(number); }, value);
+    }
+
+    template<typename T>
+    auto compare(std::int32_t op, const T &lhs, const T &rhs) -> std::optional<bool> {
+        switch (op) {
+            case MXS_OP_LT: return lhs < rhs;
+            case MXS_OP_LE: return lhs <= rhs;
+            case MXS_OP_GT: return lhs > rhs;
+            case MXS_OP_GE: return lhs >= rhs;
+            case MXS_OP_EQ: return lhs == rhs;
+            case MXS_OP_NE: return lhs != rhs;
+            default: return std::nullopt;
+        }
+    }
+
+    auto type_mismatch(std::int32_t op) -> MXObject * {
+        constexpr const char *symbols[] = { "+",  "-",  "*",  "/",  "%", "<", "<=",
+                                            ">",  ">=", "==", "!=", "-", "+", "!" };
+        const char *symbol = op >= 0 && op <= MXS_OP_NOT ? symbols[op] : "?";
+        return error("TypeError",
+                     std::format("unsupported operand types for '{}'", symbol));
+    }
+
+    // 与 JIT 生成的未装箱代码一致：整数按 64 位补码回绕，浮点遵循 IEEE，
+    // 只有整数除零报错；frontend 的常量折叠使用同一套规则
+    auto integer_binary(std::int32_t op, std::int64_t lhs, std::int64_t rhs)
+            -> MXObject * {
+        if (auto result = compare(op, lhs, rhs)) return new MXBoolean(*result);
+        std::int64_t value = 0;
+        switch (op) {
+            case MXS_OP_ADD: __builtin_add_overflow(lhs, rhs, &value); break;
+            case MXS_OP_SUB: __builtin_sub_overflow(lhs, rhs, &value); break;
+            case MXS_OP_MUL: __builtin_mul_overflow(lhs, rhs, &value); break;
+            case MXS_OP_DIV:
+            case MXS_OP_MOD:
+                if (rhs == 0)
+                    return error("ZeroDivisionError", "integer division by zero");
+                // INT64_MIN / -1 在 C++ 里是未定义行为，按回绕处理
+                if (rhs == -1) {
+                    __builtin_sub_overflow(std::int64_t{ 0 }, lhs, &value);
+                    if (op == MXS_OP_MOD) value = 0;
+                } else {
+                    value = op == MXS_OP_DIV ? lhs / rhs : lhs % rhs;
+                }
+                break;
+            default: return type_mismatch(op);
+        }
+        return new MXInteger(value);
+    }
+
+    auto float_binary(std::int32_t op, double lhs, double rhs) -> MXObject * {
+        if (auto result = compare(op, lhs, rhs)) return new MXBoolean(*result);
+        switch (op) {
+            case MXS_OP_ADD: return new MXFloat(lhs + rhs);
+            case MXS_OP_SUB: return new MXFloat(lhs - rhs);
+            case MXS_OP_MUL: return new MXFloat(lhs * rhs);
+            case MXS_OP_DIV: return new MXFloat(lhs / rhs);
+            case MXS_OP_MOD: return new MXFloat(std::fmod(lhs, rhs));
+            default: return type_mismatch(op);
+        }
+    }
+
+    auto write_failed(const char *function) -> MXObject * {
+        return error("IOError", std::format("{}: write failed", function));
+    }
+
+    // JIT 代码进入运行时时不在任何对象的构造或析构中间，可以在这里为堆快照停下。
+    // 装箱和运算几乎出现在每个循环里，放在这几个入口上就够了
+    auto safepoint() -> void { mxs::core::MXPopulationManager::get_manager().safepoint(); }
+
+    // 解析器的输入：File 直接共享其映射，字符串则拷贝一份交给解析器持有
+    auto parser_input(MXObject *source) -> std::shared_ptr<const MXMappedRegion> {
+        if (auto *file = dynamic_cast<MXFile *>(source)) return file->mapping();
+        if (auto *str = dynamic_cast<MXString *>(source))
+            return MXMappedRegion::adopt(std::string{ str->view() });
+        if (auto *view = dynamic_cast<MXStringView *>(source))
+            return MXMappedRegion::adopt(std::string{ view->view() });
+        return nullptr;
+    }
+}
+
+extern "C" {
+auto mxs_runtime_coro_alloc(std::uint64_t size) -> void * { return std::malloc(size); }
+
+auto mxs_runtime_coro_free(void *frame) -> void { std::free(frame); }
+
+auto mxs_runtime_coro_complete(void *handle) -> void {
+    auto &promise = MXCoroutineHandle::from_address(handle).promise();
+    if (promise.continuation) {
+        MXEventLoop::get_loop().schedule(
+                std::coroutine_handle<>::from_address(promise.continuation));
+    }
+}
+
+auto mxs_runtime_coro_begin(void *handle) -> void {
+    MXEventLoop::get_loop().adopt_task(handle);
+}
+
+auto mxs_runtime_await(void *handle, void *task) -> void {
+    auto &loop = MXEventLoop::get_loop();
+    // 操作数不是登记过的任务帧时不能当协程句柄解释，让等待者立即恢复，
+    // 由 await_resume 返回 TypeError
+    if (!loop.owns_task(task)) {
+        loop.schedule(std::coroutine_handle<>::from_address(handle));
+        return;
+    }
+    auto awaited = MXCoroutineHandle::from_address(task);
+    // 被等待的 task 已经同步完成：直接把等待者放回就绪队列
+    if (awaited.done()) {
+        loop.schedule(std::coroutine_handle<>::from_address(handle));
+    } else {
+        awaited.promise().continuation = handle;
+    }
+}
+
+auto mxs_runtime_await_resume(void *task) -> mxs::core::MXObject * {
+    // 先注销再销毁；同一任务第二次 await 也会落到这里报错而不是访问已释放的帧
+    if (!MXEventLoop::get_loop().forget_task(task)) {
+        auto *value = static_cast<MXObject *>(task);
+        auto message = std::format("await: a {} is not a task",
+                                   value ? value->runtime_type().name : "nil");
+        return error("TypeError", std::move(message));
+    }
+    auto awaited = MXCoroutineHandle::from_address(task);
+    auto *result = awaited.promise().result;
+    awaited.destroy();
+    return result;
+}
+
+auto mxs_runtime_box_integer(std::int64_t value) -> MXObject * {
+    safepoint();
+    return new MXInteger(value);
+}
+
+auto mxs_runtime_box_float(double value) -> MXObject * {
+    safepoint();
+    return new MXFloat(value);
+}
+
+auto mxs_runtime_box_bool(bool value) -> MXObject * {
+    safepoint();
+    return new MXBoolean(value);
+}
+
+auto mxs_runtime_box_string(const char *data, std::int64_t size) -> MXObject * {
+    safepoint();
+    return new MXString(std::string(data, static_cast<std::size_t>(size)));
+}
+
+auto mxs_runtime_release(MXObject *value) -> void {
+    if (value && !value->is_static) delete value;
+}
+
+auto mxs_runtime_truthy(MXObject *value) -> bool {
+    if (!value || dynamic_cast<MXNil *>(value)) return false;
+    if (auto *boolean = dynamic_cast<MXBoolean *>(value)) return boolean->value;
+    if (auto number = number_of(value)) return as_double(*number) != 0.0;
+    if (auto text = string_of(value)) return !text->empty();
+    return true;
+}
+
+auto mxs_runtime_value_kind(MXObject *value) -> std::int32_t {
+    if (dynamic_cast<MXInteger *>(value)) return MXS_KIND_INTEGER;
+    if (dynamic_cast<MXFloat *>(value)) return MXS_KIND_FLOAT;
+    return MXS_KIND_OTHER;
+}
+
+auto mxs_runtime_unbox_integer(MXObject *value, std::int64_t *out) -> bool {
+    auto *integer = dynamic_cast<MXInteger *>(value);
+    if (!integer) return false;
+    *out = integer->value;
+    return true;
+}
+
+auto mxs_runtime_unbox_float(MXObject *value, double *out) -> bool {
+    auto *number = dynamic_cast<MXFloat *>(value);
+    if (!number) return false;
+    *out = number->value;
+    return true;
+}
+
+auto mxs_runtime_unary(std::int32_t op, MXObject *operand) -> MXObject * {
+    safepoint();
+    if (op == MXS_OP_NOT) return new MXBoolean(!mxs_runtime_truthy(operand));
+    const auto number = number_of(operand);
+    if (!number) return type_mismatch(op);
+    // 结果总是新对象：+x 若直接返回借用的操作数，调用方释放结果时会连带释放 x
+    if (op == MXS_OP_POS) {
+        if (const auto *integer = std::get_if<std::int64_t>(&*number))
+            return new MXInteger(*integer);
+        return new MXFloat(std::get<double>(*number));
+    }
+    if (op != MXS_OP_NEG) return type_mismatch(op);
+    if (const auto *integer = std::get_if<std::int64_t>(&*number)) {
+        std::int64_t negated = 0;
+        __builtin_sub_overflow(std::int64_t{ 0 }, *integer, &negated);
+        return new MXInteger(negated);
+    }
+    return new MXFloat(-std::get<double>(*number));
+}
+
+auto mxs_runtime_binary(std::int32_t op, MXObject *lhs, MXObject *rhs) -> MXObject * {
+    safepoint();
+    const auto left = number_of(lhs);
+    const auto right = number_of(rhs);
+    if (left && right) {
+        const auto *x = std::get_if<std::int64_t>(&*left);
+        const auto *y = std::get_if<std::int64_t>(&*right);
+        if (x && y) return integer_binary(op, *x, *y);
+        return float_binary(op, as_double(*left), as_double(*right));
+    }
+    const auto left_text = string_of(lhs);
+    const auto right_text = string_of(rhs);
+    if (left_text && right_text) {
+        if (op == MXS_OP_ADD) {
+            std::string joined;
+            joined.reserve(left_text->size() + right_text->size());
+            joined.append(*left_text).append(*right_text);
+            return new MXString(std::move(joined));
+        }
+        if (auto result = compare(op, *left_text, *right_text))
+            return new MXBoolean(*result);
+        return type_mismatch(op);
+    }
+    if (op == MXS_OP_EQ || op == MXS_OP_NE) {
+        // 其余类型按值比较布尔和 nil，其他对象按同一性比较。MXNil（比如顶层
+        // JSON null）和 nil 相等
+        if (dynamic_cast<MXNil *>(lhs)) lhs = nullptr;
+        if (dynamic_cast<MXNil *>(rhs)) rhs = nullptr;
+        auto *left_bool = dynamic_cast<MXBoolean *>(lhs);
+        auto *right_bool = dynamic_cast<MXBoolean *>(rhs);
+        const bool equal = left_bool && right_bool ? left_bool->value == right_bool->value
+                                                   : lhs == rhs;
+        return new MXBoolean(equal == (op == MXS_OP_EQ));
+    }
+    return type_mismatch(op);
+}
+
+[[gnu::cold, gnu::noinline]] auto mxs_runtime_assert_failed(std::int32_t line,
+                                                           std::int32_t column)
+        -> MXObject * {
+    return error("AssertionError",
+                 std::format("assertion failed at line {}, column {}", line, column));
+}
+
+auto mxs_runtime_closure_new(void *code, std::int64_t arity, std::int64_t slots)
+        -> MXObject * {
+    safepoint();
+    return new MXClosure(code, arity, static_cast<std::size_t>(slots));
+}
+
+auto mxs_runtime_closure_environment(MXObject *closure) -> void * {
+    return static_cast<MXClosure *>(closure)->environment();
+}
+
+auto mxs_runtime_closure_code(MXObject *value, std::int64_t arity) -> void * {
+    auto *closure = dynamic_cast<MXClosure *>(value);
+    return closure && closure->arity == arity ? closure->code : nullptr;
+}
+
+auto mxs_runtime_cell_new() -> MXObject ** {
+    return new MXObject *{ nullptr };
+}
+
+auto mxs_runtime_error(const char *type, const char *message) -> MXObject * {
+    return error(type, message);
+}
+
+auto mxs_runtime_global_store(MXObject *name, MXObject *value) -> MXObject * {
+    const auto key = string_of(name);
+    if (!key) return error("TypeError", "mxs_runtime_global_store: name is not a string");
+    // 初始化表达式失败时不存，把错误交回给调用方
+    if (dynamic_cast<MXError *>(value)) return value;
+    auto copy = copy_value(value);
+    if (!copy) {
+        auto message = std::format("mxs_runtime_global_store: a {} cannot be a global",
+                                   value->runtime_type().name);
+        return error("TypeError", std::move(message));
+    }
+    module_globals().set(std::string{ *key }, std::move(*copy));
+    return nullptr;
+}
+
+auto mxs_runtime_global_load(MXObject *name) -> MXObject * {
+    const auto key = string_of(name);
+    if (!key) return error("TypeError", "mxs_runtime_global_load: name is not a string");
+    return module_globals().get(*key);
+}
+
+auto mxs_runtime_globals() -> MXObject * { return &module_globals(); }
+
+auto mxs_runtime_run_until_complete(void *task) -> mxs::core::MXObject * {
+    if (!MXEventLoop::get_loop().owns_task(task)) return mxs_runtime_await_resume(task);
+    MXEventLoop::get_loop().run_until(std::coroutine_handle<>::from_address(task));
+    return mxs_runtime_await_resume(task);
+}
+
+auto mxs_io_async_read(MXObject *fd, MXObject *length, MXObject *offset) -> void * {
+    auto *fd_int = dynamic_cast<MXInteger *>(fd);
+    auto *length_int = dynamic_cast<MXInteger *>(length);
+    auto *offset_int = dynamic_cast<MXInteger *>(offset);
+    if (!fd_int) return type_error("mxs_io_async_read", "fd");
+    if (!length_int || length_int->value < 0)
+        return type_error("mxs_io_async_read", "length");
+    if (!offset_int) return type_error("mxs_io_async_read", "offset");
+    return mxs::core::mx_async_read(static_cast<int>(fd_int->value),
+                                    static_cast<std::size_t>(length_int->value),
+                                    offset_int->value)
+            .release();
+}
+
+auto mxs_io_async_write(MXObject *fd, MXObject *data, MXObject *offset) -> void * {
+    auto *fd_int = dynamic_cast<MXInteger *>(fd);
+    auto *data_str = dynamic_cast<MXString *>(data);
+    auto *offset_int = dynamic_cast<MXInteger *>(offset);
+    if (!fd_int) return type_error("mxs_io_async_write", "fd");
+    if (!data_str) return type_error("mxs_io_async_write", "data");
+    if (!offset_int) return type_error("mxs_io_async_write", "offset");
+    return mxs::core::mx_async_write(static_cast<int>(fd_int->value),
+                                     std::string{ data_str->view() }, offset_int->value)
+            .release();
+}
+
+auto mxs_io_async_accept(MXObject *fd) -> void * {
+    auto *fd_int = dynamic_cast<MXInteger *>(fd);
+    if (!fd_int) return type_error("mxs_io_async_accept", "fd");
+    return mxs::core::mx_async_accept(static_cast<int>(fd_int->value)).release();
+}
+
+auto mxs_io_async_connect(MXObject *fd, MXObject *host, MXObject *port) -> void * {
+    auto *fd_int = dynamic_cast<MXInteger *>(fd);
+    auto *host_str = dynamic_cast<MXString *>(host);
+    auto *port_int = dynamic_cast<MXInteger *>(port);
+    if (!fd_int) return type_error("mxs_io_async_connect", "fd");
+    if (!host_str) return type_error("mxs_io_async_connect", "host");
+    if (!port_int || port_int->value < 0 || port_int->value > 65535)
+        return type_error("mxs_io_async_connect", "port");
+    return mxs::core::mx_async_connect(static_cast<int>(fd_int->value),
+                                       std::string{ host_str->view() },
+                                       static_cast<std::uint16_t>(port_int->value))
+            .release();
+}
+
+auto mxs_io_stdout() -> MXObject * { return &MXOutputStream::standard_output(); }
+
+auto mxs_io_stderr() -> MXObject * { return &MXOutputStream::standard_error(); }
+
+auto mxs_io_print(MXObject *value) -> MXObject * {
+    auto &out = MXOutputStream::standard_output();
+    if (write_text(value, [&](std::string_view text) { return out.write(text); }))
+        return nullptr;
+    return write_failed("mxs_io_print");
+}
+
+auto mxs_io_println(MXObject *value) -> MXObject * {
+    auto &out = MXOutputStream::standard_output();
+    if (write_text(value, [&](std::string_view text) { return out.write_line(text); }))
+        return nullptr;
+    return write_failed("mxs_io_println");
+}
+
+auto mxs_io_write_file(MXObject *stream, MXObject *value) -> MXObject * {
+    if (auto *file = dynamic_cast<MXFile *>(stream)) return mxs_file_write(file, value);
+    auto *out = dynamic_cast<MXOutputStream *>(stream);
+    if (!out)
+        return error("TypeError", "mxs_io_write_file: argument 'stream' is not a stream");
+    if (write_text(value, [&](std::string_view text) { return out->write(text); }))
+        return nullptr;
+    return write_failed("mxs_io_write_file");
+}
+
+auto mxs_io_flush(MXObject *stream) -> MXObject * {
+    if (auto *file = dynamic_cast<MXFile *>(stream)) {
+        return file->flush() ? nullptr : write_failed("mxs_io_flush");
+    }
+    auto *out = dynamic_cast<MXOutputStream *>(stream);
+    if (!out)
+        return error("TypeError", "mxs_io_flush: argument 'stream' is not a stream");
+    return out->flush() ? nullptr : write_failed("mxs_io_flush");
+}
+
+auto mxs_file_open(MXObject *path, MXObject *mode) -> MXObject * {
+    auto *path_str = dynamic_cast<MXString *>(path);
+    auto *mode_str = dynamic_cast<MXString *>(mode);
+    if (!path_str)
+        return error("TypeError", "mxs_file_open: argument 'path' is not a string");
+    if (!mode_str)
+        return error("TypeError", "mxs_file_open: argument 'mode' is not a string");
+    MXTracer::Scope trace("runtime", "file open");
+    return MXFile::open(std::string{ path_str->view() }, mode_str->view()).release();
+}
+
+auto mxs_file_write(MXObject *file, MXObject *value) -> MXObject * {
+    auto *f = dynamic_cast<MXFile *>(file);
+    if (!f) return error("TypeError", "mxs_file_write: argument 'file' is not a File");
+    if (!f->is_writable()) return error("IOError", f->path() + ": file is not writable");
+    if (write_text(value, [&](std::string_view text) { return f->write(text); }))
+        return nullptr;
+    return write_failed("mxs_file_write");
+}
+
+auto mxs_file_close(MXObject *file) -> MXObject * {
+    auto *f = dynamic_cast<MXFile *>(file);
+    if (!f) return error("TypeError", "mxs_file_close: argument 'file' is not a File");
+    return f->close() ? nullptr : error("IOError", f->path() + ": close failed");
+}
+
+auto mxs_file_lines(MXObject *file) -> MXObject * {
+    auto *f = dynamic_cast<MXFile *>(file);
+    if (!f) return error("TypeError", "mxs_file_lines: argument 'file' is not a File");
+    return f->lines().release();
+}
+
+auto mxs_file_next_line(MXObject *lines) -> MXObject * {
+    auto *it = dynamic_cast<MXLineIterator *>(lines);
+    if (!it)
+        return error("TypeError", "mxs_file_next_line: argument is not a LineIterator");
+    return it->next().release();
+}
+
+auto mxs_string_own(MXObject *value) -> MXObject * {
+    if (auto *view = dynamic_cast<MXStringView *>(value))
+        return view->materialize().release();
+    // 参数是借用的，原样返回会让调用方释放别人的对象
+    if (auto *str = dynamic_cast<MXString *>(value))
+        return std::make_unique<MXString>(std::string{ str->view() }).release();
+    return error("TypeError", "mxs_string_own: argument is not a string");
+}
+
+auto mxs_json_parse(MXObject *text) -> MXObject * {
+    MXTracer::Scope trace("runtime", "json parse");
+    if (auto *str = dynamic_cast<MXString *>(text))
+        return MXJsonReader::parse(std::string{ str->view() }).release();
+    if (auto *view = dynamic_cast<MXStringView *>(text))
+        return MXJsonReader::parse(std::string{ view->view() }).release();
+    return error("TypeError", "mxs_json_parse: argument 'text' is not a string");
+}
+
+auto mxs_json_reader(MXObject *source) -> MXObject * {
+    auto input = parser_input(source);
+    if (!input)
+        return error("TypeError", "mxs_json_reader: argument 'source' is not readable");
+    return new MXJsonReader(std::move(input));
+}
+
+auto mxs_json_next(MXObject *reader) -> MXObject * {
+    auto *json = dynamic_cast<MXJsonReader *>(reader);
+    if (!json) return error("TypeError", "mxs_json_next: argument is not a JsonReader");
+    return json->next().release();
+}
+
+auto mxs_json_done(MXObject *reader) -> MXObject * {
+    auto *json = dynamic_cast<MXJsonReader *>(reader);
+    if (!json) return error("TypeError", "mxs_json_done: argument is not a JsonReader");
+    return new MXBoolean(json->done());
+}
+
+auto mxs_csv_reader(MXObject *source, MXObject *delimiter) -> MXObject * {
+    auto *delim = dynamic_cast<MXString *>(delimiter);
+    if (!delim || delim->size() != 1)
+        return error("TypeError", "mxs_csv_reader: 'delimiter' must be a 1-char string");
+    auto input = parser_input(source);
+    if (!input)
+        return error("TypeError", "mxs_csv_reader: argument 'source' is not readable");
+    return new MXCsvReader(std::move(input), delim->view()[0]);
+}
+
+auto mxs_csv_next_row(MXObject *reader) -> MXObject * {
+    auto *csv = dynamic_cast<MXCsvReader *>(reader);
+    if (!csv) return error("TypeError", "mxs_csv_next_row: argument is not a CsvReader");
+    return csv->next_row().release();
+}
+
+auto mxs_csv_next_batch(MXObject *reader, MXObject *rows) -> MXObject * {
+    auto *csv = dynamic_cast<MXCsvReader *>(reader);
+    auto *rows_int = dynamic_cast<MXInteger *>(rows);
+    if (!csv)
+        return error("TypeError", "mxs_csv_next_batch: argument is not a CsvReader");
+    if (!rows_int || rows_int->value <= 0)
+        return error("ValueError", "mxs_csv_next_batch: 'rows' must be a positive int");
+    MXTracer::Scope trace("runtime", "csv batch");
+    return csv->next_batch(static_cast<std::size_t>(rows_int->value)).release();
+}
+}
@@ -1,3 +1,760 @@
 //
 // Created by mux on 2025/7/10.
 //
+#include "mxspp/shell/shell.h"
+#include "mxspp/core/MXCollection.h"
+#include "mxspp/core/MXError.h"
+#include "mxspp/core/MXMetrics.h"
+#include "mxspp/core/MXNumeric.h"
+#include "mxspp/core/MXOutputStream.h"
+#include "mxspp/core/MXPopulationManager.h"
+#include "mxspp/core/MXSnapshot.h"
+#include "mxspp/core/MXString.h"
+#include "mxspp/core/MXTrace.h"
+#include "mxspp/frontend/action.h"
+#include "mxspp/jit/feedback.h"
+#include "mxspp/jit/timing.h"
+#include "mxspp/runtime/runtime.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <dlfcn.h>
+#include <format>
+#include <map>
+#include <optional>
+#include <span>
+#include <typeinfo>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include <llvm/Config/llvm-config.h>
+#include <llvm/IR/Verifier.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/raw_ostream.h>
+#include <llvm/Support/xxhash.h>
+
+namespace mxs::shell {
+    namespace {
+        namespace pegtl = tao::pegtl;
+        namespace grammar = mxs::frontend::grammar;
+        namespace actions = mxs::frontend::actions;
+        namespace ast = mxs::frontend::ast;
+
+        auto error_text(const char *type, std::string message) -> std::string {
+            return core::MXError(type, std::move(message)).repr();
+        }
+
+        auto report(const char *type, std::string message) -> int {
+            core::MXOutputStream::standard_error().write_line(
+                    error_text(type, std::move(message)));
+            return 1;
+        }
+
+        auto new_module(const jit::MXJit &jit, const std::string &name,
+                        llvm::LLVMContext &context) -> std::unique_ptr<llvm::Module> {
+            auto module = std::make_unique<llvm::Module>(name, context);
+            module->setDataLayout(jit.data_layout());
+            module->setTargetTriple(jit.target_triple().str());
+            return module;
+        }
+
+        // 镜像 flags：main 是 async func
+        constexpr std::uint32_t ASYNC_MAIN = 1;
+
+        // 执行不能在编译期折叠的顶层绑定；由 shell 在 main / init 之前调用
+        constexpr const char *MODULE_INIT = "__mxs_module_init";
+
+        // 整个脚本降级后的模块，以及其中定义的函数（名字 -> 是否 async）；
+        // key 标识源码，profiled 是收集了类型反馈的函数（名字 -> 参数个数），
+        // osr 是顶层循环的续体模块（没有这样的循环时为空）
+        struct Program {
+            llvm::orc::ThreadSafeModule module;
+            std::unordered_map<std::string, bool> functions;
+            std::uint64_t key = 0;
+            std::vector<std::pair<std::string, std::size_t>> profiled;
+            std::optional<llvm::orc::ThreadSafeModule> osr;
+        };
+
+        // 生成的代码通过 mxs.osr.context 把它传回 osr_compile
+        struct OsrSite {
+            jit::MXJit *jit;
+            llvm::orc::JITDylib *dylib;
+        };
+
+        // 循环回边计数到阈值时由 JIT 代码调用：查找续体即触发它的 O2 编译。
+        // 失败时返回 nullptr，循环留在基线代码里继续执行，结果不受影响
+        auto osr_compile(OsrSite *site, const char *symbol) -> void * {
+            static auto &entries = core::MXMetricsRegistry::get_registry().counter(
+                    "mxs_jit_osr_entries_total",
+                    "Loops that moved to optimized code while running.");
+            jit::MXCompileTimer::Scope scope(jit::MXCompileTimer::get_timer(),
+                                             "OSR compile");
+            core::MXTracer::Scope trace("jit", "osr compile");
+            auto address = site->jit->lookup_in(*site->dylib, symbol);
+            if (!address) {
+                llvm::consumeError(address.takeError());
+                return nullptr;
+            }
+            entries.add();
+            return address->toPtr<void *>();
+        }
+
+        // 续体模块和 OSR 回调放进程序所在的 JITDylib；续体要到回调查找它时才编译
+        auto install_osr(jit::MXJit &jit, OsrSite &site,
+                         llvm::orc::ThreadSafeModule module) -> llvm::Error {
+            auto &dylib = *site.dylib;
+            const auto *callback = reinterpret_cast<const void *>(&osr_compile);
+            if (auto error = jit.define_absolute(dylib, "mxs.osr.compile", callback))
+                return error;
+            if (auto error = jit.define_absolute(dylib, "mxs.osr.context", &site))
+                return error;
+            return jit.add_to(dylib, std::move(module));
+        }
+
+        // MXS_SPECULATION=0 关掉类型反馈和推测编译，便于排查推测引入的问题
+        auto speculation_enabled() -> bool {
+            const char *value = std::getenv("MXS_SPECULATION");
+            return !value || std::string_view{ value } != "0";
+        }
+
+        // 编译器本身的标识：同一 LLVM 版本下改动代码生成也必须让旧缓存失效。
+        // 生成代码的逻辑分布在可执行文件和 frontend / backend / jit / shell 几个
+        // 共享库里，取它们文件内容的哈希；每个进程只算一次
+        auto compiler_build_id() -> std::uint64_t {
+            static const std::uint64_t id = [] {
+                // 每个库里取一个地址，由 dladdr 找到所在的文件；静态链接时它们
+                // 都落在可执行文件里，去重后只算一次
+                const void *anchors[] = {
+                    &typeid(ast::Block),
+                    reinterpret_cast<const void *>(&backend::codegen::emit_box),
+                    reinterpret_cast<const void *>(&jit::MXJit::create),
+                    reinterpret_cast<const void *>(&compiler_build_id),
+                };
+                std::vector<std::string> paths{
+                    llvm::sys::fs::getMainExecutable(nullptr, nullptr)
+                };
+                for (const void *anchor : anchors) {
+                    Dl_info info{};
+                    if (::dladdr(anchor, &info) == 0 || !info.dli_fname) continue;
+                    // 可执行文件的 dli_fname 可能是相对路径，统一成真实路径再去重
+                    llvm::SmallString<256> path;
+                    if (llvm::sys::fs::real_path(info.dli_fname, path)) {
+                        paths.emplace_back(info.dli_fname);
+                    } else {
+                        paths.emplace_back(path.str());
+                    }
+                }
+                std::ranges::sort(paths);
+                paths.erase(std::ranges::unique(paths).begin(), paths.end());
+                std::string digests;
+                for (const auto &path : paths) {
+                    auto binary = llvm::MemoryBuffer::getFile(path);
+                    if (!binary) continue;
+                    digests += std::format("{:016x}",
+                                           llvm::xxh3_64bits((*binary)->getBuffer()));
+                }
+                return llvm::xxh3_64bits(llvm::StringRef(digests));
+            }();
+            return id;
+        }
+
+        // 解析并生成整程序模块；出错时已在 stderr 报告并返回 nullopt。
+        // tiered 时顶层循环带回边计数，续体另外生成到 Program::osr
+        auto lower_program(const jit::MXJit &jit, std::string_view source,
+                           std::string_view name, bool strip_asserts,
+                           bool tiered = false)
+                -> std::optional<Program> {
+            using jit::MXCompileTimer;
+            auto &timer = MXCompileTimer::get_timer();
+            core::MXTracer::Scope trace("compile", "lower program");
+            actions::AstBuilderState state;
+            try {
+                if (timer.enabled()) {
+                    // action 在匹配过程中建树，单独计时只能先不带 action 再解析一遍
+                    MXCompileTimer::Scope scope(timer, "Parse (grammar only)");
+                    pegtl::memory_input input(source.data(), source.size(), name);
+                    pegtl::parse<grammar::grammar>(input);
+                }
+                pegtl::memory_input input(source.data(), source.size(), name);
+                auto &population = core::MXPopulationManager::get_manager();
+                const auto nodes_before = population.total_registered();
+                MXCompileTimer::Scope scope(timer, "Parse + AST build");
+                pegtl::parse<grammar::grammar, actions::action, actions::control>(
+                        input, state);
+                // AST 节点都是 MXObject，解析期间注册的对象数就是建出的节点数
+                timer.count("AST nodes", population.total_registered() - nodes_before);
+            } catch (const pegtl::parse_error &error) {
+                report("SyntaxError", error.what());
+                return std::nullopt;
+            }
+
+            Program program;
+            program.key = MXShell::program_key(source, name, jit.runtime_key(), strip_asserts);
+
+            // 按之前几次运行的类型反馈决定推测哪些函数；推测改变了生成的代码，
+            // 所以也要计入缓存键
+            std::map<std::string, std::vector<std::int32_t>> speculation;
+            const bool speculate = speculation_enabled();
+            for (auto &node : state.node_stack) {
+                auto *function = dynamic_cast<ast::FunctionDefinition *>(node.get());
+                if (!speculate || !function || function->params.empty() ||
+                    !function->genericParams.empty())
+                    continue;
+                program.profiled.emplace_back(function->name, function->params.size());
+                auto kinds = jit::MXTypeFeedback::get_feedback().speculation(
+                        program.key, function->name, function->params.size());
+                if (!kinds.empty()) speculation[function->name] = std::move(kinds);
+            }
+            auto key_source = std::format("{:016x}", program.key);
+            for (const auto &[function, kinds] : speculation) {
+                key_source += '\0';
+                key_source += function;
+                for (auto kind : kinds) key_source += static_cast<char>('0' + kind);
+            }
+            const auto key = speculation.empty()
+                                     ? program.key
+                                     : llvm::xxh3_64bits(llvm::StringRef(key_source));
+
+            auto context = std::make_unique<llvm::LLVMContext>();
+            auto module = new_module(jit, std::format("script.{:016x}", key), *context);
+            llvm::IRBuilder<> builder(*context);
+            backend::codegen::CodegenContext ctx{ *context, module.get(), &builder };
+            backend::codegen::begin_debug_info(ctx, name);
+            ctx.collect_feedback = speculate;
+            ctx.strip_asserts = strip_asserts;
+            ctx.speculation.insert(speculation.begin(), speculation.end());
+            std::unique_ptr<llvm::Module> osr;
+            if (tiered) {
+                osr = new_module(jit, std::format("script.{:016x}.osr", key), *context);
+                ctx.osr_module = osr.get();
+            }
+
+            // 语法接受、但出现的位置不对的构造（函数外的 await 等）在生成时抛出
+            try {
+                // 先登记所有函数，调用点才能引用后面定义的函数和实例化泛型函数
+                for (auto &node : state.node_stack) {
+                    if (auto *function =
+                                dynamic_cast<ast::FunctionDefinition *>(node.get()))
+                        function->declare(ctx);
+                }
+
+                // 先处理顶层绑定，函数体生成时才能内联折叠出的常量
+                auto *object_ptr = llvm::PointerType::getUnqual(*context);
+                auto *module_init = llvm::Function::Create(
+                        llvm::FunctionType::get(object_ptr, false),
+                        llvm::Function::ExternalLinkage, MODULE_INIT, module.get());
+                builder.SetInsertPoint(
+                        llvm::BasicBlock::Create(*context, "entry", module_init));
+                {
+                    MXCompileTimer::Scope scope(timer, "Codegen: top-level bindings");
+                    backend::codegen::begin_function_scope(ctx, module_init, { 1, 1 });
+                    for (auto &node : state.node_stack) {
+                        if (auto *binding =
+                                    dynamic_cast<ast::BindingStatement *>(node.get()))
+                            binding->codegen(ctx);
+                    }
+                    builder.CreateRet(llvm::ConstantPointerNull::get(object_ptr));
+                    backend::codegen::end_function_scope(ctx);
+                }
+
+                for (auto &node : state.node_stack) {
+                    // 泛型函数只有调用点生成的内部实例，不是可调用的入口
+                    auto *function = dynamic_cast<ast::FunctionDefinition *>(node.get());
+                    if (!function || !function->genericParams.empty()) continue;
+                    MXCompileTimer::Scope scope(
+                            timer, std::format("Codegen: {}", function->name));
+                    function->codegen(ctx);
+                    program.functions[function->name] = function->isAsync;
+                }
+            } catch (const backend::codegen::CompileError &error) {
+                report("CompileError", std::format("{}:{}", name, error.what()));
+                return std::nullopt;
+            }
+
+            std::string diagnostics;
+            llvm::raw_string_ostream diagnostics_stream(diagnostics);
+            backend::codegen::finish_debug_info(ctx);
+            MXCompileTimer::Scope verify_scope(timer, "IR verification");
+            if (llvm::verifyModule(*module, &diagnostics_stream) ||
+                (osr && llvm::verifyModule(*osr, &diagnostics_stream))) {
+                report("CompileError", diagnostics);
+                return std::nullopt;
+            }
+            if (timer.enabled()) {
+                std::uint64_t instructions = 0;
+                for (const auto &function : *module)
+                    instructions += function.getInstructionCount();
+                timer.count("IR functions", module->size());
+                timer.count("IR instructions", instructions);
+            }
+            llvm::orc::ThreadSafeContext shared(std::move(context));
+            program.module = llvm::orc::ThreadSafeModule(std::move(module), shared);
+            if (osr && !osr->empty())
+                program.osr = llvm::orc::ThreadSafeModule(std::move(osr), shared);
+            return program;
+        }
+
+        // main 的 int 结果作为退出码；MXError 打印到 stderr 并返回 1
+        auto exit_status(core::MXObject *result) -> int {
+            if (auto *code = dynamic_cast<builtin::MXInteger *>(result))
+                return static_cast<int>(code->value);
+            if (auto *error = dynamic_cast<core::MXError *>(result)) {
+                core::MXOutputStream::standard_error().write_line(error->repr());
+                return 1;
+            }
+            return 0;
+        }
+
+        // 依次尝试声明、表达式、语句；每次都用新的状态，失败的尝试不会残留节点
+        template<typename Entry, typename... Rest>
+        auto parse_entry(std::string_view source, actions::AstBuilderState &state)
+                -> bool {
+            state.node_stack.clear();
+            pegtl::memory_input input(source.data(), source.size(), "<repl>");
+            if (pegtl::parse<Entry, actions::action, actions::control>(input, state))
+                return true;
+            if constexpr (sizeof...(Rest) > 0) {
+                return parse_entry<Rest...>(source, state);
+            } else {
+                return false;
+            }
+        }
+
+        // REPL 的包装函数既不是块也不是循环，顶层的 defer / break / continue
+        // 没有可以挂靠的地方；返回该语句的关键字，其他节点返回 nullptr
+        auto misplaced_in_repl(const ast::MXASTNode *node) -> const char * {
+            if (dynamic_cast<const ast::DeferStatement *>(node)) return "defer";
+            if (dynamic_cast<const ast::BreakStatement *>(node)) return "break";
+            if (dynamic_cast<const ast::ContinueStatement *>(node)) return "continue";
+            return nullptr;
+        }
+
+        // 把这次运行的类型反馈和退优化次数并入 MXTypeFeedback，供下次编译使用
+        auto harvest_feedback(jit::MXJit &jit, llvm::orc::JITDylib &dylib,
+                              const Program &program) -> void {
+            static auto &deopt_total = core::MXMetricsRegistry::get_registry().counter(
+                    "mxs_jit_deoptimizations_total",
+                    "Calls of speculated functions that fell back to baseline code.");
+            for (const auto &[function, params] : program.profiled) {
+                auto counts = jit.lookup_in(dylib, "mxs.feedback." + function);
+                if (!counts) {
+                    llvm::consumeError(counts.takeError());
+                    continue;
+                }
+                std::uint64_t deopts = 0;
+                if (auto deopt = jit.lookup_in(dylib, "mxs.deopt." + function)) {
+                    deopts = *deopt->toPtr<std::uint64_t *>();
+                } else {
+                    // 没有推测过的函数没有这个计数器
+                    llvm::consumeError(deopt.takeError());
+                }
+                const std::span<const std::uint64_t> kinds{
+                        counts->toPtr<const std::uint64_t *>(), params * MXS_KIND_COUNT };
+                jit::MXTypeFeedback::get_feedback().record(program.key, function, kinds,
+                                                           deopts);
+                if (deopts == 0) continue;
+                deopt_total.add(deopts);
+                if (core::MXTracer::enabled()) {
+                    core::MXTracer::get_tracer().instant(
+                            "jit", "deoptimization", static_cast<std::int64_t>(deopts));
+                }
+            }
+        }
+
+        // REPL 结果可能借用自全局表（比如直接求值一个 dynamic let 的名字），
+        // 这样的结果不能由回显释放。用显式栈和已访问集合遍历：深层嵌套不会
+        // 爆栈，共享或成环的引用也只访问一次，开销以全局表的对象数为上界
+        auto reachable(const core::MXObject *root, const core::MXObject *value) -> bool {
+            std::vector<const core::MXObject *> pending{ root };
+            std::unordered_set<const core::MXObject *> visited{ root };
+            while (!pending.empty()) {
+                const auto *object = pending.back();
+                pending.pop_back();
+                if (object == value) return true;
+                object->visit_references(
+                        [&](std::string_view, const core::MXObject *child) {
+                            if (child && visited.insert(child).second)
+                                pending.push_back(child);
+                        });
+            }
+            return false;
+        }
+
+        // 统计未闭合的括号，用来判断一条输入是否还要继续读下一行
+        auto open_brackets(std::string_view source) -> int {
+            int depth = 0;
+            char quote = 0;
+            for (std::size_t i = 0; i < source.size(); ++i) {
+                const char c = source[i];
+                if (quote) {
+                    if (c == '\\') {
+                        ++i;
+                    } else if (c == quote) {
+                        quote = 0;
+                    }
+                } else if (c == '"' || c == '\'') {
+                    quote = c;
+                } else if (c == '{' || c == '(' || c == '[') {
+                    ++depth;
+                } else if (c == '}' || c == ')' || c == ']') {
+                    --depth;
+                }
+            }
+            return depth;
+        }
+
+        auto record_compile_time(std::chrono::nanoseconds elapsed) -> void {
+            static auto &latency = core::MXMetricsRegistry::get_registry().histogram(
+                    "mxs_program_compile_seconds",
+                    "Parse, lowering and JIT compilation time per whole program.", 1e-9);
+            latency.record(static_cast<std::uint64_t>(elapsed.count()));
+        }
+    }
+
+    MXShell::MXShell(std::unique_ptr<jit::MXJit> jit) : jit_(std::move(jit)) { }
+
+    auto MXShell::create(const std::string &runtime_path, const std::string &cache_dir)
+            -> llvm::Expected<std::unique_ptr<MXShell>> {
+        auto jit = jit::MXJit::create(cache_dir);
+        if (!jit) return jit.takeError();
+        if (auto error = (*jit)->load_runtime(runtime_path)) return std::move(error);
+        return std::unique_ptr<MXShell>(new MXShell(std::move(*jit)));
+    }
+
+    auto MXShell::eval(std::string_view source) -> std::string {
+        actions::AstBuilderState state;
+        try {
+            if (!parse_entry<grammar::repl_declaration, grammar::repl_expression,
+                             grammar::repl_statement>(source, state))
+                return error_text("SyntaxError", "invalid input");
+        } catch (const pegtl::parse_error &error) {
+            return error_text("SyntaxError", error.what());
+        }
+        if (state.node_stack.empty()) {
+            return error_text("NotImplementedError",
+                              "the frontend does not build this construct yet");
+        }
+        for (const auto &node : state.node_stack) {
+            if (const char *keyword = misplaced_in_repl(node.get())) {
+                return error_text("SyntaxError",
+                                  std::format("<repl>:{}:{}: {} is not valid at the top "
+                                              "level of the REPL",
+                                              node->location.line, node->location.column,
+                                              keyword));
+            }
+        }
+
+        const std::size_t entry = this->entries_++;
+        auto context = std::make_unique<llvm::LLVMContext>();
+        auto module = new_module(*this->jit_, std::format("input.{}", entry), *context);
+        llvm::IRBuilder<> builder(*context);
+        backend::codegen::CodegenContext ctx{ *context, module.get(), &builder };
+        // 之前输入里折叠出的 static let 在本模块中同样内联
+        ctx.constants = this->constants_;
+        ctx.strip_asserts = this->strip_asserts_;
+        ctx.functions = this->functions_;
+
+        // 函数定义各自生成顶层函数；其余语句和表达式放进本次输入的包装函数里
+        std::vector<actions::NodePtr> body;
+        const std::string wrapper_name = std::format("__mxs_repl_{}", entry);
+        try {
+            for (auto &node : state.node_stack) {
+                if (auto *function = dynamic_cast<ast::FunctionDefinition *>(node.get()))
+                    function->declare(ctx);
+            }
+            for (auto &node : state.node_stack) {
+                if (auto *function =
+                            dynamic_cast<ast::FunctionDefinition *>(node.get())) {
+                    function->codegen(ctx);
+                } else {
+                    body.push_back(std::move(node));
+                }
+            }
+
+            if (!body.empty()) {
+                auto *object_ptr = llvm::PointerType::getUnqual(*context);
+                auto *wrapper = llvm::Function::Create(
+                        llvm::FunctionType::get(object_ptr, false),
+                        llvm::Function::ExternalLinkage, wrapper_name, module.get());
+                builder.SetInsertPoint(
+                        llvm::BasicBlock::Create(*context, "entry", wrapper));
+                ctx.namedValues.clear();
+                llvm::Value *result = llvm::ConstantPointerNull::get(object_ptr);
+                for (auto &node : body) {
+                    if (builder.GetInsertBlock()->getTerminator()) break;
+                    if (auto *statement = dynamic_cast<ast::Statement *>(node.get())) {
+                        statement->codegen(ctx);
+                    } else if (auto *expr = dynamic_cast<ast::Expression *>(node.get())) {
+                        result = backend::codegen::emit_box(ctx, expr->codegen(ctx));
+                    }
+                }
+                if (!builder.GetInsertBlock()->getTerminator()) builder.CreateRet(result);
+            }
+        } catch (const backend::codegen::CompileError &error) {
+            // 和 lower_program 一样：位置不对的构造（包装函数里的 await 等）
+            return error_text("CompileError", std::format("<repl>:{}", error.what()));
+        }
+
+        std::string diagnostics;
+        llvm::raw_string_ostream diagnostics_stream(diagnostics);
+        if (llvm::verifyModule(*module, &diagnostics_stream))
+            return error_text("CompileError", diagnostics);
+
+        auto added = this->jit_->add_module(
+                llvm::orc::ThreadSafeModule(std::move(module), std::move(context)));
+        if (!added) return error_text("CompileError", llvm::toString(added.takeError()));
+        this->constants_ = std::move(ctx.constants);
+        this->functions_ = std::move(ctx.functions);
+        if (body.empty()) return "";
+
+        auto address = this->jit_->lookup(wrapper_name);
+        if (!address)
+            return error_text("CompileError", llvm::toString(address.takeError()));
+        auto *value = address->toPtr<core::MXObject *(*)()>()();
+        // 让脚本里 print 的输出先于回显出现
+        core::MXOutputStream::standard_output().flush();
+        if (!value) return "nil";
+        auto text = value->repr();
+        // 回显之后结果就没用了；静态对象和全局表里的值不归这次输入所有
+        auto globals = this->jit_->lookup("mxs_runtime_globals");
+        if (!globals) {
+            llvm::consumeError(globals.takeError());
+        } else if (!value->is_static &&
+                   !reachable(globals->toPtr<core::MXObject *(*)()>()(), value)) {
+            delete value;
+        }
+        return text;
+    }
+
+    auto MXShell::call_entry(llvm::orc::JITDylib &dylib, llvm::StringRef name,
+                             bool is_async) -> llvm::Expected<core::MXObject *> {
+        auto entry = this->jit_->lookup_in(dylib, name);
+        if (!entry) return entry.takeError();
+        auto *result = entry->toPtr<core::MXObject *(*)()>()();
+        if (!is_async) return result;
+        // async 函数返回的是任务帧，交给事件循环跑完
+        auto drive = this->jit_->lookup("mxs_runtime_run_until_complete");
+        if (!drive) return drive.takeError();
+        return drive->toPtr<core::MXObject *(*)(void *)>()(result);
+    }
+
+    auto MXShell::first_call(llvm::orc::JITDylib &dylib)
+            -> llvm::Expected<llvm::orc::ExecutorAddr> {
+        jit::MXCompileTimer::Scope scope(jit::MXCompileTimer::get_timer(),
+                                         "First-call latency: main");
+        core::MXTracer::Scope trace("compile", "materialize main");
+        return this->jit_->lookup_in(dylib, "main");
+    }
+
+    auto MXShell::init_module(llvm::orc::JITDylib &dylib) -> int {
+        core::MXTracer::Scope trace("run", "module init");
+        auto result = this->call_entry(dylib, MODULE_INIT, false);
+        if (!result) return report("CompileError", llvm::toString(result.takeError()));
+        // 第一个失败的绑定的错误；此时 main 不再运行
+        if (auto *error = dynamic_cast<core::MXError *>(*result)) {
+            core::MXOutputStream::standard_output().flush();
+            core::MXOutputStream::standard_error().write_line(error->repr());
+            return 1;
+        }
+        return 0;
+    }
+
+    auto MXShell::run_main(llvm::orc::JITDylib &dylib, bool is_async) -> int {
+        core::MXTracer::Scope trace("run", "main");
+        auto result = this->call_entry(dylib, "main", is_async);
+        if (!result) return report("CompileError", llvm::toString(result.takeError()));
+        core::MXOutputStream::standard_output().flush();
+        return exit_status(*result);
+    }
+
+    auto MXShell::run_program(std::string_view source, bool execute,
+                              std::string_view name) -> int {
+        const auto started = std::chrono::steady_clock::now();
+        this->last_compile_time_ = {};
+        auto program =
+                lower_program(*this->jit_, source, name, this->strip_asserts_, true);
+        if (!program) return 1;
+        auto dylib = this->jit_->add_isolated_module(std::move(program->module));
+        if (!dylib) return report("CompileError", llvm::toString(dylib.takeError()));
+
+        // 要比 JITDylib 活得久：生成的代码里存着它的地址。装不上时 main 引用的
+        // mxs.osr.* 无法解析，下面物化时会报告 CompileError
+        OsrSite osr_site{ this->jit_.get(), *dylib };
+        if (program->osr) {
+            if (auto error = install_osr(*this->jit_, osr_site, std::move(*program->osr)))
+                report("CompileError", llvm::toString(std::move(error)));
+        }
+
+        int status = 0;
+        if (!execute) {
+            // 只编译：逐个解析符号以触发物化，目标文件随之写入缓存
+            for (const auto &[name, is_async] : program->functions) {
+                if (auto address = this->jit_->lookup_in(**dylib, name); !address) {
+                    status = report("CompileError", llvm::toString(address.takeError()));
+                    break;
+                }
+            }
+            this->last_compile_time_ = std::chrono::steady_clock::now() - started;
+        } else if (!program->functions.contains("main")) {
+            status = report("NameError", "script defines no main function");
+        } else if (auto address = this->first_call(**dylib); !address) {
+            // 先解析 main 触发整个模块的物化，这样编译耗时不混入执行时间
+            status = report("CompileError", llvm::toString(address.takeError()));
+        } else {
+            this->last_compile_time_ = std::chrono::steady_clock::now() - started;
+            status = this->init_module(**dylib);
+            if (status == 0)
+                status = this->run_main(**dylib, program->functions.at("main"));
+            harvest_feedback(*this->jit_, **dylib, *program);
+        }
+        if (this->last_compile_time_.count() > 0)
+            record_compile_time(this->last_compile_time_);
+        if (auto error = this->jit_->remove(**dylib))
+            report("RuntimeError", llvm::toString(std::move(error)));
+        return status;
+    }
+
+    auto MXShell::last_compile_time() const -> std::chrono::nanoseconds {
+        return this->last_compile_time_;
+    }
+
+    auto MXShell::set_strip_asserts(bool strip) -> void { this->strip_asserts_ = strip; }
+
+    // 源码、文件名（写进了调试信息）、编译器和链接进来的运行时共同决定缓存键：
+    // 缓存的目标代码按符号直接调用运行时。各部分之间用 '\0' 分隔；格式串里
+    // 不能写 '\0'，std::format 会在那里截断格式串
+    auto MXShell::program_key(std::string_view source, std::string_view name,
+                              std::uint64_t runtime_key, bool strip_asserts)
+            -> std::uint64_t {
+        std::string key_source{ source };
+        key_source += '\0';
+        key_source += name;
+        key_source += '\0';
+        key_source += LLVM_VERSION_STRING;
+        key_source.append(1, '\0');
+        key_source += std::format("{:016x}", compiler_build_id());
+        key_source.append(1, '\0');
+        key_source += std::format("{:016x}", runtime_key);
+        // 去掉 assert 的代码与保留的不同，分开缓存
+        if (strip_asserts) key_source += std::string_view{ "\0strip-asserts", 14 };
+        return llvm::xxh3_64bits(llvm::StringRef(key_source));
+    }
+
+    auto MXShell::snapshot(std::string_view source, const std::string &image_path,
+                           std::string_view name) -> int {
+        auto program = lower_program(*this->jit_, source, name, this->strip_asserts_);
+        if (!program) return 1;
+        if (!program->functions.contains("main"))
+            return report("NameError", "script defines no main function");
+        const bool async_main = program->functions.at("main");
+        auto object = this->jit_->compile_object(std::move(program->module));
+        if (!object) return report("CompileError", llvm::toString(object.takeError()));
+        std::string code = (*object)->getBuffer().str();
+        auto dylib = this->jit_->add_isolated_object(std::move(*object));
+        if (!dylib) return report("CompileError", llvm::toString(dylib.takeError()));
+
+        // 不可折叠的绑定和 init() 的结果一起进入镜像，启动时不再执行
+        int status = this->init_module(**dylib);
+        const auto init = program->functions.find("init");
+        if (status == 0 && init != program->functions.end()) {
+            auto result = this->call_entry(**dylib, "init", init->second);
+            core::MXOutputStream::standard_output().flush();
+            if (!result) {
+                status = report("CompileError", llvm::toString(result.takeError()));
+            } else if (auto *error = dynamic_cast<core::MXError *>(*result)) {
+                core::MXOutputStream::standard_error().write_line(error->repr());
+                status = 1;
+            }
+        }
+
+        // init() 之后的全局表就是要保存的堆
+        core::MXSnapshotWriter writer;
+        if (status == 0) {
+            auto globals = this->jit_->lookup("mxs_runtime_globals");
+            if (!globals) {
+                status = report("CompileError", llvm::toString(globals.takeError()));
+            } else {
+                auto *table = dynamic_cast<builtin::MXDict *>(
+                        globals->toPtr<core::MXObject *(*)()>()());
+                for (const auto &name : table->keys()) {
+                    if (auto error = writer.add_root(name, table->get(name))) {
+                        core::MXOutputStream::standard_error().write_line(error->repr());
+                        status = 1;
+                        break;
+                    }
+                }
+            }
+        }
+        if (status == 0) {
+            writer.set_code(std::move(code));
+            writer.set_flags(async_main ? ASYNC_MAIN : 0);
+            if (auto error = writer.write(image_path, this->jit_->runtime_key())) {
+                core::MXOutputStream::standard_error().write_line(error->repr());
+                status = 1;
+            }
+        }
+        if (auto error = this->jit_->remove(**dylib))
+            report("RuntimeError", llvm::toString(std::move(error)));
+        return status;
+    }
+
+    auto MXShell::run_image(const std::string &image_path) -> int {
+        auto image = core::MXSnapshotImage::open(image_path, this->jit_->runtime_key());
+        if (!image) {
+            return report("SnapshotError",
+                          std::format("{}: missing, corrupt or built for another runtime",
+                                      image_path));
+        }
+        auto store = this->jit_->lookup("mxs_runtime_global_store");
+        if (!store) return report("CompileError", llvm::toString(store.takeError()));
+        auto *store_global =
+                store->toPtr<core::MXObject *(*)(core::MXObject *, core::MXObject *)>();
+        for (auto &[name, value] : image->restore()) {
+            // store 保存的是副本，恢复出的对象仍归这里释放。存不进去的全局值
+            // 让镜像作废：main 会读到缺失的全局
+            core::MXString key{ std::move(name) };
+            if (auto *error = store_global(&key, value.get())) {
+                return report("SnapshotError",
+                              std::format("{}: cannot restore global '{}': {}",
+                                          image_path, key.view(), error->repr()));
+            }
+        }
+
+        // 目标代码直接借用镜像的映射，不再编译；image 要活到 dylib 移除之后
+        auto dylib = this->jit_->add_isolated_object(
+                llvm::MemoryBuffer::getMemBuffer(image->code(), image_path, false));
+        if (!dylib) return report("CompileError", llvm::toString(dylib.takeError()));
+        int status = 0;
+        if (auto address = this->first_call(**dylib); !address)
+            status = report("CompileError", llvm::toString(address.takeError()));
+        else
+            status = this->run_main(**dylib, image->flags() & ASYNC_MAIN);
+        if (auto error = this->jit_->remove(**dylib))
+            report("RuntimeError", llvm::toString(std::move(error)));
+        return status;
+    }
+
+    auto MXShell::run(std::istream &in, std::ostream &out) -> int {
+        std::string entry;
+        std::string line;
+        while (true) {
+            out << (entry.empty() ? ">>> " : "... ") << std::flush;
+            {
+                // 等输入时不碰对象，堆快照不必等这个线程
+                core::MXPopulationManager::Parked parked;
+                if (!std::getline(in, line)) break;
+            }
+            if (entry.empty() && (line == ":quit" || line == ":q")) break;
+            entry += line;
+            entry += '\n';
+            if (open_brackets(entry) > 0) continue;
+            if (entry.find_first_not_of(" \t\r\n") != std::string::npos) {
+                if (auto text = this->eval(entry); !text.empty()) out << text << '\n';
+            }
+            entry.clear();
+        }
+        out << '\n';
+        return 0;
+    }
+}
@@ -0,0 +1,136 @@
+#include "mxspp/core/MXAsyncIO.h"
+#include <catch2/catch.hpp>
+#include <cerrno>
+#include <coroutine>
+#include <poll.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+using mxs::core::MXEventLoop;
+using mxs::core::MXIOOp;
+using mxs::core::MXIORequest;
+using mxs::core::mx_make_io_uring_backend;
+
+namespace {
+    // 接下来 failures 次 io_uring_enter 以 error 失败，之后照常进入内核
+    int failures = 0;
+    int error = 0;
+
+    auto failing_enter(int ring_fd, unsigned to_submit) -> int {
+        if (failures > 0) {
+            --failures;
+            errno = error;
+            return -1;
+        }
+        return static_cast<int>(
+                ::syscall(__NR_io_uring_enter, ring_fd, to_submit, 0, 0, nullptr, 0));
+    }
+
+    struct Pipe {
+        int fds[2] = { -1, -1 };
+        Pipe() { REQUIRE(::pipe(fds) == 0); }
+        ~Pipe() {
+            ::close(fds[0]);
+            ::close(fds[1]);
+        }
+    };
+
+    // 从管道读一个字节的请求；等待者什么也不做，调度到事件循环上也无妨
+    auto read_request(const Pipe &pipe, char &byte) -> MXIORequest {
+        return MXIORequest{ .op = MXIOOp::READ,
+                            .fd = pipe.fds[0],
+                            .buffer = &byte,
+                            .length = 1,
+                            .waiter = std::noop_coroutine() };
+    }
+
+    // 等到有请求完成并收割，最多等一秒
+    auto reap_one(mxs::core::MXIOBackend &backend) -> std::size_t {
+        pollfd ready{ .fd = backend.completion_fd(), .events = POLLIN };
+        ::poll(&ready, 1, 1000);
+        return backend.reap(MXEventLoop::get_loop());
+    }
+}
+
+TEST_CASE("a failed io_uring submission completes every queued request", "[io]") {
+    auto backend = mx_make_io_uring_backend(failing_enter);
+    if (!backend) {
+        WARN("io_uring is not available");
+        return;
+    }
+    const Pipe pipe;
+    char first = 0;
+    char second = 0;
+    auto one = read_request(pipe, first);
+    auto two = read_request(pipe, second);
+    backend->submit(one);
+    backend->submit(two);
+
+    failures = 1;
+    error = EINVAL;
+    backend->flush();
+    CHECK(backend->reap(MXEventLoop::get_loop()) == 2);
+    CHECK(one.result == -EINVAL);
+    CHECK(two.result == -EINVAL);
+    CHECK(backend->in_flight() == 0);
+
+    // 退回的提交队列项不会在下一次提交时被内核再取走
+    REQUIRE(::write(pipe.fds[1], "x", 1) == 1);
+    char third = 0;
+    auto three = read_request(pipe, third);
+    backend->submit(three);
+    backend->flush();
+    CHECK(reap_one(*backend) == 1);
+    CHECK(three.result == 1);
+    CHECK(third == 'x');
+    CHECK(backend->in_flight() == 0);
+    MXEventLoop::get_loop().run_once(0);
+}
+
+TEST_CASE("a busy io_uring submission is retried", "[io]") {
+    auto backend = mx_make_io_uring_backend(failing_enter);
+    if (!backend) {
+        WARN("io_uring is not available");
+        return;
+    }
+    const Pipe pipe;
+    REQUIRE(::write(pipe.fds[1], "a", 1) == 1);
+    char first = 0;
+    auto one = read_request(pipe, first);
+    backend->submit(one);
+    backend->flush();
+    REQUIRE(reap_one(*backend) == 1);
+
+    // 内核里没有在途的请求，EBUSY 之后再等也不会有完成事件，只能报错
+    char second = 0;
+    auto two = read_request(pipe, second);
+    backend->submit(two);
+    failures = 1;
+    error = EBUSY;
+    backend->flush();
+    CHECK(backend->reap(MXEventLoop::get_loop()) == 1);
+    CHECK(two.result == -EBUSY);
+
+    // 有在途的请求时留到下一次 flush 重试
+    char blocked = 0;
+    auto waiting = read_request(pipe, blocked);
+    backend->submit(waiting);
+    backend->flush();
+    char third = 0;
+    auto three = read_request(pipe, third);
+    backend->submit(three);
+    failures = 1;
+    error = EAGAIN;
+    backend->flush();
+    CHECK(backend->in_flight() == 2);
+    CHECK(backend->reap(MXEventLoop::get_loop()) == 0);
+    backend->flush();
+    REQUIRE(::write(pipe.fds[1], "cd", 2) == 2);
+    std::size_t finished = 0;
+    for (int i = 0; i < 2 && finished < 2; ++i) finished += reap_one(*backend);
+    CHECK(finished == 2);
+    CHECK(waiting.result == 1);
+    CHECK(three.result == 1);
+    CHECK(backend->in_flight() == 0);
+    MXEventLoop::get_loop().run_once(0);
+}
@@ -0,0 +1,110 @@
+#include "mxspp/core/MXCollection.h"
+#include "mxspp/core/MXCsv.h"
+#include "mxspp/core/MXString.h"
+#include <catch2/catch.hpp>
+#include <string>
+#include <vector>
+
+using mxs::builtin::MXArray;
+using mxs::builtin::MXList;
+using mxs::core::MXCsvReader;
+using mxs::core::MXMappedRegion;
+using mxs::core::MXObject;
+using mxs::core::MXString;
+using mxs::core::MXStringView;
+
+namespace {
+    auto text_of(const MXObject *value) -> std::string {
+        if (auto *str = dynamic_cast<const MXString *>(value))
+            return std::string{ str->view() };
+        if (auto *view = dynamic_cast<const MXStringView *>(value))
+            return std::string{ view->view() };
+        FAIL("not a string: " << (value ? value->repr() : "nullptr"));
+        return {};
+    }
+
+    // 把 next_row() 的结果转成字符串表，nullptr（输入结束）之后停止
+    auto read_rows(std::string input) -> std::vector<std::vector<std::string>> {
+        MXCsvReader reader{ MXMappedRegion::adopt(std::move(input)) };
+        std::vector<std::vector<std::string>> rows;
+        while (auto row = reader.next_row()) {
+            auto *list = dynamic_cast<MXList *>(row.get());
+            REQUIRE(list);
+            auto &cells = rows.emplace_back();
+            for (std::size_t i = 0; i < list->size(); ++i)
+                cells.push_back(text_of(list->at(i)));
+        }
+        return rows;
+    }
+
+    using Rows = std::vector<std::vector<std::string>>;
+}
+
+TEST_CASE("quoted fields may contain newlines", "[csv]") {
+    CHECK(read_rows("a,\"b\nc\",d\n1,2,3\n")
+          == Rows{ { "a", "b\nc", "d" }, { "1", "2", "3" } });
+
+    // 引号内的换行落在第二个 64 字节块里，不能被当成记录结尾
+    const std::string longer(70, 'x');
+    CHECK(read_rows("id,\"" + longer + "\n" + longer + "\"\n7,8\n")
+          == Rows{ { "id", longer + "\n" + longer }, { "7", "8" } });
+}
+
+TEST_CASE("quote escapes, CRLF and blank lines", "[csv]") {
+    CHECK(read_rows("\"x \"\"y\"\" z\",w\n") == Rows{ { "x \"y\" z", "w" } });
+    CHECK(read_rows("a,b\r\nc,\"d\"\r\n") == Rows{ { "a", "b" }, { "c", "d" } });
+    // 引号内的 \r 是字段内容，不是行尾
+    CHECK(read_rows("\"a\r\nb\",c\r\n") == Rows{ { "a\r\nb", "c" } });
+    CHECK(read_rows("a\n\nb\n\n") == Rows{ { "a" }, { "b" } });
+    // 最后一条记录没有换行
+    CHECK(read_rows("a,b\nc,d") == Rows{ { "a", "b" }, { "c", "d" } });
+    CHECK(read_rows("").empty());
+}
+
+TEST_CASE("short rows in a batch", "[csv]") {
+    MXCsvReader reader{ MXMappedRegion::adopt("1,2,3\n4\n5,6\n") };
+    const auto batch = reader.next_batch(10);
+    auto *columns = dynamic_cast<MXList *>(batch.get());
+    REQUIRE(columns);
+    REQUIRE(columns->size() == 3);
+
+    // 第一列完整，按整数存
+    auto *first = dynamic_cast<MXArray *>(columns->at(0));
+    REQUIRE(first);
+    REQUIRE(first->is_integer());
+    CHECK(std::vector<std::int64_t>(first->integers().begin(), first->integers().end())
+          == std::vector<std::int64_t>{ 1, 4, 5 });
+
+    // 短行缺的单元格是空字符串，整列于是不再是数字
+    auto *second = dynamic_cast<MXList *>(columns->at(1));
+    REQUIRE(second);
+    CHECK(text_of(second->at(0)) == "2");
+    CHECK(text_of(second->at(1)).empty());
+    CHECK(text_of(second->at(2)) == "6");
+    auto *third = dynamic_cast<MXList *>(columns->at(2));
+    REQUIRE(third);
+    CHECK(text_of(third->at(1)).empty());
+    CHECK(text_of(third->at(2)).empty());
+
+    CHECK(reader.next_batch(10) == nullptr);
+}
+
+TEST_CASE("batches split across calls", "[csv]") {
+    MXCsvReader reader{ MXMappedRegion::adopt("1.5,a\n2,b\n3,c\n") };
+    const auto first = reader.next_batch(2);
+    auto *columns = dynamic_cast<MXList *>(first.get());
+    REQUIRE(columns);
+    auto *numbers = dynamic_cast<MXArray *>(columns->at(0));
+    REQUIRE(numbers);
+    CHECK_FALSE(numbers->is_integer());
+    CHECK(numbers->floats().size() == 2);
+
+    const auto rest = reader.next_batch(2);
+    columns = dynamic_cast<MXList *>(rest.get());
+    REQUIRE(columns);
+    numbers = dynamic_cast<MXArray *>(columns->at(0));
+    REQUIRE(numbers);
+    CHECK(numbers->is_integer());
+    CHECK(numbers->size() == 1);
+    CHECK(reader.next_batch(2) == nullptr);
+}
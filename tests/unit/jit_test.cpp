@@ -0,0 +1,63 @@
+#include "mxspp/core/MXMetrics.h"
+#include "mxspp/shell/shell.h"
+#include <catch2/catch.hpp>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <string>
+
+using mxs::shell::MXShell;
+
+namespace {
+    // runtime.bc 和脚本目录由 tests/CMakeLists.txt 传入
+    auto read_script(const std::string &name) -> std::string {
+        std::ifstream in(std::string{ MXS_TEST_SCRIPT_DIR } + "/" + name);
+        REQUIRE(in);
+        return { std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>() };
+    }
+
+    auto make_shell() -> std::unique_ptr<MXShell> {
+        auto shell = MXShell::create(MXS_TEST_RUNTIME_BC);
+        REQUIRE(static_cast<bool>(shell));
+        return std::move(*shell);
+    }
+
+    // shell 第一次用到时登记这些计数器，之后按名字取回的是同一个
+    auto counter(const char *name) -> std::uint64_t {
+        return mxs::core::MXMetricsRegistry::get_registry().counter(name, "").value();
+    }
+}
+
+TEST_CASE("a failed speculation guard falls back to the baseline", "[jit][speculation]") {
+    auto shell = make_shell();
+    const auto source = read_script("deopt_guard.mxs");
+    // 第一次运行只收集类型反馈，第二次编译出的 scaled() 假设参数是整数
+    REQUIRE(shell->run_program(source, true, "deopt_guard.mxs") == 0);
+    const auto before = counter("mxs_jit_deoptimizations_total");
+    REQUIRE(shell->run_program(source, true, "deopt_guard.mxs") == 0);
+    CHECK(counter("mxs_jit_deoptimizations_total") == before + 1);
+}
+
+TEST_CASE("let mut from a speculated parameter takes any value", "[jit][speculation]") {
+    auto shell = make_shell();
+    const auto source = read_script("speculated_let_mut.mxs");
+    // 第二次运行的 relabel() 假设参数是整数，变量仍然装箱，可以存字符串
+    REQUIRE(shell->run_program(source, true, "speculated_let_mut.mxs") == 0);
+    const auto before = counter("mxs_jit_deoptimizations_total");
+    REQUIRE(shell->run_program(source, true, "speculated_let_mut.mxs") == 0);
+    CHECK(counter("mxs_jit_deoptimizations_total") == before);
+}
+
+TEST_CASE("hot loops continue in their OSR continuation", "[jit][osr]") {
+    auto shell = make_shell();
+    const auto source = read_script("osr_loop.mxs");
+    // 每次运行有两个循环越过阈值：sum_to(150000) 的和 main 里的第二个。
+    // 第二次运行的 sum_to 是推测版本，转入的是它自己的续体
+    for (int run = 0; run < 2; ++run) {
+        const auto entries = counter("mxs_jit_osr_entries_total");
+        const auto deopts = counter("mxs_jit_deoptimizations_total");
+        REQUIRE(shell->run_program(source, true, "osr_loop.mxs") == 0);
+        CHECK(counter("mxs_jit_osr_entries_total") == entries + 2);
+        CHECK(counter("mxs_jit_deoptimizations_total") == deopts);
+    }
+}
@@ -0,0 +1,119 @@
+#include "mxspp/core/MXBoolean.h"
+#include "mxspp/core/MXCollection.h"
+#include "mxspp/core/MXError.h"
+#include "mxspp/core/MXJson.h"
+#include "mxspp/core/MXNil.h"
+#include "mxspp/core/MXNumeric.h"
+#include "mxspp/core/MXString.h"
+#include <catch2/catch.hpp>
+#include <string>
+
+using mxs::builtin::MXFloat;
+using mxs::builtin::MXInteger;
+using mxs::builtin::MXList;
+using mxs::builtin::MXNil;
+using mxs::core::MXError;
+using mxs::core::MXJsonReader;
+using mxs::core::MXMappedRegion;
+using mxs::core::MXObject;
+using mxs::core::MXString;
+using mxs::core::MXStringView;
+
+namespace {
+    auto text_of(const MXObject *value) -> std::string {
+        if (auto *str = dynamic_cast<const MXString *>(value))
+            return std::string{ str->view() };
+        if (auto *view = dynamic_cast<const MXStringView *>(value))
+            return std::string{ view->view() };
+        FAIL("not a string: " << (value ? value->repr() : "nullptr"));
+        return {};
+    }
+
+    auto parse_list(const std::string &text) -> std::unique_ptr<MXList> {
+        auto value = MXJsonReader::parse(text);
+        auto *list = dynamic_cast<MXList *>(value.get());
+        INFO(text << " -> " << (value ? value->repr() : "nullptr"));
+        REQUIRE(list);
+        value.release();
+        return std::unique_ptr<MXList>(list);
+    }
+
+    // 断言解析失败，并且错误信息里有 `what`
+    auto check_error(const std::string &text, const std::string &what) -> void {
+        const auto value = MXJsonReader::parse(text);
+        INFO(text);
+        REQUIRE(dynamic_cast<const MXError *>(value.get()));
+        CHECK_THAT(value->repr(), Catch::Matchers::Contains(what));
+    }
+}
+
+TEST_CASE("escaped quotes across a 64-byte block", "[json][simd]") {
+    // 反斜杠是第一个块的最后一个字节，被转义的引号是第二个块的第一个字节
+    const std::string before(61, 'a');
+    auto list = parse_list("[\"" + before + "\\\"b\", 1]");
+    REQUIRE(list->size() == 2);
+    CHECK(text_of(list->at(0)) == before + "\"b");
+    CHECK(dynamic_cast<MXInteger *>(list->at(1))->value == 1);
+
+    // 两个反斜杠互相转义，块边界上的引号是字符串的结尾
+    const std::string shorter(60, 'a');
+    list = parse_list("[\"" + shorter + "\\\\\", 2]");
+    REQUIRE(list->size() == 2);
+    CHECK(text_of(list->at(0)) == shorter + "\\");
+    CHECK(dynamic_cast<MXInteger *>(list->at(1))->value == 2);
+}
+
+TEST_CASE("surrogate pairs", "[json]") {
+    auto list = parse_list(R"(["\uD83D\uDE00", "\u00e9"])");
+    CHECK(text_of(list->at(0)) == "\xF0\x9F\x98\x80");
+    CHECK(text_of(list->at(1)) == "\xC3\xA9");
+
+    check_error(R"("\uD83D")", "unpaired surrogate");
+    check_error(R"("\uD83D\u0041")", "unpaired surrogate");
+    check_error(R"("\uDE00")", "unpaired surrogate");
+    check_error(R"("\uD83")", "invalid \\u escape");
+}
+
+TEST_CASE("invalid numbers are rejected", "[json]") {
+    for (const char *text : { "01", "1.", ".5", "-", "1e", "1e+", "+1", "nan", "inf",
+                              "0x10", "--1", "1.5.2" }) {
+        check_error(text, "invalid literal");
+    }
+
+    auto list = parse_list("[-0.5e3, 9223372036854775807, 9223372036854775808, -0]");
+    CHECK(dynamic_cast<MXFloat *>(list->at(0))->value == -500.0);
+    CHECK(dynamic_cast<MXInteger *>(list->at(1))->value == INT64_MAX);
+    CHECK(dynamic_cast<MXFloat *>(list->at(2)));
+    CHECK(dynamic_cast<MXInteger *>(list->at(3))->value == 0);
+}
+
+TEST_CASE("raw control bytes are rejected", "[json]") {
+    check_error("\"a\tb\"", "control character in string");
+    check_error("[\"ok\", \"a\x01\"]", "control character in string");
+    // 控制字节在第二个 64 字节块里
+    check_error("\"" + std::string(80, 'x') + "\x1f\"", "control character in string");
+    // 走转义解码的慢路径时也要检查
+    check_error("\"\\n\x02\"", "control character in string");
+    check_error("[1,\v2]", "control character outside a string");
+    check_error("[true\x0c]", "control character outside a string");
+
+    // 转义过的控制字符和四种 JSON 空白都是合法的
+    auto list = parse_list("\t[\"a\\tb\\u0001\",\r\n 1]\n");
+    CHECK(text_of(list->at(0)) == "a\tb\x01");
+}
+
+TEST_CASE("top-level null is an explicit nil", "[json]") {
+    CHECK(dynamic_cast<MXNil *>(MXJsonReader::parse("null").get()));
+
+    MXJsonReader reader{ MXMappedRegion::adopt("1 null\n[null]") };
+    CHECK(dynamic_cast<MXInteger *>(reader.next().get()));
+    // nullptr 只表示输入结束，所以文档本身是 null 时得到 MXNil
+    CHECK(dynamic_cast<MXNil *>(reader.next().get()));
+    CHECK_FALSE(reader.done());
+    const auto nested = reader.next();
+    auto *list = dynamic_cast<MXList *>(nested.get());
+    REQUIRE(list);
+    CHECK(list->at(0) == nullptr);
+    CHECK(reader.done());
+    CHECK(reader.next() == nullptr);
+}
@@ -0,0 +1,3 @@
+// Catch2 单元测试的入口；各个 *_test.cpp 只写 TEST_CASE
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
@@ -0,0 +1,20 @@
+#include "mxspp/core/MXMetrics.h"
+#include <catch2/catch.hpp>
+#include <sstream>
+
+using mxs::core::MXMetricsRegistry;
+
+TEST_CASE("collectors run outside the registry lock", "[metrics]") {
+    auto &registry = MXMetricsRegistry::get_registry();
+    // 回调里再访问注册表：在锁内调用回调时这里会死锁
+    registry.collector("mxs_test_reentrant", "Collector that touches the registry.",
+                       MXMetricsRegistry::Kind::GAUGE, "", [&registry] {
+                           registry.counter("mxs_test_from_collector_total", "").add();
+                           return std::map<std::string, double>{ { "", 7.0 } };
+                       });
+
+    std::ostringstream out;
+    registry.write_prometheus(out);
+    CHECK_THAT(out.str(), Catch::Matchers::Contains("mxs_test_reentrant 7\n"));
+    CHECK(registry.counter("mxs_test_from_collector_total", "").value() == 1);
+}
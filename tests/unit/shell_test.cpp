@@ -0,0 +1,64 @@
+#include "mxspp/shell/shell.h"
+#include <catch2/catch.hpp>
+#include <memory>
+#include <string>
+#include <utility>
+
+using mxs::shell::MXShell;
+
+namespace {
+    auto make_shell() -> std::unique_ptr<MXShell> {
+        auto shell = MXShell::create(MXS_TEST_RUNTIME_BC);
+        REQUIRE(static_cast<bool>(shell));
+        return std::move(*shell);
+    }
+}
+
+TEST_CASE("program key covers the runtime", "[shell][cache]") {
+    constexpr std::string_view source = "func main() -> int { return 0; }";
+    const auto key = MXShell::program_key(source, "a.mxs", 0x1234, false);
+
+    // 同样的输入得到同样的键，缓存才能命中
+    CHECK(MXShell::program_key(source, "a.mxs", 0x1234, false) == key);
+    // 换了 runtime.bc（或 LLVM、宿主 CPU）的进程不能复用旧的目标代码
+    CHECK(MXShell::program_key(source, "a.mxs", 0x1235, false) != key);
+    CHECK(MXShell::program_key(source, "a.mxs", 0x1234ull << 32, false) != key);
+}
+
+TEST_CASE("program key covers source, name and --strip-asserts", "[shell][cache]") {
+    const auto key = MXShell::program_key("func main() -> int { return 0; }", "a.mxs", 7, false);
+    CHECK(MXShell::program_key("func main() -> int { return 1; }", "a.mxs", 7, false) != key);
+    CHECK(MXShell::program_key("func main() -> int { return 0; }", "b.mxs", 7, false) != key);
+    CHECK(MXShell::program_key("func main() -> int { return 0; }", "a.mxs", 7, true) != key);
+}
+
+TEST_CASE("await outside an async func is a compile error", "[shell][repl]") {
+    auto shell = make_shell();
+    using Catch::Matchers::Contains;
+    // 非 async 函数、REPL 的包装函数都没有协程帧
+    const auto in_function = shell->eval("func f() -> int { return await f(); }");
+    CHECK_THAT(in_function, Contains("CompileError"));
+    CHECK_THAT(in_function, Contains("<repl>:1:"));
+    CHECK_THAT(in_function, Contains("await is only valid inside an async func"));
+    CHECK_THAT(shell->eval("await 1;"), Contains("CompileError"));
+    // 出错的输入不留下半个函数，之后的输入照常求值
+    CHECK_THAT(shell->eval("1 + 2"), Contains("3"));
+}
+
+TEST_CASE("top-level defer, break and continue are rejected", "[shell][repl]") {
+    auto shell = make_shell();
+    using Catch::Matchers::Contains;
+    // 在生成代码之前就报告，而不是走到 codegen 里的检查
+    const std::pair<const char *, std::string> inputs[] = {
+        { "defer { 1; }", "defer" }, { "break;", "break" }, { "continue;", "continue" }
+    };
+    for (const auto &[input, keyword] : inputs) {
+        INFO(input);
+        const auto result = shell->eval(input);
+        CHECK_THAT(result, Contains("SyntaxError"));
+        CHECK_THAT(result,
+                   Contains("<repl>:1:1: " + keyword + " is not valid at the top"));
+    }
+    // 块和循环里的同样语句照常可用
+    CHECK_THAT(shell->eval("loop { defer { 1; } break; }"), !Contains("Error"));
+}
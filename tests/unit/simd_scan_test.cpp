@@ -0,0 +1,67 @@
+#include "mxspp/core/MXSimdScan.h"
+#include <catch2/catch.hpp>
+#include <array>
+#include <cstdint>
+#include <vector>
+
+using mxs::core::MX_SCAN_BLOCK;
+using mxs::core::mx_pop_bit;
+using mxs::core::mx_prefix_xor;
+using mxs::core::MXScanBlock;
+
+namespace {
+    // 逐字节算出的掩码，作为 SIMD 实现的参照
+    template<typename Predicate>
+    auto reference_mask(const char *bytes, Predicate &&matches) -> std::uint64_t {
+        std::uint64_t mask = 0;
+        for (std::size_t i = 0; i < MX_SCAN_BLOCK; ++i) {
+            const bool hit = matches(static_cast<unsigned char>(bytes[i]));
+            mask |= static_cast<std::uint64_t>(hit) << i;
+        }
+        return mask;
+    }
+}
+
+TEST_CASE("block masks match a byte-by-byte scan", "[simd]") {
+    // 四个块覆盖全部 256 个字节值，包括 >= 0x80 的 UTF-8 字节
+    std::array<char, 256> bytes{};
+    for (std::size_t i = 0; i < bytes.size(); ++i)
+        bytes[i] = static_cast<char>(i * 7 + 3);
+
+    for (std::size_t base = 0; base < bytes.size(); base += MX_SCAN_BLOCK) {
+        const MXScanBlock block{ bytes.data() + base, MX_SCAN_BLOCK };
+        for (const char needle : { '"', '\\', ',', '\n', ' ', '\x80', '\xff' }) {
+            INFO("block " << base << ", byte "
+                          << int(static_cast<unsigned char>(needle)));
+            CHECK(block.eq(needle)
+                  == reference_mask(bytes.data() + base, [&](unsigned char c) {
+                         return c == static_cast<unsigned char>(needle);
+                     }));
+        }
+        CHECK(block.control()
+              == reference_mask(bytes.data() + base,
+                                [](unsigned char c) { return c < 0x20; }));
+    }
+}
+
+TEST_CASE("a short block is padded with spaces", "[simd]") {
+    const char tail[] = "\"a\x01";
+    const MXScanBlock block{ tail, 3 };
+    CHECK(block.eq('"') == 0b001);
+    CHECK(block.control() == 0b100);
+    // 填充的空格既不是控制字节，也不会被当成别的字符
+    CHECK(block.eq(' ') == ~std::uint64_t{ 0b111 });
+}
+
+TEST_CASE("prefix xor turns quotes into an inside-quotes mask", "[simd]") {
+    // 引号在 1 和 5：1..4 在引号内
+    CHECK(mx_prefix_xor(0b100010) == 0b011110);
+    CHECK(mx_prefix_xor(0) == 0);
+    // 最高位上的开引号让下一块从引号内开始
+    CHECK(mx_prefix_xor(std::uint64_t{ 1 } << 63) >> 63 == 1);
+
+    std::uint64_t bits = 0x8000'0000'0000'0101ULL;
+    std::vector<unsigned> popped;
+    while (bits != 0) popped.push_back(mx_pop_bit(bits));
+    CHECK(popped == std::vector<unsigned>{ 0, 8, 63 });
+}
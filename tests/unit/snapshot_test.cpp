@@ -0,0 +1,135 @@
+#include "mxspp/core/MXBoolean.h"
+#include "mxspp/core/MXCollection.h"
+#include "mxspp/core/MXError.h"
+#include "mxspp/core/MXNumeric.h"
+#include "mxspp/core/MXSnapshot.h"
+#include "mxspp/core/MXString.h"
+#include <catch2/catch.hpp>
+#include <cstdio>
+#include <filesystem>
+#include <format>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+using mxs::builtin::MXArray;
+using mxs::builtin::MXBoolean;
+using mxs::builtin::MXDict;
+using mxs::builtin::MXFloat;
+using mxs::builtin::MXInteger;
+using mxs::builtin::MXList;
+using mxs::core::MXError;
+using mxs::core::MXSnapshotImage;
+using mxs::core::MXSnapshotWriter;
+using mxs::core::MXString;
+
+namespace {
+    constexpr std::uint64_t KEY = 0x6d78'7369'0000'0001ULL;
+
+    // 测试结束时删掉镜像文件
+    struct TempImage {
+        std::string path = (std::filesystem::temp_directory_path()
+                            / std::format("mxs-snapshot-test-{}.mxsi", ::getpid()))
+                                   .string();
+        ~TempImage() { std::remove(this->path.c_str()); }
+    };
+
+    // 和 module init 之后的全局表一样：标量、嵌套容器、nil，以及同一个字符串出现两次
+    auto make_config() -> std::unique_ptr<MXDict> {
+        auto config = std::make_unique<MXDict>();
+        config->set("name", std::make_unique<MXString>("mxs"));
+        config->set("limits",
+                    std::make_unique<MXArray>(std::vector<std::int64_t>{ 1, 2, 3 }));
+        config->set("weights",
+                    std::make_unique<MXArray>(std::vector<double>{ 0.5, 1.5 }));
+        config->set("missing", nullptr);
+        auto items = std::make_unique<MXList>();
+        items->append(std::make_unique<MXInteger>(7));
+        items->append(std::make_unique<MXFloat>(2.5));
+        items->append(std::make_unique<MXBoolean>(true));
+        items->append(std::make_unique<MXString>("mxs"));
+        items->append(nullptr);
+        config->set("items", std::move(items));
+        return config;
+    }
+}
+
+TEST_CASE("globals round-trip through an image", "[snapshot]") {
+    const TempImage image;
+    const auto config = make_config();
+    const MXInteger answer{ 42 };
+    {
+        MXSnapshotWriter writer;
+        REQUIRE(writer.add_root("config", config.get()) == nullptr);
+        REQUIRE(writer.add_root("answer", &answer) == nullptr);
+        REQUIRE(writer.add_root("nothing", nullptr) == nullptr);
+        // 放不进镜像的值被拒绝，而且不留下半条记录
+        const MXError error{ "IOError", "not serializable" };
+        CHECK(writer.add_root("error", &error) != nullptr);
+        writer.set_code("object code");
+        writer.set_flags(1);
+        REQUIRE(writer.write(image.path, KEY) == nullptr);
+    }
+
+    CHECK(MXSnapshotImage::open(image.path, KEY + 1) == nullptr);
+    const auto loaded = MXSnapshotImage::open(image.path, KEY);
+    REQUIRE(loaded);
+    CHECK(loaded->code() == "object code");
+    CHECK(loaded->flags() == 1);
+
+    const auto roots = loaded->restore();
+    REQUIRE(roots.size() == 3);
+    CHECK(roots[0].first == "config");
+    CHECK(roots[0].second->repr() == config->repr());
+    CHECK(roots[1].first == "answer");
+    CHECK(dynamic_cast<MXInteger *>(roots[1].second.get())->value == 42);
+    CHECK(roots[2].first == "nothing");
+    CHECK(roots[2].second == nullptr);
+
+    auto *restored = dynamic_cast<MXDict *>(roots[0].second.get());
+    REQUIRE(restored);
+    CHECK(restored->keys().size() == config->keys().size());
+    CHECK(restored->contains("missing"));
+    CHECK(restored->get("missing") == nullptr);
+    auto *limits = dynamic_cast<MXArray *>(restored->get("limits"));
+    REQUIRE(limits);
+    CHECK(limits->is_integer());
+    auto *weights = dynamic_cast<MXArray *>(restored->get("weights"));
+    REQUIRE(weights);
+    CHECK_FALSE(weights->is_integer());
+}
+
+TEST_CASE("restored globals are deep copies", "[snapshot]") {
+    const TempImage image;
+    const auto config = make_config();
+    {
+        MXSnapshotWriter writer;
+        REQUIRE(writer.add_root("config", config.get()) == nullptr);
+        REQUIRE(writer.write(image.path, KEY) == nullptr);
+    }
+    const auto loaded = MXSnapshotImage::open(image.path, KEY);
+    REQUIRE(loaded);
+
+    auto first = loaded->restore();
+    auto second = loaded->restore();
+    auto *one = dynamic_cast<MXDict *>(first[0].second.get());
+    auto *two = dynamic_cast<MXDict *>(second[0].second.get());
+    REQUIRE(one);
+    REQUIRE(two);
+    // 每次 restore 都是新的对象图，和写入时的对象也不共享
+    CHECK(one != two);
+    CHECK(one->get("items") != two->get("items"));
+    CHECK(one->get("items") != config->get("items"));
+
+    // 镜像里驻留成一条记录的字符串，恢复后仍是两个独立对象
+    auto *items = dynamic_cast<MXList *>(one->get("items"));
+    REQUIRE(items);
+    CHECK(items->at(3) != one->get("name"));
+    CHECK(items->at(3)->repr() == one->get("name")->repr());
+
+    // 修改一份恢复结果，不影响另一份，也不影响原来的值
+    items->append(std::make_unique<MXInteger>(8));
+    one->set("name", std::make_unique<MXString>("changed"));
+    CHECK(two->repr() == config->repr());
+    CHECK(one->repr() != config->repr());
+}
@@ -5,7 +5,6 @@ set(CMAKE_SYSTEM_NAME Linux)
 set(CMAKE_C_COMPILER clang)
 set(CMAKE_CXX_COMPILER clang++)
 
-# 使用全局命令为所有后续目标添加编译和链接选项。
-# 这是最直接、最权威的方式，确保所有模块都使用libc++。
-add_compile_options("-stdlib=libc++")
-add_link_options("-stdlib=libc++")
\ No newline at end of file
+# 所有模块都使用 libc++。根目录的 CMakeLists.txt 据此为每个目标加上 -stdlib，
+# src/runtime 单独编译 runtime.bc 时也用同一个值
+set(MXS_CXX_STDLIB libc++ CACHE STRING "C++ standard library passed as -stdlib=")
\ No newline at end of file